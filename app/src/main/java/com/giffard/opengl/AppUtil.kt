@@ -4,6 +4,10 @@ import android.content.ContentUris
 import android.content.Context
 import android.os.Build
 import android.provider.MediaStore
+import com.giffard.video_player.library.MediaInfo
+import com.giffard.video_player.library.MediaProber
+import com.giffard.video_player.library.ProbeRequest
+import java.io.File
 
 object AppUtil {
 
@@ -43,4 +47,36 @@ object AppUtil {
 
         return null // 未找到视频
     }
+
+    /**
+     * 列出媒体库里的所有视频并取得时长、分辨率、帧率和编码。MediaStore 的 SIZE 和 DATE_MODIFIED
+     * 作为缓存校验值传给 native，缓存已热时不打开任何文件；未命中的文件在 native 线程池上并行探测。
+     * 会阻塞调用线程，不要在主线程调用
+     */
+    fun scanVideoLibrary(context: Context): List<Pair<String, MediaInfo?>> {
+        MediaProber.setCacheFile(File(context.cacheDir, "media_probe.bin"))
+        val projection = arrayOf(
+            MediaStore.Video.Media.DATA,
+            MediaStore.Video.Media.SIZE,
+            MediaStore.Video.Media.DATE_MODIFIED
+        )
+        val requests = ArrayList<ProbeRequest>()
+        context.contentResolver.query(
+            MediaStore.Video.Media.EXTERNAL_CONTENT_URI,
+            projection,
+            null,
+            null,
+            null
+        )?.use { cursor ->
+            val dataColumn = cursor.getColumnIndexOrThrow(MediaStore.Video.Media.DATA)
+            val sizeColumn = cursor.getColumnIndexOrThrow(MediaStore.Video.Media.SIZE)
+            val modifiedColumn = cursor.getColumnIndexOrThrow(MediaStore.Video.Media.DATE_MODIFIED)
+            while (cursor.moveToNext()) {
+                val path = cursor.getString(dataColumn) ?: continue
+                requests.add(ProbeRequest(path, cursor.getLong(sizeColumn), cursor.getLong(modifiedColumn)))
+            }
+        }
+        val results = MediaProber.probe(requests)
+        return requests.map { it.path }.zip(results)
+    }
 }
@@ -22,6 +22,14 @@ android {
     }
 
     buildTypes {
+        debug {
+            externalNativeBuild {
+                cmake {
+                    // Debug 构建开启管线事件追踪
+                    arguments("-DVP_ENABLE_TRACE=ON")
+                }
+            }
+        }
         release {
             isMinifyEnabled = false
             proguardFiles(
@@ -0,0 +1,208 @@
+#define LOG_TAG "Native-Abr"
+
+#include "abr_controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <strings.h>
+
+#include "log.h"
+#include "metrics.h"
+#include "trace.h"
+
+namespace {
+
+    const double FAST_HALF_LIFE_SECS = 2.0;    // 快速 EWMA 半衰期（按下载时间计）
+    const double SLOW_HALF_LIFE_SECS = 8.0;    // 慢速 EWMA 半衰期
+    const int64_t MIN_SAMPLE_BYTES = 16 * 1024;  // 太小的传输（播放列表等）受延迟主导，不计入吞吐
+    const double SAFETY_FACTOR = 0.8;          // 只选码率不超过吞吐估计 80% 的变体
+    const double PANIC_BUFFER = 0.25;          // 缓冲低于此值时强制降档
+    const double UPSWITCH_BUFFER = 0.75;       // 缓冲高于此值才允许升档，也在此时容忍短暂的吞吐下降
+    const int64_t MIN_UPSWITCH_INTERVAL = 4 * AV_TIME_BASE;  // 两次升档的最小间隔，避免来回切换
+
+    int64_t metadataInt(const AVDictionary *metadata, const char *key) {
+        const AVDictionaryEntry *entry = av_dict_get(metadata, key, nullptr, 0);
+        return entry ? strtoll(entry->value, nullptr, 10) : 0;
+    }
+
+    // 播放列表 / MPD 的刷新不是分片边界
+    bool isPlaylistUrl(const char *url) {
+        const char *end = strchr(url, '?');
+        size_t length = end ? static_cast<size_t>(end - url) : strlen(url);
+        auto endsWith = [&](const char *suffix) {
+            size_t n = strlen(suffix);
+            return length >= n && strncasecmp(url + length - n, suffix, n) == 0;
+        };
+        return endsWith(".m3u8") || endsWith(".m3u") || endsWith(".mpd");
+    }
+
+}  // namespace
+
+bool AbrController::attach(AVFormatContext *context) {
+    variants_.clear();
+
+    // HLS：每个变体是一个 program，码率在 program 的元数据里
+    for (unsigned int i = 0; i < context->nb_programs; i++) {
+        const AVProgram *program = context->programs[i];
+        Variant variant;
+        variant.bitrate = metadataInt(program->metadata, "variant_bitrate");
+        for (unsigned int j = 0; j < program->nb_stream_indexes; j++) {
+            int index = static_cast<int>(program->stream_index[j]);
+            variant.streams.push_back(index);
+            if (variant.videoStream < 0 &&
+                context->streams[index]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+                variant.videoStream = index;
+            }
+        }
+        if (variant.bitrate > 0 && variant.videoStream >= 0) {
+            variants_.push_back(variant);
+        }
+    }
+
+    // DASH：没有 program，每个带码率的视频流（representation）是一个变体
+    if (variants_.size() < 2) {
+        variants_.clear();
+        for (unsigned int i = 0; i < context->nb_streams; i++) {
+            const AVStream *stream = context->streams[i];
+            Variant variant;
+            variant.bitrate = metadataInt(stream->metadata, "variant_bitrate");
+            if (stream->codecpar->codec_type != AVMEDIA_TYPE_VIDEO || variant.bitrate <= 0) {
+                continue;
+            }
+            variant.videoStream = static_cast<int>(i);
+            variant.streams.push_back(static_cast<int>(i));
+            variants_.push_back(variant);
+        }
+    }
+
+    if (variants_.size() < 2) {
+        variants_.clear();
+        return false;
+    }
+
+    std::sort(variants_.begin(), variants_.end(), [](const Variant &a, const Variant &b) {
+        return a.bitrate < b.bitrate;
+    });
+    for (auto &variant: variants_) {
+        const AVCodecParameters *par = context->streams[variant.videoStream]->codecpar;
+        variant.width = par->width;
+        variant.height = par->height;
+        LOGI("变体: %lld bps, %dx%d, 视频流 %d", static_cast<long long>(variant.bitrate),
+             variant.width, variant.height, variant.videoStream);
+    }
+
+    context_ = context;
+    current_ = -1;
+    applyVariant(0);
+    return true;
+}
+
+void AbrController::connect(IoHooks &hooks) {
+    hooks.setOpenCallback([this](const char *url) { onSegmentOpen(url); });
+    hooks.setCloseCallback([this](const IoHooks::Transfer &transfer) { onTransfer(transfer); });
+}
+
+void AbrController::onTransfer(const IoHooks::Transfer &transfer) {
+    if (transfer.bytes < MIN_SAMPLE_BYTES || transfer.readMicros <= 0) {
+        return;
+    }
+    static auto &throughputKbps = metrics::counter("abr.throughputKbps");
+
+    // 按下载时间加权，下载越久的样本越可信
+    double seconds = static_cast<double>(transfer.readMicros) / AV_TIME_BASE;
+    double sample = static_cast<double>(transfer.bytes) * 8 / seconds;
+    double fastAlpha = std::pow(0.5, seconds / FAST_HALF_LIFE_SECS);
+    double slowAlpha = std::pow(0.5, seconds / SLOW_HALF_LIFE_SECS);
+    fastEstimate_ = fastAlpha * fastEstimate_ + (1 - fastAlpha) * sample;
+    slowEstimate_ = slowAlpha * slowEstimate_ + (1 - slowAlpha) * sample;
+    totalWeight_ += seconds;
+    TRACE_COUNTER("abr.sampleKbps", static_cast<int64_t>(sample / 1000));
+    throughputKbps.set(static_cast<int64_t>(throughputEstimate() / 1000));
+}
+
+double AbrController::throughputEstimate() const {
+    if (totalWeight_ <= 0) {
+        return 0;
+    }
+    // 修正初始值为 0 带来的偏低，取快慢两个估计中较保守的一个
+    double fast = fastEstimate_ / (1 - std::pow(0.5, totalWeight_ / FAST_HALF_LIFE_SECS));
+    double slow = slowEstimate_ / (1 - std::pow(0.5, totalWeight_ / SLOW_HALF_LIFE_SECS));
+    return std::min(fast, slow);
+}
+
+void AbrController::onSegmentOpen(const char *url) {
+    if (!context_ || isPlaylistUrl(url)) {
+        return;
+    }
+    static auto &segments = metrics::counter("abr.segments");
+    static auto &bufferPercent = metrics::counter("abr.bufferPercent");
+    segments.add(1);
+    if (totalWeight_ <= 0) {
+        return;
+    }
+
+    double throughput = throughputEstimate();
+    double bufferLevel = bufferProbe_ ? bufferProbe_() : 1.0;
+    bufferPercent.set(static_cast<int64_t>(bufferLevel * 100));
+
+    int next = chooseVariant(bufferLevel, throughput, av_gettime_relative());
+    if (next != current_) {
+        LOGI("切换变体: %lld -> %lld bps（吞吐 %.0f kbps，缓冲 %.0f%%）",
+             static_cast<long long>(variants_[current_].bitrate),
+             static_cast<long long>(variants_[next].bitrate), throughput / 1000,
+             bufferLevel * 100);
+        applyVariant(next);
+    }
+}
+
+int AbrController::chooseVariant(double bufferLevel, double throughput, int64_t now) const {
+    // 吞吐能承受的最高变体
+    int byRate = 0;
+    for (int i = 0; i < static_cast<int>(variants_.size()); i++) {
+        if (static_cast<double>(variants_[i].bitrate) <= throughput * SAFETY_FACTOR) {
+            byRate = i;
+        }
+    }
+
+    // 缓冲快耗尽：至少降一档，避免卡顿
+    if (bufferLevel < PANIC_BUFFER) {
+        return std::min(byRate, std::max(current_ - 1, 0));
+    }
+    if (byRate > current_) {
+        bool canUpswitch = bufferLevel >= UPSWITCH_BUFFER &&
+                           now - lastSwitchTime_ >= MIN_UPSWITCH_INTERVAL;
+        return canUpswitch ? byRate : current_;
+    }
+    if (byRate < current_) {
+        // 缓冲充足且吞吐仍高于当前码率时保持，不为短暂波动降档
+        bool canHold = bufferLevel >= UPSWITCH_BUFFER &&
+                       static_cast<double>(variants_[current_].bitrate) <= throughput;
+        return canHold ? current_ : byRate;
+    }
+    return current_;
+}
+
+void AbrController::applyVariant(int index) {
+    static auto &bitrateKbps = metrics::counter("abr.bitrateKbps");
+    static auto &switchesUp = metrics::counter("abr.switchesUp");
+    static auto &switchesDown = metrics::counter("abr.switchesDown");
+    TRACE_SCOPE("abr.switch");
+
+    // 先全部 discard，再只打开选中变体的视频流；播放器不解码音频，变体的音频流（包括多个变体
+    // 共用的 HLS 音频组）保持 discard，对应的播放列表和分片不再下载
+    for (const auto &variant: variants_) {
+        for (int stream: variant.streams) {
+            context_->streams[stream]->discard = AVDISCARD_ALL;
+        }
+    }
+    context_->streams[variants_[index].videoStream]->discard = AVDISCARD_DEFAULT;
+
+    if (current_ >= 0) {
+        (index > current_ ? switchesUp : switchesDown).add(1);
+    }
+    current_ = index;
+    lastSwitchTime_ = av_gettime_relative();
+    activeVideoStream_ = variants_[index].videoStream;
+    bitrateKbps.set(variants_[index].bitrate / 1000);
+}
@@ -0,0 +1,130 @@
+#define LOG_TAG "Native-Async"
+
+#include "async_executor.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "ffmpeg_headers.h"
+#include "log.h"
+#include "metrics.h"
+#include "trace.h"
+
+namespace async {
+
+    void Task::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+        Executor *executor = handle.promise().executor;
+        // 先销毁协程帧再通知，waitIdle 返回时任务占用的资源都已释放
+        handle.destroy();
+        if (executor) {
+            executor->taskFinished();
+        }
+    }
+
+    Executor::Executor(int threads) {
+        int count = std::max(1, threads);
+        threads_.reserve(count);
+        for (int i = 0; i < count; i++) {
+            threads_.emplace_back(&Executor::run, this);
+        }
+        LOGI("协程执行器: %d 个工作线程", count);
+    }
+
+    Executor::~Executor() {
+        waitIdle();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread &thread: threads_) {
+            thread.join();
+        }
+    }
+
+    int64_t Executor::now() {
+        return av_gettime_relative();
+    }
+
+    void Executor::spawn(Task task) {
+        std::coroutine_handle<Task::promise_type> handle = std::exchange(task.handle_, nullptr);
+        handle.promise().executor = this;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            activeTasks_++;
+        }
+        post(handle);
+    }
+
+    void Executor::post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(handle);
+        }
+        cv_.notify_one();
+    }
+
+    void Executor::postAt(int64_t deadlineUs, std::coroutine_handle<> handle) {
+        static auto &timerWaits = metrics::counter("async.timerWaits");
+        timerWaits.add(1);
+        bool earliest;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            earliest = timers_.empty() || deadlineUs < timers_.top().deadlineUs;
+            timers_.push({deadlineUs, timerSequence_++, handle});
+        }
+        // 新的最早时间点要让等待中的线程重新计算睡眠时长
+        if (earliest) {
+            cv_.notify_one();
+        }
+    }
+
+    void Executor::waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCv_.wait(lock, [this]() { return activeTasks_ == 0; });
+    }
+
+    void Executor::taskFinished() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--activeTasks_ == 0) {
+            idleCv_.notify_all();
+        }
+    }
+
+    void Executor::run() {
+        static auto &resumes = metrics::counter("async.resumes");
+        TRACE_THREAD_NAME("async");
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            // 到期的定时器移到就绪队列
+            int64_t current = now();
+            while (!timers_.empty() && timers_.top().deadlineUs <= current) {
+                ready_.push_back(timers_.top().handle);
+                timers_.pop();
+            }
+            if (!ready_.empty()) {
+                std::coroutine_handle<> handle = ready_.front();
+                ready_.pop_front();
+                bool more = !ready_.empty();
+                lock.unlock();
+                if (more) {
+                    // 还有就绪的协程，叫醒另一个线程并行处理
+                    cv_.notify_one();
+                }
+                resumes.add(1);
+                handle.resume();
+                lock.lock();
+                continue;
+            }
+            if (stopping_) {
+                break;
+            }
+            if (timers_.empty()) {
+                cv_.wait(lock);
+            } else {
+                cv_.wait_for(lock, std::chrono::microseconds(timers_.top().deadlineUs - current));
+            }
+        }
+    }
+
+}  // namespace async
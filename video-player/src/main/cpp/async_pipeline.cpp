@@ -0,0 +1,263 @@
+#define LOG_TAG "Native-AsyncPipeline"
+
+#include "async_pipeline.h"
+
+#include <chrono>
+#include <vector>
+
+#include "decoder_pool.h"
+#include "log.h"
+#include "metrics.h"
+#include "stream_selection.h"
+#include "trace.h"
+
+namespace {
+
+    const int STAGE_COUNT = 4;
+
+    void freePacket(AVPacket *&packet) {
+        av_packet_free(&packet);
+    }
+
+    void freeFrame(AVFrame *&frame) {
+        av_frame_free(&frame);
+    }
+
+}  // namespace
+
+AsyncPipeline::AsyncPipeline(async::Executor &executor, std::shared_ptr<VideoSink> sink)
+        : executor_(executor), sink_(std::move(sink)) {}
+
+AsyncPipeline::~AsyncPipeline() {
+    stop();
+    if (codecContext_) {
+        DecoderPool::instance().release(codecContext_);
+    }
+    avformat_close_input(&formatContext_);
+}
+
+bool AsyncPipeline::open(const char *path, const AsyncPipelineOptions &options) {
+    options_ = options;
+    formatContext_ = avformat_alloc_context();
+    if (!formatContext_) {
+        return false;
+    }
+    // 停止时让阻塞的 av_read_frame 立即返回
+    formatContext_->interrupt_callback.callback = [](void *opaque) -> int {
+        return static_cast<AsyncPipeline *>(opaque)->abortRequest_ ? 1 : 0;
+    };
+    formatContext_->interrupt_callback.opaque = this;
+    if (avformat_open_input(&formatContext_, path, nullptr, nullptr) != 0) {
+        LOGE("无法打开输入: %s", path);
+        return false;
+    }
+    if (avformat_find_stream_info(formatContext_, nullptr) < 0) {
+        LOGE("无法读取流信息: %s", path);
+        return false;
+    }
+    const AVCodec *codec = nullptr;
+    streamIndex_ = streams::selectVideoStream(formatContext_, {}, &codec);
+    if (streamIndex_ < 0 || !codec) {
+        LOGE("没有可解码的视频流: %s", path);
+        return false;
+    }
+    streams::discardAllExcept(formatContext_, streamIndex_);
+
+    AVStream *stream = formatContext_->streams[streamIndex_];
+    DecoderOptions decoderOptions;
+    decoderOptions.threadCount = options_.decoderThreads;
+    codecContext_ = DecoderPool::instance().acquire(codec, stream->codecpar, decoderOptions);
+    if (!codecContext_) {
+        return false;
+    }
+    codecContext_->pkt_timebase = stream->time_base;
+    frameRate_ = av_q2d(stream->avg_frame_rate);
+
+    packets_ = std::make_unique<async::AsyncQueue<AVPacket *>>(executor_, options_.queueSize);
+    decoded_ = std::make_unique<async::AsyncQueue<AVFrame *>>(executor_, options_.queueSize);
+    converted_ = std::make_unique<async::AsyncQueue<AVFrame *>>(executor_, options_.queueSize);
+    return true;
+}
+
+void AsyncPipeline::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (started_ || !codecContext_) {
+            return;
+        }
+        started_ = true;
+        runningStages_ = STAGE_COUNT;
+    }
+    executor_.spawn(present());
+    executor_.spawn(convert());
+    executor_.spawn(decode());
+    executor_.spawn(demux());
+}
+
+void AsyncPipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_) {
+            return;
+        }
+    }
+    abortRequest_ = true;
+    packets_->close();
+    decoded_->close();
+    converted_->close();
+    wait();
+    packets_->drain(freePacket);
+    decoded_->drain(freeFrame);
+    converted_->drain(freeFrame);
+}
+
+bool AsyncPipeline::finished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return started_ && runningStages_ == 0;
+}
+
+bool AsyncPipeline::wait(int64_t timeoutUs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto done = [this]() { return !started_ || runningStages_ == 0; };
+    if (timeoutUs < 0) {
+        cv_.wait(lock, done);
+        return true;
+    }
+    return cv_.wait_for(lock, std::chrono::microseconds(timeoutUs), done);
+}
+
+void AsyncPipeline::stageFinished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--runningStages_ == 0) {
+        cv_.notify_all();
+    }
+}
+
+// 解复用：读到的视频包交给解码阶段，队列满时挂起
+async::Task AsyncPipeline::demux() {
+    while (!abortRequest_) {
+        AVPacket *packet = av_packet_alloc();
+        if (!packet) {
+            break;
+        }
+        TRACE_BEGIN("async.demux");
+        int readResult = av_read_frame(formatContext_, packet);
+        TRACE_END("async.demux");
+        if (readResult < 0) {
+            av_packet_free(&packet);
+            break;
+        }
+        if (packet->stream_index != streamIndex_) {
+            av_packet_free(&packet);
+            continue;
+        }
+        if (!co_await packets_->push(packet)) {
+            av_packet_free(&packet);
+            break;
+        }
+    }
+    packets_->close();
+    stageFinished();
+}
+
+// 解码：每个包送入解码器后取出所有可用的帧；包队列结束后冲刷解码器
+async::Task AsyncPipeline::decode() {
+    bool draining = false;
+    while (!abortRequest_) {
+        std::optional<AVPacket *> packet;
+        if (!draining) {
+            packet = co_await packets_->pop();
+            draining = !packet;
+        }
+        TRACE_BEGIN("async.decode");
+        int sendResult = avcodec_send_packet(codecContext_, packet ? *packet : nullptr);
+        TRACE_END("async.decode");
+        if (packet) {
+            av_packet_free(&*packet);
+        }
+        if (sendResult < 0 && sendResult != AVERROR(EAGAIN) && !draining) {
+            continue;
+        }
+        bool ended = false;
+        while (true) {
+            AVFrame *frame = av_frame_alloc();
+            TRACE_BEGIN("async.receive");
+            int receiveResult = frame ? avcodec_receive_frame(codecContext_, frame) : AVERROR(ENOMEM);
+            TRACE_END("async.receive");
+            if (receiveResult != 0) {
+                av_frame_free(&frame);
+                ended = receiveResult != AVERROR(EAGAIN);
+                break;
+            }
+            if (!co_await decoded_->push(frame)) {
+                av_frame_free(&frame);
+                ended = true;
+                break;
+            }
+        }
+        if (draining && ended) {
+            break;
+        }
+        if (ended && abortRequest_) {
+            break;
+        }
+    }
+    decoded_->close();
+    stageFinished();
+}
+
+// 转换：10/12 位的帧转成 8 位，其余原样传递
+async::Task AsyncPipeline::convert() {
+    while (std::optional<AVFrame *> frame = co_await decoded_->pop()) {
+        AVFrame *output = *frame;
+        if (BitDepthConverter::canConvert(static_cast<AVPixelFormat>(output->format))) {
+            TRACE_SCOPE("async.convert");
+            AVFrame *converted = depthConverter_.convert(output);
+            if (converted) {
+                av_frame_free(&output);
+                output = converted;
+            }
+        }
+        if (!co_await converted_->push(output)) {
+            av_frame_free(&output);
+            break;
+        }
+    }
+    converted_->close();
+    stageFinished();
+}
+
+// 呈现：按第一帧建立播放时钟，挂起到每帧的理想时间后交给输出端
+async::Task AsyncPipeline::present() {
+    static auto &presented = metrics::counter("async.framesPresented");
+    static auto &late = metrics::counter("async.lateFrames");
+    double timeBase = av_q2d(formatContext_->streams[streamIndex_]->time_base);
+    int64_t halfInterval = frameRate_ > 0 ? static_cast<int64_t>(AV_TIME_BASE / frameRate_ / 2) : 0;
+    int64_t anchorTime = -1;
+    int64_t anchorPts = 0;
+    while (std::optional<AVFrame *> next = co_await converted_->pop()) {
+        AVFrame *frame = *next;
+        if (options_.paced && !abortRequest_) {
+            int64_t pts = frame->best_effort_timestamp == AV_NOPTS_VALUE ? 0 : static_cast<int64_t>(
+                    frame->best_effort_timestamp * timeBase * AV_TIME_BASE);
+            if (anchorTime < 0) {
+                anchorTime = async::Executor::now();
+                anchorPts = pts;
+            }
+            int64_t idealTime = anchorTime + pts - anchorPts;
+            co_await executor_.sleepUntil(idealTime);
+            if (halfInterval > 0 && async::Executor::now() - idealTime > halfInterval) {
+                lateFrames_++;
+                late.add(1);
+            }
+        }
+        if (!abortRequest_) {
+            TRACE_SCOPE("async.present");
+            sink_->onFrame(frame);
+            framesPresented_++;
+            presented.add(1);
+        }
+        av_frame_free(&frame);
+    }
+    stageFinished();
+}
@@ -0,0 +1,136 @@
+#define LOG_TAG "Native-BitDepth"
+
+#include "bit_depth.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "log.h"
+#include "metrics.h"
+#include "row_kernels.h"
+#include "trace.h"
+#include "video_sink.h"
+
+namespace {
+
+    rows::DitherRow makeDitherRow(int shift, bool dither, int row, bool paired) {
+        static const int BAYER[2][2] = {{0, 2},
+                                        {3, 1}};
+        rows::DitherRow result{};
+        for (int i = 0; i < 16; i++) {
+            int column = paired ? (i >> 1) & 1 : i & 1;
+            result.lanes[i] = static_cast<uint16_t>(
+                    dither ? BAYER[row & 1][column] << (shift - 2) : 1 << (shift - 1));
+        }
+        return result;
+    }
+
+    // 右移的位数：低位对齐的格式丢掉 depth - 8 位，高位对齐（P010/P016）丢掉低 8 位
+    int sourceShift(AVPixelFormat format) {
+        switch (format) {
+            case AV_PIX_FMT_YUV420P10LE:
+                return 2;
+            case AV_PIX_FMT_YUV420P12LE:
+                return 4;
+            case AV_PIX_FMT_P010LE:
+            case AV_PIX_FMT_P016LE:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+
+    bool isSemiPlanar(AVPixelFormat format) {
+        return format == AV_PIX_FMT_P010LE || format == AV_PIX_FMT_P016LE;
+    }
+
+    inline const uint16_t *row16(const AVFrame *frame, int plane, int y) {
+        return reinterpret_cast<const uint16_t *>(frame->data[plane] + y * frame->linesize[plane]);
+    }
+
+    inline uint8_t *row8(AVFrame *frame, int plane, int y) {
+        return frame->data[plane] + y * frame->linesize[plane];
+    }
+
+}  // namespace
+
+bool BitDepthConverter::canConvert(AVPixelFormat format) {
+    return sourceShift(format) > 0;
+}
+
+void BitDepthConverter::configure(AVPixelFormat output, bool dither) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    output_ = output == AV_PIX_FMT_NV12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+    dither_ = dither;
+}
+
+AVPixelFormat BitDepthConverter::outputFormat() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return output_;
+}
+
+bool BitDepthConverter::convertInto(const AVFrame *source, AVFrame *dest, bool dither) {
+    auto format = static_cast<AVPixelFormat>(source->format);
+    int shift = sourceShift(format);
+    auto output = static_cast<AVPixelFormat>(dest->format);
+    if (shift == 0 || dest->width != source->width || dest->height != source->height ||
+        (output != AV_PIX_FMT_YUV420P && output != AV_PIX_FMT_NV12)) {
+        return false;
+    }
+
+    rows::DitherRow plain[2] = {makeDitherRow(shift, dither, 0, false), makeDitherRow(shift, dither, 1, false)};
+    rows::DitherRow paired[2] = {makeDitherRow(shift, dither, 0, true), makeDitherRow(shift, dither, 1, true)};
+    for (int y = 0; y < source->height; y++) {
+        rows::convertRow(row16(source, 0, y), row8(dest, 0, y), source->width, shift, plain[y & 1]);
+    }
+
+    int chromaWidth = AV_CEIL_RSHIFT(source->width, 1);
+    int chromaHeight = AV_CEIL_RSHIFT(source->height, 1);
+    bool semiPlanar = isSemiPlanar(format);
+    for (int y = 0; y < chromaHeight; y++) {
+        const rows::DitherRow &dither1 = plain[y & 1];
+        if (semiPlanar && output == AV_PIX_FMT_NV12) {
+            rows::convertRow(row16(source, 1, y), row8(dest, 1, y), 2 * chromaWidth, shift, paired[y & 1]);
+        } else if (semiPlanar) {
+            rows::deinterleaveRow(row16(source, 1, y), row8(dest, 1, y), row8(dest, 2, y), chromaWidth, shift,
+                                  paired[y & 1]);
+        } else if (output == AV_PIX_FMT_NV12) {
+            rows::interleaveRow(row16(source, 1, y), row16(source, 2, y), row8(dest, 1, y), chromaWidth, shift,
+                                dither1);
+        } else {
+            rows::convertRow(row16(source, 1, y), row8(dest, 1, y), chromaWidth, shift, dither1);
+            rows::convertRow(row16(source, 2, y), row8(dest, 2, y), chromaWidth, shift, dither1);
+        }
+    }
+    return true;
+}
+
+AVFrame *BitDepthConverter::convert(const AVFrame *frame) {
+    static auto &frames = metrics::counter("bitdepth.frames");
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    if (!canConvert(format)) {
+        return nullptr;
+    }
+
+    AVPixelFormat output;
+    bool dither;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        output = output_;
+        dither = dither_;
+    }
+
+    TRACE_SCOPE("decode.bitdepth");
+    AVFrame *result = pool_.alloc(frame->width, frame->height, output);
+    if (!result) {
+        return nullptr;
+    }
+    if (!convertInto(frame, result, dither)) {
+        av_frame_free(&result);
+        return nullptr;
+    }
+    av_frame_copy_props(result, frame);
+    countFrameCopy();
+    frames.add(1);
+    return result;
+}
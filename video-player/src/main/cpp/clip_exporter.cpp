@@ -0,0 +1,715 @@
+#define LOG_TAG "Native-ClipExport"
+
+#include "clip_exporter.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "io_hooks.h"
+#include "log.h"
+#include "media_cache.h"
+#include "metrics.h"
+#include "thread_scheduling.h"
+#include "trace.h"
+
+namespace {
+
+    std::string errorString(int error) {
+        char buffer[AV_ERROR_MAX_STRING_SIZE] = {};
+        av_strerror(error, buffer, sizeof(buffer));
+        return buffer;
+    }
+
+    bool isAnnexB(const uint8_t *data, int size) {
+        return size >= 3 && data[0] == 0 && data[1] == 0 &&
+               (data[2] == 1 || (size >= 4 && data[2] == 0 && data[3] == 1));
+    }
+
+    // 开头 GOP 能重新编码的编码：H.264/HEVC 的参数集可以放进关键帧，VP8/VP9 没有带外参数
+    bool canReencodeHead(AVCodecID codecId) {
+        return codecId == AV_CODEC_ID_H264 || codecId == AV_CODEC_ID_HEVC ||
+               codecId == AV_CODEC_ID_VP8 || codecId == AV_CODEC_ID_VP9;
+    }
+
+    // avcC / hvcC 中 NAL 长度字段的字节数，extradata 为 Annex B 或没有时返回 0（包本身就是 Annex B）
+    int nalLengthSize(const AVCodecParameters *par) {
+        const uint8_t *data = par->extradata;
+        int size = par->extradata_size;
+        if (!data || isAnnexB(data, size)) {
+            return 0;
+        }
+        if (par->codec_id == AV_CODEC_ID_H264 && size >= 7) {
+            return (data[4] & 3) + 1;
+        }
+        if (par->codec_id == AV_CODEC_ID_HEVC && size >= 23) {
+            return (data[21] & 3) + 1;
+        }
+        return 0;
+    }
+
+    void appendNal(std::vector<uint8_t> &out, const uint8_t *nal, int size, int lengthSize) {
+        if (lengthSize == 0) {
+            static const uint8_t START_CODE[] = {0, 0, 0, 1};
+            out.insert(out.end(), START_CODE, START_CODE + 4);
+        } else {
+            for (int i = lengthSize - 1; i >= 0; i--) {
+                out.push_back(static_cast<uint8_t>(size >> (8 * i)));
+            }
+        }
+        out.insert(out.end(), nal, nal + size);
+    }
+
+    // extradata 里的参数集（SPS/PPS，HEVC 还有 VPS），按 lengthSize 的格式拼接，可以直接放在关键帧前面
+    std::vector<uint8_t> parameterSets(const AVCodecParameters *par, int lengthSize) {
+        std::vector<uint8_t> out;
+        const uint8_t *data = par->extradata;
+        int size = par->extradata_size;
+        if (!data || size <= 0) {
+            return out;
+        }
+        if (isAnnexB(data, size)) {
+            out.assign(data, data + size);
+            return out;
+        }
+        // 读一个 2 字节长度的 NAL，越界时返回 false
+        int pos = 0;
+        auto readNal = [&]() {
+            if (pos + 2 > size) {
+                return false;
+            }
+            int nalSize = (data[pos] << 8) | data[pos + 1];
+            pos += 2;
+            if (pos + nalSize > size) {
+                return false;
+            }
+            appendNal(out, data + pos, nalSize, lengthSize);
+            pos += nalSize;
+            return true;
+        };
+        if (par->codec_id == AV_CODEC_ID_H264 && size >= 7) {
+            int spsCount = data[5] & 0x1f;
+            pos = 6;
+            for (int i = 0; i < spsCount && readNal(); i++) {}
+            if (pos < size) {
+                int ppsCount = data[pos++];
+                for (int i = 0; i < ppsCount && readNal(); i++) {}
+            }
+        } else if (par->codec_id == AV_CODEC_ID_HEVC && size >= 23) {
+            int arrays = data[22];
+            pos = 23;
+            for (int a = 0; a < arrays && pos + 3 <= size; a++) {
+                int count = (data[pos + 1] << 8) | data[pos + 2];
+                pos += 3;
+                for (int i = 0; i < count && readNal(); i++) {}
+            }
+        }
+        return out;
+    }
+
+    // 编码器输出的 Annex B 包改成与源流相同的长度前缀格式，lengthSize 为 0 时原样返回
+    std::vector<uint8_t> toLengthPrefixed(const uint8_t *data, int size, int lengthSize) {
+        if (lengthSize == 0 || !isAnnexB(data, size)) {
+            return std::vector<uint8_t>(data, data + size);
+        }
+        std::vector<uint8_t> out;
+        out.reserve(static_cast<size_t>(size) + 16);
+        int pos = 0;
+        while (pos < size) {
+            // 跳过起始码
+            while (pos + 3 <= size && !(data[pos] == 0 && data[pos + 1] == 0 && data[pos + 2] == 1)) {
+                pos++;
+            }
+            if (pos + 3 > size) {
+                break;
+            }
+            int start = pos + 3;
+            int end = start;
+            while (end + 3 <= size && !(data[end] == 0 && data[end + 1] == 0 &&
+                                        (data[end + 2] == 1 || (data[end + 2] == 0 && end + 3 < size &&
+                                                                data[end + 3] == 1)))) {
+                end++;
+            }
+            if (end + 3 > size) {
+                end = size;
+            }
+            appendNal(out, data + start, end - start, lengthSize);
+            pos = end;
+        }
+        return out;
+    }
+
+    // 一次导出用到的 FFmpeg 对象，析构时统一释放
+    struct ExportSession {
+        AVFormatContext *input = nullptr;
+        AVFormatContext *output = nullptr;
+        std::unique_ptr<IoHooks> ioHooks;
+        AVCodecContext *decoder = nullptr;
+        AVCodecContext *encoder = nullptr;
+        AVPacket *packet = av_packet_alloc();
+        AVFrame *frame = av_frame_alloc();
+        std::vector<int> streamMap;        // 输入流下标 -> 输出流下标，-1 表示不导出
+        std::vector<int64_t> lastDts;      // 每个输出流上一次写入的 DTS（输出时间基）
+
+        ~ExportSession() {
+            av_frame_free(&frame);
+            av_packet_free(&packet);
+            avcodec_free_context(&encoder);
+            avcodec_free_context(&decoder);
+            if (output) {
+                if (!(output->oformat->flags & AVFMT_NOFILE)) {
+                    avio_closep(&output->pb);
+                }
+                avformat_free_context(output);
+            }
+            avformat_close_input(&input);
+            if (ioHooks) {
+                ioHooks->closeInput();
+            }
+        }
+    };
+
+    int interruptCallback(void *opaque) {
+        return static_cast<std::atomic<bool> *>(opaque)->load() ? 1 : 0;
+    }
+
+}  // namespace
+
+ClipExporter::~ClipExporter() {
+    cancel();
+    wait();
+}
+
+bool ClipExporter::start(const ClipExportOptions &options, ProgressCallback onProgress,
+                         FinishCallback onFinish) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == State::Running) {
+        LOGW("已有导出在进行");
+        return false;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    error_.clear();
+    progress_ = 0;
+    cancelled_ = false;
+    state_ = State::Running;
+    thread_ = std::thread(&ClipExporter::run, this, options, std::move(onProgress), std::move(onFinish));
+    return true;
+}
+
+void ClipExporter::cancel() {
+    cancelled_ = true;
+}
+
+ClipExporter::State ClipExporter::wait() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread.swap(thread_);
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    return state_;
+}
+
+std::string ClipExporter::error() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+void ClipExporter::setError(const std::string &message) {
+    LOGE("导出失败: %s", message.c_str());
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = message;
+}
+
+void ClipExporter::run(ClipExportOptions options, ProgressCallback onProgress, FinishCallback onFinish) {
+    TRACE_THREAD_NAME("export");
+    scheduling::ScopedThread scheduled(scheduling::Role::Background);
+    LOGI("导出片段: %s [%lld, %lld]us -> %s%s", options.inputPath.c_str(),
+         static_cast<long long>(options.startUs), static_cast<long long>(options.endUs),
+         options.outputPath.c_str(), options.accurateStart ? "（精确起点）" : "");
+    int64_t startedAt = av_gettime_relative();
+    int ret = exportClip(options, onProgress);
+
+    State result = State::Finished;
+    if (cancelled_) {
+        result = State::Cancelled;
+    } else if (ret < 0) {
+        result = State::Failed;
+    }
+    if (result != State::Finished) {
+        // 不完整的文件没有意义，直接删除
+        remove(options.outputPath.c_str());
+    } else {
+        progress_ = 1.0;
+        if (onProgress) {
+            onProgress(1.0);
+        }
+        LOGI("导出完成，用时 %lldms", static_cast<long long>((av_gettime_relative() - startedAt) / 1000));
+    }
+    // 先取出错误信息再改状态：状态不再是 Running 后 start 可能持锁等待这个线程结束
+    std::string message = error();
+    state_ = result;
+    if (onFinish) {
+        onFinish(result, message);
+    }
+}
+
+int ClipExporter::exportClip(const ClipExportOptions &options, const ProgressCallback &onProgress) {
+    static auto &packets = metrics::counter("export.packets");
+    static auto &bytes = metrics::counter("export.bytes");
+    static auto &reencodedFrames = metrics::counter("export.reencodedFrames");
+
+    ExportSession session;
+    if (!session.packet || !session.frame) {
+        setError("内存不足");
+        return AVERROR(ENOMEM);
+    }
+
+    // ---- 打开输入，与播放器相同：开启磁盘缓存时网络输入走缓存 ----
+    session.input = avformat_alloc_context();
+    if (!session.input) {
+        setError("内存不足");
+        return AVERROR(ENOMEM);
+    }
+    session.input->interrupt_callback = {interruptCallback, &cancelled_};
+    const char *inputPath = options.inputPath.c_str();
+    if (MediaCache::instance().enabled() && MediaCache::isCacheable(inputPath)) {
+        session.ioHooks = std::make_unique<IoHooks>();
+        session.ioHooks->install(session.input);
+        int ret = session.ioHooks->openInput(session.input, inputPath);
+        if (ret < 0) {
+            setError("无法打开输入: " + errorString(ret));
+            return ret;
+        }
+    }
+    int ret = avformat_open_input(&session.input, inputPath, nullptr, nullptr);
+    if (ret < 0) {
+        setError("无法打开输入: " + errorString(ret));
+        return ret;
+    }
+    ret = avformat_find_stream_info(session.input, nullptr);
+    if (ret < 0) {
+        setError("无法读取流信息: " + errorString(ret));
+        return ret;
+    }
+    AVFormatContext *input = session.input;
+
+    // ---- 输出：容器支持的视频、音频、字幕流原样映射，其余流在解复用时丢弃 ----
+    ret = avformat_alloc_output_context2(&session.output, nullptr, nullptr, options.outputPath.c_str());
+    if (ret < 0 || !session.output) {
+        setError("不支持的输出格式: " + options.outputPath);
+        return ret < 0 ? ret : AVERROR_MUXER_NOT_FOUND;
+    }
+    AVFormatContext *output = session.output;
+    output->interrupt_callback = {interruptCallback, &cancelled_};
+    int videoIndex = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    session.streamMap.assign(input->nb_streams, -1);
+    for (unsigned i = 0; i < input->nb_streams; i++) {
+        AVStream *inStream = input->streams[i];
+        AVCodecParameters *par = inStream->codecpar;
+        bool wanted = par->codec_type == AVMEDIA_TYPE_VIDEO || par->codec_type == AVMEDIA_TYPE_AUDIO ||
+                      par->codec_type == AVMEDIA_TYPE_SUBTITLE;
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO && static_cast<int>(i) != videoIndex) {
+            // 其余视频流（封面图、备用角度）不导出
+            wanted = false;
+        }
+        if (!wanted || avformat_query_codec(output->oformat, par->codec_id, FF_COMPLIANCE_NORMAL) == 0) {
+            inStream->discard = AVDISCARD_ALL;
+            continue;
+        }
+        AVStream *outStream = avformat_new_stream(output, nullptr);
+        if (!outStream || avcodec_parameters_copy(outStream->codecpar, par) < 0) {
+            setError("无法创建输出流");
+            return AVERROR(ENOMEM);
+        }
+        outStream->codecpar->codec_tag = 0;
+        outStream->time_base = inStream->time_base;
+        outStream->disposition = inStream->disposition;
+        av_dict_copy(&outStream->metadata, inStream->metadata, 0);
+        session.streamMap[i] = outStream->index;
+    }
+    if (output->nb_streams == 0) {
+        setError("没有可以导出的流");
+        return AVERROR_STREAM_NOT_FOUND;
+    }
+    av_dict_copy(&output->metadata, input->metadata, 0);
+    session.lastDts.assign(output->nb_streams, AV_NOPTS_VALUE);
+    bool hasVideo = videoIndex >= 0 && session.streamMap[videoIndex] >= 0;
+
+    // ---- 精确起点：准备开头 GOP 的解码器，编码器等拿到第一帧（知道像素格式）后再打开 ----
+    const AVCodec *encoderCodec = nullptr;
+    if (options.accurateStart && hasVideo) {
+        AVCodecParameters *par = input->streams[videoIndex]->codecpar;
+        const AVCodec *decoderCodec = avcodec_find_decoder(par->codec_id);
+        encoderCodec = canReencodeHead(par->codec_id) ? avcodec_find_encoder(par->codec_id) : nullptr;
+        if (decoderCodec && encoderCodec) {
+            session.decoder = avcodec_alloc_context3(decoderCodec);
+            if (!session.decoder || avcodec_parameters_to_context(session.decoder, par) < 0 ||
+                avcodec_open2(session.decoder, decoderCodec, nullptr) < 0) {
+                avcodec_free_context(&session.decoder);
+            } else {
+                session.decoder->pkt_timebase = input->streams[videoIndex]->time_base;
+            }
+        }
+        if (!session.decoder) {
+            LOGW("%s 不能重新编码开头的 GOP，改为从关键帧切入", avcodec_get_name(par->codec_id));
+        }
+    }
+
+    if (!(output->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open2(&output->pb, options.outputPath.c_str(), AVIO_FLAG_WRITE,
+                         &output->interrupt_callback, nullptr);
+        if (ret < 0) {
+            setError("无法创建输出文件: " + errorString(ret));
+            return ret;
+        }
+    }
+    ret = avformat_write_header(output, nullptr);
+    if (ret < 0) {
+        setError("无法写入文件头: " + errorString(ret));
+        return ret;
+    }
+
+    // ---- 定位：startUs 之前最近的关键帧 ----
+    int64_t fileStart = input->start_time != AV_NOPTS_VALUE ? input->start_time : 0;
+    int64_t startTs = fileStart + std::max<int64_t>(0, options.startUs);
+    int64_t endTs = options.endUs >= 0 ? fileStart + options.endUs : INT64_MAX;
+    if (endTs == INT64_MAX && input->duration > 0) {
+        endTs = fileStart + input->duration;
+    }
+    if (options.startUs > 0) {
+        ret = av_seek_frame(input, -1, startTs, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            setError("定位失败: " + errorString(ret));
+            return ret;
+        }
+    }
+
+    // 片段的零点（AV_TIME_BASE）：关键帧切入时为第一个视频关键帧的时间，在读到它之前先缓存其余流的包
+    int64_t cutStart = hasVideo && !session.decoder ? AV_NOPTS_VALUE : startTs;
+    std::vector<AVPacket *> pending;
+    int lastPercent = 0;
+
+    auto toAvTime = [&](int64_t ts, int streamIndex) {
+        return av_rescale_q(ts, input->streams[streamIndex]->time_base, AV_TIME_BASE_Q);
+    };
+    // 平移到片段零点并写入。流复制的包和重新编码的包在衔接处可能 DTS 不递增，顺延 1 个单位
+    auto writePacket = [&](AVPacket *pkt, int inIndex) {
+        int outIndex = session.streamMap[inIndex];
+        AVRational inTb = input->streams[inIndex]->time_base;
+        int64_t offset = av_rescale_q(cutStart, AV_TIME_BASE_Q, inTb);
+        if (pkt->pts != AV_NOPTS_VALUE) {
+            pkt->pts -= offset;
+        }
+        if (pkt->dts != AV_NOPTS_VALUE) {
+            pkt->dts -= offset;
+        }
+        av_packet_rescale_ts(pkt, inTb, output->streams[outIndex]->time_base);
+        int64_t &last = session.lastDts[outIndex];
+        if (pkt->dts != AV_NOPTS_VALUE && last != AV_NOPTS_VALUE && pkt->dts <= last) {
+            pkt->dts = last + 1;
+            if (pkt->pts != AV_NOPTS_VALUE && pkt->pts < pkt->dts) {
+                pkt->pts = pkt->dts;
+            }
+        }
+        if (pkt->dts != AV_NOPTS_VALUE) {
+            last = pkt->dts;
+        }
+        pkt->stream_index = outIndex;
+        pkt->pos = -1;
+        packets.add(1);
+        bytes.add(pkt->size);
+        int result = av_interleaved_write_frame(output, pkt);
+        av_packet_unref(pkt);
+        return result;
+    };
+    auto reportProgress = [&](int64_t ts) {
+        if (endTs == INT64_MAX || cutStart == AV_NOPTS_VALUE || endTs <= cutStart) {
+            return;
+        }
+        double fraction = std::min(1.0, std::max(0.0, static_cast<double>(ts - cutStart) / (endTs - cutStart)));
+        progress_ = fraction;
+        int percent = static_cast<int>(fraction * 100);
+        if (percent > lastPercent) {
+            lastPercent = percent;
+            if (onProgress) {
+                onProgress(fraction);
+            }
+        }
+    };
+
+    // ---- 开头 GOP 的重新编码 ----
+    // 从切入的关键帧解码到下一个关键帧 K1（开放 GOP 时还包括 K1 之后显示时间在它之前的前导帧），
+    // 显示时间在 [startTs, K1) 的帧重新编码，K1 起原样复制，前导帧由重新编码的部分代替
+    AVStream *videoStream = hasVideo ? input->streams[videoIndex] : nullptr;
+    bool inHead = session.decoder != nullptr;
+    int64_t headEndPts = AV_NOPTS_VALUE;  // K1 的 PTS（视频流时间基）
+    AVPacket *copyStart = nullptr;        // K1，重新编码的部分写完后带上参数集写入
+    int lengthSize = hasVideo ? nalLengthSize(videoStream->codecpar) : 0;
+    int64_t startPts = hasVideo ? av_rescale_q(startTs, AV_TIME_BASE_Q, videoStream->time_base) : 0;
+    bool forceKeyframe = true;
+
+    auto openEncoder = [&](const AVFrame *first) {
+        session.encoder = avcodec_alloc_context3(encoderCodec);
+        if (!session.encoder) {
+            return AVERROR(ENOMEM);
+        }
+        AVCodecParameters *par = videoStream->codecpar;
+        AVCodecContext *encoder = session.encoder;
+        encoder->width = first->width;
+        encoder->height = first->height;
+        encoder->pix_fmt = static_cast<AVPixelFormat>(first->format);
+        encoder->sample_aspect_ratio = first->sample_aspect_ratio;
+        encoder->time_base = videoStream->time_base;
+        encoder->framerate = videoStream->avg_frame_rate;
+        encoder->color_range = first->color_range;
+        encoder->color_primaries = first->color_primaries;
+        encoder->color_trc = first->color_trc;
+        encoder->colorspace = first->colorspace;
+        encoder->profile = par->profile;
+        encoder->bit_rate = par->bit_rate > 0 ? par->bit_rate : 0;
+        // 不用 B 帧，DTS 等于 PTS，与之后复制的包衔接时不会倒退；参数集放在关键帧里（不设全局头）
+        encoder->max_b_frames = 0;
+        encoder->gop_size = INT_MAX;
+        encoder->thread_count = 0;
+        int result = avcodec_open2(encoder, encoderCodec, nullptr);
+        if (result < 0) {
+            return result;
+        }
+        LOGI("开头 GOP 重新编码: %s %dx%d %s", encoderCodec->name, encoder->width, encoder->height,
+             av_get_pix_fmt_name(encoder->pix_fmt));
+        return 0;
+    };
+    // 取出编码器的输出，转换成源流的 NAL 格式后写入
+    auto drainEncoder = [&]() {
+        AVPacket *encoded = av_packet_alloc();
+        int result = 0;
+        while (encoded && (result = avcodec_receive_packet(session.encoder, encoded)) >= 0) {
+            std::vector<uint8_t> data = toLengthPrefixed(encoded->data, encoded->size, lengthSize);
+            AVPacket *out = av_packet_alloc();
+            if (!out || av_new_packet(out, static_cast<int>(data.size())) < 0) {
+                av_packet_free(&out);
+                result = AVERROR(ENOMEM);
+                break;
+            }
+            memcpy(out->data, data.data(), data.size());
+            out->pts = encoded->pts;
+            out->dts = encoded->dts;
+            out->duration = encoded->duration;
+            out->flags = encoded->flags;
+            av_packet_unref(encoded);
+            result = writePacket(out, videoIndex);
+            av_packet_free(&out);
+            if (result < 0) {
+                break;
+            }
+        }
+        av_packet_free(&encoded);
+        return result == AVERROR(EAGAIN) || result == AVERROR_EOF ? 0 : result;
+    };
+    // 取出解码器的输出，显示时间在 [startTs, K1) 的帧送入编码器
+    auto drainDecoder = [&]() {
+        int result;
+        while ((result = avcodec_receive_frame(session.decoder, session.frame)) >= 0) {
+            int64_t pts = session.frame->best_effort_timestamp;
+            bool wanted = pts != AV_NOPTS_VALUE && pts >= startPts &&
+                          (headEndPts == AV_NOPTS_VALUE || pts < headEndPts);
+            if (wanted && !session.encoder && (result = openEncoder(session.frame)) < 0) {
+                av_frame_unref(session.frame);
+                return result;
+            }
+            if (wanted) {
+                session.frame->pts = pts;
+                session.frame->pict_type = forceKeyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+                forceKeyframe = false;
+                reencodedFrames.add(1);
+                result = avcodec_send_frame(session.encoder, session.frame);
+                if (result < 0 || (result = drainEncoder()) < 0) {
+                    av_frame_unref(session.frame);
+                    return result;
+                }
+            }
+            av_frame_unref(session.frame);
+        }
+        return result == AVERROR(EAGAIN) || result == AVERROR_EOF ? 0 : result;
+    };
+    // 重新编码的部分结束：清空解码器和编码器，再写入带参数集的 K1
+    auto finishHead = [&]() {
+        inHead = false;
+        avcodec_send_packet(session.decoder, nullptr);
+        int result = drainDecoder();
+        if (result >= 0 && session.encoder) {
+            avcodec_send_frame(session.encoder, nullptr);
+            result = drainEncoder();
+        }
+        if (result >= 0 && copyStart) {
+            // 重新编码的帧带着编码器自己的参数集，K1 之前补上源流的参数集，之后的帧按源流参数解码
+            std::vector<uint8_t> header = parameterSets(videoStream->codecpar, lengthSize);
+            if (!header.empty() && session.encoder) {
+                AVPacket *merged = av_packet_alloc();
+                if (merged && av_new_packet(merged, static_cast<int>(header.size()) + copyStart->size) >= 0 &&
+                    av_packet_copy_props(merged, copyStart) >= 0) {
+                    memcpy(merged->data, header.data(), header.size());
+                    memcpy(merged->data + header.size(), copyStart->data, copyStart->size);
+                    av_packet_free(&copyStart);
+                    copyStart = merged;
+                } else {
+                    av_packet_free(&merged);
+                }
+            }
+            result = writePacket(copyStart, videoIndex);
+        }
+        av_packet_free(&copyStart);
+        return result;
+    };
+
+    TRACE_BEGIN("export");
+    AVPacket *pkt = session.packet;
+    bool sawKeyframe = false;
+    std::vector<bool> finished(input->nb_streams, true);
+    int unfinished = 0;
+    for (unsigned i = 0; i < input->nb_streams; i++) {
+        AVMediaType type = input->streams[i]->codecpar->codec_type;
+        if (session.streamMap[i] >= 0 && (type == AVMEDIA_TYPE_VIDEO || type == AVMEDIA_TYPE_AUDIO)) {
+            finished[i] = false;
+            unfinished++;
+        }
+    }
+    while (!cancelled_ && ret >= 0) {
+        ret = av_read_frame(input, pkt);
+        if (ret == AVERROR_EOF) {
+            ret = 0;
+            break;
+        }
+        if (ret < 0) {
+            setError("读取失败: " + errorString(ret));
+            break;
+        }
+        int index = pkt->stream_index;
+        if (index >= static_cast<int>(session.streamMap.size()) || session.streamMap[index] < 0) {
+            av_packet_unref(pkt);
+            continue;
+        }
+        int64_t pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+        int64_t ptsUs = pts != AV_NOPTS_VALUE ? toAvTime(pts, index) : AV_NOPTS_VALUE;
+        int64_t dtsUs = pkt->dts != AV_NOPTS_VALUE ? toAvTime(pkt->dts, index) : ptsUs;
+
+        if (index == videoIndex) {
+            bool keyframe = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+            if (cutStart == AV_NOPTS_VALUE) {
+                // 关键帧切入：第一个视频关键帧之前的包无法解码
+                if (!keyframe || ptsUs == AV_NOPTS_VALUE) {
+                    av_packet_unref(pkt);
+                    continue;
+                }
+                cutStart = ptsUs;
+                LOGI("从关键帧切入，比要求早 %lldms", static_cast<long long>((startTs - cutStart) / 1000));
+                for (AVPacket *held: pending) {
+                    int heldIndex = held->stream_index;
+                    int64_t heldPts = held->pts != AV_NOPTS_VALUE ? held->pts : held->dts;
+                    if (ret >= 0 && heldPts != AV_NOPTS_VALUE && toAvTime(heldPts, heldIndex) >= cutStart) {
+                        ret = writePacket(held, heldIndex);
+                    }
+                    av_packet_free(&held);
+                }
+                pending.clear();
+                if (ret < 0) {
+                    setError("写入失败: " + errorString(ret));
+                    break;
+                }
+            }
+            if (inHead && !sawKeyframe) {
+                // 定位后第一个关键帧之前的包无法解码；关键帧正好不早于起点时不需要重新编码
+                if (!keyframe || pts == AV_NOPTS_VALUE) {
+                    av_packet_unref(pkt);
+                    continue;
+                }
+                sawKeyframe = true;
+                inHead = pts < startPts;
+            } else if (inHead) {
+                if (keyframe && headEndPts == AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE && pts > startPts) {
+                    // K1：同样送入解码器（前导帧要参考它），另外留一份原样复制
+                    headEndPts = pts;
+                    copyStart = av_packet_clone(pkt);
+                } else if (headEndPts != AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE && pts >= headEndPts) {
+                    // K1 之后第一个不是前导帧的包，重新编码的部分结束，这个包在下面按复制处理
+                    ret = finishHead();
+                    if (ret < 0) {
+                        setError("重新编码失败: " + errorString(ret));
+                        break;
+                    }
+                }
+            }
+            if (inHead) {
+                ret = avcodec_send_packet(session.decoder, pkt);
+                av_packet_unref(pkt);
+                if (ret >= 0 || ret == AVERROR_INVALIDDATA) {
+                    ret = drainDecoder();
+                }
+                if (ret < 0) {
+                    setError("重新编码失败: " + errorString(ret));
+                    break;
+                }
+                continue;
+            } else if (session.decoder && headEndPts != AV_NOPTS_VALUE && pts != AV_NOPTS_VALUE &&
+                       pts < headEndPts) {
+                // 开放 GOP 中 K1 的前导帧，已由重新编码的部分代替
+                av_packet_unref(pkt);
+                continue;
+            }
+        } else if (cutStart == AV_NOPTS_VALUE) {
+            pending.push_back(av_packet_clone(pkt));
+            av_packet_unref(pkt);
+            continue;
+        }
+
+        // 片段之外的包丢弃。一个流的 DTS 越过结尾后不会再有片段内的包（B 帧的 PTS 可能先越过），
+        // 所有音视频流都越过后停止读取，稀疏的字幕流不参与判断
+        if (dtsUs != AV_NOPTS_VALUE && dtsUs >= endTs && !finished[index]) {
+            finished[index] = true;
+            if (--unfinished == 0) {
+                av_packet_unref(pkt);
+                break;
+            }
+        }
+        if (ptsUs == AV_NOPTS_VALUE || ptsUs < cutStart || ptsUs >= endTs) {
+            av_packet_unref(pkt);
+            continue;
+        }
+        reportProgress(ptsUs);
+        ret = writePacket(pkt, index);
+        if (ret < 0) {
+            setError("写入失败: " + errorString(ret));
+        }
+    }
+    if (ret >= 0 && inHead && !cancelled_) {
+        // 片段在 K1 之前就结束了，或者输入只有一个 GOP
+        ret = finishHead();
+        if (ret < 0) {
+            setError("重新编码失败: " + errorString(ret));
+        }
+    }
+    for (AVPacket *held: pending) {
+        av_packet_free(&held);
+    }
+    av_packet_free(&copyStart);
+    TRACE_END("export");
+
+    if (cancelled_) {
+        return AVERROR_EXIT;
+    }
+    if (ret >= 0) {
+        ret = av_write_trailer(output);
+        if (ret < 0) {
+            setError("无法写入文件尾: " + errorString(ret));
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,165 @@
+#define LOG_TAG "Native-DecoderPool"
+
+#include "decoder_pool.h"
+
+#include "log.h"
+#include "memory_budget.h"
+#include "metrics.h"
+#include "trace.h"
+
+namespace {
+
+    // FNV-1a，只用于区分 extradata（SPS/PPS 等）是否相同
+    uint32_t hashBytes(const uint8_t *data, int size) {
+        uint32_t hash = 2166136261u;
+        for (int i = 0; i < size; i++) {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void applyOptions(AVCodecContext *context, const DecoderOptions &options) {
+        context->flags |= options.flags;
+        context->flags2 |= options.flags2;
+        if (options.threadType) {
+            context->thread_type = options.threadType;
+        }
+        if (options.threadCount) {
+            context->thread_count = options.threadCount;
+        }
+        context->lowres = options.lowres;
+    }
+
+}  // namespace
+
+DecoderKey DecoderKey::from(const AVCodecParameters *par, const DecoderOptions &options) {
+    DecoderKey key;
+    key.codecId = par->codec_id;
+    key.width = par->width;
+    key.height = par->height;
+    key.format = par->format;
+    key.profile = par->profile;
+    key.level = par->level;
+    key.extradataSize = par->extradata_size;
+    key.extradataHash = par->extradata ? hashBytes(par->extradata, par->extradata_size) : 0;
+    key.options = options;
+    return key;
+}
+
+DecoderPool &DecoderPool::instance() {
+    static DecoderPool pool;
+    return pool;
+}
+
+AVCodecContext *DecoderPool::acquire(const AVCodec *codec, const AVCodecParameters *par,
+                                     const DecoderOptions &options) {
+    static auto &hits = metrics::counter("decoderPool.hits");
+    static auto &misses = metrics::counter("decoderPool.misses");
+    static auto &savedOpenUs = metrics::counter("decoderPool.savedOpenUs");
+    static auto &openUs = metrics::counter("decoderPool.openUs");
+
+    DecoderKey key = DecoderKey::from(par, options);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+            if (it->key == key) {
+                AVCodecContext *context = it->context;
+                int64_t openMicros = it->openMicros;
+                inUse_[context] = {key, openMicros};
+                idle_.erase(it);
+                hits.add(1);
+                savedOpenUs.add(openMicros);
+                LOGI("复用解码器 %s %dx%d，节省打开耗时 %lld us（命中 %lld / 未命中 %lld）",
+                     codec->name, key.width, key.height, static_cast<long long>(openMicros),
+                     static_cast<long long>(hits.get()), static_cast<long long>(misses.get()));
+                return context;
+            }
+        }
+    }
+
+    int64_t begin = av_gettime_relative();
+    AVCodecContext *context = avcodec_alloc_context3(codec);
+    if (!context) {
+        LOGE("Failed to allocate codec context");
+        return nullptr;
+    }
+    if (avcodec_parameters_to_context(context, par) < 0) {
+        LOGE("Failed to copy codec parameters");
+        avcodec_free_context(&context);
+        return nullptr;
+    }
+    applyOptions(context, options);
+    // 帧缓冲按 av_buffer 的释放回调记账，复用的上下文保留这个分配器
+    context->get_buffer2 = memory::trackedGetBuffer2;
+
+    TRACE_BEGIN("codec.open");
+    int openResult = avcodec_open2(context, codec, nullptr);
+    TRACE_END("codec.open");
+    if (openResult < 0) {
+        LOGE("Failed to open codec");
+        avcodec_free_context(&context);
+        return nullptr;
+    }
+    int64_t elapsed = av_gettime_relative() - begin;
+    misses.add(1);
+    openUs.add(elapsed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    inUse_[context] = {key, elapsed};
+    return context;
+}
+
+void DecoderPool::release(AVCodecContext *context) {
+    if (!context) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = inUse_.find(context);
+    if (it == inUse_.end() || capacity_ == 0) {
+        if (it != inUse_.end()) {
+            inUse_.erase(it);
+        }
+        lock.unlock();
+        avcodec_free_context(&context);
+        return;
+    }
+
+    InUseEntry entry = it->second;
+    inUse_.erase(it);
+    lock.unlock();
+
+    // 复位解码器内部状态并释放其持有的参考帧，空闲期间不占用帧内存
+    avcodec_flush_buffers(context);
+
+    lock.lock();
+    idle_.push_back({entry.key, context, entry.openMicros, av_gettime_relative()});
+    trimLocked(capacity_);
+}
+
+void DecoderPool::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    trimLocked(capacity_);
+}
+
+void DecoderPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trimLocked(0);
+}
+
+void DecoderPool::trimLocked(size_t capacity) {
+    static auto &evictions = metrics::counter("decoderPool.evictions");
+    while (idle_.size() > capacity) {
+        auto oldest = idle_.begin();
+        for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+            if (it->lastUsed < oldest->lastUsed) {
+                oldest = it;
+            }
+        }
+        avcodec_free_context(&oldest->context);
+        idle_.erase(oldest);
+        evictions.add(1);
+    }
+}
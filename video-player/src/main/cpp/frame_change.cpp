@@ -0,0 +1,223 @@
+#define LOG_TAG "Native-FrameChange"
+
+#include "frame_change.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "log.h"
+#include "metrics.h"
+#include "row_kernels.h"
+#include "trace.h"
+#include "video_sink.h"
+
+namespace {
+
+    // 8 位的平面或半平面格式（YUV420P/422P/444P、NV12、GRAY8 等），按字节比较
+    bool isSupported(AVPixelFormat format) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+        return desc && desc->comp[0].depth == 8 &&
+               (desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
+               !(desc->flags & (AV_PIX_FMT_FLAG_BE | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL |
+                                AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_FLOAT));
+    }
+
+    // 一个块在某个平面上的字节范围
+    struct PlaneRegion {
+        int x = 0;       // 字节偏移
+        int y = 0;
+        int bytes = 0;   // 每行字节数
+        int rows = 0;
+    };
+
+    PlaneRegion planeRegion(const AVPixFmtDescriptor *desc, const int *pixelSteps, int plane,
+                            int x0, int y0, int x1, int y1) {
+        // 第 1、2 个平面是色度（GRAY8 等没有），alpha 平面不抽样
+        bool chroma = plane == 1 || plane == 2;
+        int shiftW = chroma ? desc->log2_chroma_w : 0;
+        int shiftH = chroma ? desc->log2_chroma_h : 0;
+        PlaneRegion region;
+        region.x = (x0 >> shiftW) * pixelSteps[plane];
+        region.y = y0 >> shiftH;
+        region.bytes = (AV_CEIL_RSHIFT(x1, shiftW) - (x0 >> shiftW)) * pixelSteps[plane];
+        region.rows = AV_CEIL_RSHIFT(y1, shiftH) - region.y;
+        return region;
+    }
+
+}  // namespace
+
+FrameChangeDetector::~FrameChangeDetector() {
+    av_frame_free(&reference_);
+}
+
+void FrameChangeDetector::configure(bool enabled, int tileSize, int threshold) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = enabled;
+    tileSize_ = tileSize > 0 ? (tileSize + 15) / 16 * 16 : 0;
+    threshold_ = std::max(0, threshold);
+    resetRequested_ = true;
+    LOGI("静态帧检测: %s, 块大小 %d, 阈值 %d", enabled ? "on" : "off", tileSize_, threshold_);
+}
+
+bool FrameChangeDetector::enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+}
+
+void FrameChangeDetector::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    resetRequested_ = true;
+}
+
+bool FrameChangeDetector::ensureReference(const AVFrame *frame) {
+    if (reference_ && reference_->width == frame->width && reference_->height == frame->height &&
+        reference_->format == frame->format) {
+        return true;
+    }
+    av_frame_free(&reference_);
+    reference_ = pool_.alloc(frame->width, frame->height, static_cast<AVPixelFormat>(frame->format));
+    return false;
+}
+
+void FrameChangeDetector::copyTile(const AVFrame *frame, int x0, int y0, int x1, int y1) {
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    int pixelSteps[4] = {};
+    av_image_fill_max_pixsteps(pixelSteps, nullptr, desc);
+    for (int p = 0; p < av_pix_fmt_count_planes(format); p++) {
+        PlaneRegion region = planeRegion(desc, pixelSteps, p, x0, y0, x1, y1);
+        for (int row = 0; row < region.rows; row++) {
+            int y = region.y + row;
+            memcpy(reference_->data[p] + y * reference_->linesize[p] + region.x,
+                   frame->data[p] + y * frame->linesize[p] + region.x, region.bytes);
+        }
+    }
+}
+
+const FrameChange &FrameChangeDetector::compare(const AVFrame *frame, bool partialUpdates) {
+    static auto &frames = metrics::counter("change.frames");
+    static auto &unchangedFrames = metrics::counter("change.unchangedFrames");
+    static auto &partialFrames = metrics::counter("change.partialFrames");
+    static auto &skippedBytes = metrics::counter("change.skippedBytes");
+    static auto &totalBytes = metrics::counter("change.totalBytes");
+    static auto &skippedPercent = metrics::counter("change.skippedPercent");
+
+    bool enabled;
+    bool resetRequested;
+    int tileSize;
+    int threshold;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled = enabled_;
+        resetRequested = resetRequested_;
+        resetRequested_ = false;
+        tileSize = tileSize_;
+        threshold = threshold_;
+    }
+
+    change_.kind = FrameChange::Kind::Full;
+    change_.rects.clear();
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    if (!enabled || !isSupported(format) || frame->width <= 0 || frame->height <= 0) {
+        if (!enabled) {
+            av_frame_free(&reference_);
+        }
+        return change_;
+    }
+
+    TRACE_SCOPE("change.compare");
+    int frameBytes = std::max(0, packedFrameSize(frame));
+    frames.add(1);
+    totalBytes.add(frameBytes);
+
+    // 第一帧或尺寸、格式变化：整帧输出并作为参考
+    if (!ensureReference(frame) || resetRequested) {
+        if (!reference_ || av_frame_copy(reference_, frame) < 0) {
+            av_frame_free(&reference_);
+        }
+        return change_;
+    }
+
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    int pixelSteps[4] = {};
+    av_image_fill_max_pixsteps(pixelSteps, nullptr, desc);
+    int planes = av_pix_fmt_count_planes(format);
+
+    int tile = tileSize > 0 ? tileSize : std::max(frame->width, frame->height);
+    int tilesX = (frame->width + tile - 1) / tile;
+    int tilesY = (frame->height + tile - 1) / tile;
+    dirty_.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+    int dirtyTiles = 0;
+    int64_t dirtyBytes = 0;
+    for (int ty = 0; ty < tilesY; ty++) {
+        int y0 = ty * tile;
+        int y1 = std::min(y0 + tile, frame->height);
+        for (int tx = 0; tx < tilesX; tx++) {
+            int x0 = tx * tile;
+            int x1 = std::min(x0 + tile, frame->width);
+            PlaneRegion regions[4];
+            int64_t tileBytes = 0;
+            for (int p = 0; p < planes; p++) {
+                regions[p] = planeRegion(desc, pixelSteps, p, x0, y0, x1, y1);
+                tileBytes += static_cast<int64_t>(regions[p].bytes) * regions[p].rows;
+            }
+            // 阈值按每字节平均绝对差计，超过预算立即停止，变化的块通常第一行就能判定
+            int64_t budget = tileBytes * threshold;
+            int64_t sad = 0;
+            for (int p = 0; p < planes && sad <= budget; p++) {
+                const PlaneRegion &region = regions[p];
+                for (int row = 0; row < region.rows && sad <= budget; row++) {
+                    int y = region.y + row;
+                    sad += rows::blockSad(frame->data[p] + y * frame->linesize[p] + region.x,
+                                          reference_->data[p] + y * reference_->linesize[p] + region.x,
+                                          region.bytes);
+                }
+            }
+            if (sad > budget) {
+                dirty_[ty * tilesX + tx] = 1;
+                dirtyTiles++;
+                dirtyBytes += tileBytes;
+            }
+        }
+    }
+
+    int64_t skipped = 0;
+    if (dirtyTiles == 0) {
+        change_.kind = FrameChange::Kind::Unchanged;
+        unchangedFrames.add(1);
+        skipped = frameBytes;
+    } else if (dirtyTiles == tilesX * tilesY || !partialUpdates) {
+        // 输出端整帧显示，参考也整帧更新，和屏幕上的内容保持一致
+        av_frame_copy(reference_, frame);
+    } else {
+        change_.kind = FrameChange::Kind::Partial;
+        partialFrames.add(1);
+        skipped = std::max<int64_t>(0, frameBytes - dirtyBytes);
+        // 只有变化的块会被输出端更新，参考同样只更新这些块，没变的块保留旧内容，
+        // 阈值大于 0 时近似相同的块不会逐帧累积偏差。同一块行里相邻的变化块合并成一个矩形
+        for (int ty = 0; ty < tilesY; ty++) {
+            int y0 = ty * tile;
+            int y1 = std::min(y0 + tile, frame->height);
+            int tx = 0;
+            while (tx < tilesX) {
+                if (!dirty_[ty * tilesX + tx]) {
+                    tx++;
+                    continue;
+                }
+                int start = tx;
+                while (tx < tilesX && dirty_[ty * tilesX + tx]) {
+                    tx++;
+                }
+                int x0 = start * tile;
+                int x1 = std::min(tx * tile, frame->width);
+                copyTile(frame, x0, y0, x1, y1);
+                change_.rects.push_back({x0, y0, x1 - x0, y1 - y0});
+            }
+        }
+    }
+    skippedBytes.add(skipped);
+    int64_t total = totalBytes.get();
+    skippedPercent.set(total > 0 ? skippedBytes.get() * 100 / total : 0);
+    return change_;
+}
@@ -0,0 +1,172 @@
+#define LOG_TAG "Native-Downscaler"
+
+#include "frame_downscaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "log.h"
+#include "metrics.h"
+#include "row_kernels.h"
+#include "trace.h"
+#include "video_sink.h"
+
+namespace {
+
+    // 每次 2:1 缩小后的尺寸，保持偶数，这样 4:2:0 的色度平面也能整除
+    int halvedSize(int size) {
+        return std::max(2, (size / 2) & ~1);
+    }
+
+    // 盒式滤波只处理 8 位、每个分量一个平面、色度最多减半的格式（YUV420P/422P/444P、GRAY8 等）
+    bool canHalve(AVPixelFormat format) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+        if (!desc || desc->comp[0].depth != 8 ||
+            (desc->flags & (AV_PIX_FMT_FLAG_BE | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL |
+                            AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_FLOAT))) {
+            return false;
+        }
+        return av_pix_fmt_count_planes(format) == desc->nb_components &&
+               desc->log2_chroma_w <= 1 && desc->log2_chroma_h <= 1;
+    }
+
+    void halvePlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride,
+                    int width, int height) {
+        for (int y = 0; y < height; y++) {
+            const uint8_t *row0 = src + 2 * y * srcStride;
+            rows::halveRow(row0, row0 + srcStride, dst + y * dstStride, width);
+        }
+    }
+
+}  // namespace
+
+DownscalePlan FrameDownscaler::plan(const AVCodec *codec, int sourceWidth, int sourceHeight,
+                                    int targetWidth, int targetHeight, double threshold) {
+    DownscalePlan plan;
+    plan.outputWidth = sourceWidth;
+    plan.outputHeight = sourceHeight;
+    if (targetWidth <= 0 || targetHeight <= 0 || sourceWidth <= 0 || sourceHeight <= 0) {
+        return plan;
+    }
+
+    // 按两个方向中较小的倍数缩小，保证输出仍然覆盖整个表面
+    double scale = std::min(static_cast<double>(sourceWidth) / targetWidth,
+                            static_cast<double>(sourceHeight) / targetHeight);
+    if (scale < std::max(1.0, threshold)) {
+        return plan;
+    }
+
+    int steps = static_cast<int>(std::floor(std::log2(scale)));
+    if (steps == 0) {
+        plan.swsOnly = true;
+        plan.outputWidth = std::max(2, static_cast<int>(sourceWidth / scale) & ~1);
+        plan.outputHeight = std::max(2, static_cast<int>(sourceHeight / scale) & ~1);
+        return plan;
+    }
+
+    // lowres 在解码时就跳过高频系数，比解码完再缩小省得多，编码器支持多少级就用多少级
+    plan.lowres = std::min(steps, codec ? static_cast<int>(codec->max_lowres) : 0);
+    plan.boxSteps = steps - plan.lowres;
+    plan.outputWidth = AV_CEIL_RSHIFT(sourceWidth, plan.lowres);
+    plan.outputHeight = AV_CEIL_RSHIFT(sourceHeight, plan.lowres);
+    for (int i = 0; i < plan.boxSteps; i++) {
+        plan.outputWidth = halvedSize(plan.outputWidth);
+        plan.outputHeight = halvedSize(plan.outputHeight);
+    }
+    return plan;
+}
+
+FrameDownscaler::~FrameDownscaler() {
+    sws_freeContext(swsContext_);
+}
+
+AVFrame *FrameDownscaler::halve(const AVFrame *source) {
+    auto format = static_cast<AVPixelFormat>(source->format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    int width = halvedSize(source->width);
+    int height = halvedSize(source->height);
+    AVFrame *result = pool_.alloc(width, height, format);
+    if (!result) {
+        return nullptr;
+    }
+    for (int plane = 0; plane < av_pix_fmt_count_planes(format); plane++) {
+        bool chroma = plane == 1 || plane == 2;
+        int planeWidth = chroma ? AV_CEIL_RSHIFT(width, desc->log2_chroma_w) : width;
+        int planeHeight = chroma ? AV_CEIL_RSHIFT(height, desc->log2_chroma_h) : height;
+        halvePlane(source->data[plane], source->linesize[plane],
+                   result->data[plane], result->linesize[plane], planeWidth, planeHeight);
+    }
+    countFrameCopy();
+    return result;
+}
+
+AVFrame *FrameDownscaler::scaleWithSws(const AVFrame *source, int width, int height) {
+    auto format = static_cast<AVPixelFormat>(source->format);
+    if (!sws_isSupportedInput(format) || !sws_isSupportedOutput(format)) {
+        return nullptr;
+    }
+    swsContext_ = sws_getCachedContext(swsContext_, source->width, source->height, format,
+                                       width, height, format, SWS_AREA,
+                                       nullptr, nullptr, nullptr);
+    AVFrame *result = swsContext_ ? pool_.alloc(width, height, format) : nullptr;
+    if (!result) {
+        return nullptr;
+    }
+    sws_scale(swsContext_, source->data, source->linesize, 0, source->height,
+              result->data, result->linesize);
+    countFrameCopy();
+    return result;
+}
+
+AVFrame *FrameDownscaler::process(const AVFrame *frame, int64_t fullSizeBytes) {
+    static auto &frames = metrics::counter("downscale.frames");
+    static auto &savedBytes = metrics::counter("downscale.savedBytes");
+    static auto &savedPerFrame = metrics::counter("downscale.savedBytesPerFrame");
+
+    if (!plan_.active()) {
+        return av_frame_clone(frame);
+    }
+
+    TRACE_SCOPE("decode.downscale");
+    AVFrame *result = nullptr;
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    if (plan_.swsOnly) {
+        result = scaleWithSws(frame, plan_.outputWidth, plan_.outputHeight);
+    } else if (plan_.boxSteps > 0 && canHalve(format)) {
+        // 中途分配失败时丢掉中间结果，按原帧入队
+        for (int i = 0; i < plan_.boxSteps; i++) {
+            AVFrame *next = halve(result ? result : frame);
+            av_frame_free(&result);
+            if (!next) {
+                break;
+            }
+            result = next;
+        }
+    } else if (plan_.boxSteps > 0) {
+        int width = frame->width;
+        int height = frame->height;
+        for (int i = 0; i < plan_.boxSteps; i++) {
+            width = halvedSize(width);
+            height = halvedSize(height);
+        }
+        result = scaleWithSws(frame, width, height);
+    }
+
+    if (!result) {
+        // 只用了 lowres，或者这种格式无法缩放，原样入队
+        result = av_frame_clone(frame);
+        if (!result) {
+            return nullptr;
+        }
+    } else {
+        av_frame_copy_props(result, frame);
+    }
+
+    if (fullSizeBytes > 0) {
+        int64_t saved = std::max<int64_t>(0, fullSizeBytes - packedFrameSize(result));
+        frames.add(1);
+        savedBytes.add(saved);
+        savedPerFrame.set(savedBytes.get() / frames.get());
+    }
+    return result;
+}
@@ -0,0 +1,153 @@
+#define LOG_TAG "Native-Fanout"
+
+#include "frame_fanout.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "log.h"
+#include "trace.h"
+
+namespace {
+
+    metrics::Counter &subscriberCounter(const std::string &name, const char *field) {
+        return metrics::counter(("fanout." + name + "." + field).c_str());
+    }
+
+}  // namespace
+
+FrameSubscriber::FrameSubscriber(std::string name, size_t capacity, DropPolicy policy)
+        : name_(std::move(name)),
+          capacity_(std::max<size_t>(1, capacity)),
+          policy_(policy),
+          deliveredMetric_(subscriberCounter(name_, "delivered")),
+          droppedMetric_(subscriberCounter(name_, "dropped")),
+          lagMetric_(subscriberCounter(name_, "lagUs")) {}
+
+FrameSubscriber::~FrameSubscriber() {
+    flush();
+}
+
+void FrameSubscriber::push(const AVFrame *frame, int64_t ptsUs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closed_) {
+        return;
+    }
+    latestPtsUs_ = ptsUs;
+    if (takenPtsUs_ != AV_NOPTS_VALUE) {
+        setLag(std::max<int64_t>(0, latestPtsUs_ - takenPtsUs_));
+    }
+    if (queue_.size() >= capacity_) {
+        dropped_++;
+        droppedMetric_.add(1);
+        if (policy_ == DropPolicy::DropNewest) {
+            return;
+        }
+        av_frame_free(&queue_.front().frame);
+        queue_.pop_front();
+    }
+    AVFrame *ref = av_frame_alloc();
+    if (!ref || av_frame_ref(ref, frame) < 0) {
+        av_frame_free(&ref);
+        return;
+    }
+    queue_.push_back({ref, ptsUs});
+    lock.unlock();
+    cv_.notify_one();
+}
+
+AVFrame *FrameSubscriber::pop(int64_t timeoutUs, int64_t *ptsUs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ready = [this]() { return closed_ || !queue_.empty(); };
+    if (timeoutUs < 0) {
+        cv_.wait(lock, ready);
+    } else if (timeoutUs > 0) {
+        cv_.wait_for(lock, std::chrono::microseconds(timeoutUs), ready);
+    }
+    if (queue_.empty()) {
+        return nullptr;
+    }
+    Pending pending = queue_.front();
+    queue_.pop_front();
+    takenPtsUs_ = pending.ptsUs;
+    setLag(std::max<int64_t>(0, latestPtsUs_ - takenPtsUs_));
+    delivered_++;
+    deliveredMetric_.add(1);
+    if (ptsUs) {
+        *ptsUs = pending.ptsUs;
+    }
+    return pending.frame;
+}
+
+FrameSubscriber::Stats FrameSubscriber::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.delivered = delivered_;
+    stats.dropped = dropped_;
+    stats.queued = static_cast<int64_t>(queue_.size());
+    stats.lagUs = lagUs_;
+    return stats;
+}
+
+void FrameSubscriber::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+void FrameSubscriber::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Pending &pending: queue_) {
+        av_frame_free(&pending.frame);
+    }
+    queue_.clear();
+    // 不连续之后的时间差没有意义，从下一次取帧重新计算
+    takenPtsUs_ = AV_NOPTS_VALUE;
+    setLag(0);
+}
+
+void FrameSubscriber::setLag(int64_t lagUs) {
+    lagUs_ = lagUs;
+    lagMetric_.set(lagUs);
+}
+
+std::shared_ptr<FrameSubscriber> FrameFanout::subscribe(const std::string &name, size_t capacity,
+                                                        FrameSubscriber::DropPolicy policy) {
+    auto subscriber = std::make_shared<FrameSubscriber>(name, capacity, policy);
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.push_back(subscriber);
+    count_ = static_cast<int>(subscribers_.size());
+    LOGI("订阅解码帧: %s, 队列 %zu, %s", name.c_str(), std::max<size_t>(1, capacity),
+         policy == FrameSubscriber::DropPolicy::DropOldest ? "丢弃最旧" : "丢弃最新");
+    return subscriber;
+}
+
+void FrameFanout::unsubscribe(const std::shared_ptr<FrameSubscriber> &subscriber) {
+    if (!subscriber) {
+        return;
+    }
+    subscriber->close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.erase(std::remove(subscribers_.begin(), subscribers_.end(), subscriber), subscribers_.end());
+    count_ = static_cast<int>(subscribers_.size());
+}
+
+void FrameFanout::publish(const AVFrame *frame, int64_t ptsUs) {
+    if (!active()) {
+        return;
+    }
+    TRACE_SCOPE("fanout.publish");
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &subscriber: subscribers_) {
+        subscriber->push(frame, ptsUs);
+    }
+}
+
+void FrameFanout::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &subscriber: subscribers_) {
+        subscriber->flush();
+    }
+}
@@ -0,0 +1,67 @@
+#include "frame_pool.h"
+
+#include "memory_budget.h"
+
+namespace {
+
+    const int PLANE_ALIGN = 32;
+
+}  // namespace
+
+FramePool::~FramePool() {
+    releasePools();
+}
+
+void FramePool::releasePools() {
+    // 仍被引用的缓冲在最后一个引用释放时才随池一起释放
+    for (auto &entry: pools_) {
+        av_buffer_pool_uninit(&entry.second);
+    }
+    pools_.clear();
+}
+
+AVFrame *FramePool::alloc(int width, int height, AVPixelFormat format) {
+    AVFrame *frame = av_frame_alloc();
+    if (!frame) {
+        return nullptr;
+    }
+    frame->width = width;
+    frame->height = height;
+    frame->format = format;
+
+    int linesize[4] = {0};
+    size_t sizes[4] = {0};
+    ptrdiff_t strides[4] = {0};
+    if (av_image_fill_linesizes(linesize, format, FFALIGN(width, PLANE_ALIGN)) < 0) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    for (int i = 0; i < 4; i++) {
+        strides[i] = linesize[i];
+    }
+    if (av_image_fill_plane_sizes(sizes, format, height, strides) < 0) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    if (width != width_ || height != height_ || format != format_) {
+        releasePools();
+        width_ = width;
+        height_ = height;
+        format_ = format;
+    }
+    for (int i = 0; i < 4 && sizes[i] > 0; i++) {
+        AVBufferPool *&pool = pools_[sizes[i]];
+        if (!pool) {
+            pool = av_buffer_pool_init(sizes[i], nullptr);
+        }
+        frame->buf[i] = pool ? av_buffer_pool_get(pool) : nullptr;
+        if (!frame->buf[i]) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+        frame->data[i] = frame->buf[i]->data;
+        frame->linesize[i] = linesize[i];
+    }
+    memory::trackFrameBuffers(frame);
+    return frame;
+}
@@ -0,0 +1,68 @@
+#ifndef VIDEO_PLAYER_ABR_CONTROLLER_H
+#define VIDEO_PLAYER_ABR_CONTROLLER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ffmpeg_headers.h"
+#include "io_hooks.h"
+
+// 自适应码率（HLS master / DASH）：libavformat 把每个变体暴露为带 variant_bitrate 的流（HLS 还有 program），
+// 这里按分片下载吞吐和已解码缓冲的健康度选择变体，通过流的 discard 标志让解复用器只下载选中的变体。
+// 切换在新分片打开时决定，解复用器从当前时间点所在的分片开始读新变体。
+class AbrController {
+public:
+    struct Variant {
+        int64_t bitrate = 0;      // 播放列表声明的码率（bps）
+        int videoStream = -1;     // 变体的视频流
+        std::vector<int> streams; // 属于该变体的所有流，切走时一起 discard
+        int width = 0;
+        int height = 0;
+    };
+
+    // 从已探测的输入中枚举变体，按码率升序；少于两个变体时返回 false，不启用 ABR。
+    // 启动时选最低码率的变体，先保证起播速度
+    bool attach(AVFormatContext *context);
+
+    // 已解码缓冲的健康度（0~1，队列帧数 / 目标队列长度），在解复用线程上调用
+    void setBufferProbe(std::function<double()> probe) { bufferProbe_ = std::move(probe); }
+
+    // 把分片下载统计接到 IoHooks 上
+    void connect(IoHooks &hooks);
+
+    // 当前选中变体的视频流，解码线程在读到该流的第一个包时切换解码
+    int activeVideoStream() const { return activeVideoStream_; }
+
+    const std::vector<Variant> &variants() const { return variants_; }
+
+private:
+    // 新分片开始下载：按当前吞吐估计和缓冲选择变体
+    void onSegmentOpen(const char *url);
+
+    // 分片下载完成：更新吞吐估计
+    void onTransfer(const IoHooks::Transfer &transfer);
+
+    // 吞吐估计（bps），还没有样本时为 0
+    double throughputEstimate() const;
+
+    // 混合规则：吞吐决定能承受的码率上限，缓冲决定是否允许升档、是否要紧急降档
+    int chooseVariant(double bufferLevel, double throughput, int64_t now) const;
+
+    void applyVariant(int index);
+
+    AVFormatContext *context_ = nullptr;
+    std::vector<Variant> variants_;
+    int current_ = -1;
+    std::atomic<int> activeVideoStream_{-1};
+    std::function<double()> bufferProbe_;
+
+    // 吞吐估计：按下载时间加权的快/慢两个 EWMA，取较小值
+    double fastEstimate_ = 0;
+    double slowEstimate_ = 0;
+    double totalWeight_ = 0;
+    int64_t lastSwitchTime_ = 0;
+};
+
+#endif // VIDEO_PLAYER_ABR_CONTROLLER_H
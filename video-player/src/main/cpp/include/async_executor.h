@@ -0,0 +1,283 @@
+#ifndef VIDEO_PLAYER_ASYNC_EXECUTOR_H
+#define VIDEO_PLAYER_ASYNC_EXECUTOR_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 基于 C++20 协程的小型执行器：固定数量的工作线程运行就绪的协程，协程在队列满/空或等待时间点时
+// 挂起并让出线程，而不是阻塞在条件变量或 av_usleep 上。多个播放管线的各个阶段共享同一组线程，
+// 线程数不再随播放器数量增长。
+// 协程在哪个工作线程上恢复是不确定的，同一个协程不会同时在两个线程上运行；
+// 只应在协程里调用不会长时间阻塞的操作，阻塞的 I/O 会占住一个工作线程。
+// 指标：async.resumes 为协程恢复次数，async.timerWaits 为按时间点挂起的次数
+namespace async {
+
+    class Executor;
+
+    // 不返回值的协程任务。创建后先挂起，交给 Executor::spawn 后开始运行，结束时自动销毁
+    class Task {
+    public:
+        struct promise_type {
+            Executor *executor = nullptr;
+
+            Task get_return_object() {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+
+                void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+
+                void await_resume() noexcept {}
+            };
+
+            FinalAwaiter final_suspend() noexcept { return {}; }
+
+            void return_void() {}
+
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+        Task &operator=(Task &&other) = delete;
+
+        Task(const Task &) = delete;
+
+        ~Task() {
+            if (handle_) {
+                handle_.destroy();
+            }
+        }
+
+    private:
+        friend class Executor;
+
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    class Executor {
+    public:
+        explicit Executor(int threads);
+
+        // 等待所有任务结束后停止工作线程
+        ~Executor();
+
+        Executor(const Executor &) = delete;
+
+        Executor &operator=(const Executor &) = delete;
+
+        int threadCount() const { return static_cast<int>(threads_.size()); }
+
+        // 与 av_gettime_relative 相同的单调时钟（微秒）
+        static int64_t now();
+
+        // 开始运行任务，任务结束前执行器不会析构
+        void spawn(Task task);
+
+        // 把挂起的协程放回就绪队列
+        void post(std::coroutine_handle<> handle);
+
+        // deadlineUs（av_gettime_relative 的微秒）到达后把协程放回就绪队列
+        void postAt(int64_t deadlineUs, std::coroutine_handle<> handle);
+
+        // 等待所有 spawn 的任务结束
+        void waitIdle();
+
+        // co_await executor.sleepUntil(t)：挂起到 t 之后，t 已经过去时不挂起
+        auto sleepUntil(int64_t deadlineUs) {
+            struct Awaiter {
+                Executor &executor;
+                int64_t deadlineUs;
+
+                bool await_ready() const { return deadlineUs <= Executor::now(); }
+
+                void await_suspend(std::coroutine_handle<> handle) { executor.postAt(deadlineUs, handle); }
+
+                void await_resume() const {}
+            };
+            return Awaiter{*this, deadlineUs};
+        }
+
+        // co_await executor.yield()：重新排到就绪队列末尾，让其他协程先运行
+        auto yield() {
+            struct Awaiter {
+                Executor &executor;
+
+                bool await_ready() const { return false; }
+
+                void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+
+                void await_resume() const {}
+            };
+            return Awaiter{*this};
+        }
+
+    private:
+        friend struct Task::promise_type::FinalAwaiter;
+
+        struct Timer {
+            int64_t deadlineUs;
+            uint64_t sequence;  // 同一时间点按加入顺序
+            std::coroutine_handle<> handle;
+
+            bool operator>(const Timer &other) const {
+                return deadlineUs != other.deadlineUs ? deadlineUs > other.deadlineUs : sequence > other.sequence;
+            }
+        };
+
+        void run();
+
+        void taskFinished();
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::condition_variable idleCv_;
+        std::deque<std::coroutine_handle<>> ready_;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+        uint64_t timerSequence_ = 0;
+        int activeTasks_ = 0;
+        bool stopping_ = false;
+        std::vector<std::thread> threads_;
+    };
+
+    // 有界的协程队列：push 在队列满时挂起，pop 在队列空时挂起，对方操作后把挂起的协程交回执行器。
+    // close 之后 push 返回 false，pop 取完剩下的元素后返回 nullopt；队列里剩下的元素由 drain 交还给持有者
+    template<typename T>
+    class AsyncQueue {
+    public:
+        AsyncQueue(Executor &executor, size_t capacity) : executor_(executor), capacity_(capacity ? capacity : 1) {}
+
+        AsyncQueue(const AsyncQueue &) = delete;
+
+        AsyncQueue &operator=(const AsyncQueue &) = delete;
+
+        struct PushAwaiter {
+            AsyncQueue &queue;
+            T value;
+            std::coroutine_handle<> handle = nullptr;
+            bool result = false;
+
+            bool await_ready() const { return false; }
+
+            bool await_suspend(std::coroutine_handle<> waiting) {
+                std::lock_guard<std::mutex> lock(queue.mutex_);
+                if (queue.closed_) {
+                    result = false;
+                    return false;
+                }
+                result = true;
+                if (!queue.popWaiters_.empty()) {
+                    // 有在等的消费者时直接交给它，不经过队列
+                    PopAwaiter *consumer = queue.popWaiters_.front();
+                    queue.popWaiters_.pop_front();
+                    consumer->value = std::move(value);
+                    queue.executor_.post(consumer->handle);
+                    return false;
+                }
+                if (queue.items_.size() < queue.capacity_) {
+                    queue.items_.push_back(std::move(value));
+                    return false;
+                }
+                handle = waiting;
+                queue.pushWaiters_.push_back(this);
+                return true;
+            }
+
+            bool await_resume() const { return result; }
+        };
+
+        struct PopAwaiter {
+            AsyncQueue &queue;
+            std::optional<T> value;
+            std::coroutine_handle<> handle = nullptr;
+
+            bool await_ready() const { return false; }
+
+            bool await_suspend(std::coroutine_handle<> waiting) {
+                std::lock_guard<std::mutex> lock(queue.mutex_);
+                if (!queue.items_.empty()) {
+                    value = std::move(queue.items_.front());
+                    queue.items_.pop_front();
+                    // 腾出一个位置，把一个在等的生产者的值补进来
+                    if (!queue.pushWaiters_.empty()) {
+                        PushAwaiter *producer = queue.pushWaiters_.front();
+                        queue.pushWaiters_.pop_front();
+                        queue.items_.push_back(std::move(producer->value));
+                        queue.executor_.post(producer->handle);
+                    }
+                    return false;
+                }
+                if (queue.closed_) {
+                    return false;
+                }
+                handle = waiting;
+                queue.popWaiters_.push_back(this);
+                return true;
+            }
+
+            std::optional<T> await_resume() { return std::move(value); }
+        };
+
+        // co_await queue.push(value)，成功返回 true；关闭后返回 false，队列没有接管 value（指针元素由调用者释放）
+        PushAwaiter push(T value) { return PushAwaiter{*this, std::move(value)}; }
+
+        // co_await queue.pop()，关闭且取空后返回 nullopt
+        PopAwaiter pop() { return PopAwaiter{*this, std::nullopt}; }
+
+        // 关闭队列并唤醒所有挂起的生产者和消费者
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            for (PushAwaiter *producer: pushWaiters_) {
+                producer->result = false;
+                executor_.post(producer->handle);
+            }
+            pushWaiters_.clear();
+            for (PopAwaiter *consumer: popWaiters_) {
+                executor_.post(consumer->handle);
+            }
+            popWaiters_.clear();
+        }
+
+        // 取出队列里剩下的元素，用于关闭后释放
+        template<typename Fn>
+        void drain(Fn &&fn) {
+            std::deque<T> items;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                items.swap(items_);
+            }
+            for (T &item: items) {
+                fn(item);
+            }
+        }
+
+    private:
+        Executor &executor_;
+        const size_t capacity_;
+        std::mutex mutex_;
+        std::deque<T> items_;
+        bool closed_ = false;
+        // 挂起中的 awaiter 在协程帧里，协程恢复之前一直有效
+        std::deque<PushAwaiter *> pushWaiters_;
+        std::deque<PopAwaiter *> popWaiters_;
+    };
+
+}  // namespace async
+
+#endif // VIDEO_PLAYER_ASYNC_EXECUTOR_H
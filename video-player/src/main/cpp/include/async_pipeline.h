@@ -0,0 +1,94 @@
+#ifndef VIDEO_PLAYER_ASYNC_PIPELINE_H
+#define VIDEO_PLAYER_ASYNC_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "async_executor.h"
+#include "bit_depth.h"
+#include "ffmpeg_headers.h"
+#include "video_sink.h"
+
+struct AsyncPipelineOptions {
+    bool paced = true;       // 按播放时钟输出；关闭时以最快速度运行
+    int decoderThreads = 1;  // 解码器内部线程数，1 表示在执行器线程上直接解码，0 为 FFmpeg 默认值
+    size_t queueSize = 4;    // 各阶段之间队列的长度
+};
+
+// 协程版的播放管线：解复用、解码、位深转换、呈现四个阶段各是一个协程，阶段之间用 AsyncQueue 连接，
+// 队列满/空时挂起，呈现按帧时间 co_await 定时器，不占用线程等待。多个实例共享同一个 Executor，
+// 每个实例不再需要自己的解码、渲染线程。
+// 与 player.cpp 的线程版相比只覆盖本地文件的基本播放：没有直播、ABR、拉模式、vsync、seek / 重新播放
+// 和旁路分析；解复用的 av_read_frame 是阻塞调用，网络输入会在读取时占住一个工作线程。
+// 呈现在任意工作线程上调用 sink 的 onFrame，不调用 onThreadStart / onThreadStop，
+// 只支持与线程无关的输出端（null、memory、校验）。
+// 所有实例累计的指标：async.framesPresented，async.lateFrames（晚于理想时间半帧以上）
+class AsyncPipeline {
+public:
+    AsyncPipeline(async::Executor &executor, std::shared_ptr<VideoSink> sink);
+
+    // 停止并等待所有阶段结束
+    ~AsyncPipeline();
+
+    AsyncPipeline(const AsyncPipeline &) = delete;
+
+    AsyncPipeline &operator=(const AsyncPipeline &) = delete;
+
+    // 打开输入并选择视频流、打开解码器，在调用线程上完成
+    bool open(const char *path, const AsyncPipelineOptions &options = {});
+
+    // 在执行器上启动四个阶段
+    void start();
+
+    // 请求停止：中断阻塞的读取，关闭所有队列，等待各阶段结束
+    void stop();
+
+    // 所有帧都已呈现（或已停止）
+    bool finished();
+
+    // 等待结束，超时返回 false；timeoutUs 小于 0 时一直等待
+    bool wait(int64_t timeoutUs = -1);
+
+    uint64_t framesPresented() const { return framesPresented_; }
+
+    uint64_t lateFrames() const { return lateFrames_; }
+
+private:
+    async::Task demux();
+
+    async::Task decode();
+
+    async::Task convert();
+
+    async::Task present();
+
+    // 每个阶段结束时调用
+    void stageFinished();
+
+    async::Executor &executor_;
+    std::shared_ptr<VideoSink> sink_;
+    AsyncPipelineOptions options_;
+    AVFormatContext *formatContext_ = nullptr;
+    AVCodecContext *codecContext_ = nullptr;
+    int streamIndex_ = -1;
+    double frameRate_ = 0;
+    BitDepthConverter depthConverter_;
+
+    // 长度由 open 的选项决定
+    std::unique_ptr<async::AsyncQueue<AVPacket *>> packets_;
+    std::unique_ptr<async::AsyncQueue<AVFrame *>> decoded_;
+    std::unique_ptr<async::AsyncQueue<AVFrame *>> converted_;
+
+    std::atomic<bool> abortRequest_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int runningStages_ = 0;
+    bool started_ = false;
+    std::atomic<uint64_t> framesPresented_{0};
+    std::atomic<uint64_t> lateFrames_{0};
+};
+
+#endif // VIDEO_PLAYER_ASYNC_PIPELINE_H
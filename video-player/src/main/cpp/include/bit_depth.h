@@ -0,0 +1,44 @@
+#ifndef VIDEO_PLAYER_BIT_DEPTH_H
+#define VIDEO_PLAYER_BIT_DEPTH_H
+
+#include <mutex>
+
+#include "ffmpeg_headers.h"
+#include "frame_pool.h"
+
+// 高位深帧转 8 位：HEVC Main10 软解输出 yuv420p10le，硬解和部分编码器输出 P010，而渲染器
+// （GL 纹理、JNI 回调、ANativeWindow 转换）都按 8 位平面处理。入队前用 NEON/SSE2（编译时启用 AVX2
+// 则亮度用 AVX2）把每个平面一次读完、直接写成 8 位 YUV420P 或 NV12，位深转换和入队复制合为一次遍历，
+// 之后的队列、复制、上传都只有原来一半的数据量。可选 2x2 有序抖动，减少 8 位下平滑渐变里的色带。
+// 只转换位深，不做 HDR（PQ/HLG）到 SDR 的色调映射。
+// 支持 yuv420p10le / yuv420p12le（低位对齐）和 p010le / p016le（高位对齐）
+class BitDepthConverter {
+public:
+    BitDepthConverter() = default;
+
+    BitDepthConverter(const BitDepthConverter &) = delete;
+
+    BitDepthConverter &operator=(const BitDepthConverter &) = delete;
+
+    static bool canConvert(AVPixelFormat format);
+
+    // 输出格式（AV_PIX_FMT_YUV420P 或 AV_PIX_FMT_NV12）和是否抖动，可以在任意线程调用，下一帧生效
+    void configure(AVPixelFormat output, bool dither);
+
+    AVPixelFormat outputFormat();
+
+    // 返回转换后的新帧（调用者释放，属性从原帧复制），不是高位深格式或失败时返回 nullptr。
+    // 只在一个线程（解码线程）上调用
+    AVFrame *convert(const AVFrame *frame);
+
+    // 把 source 转换写入已分配好的同尺寸 dest（格式为 YUV420P 或 NV12），source 不支持时返回 false
+    static bool convertInto(const AVFrame *source, AVFrame *dest, bool dither);
+
+private:
+    std::mutex mutex_;
+    AVPixelFormat output_ = AV_PIX_FMT_YUV420P;
+    bool dither_ = false;
+    FramePool pool_;
+};
+
+#endif // VIDEO_PLAYER_BIT_DEPTH_H
@@ -0,0 +1,84 @@
+#ifndef VIDEO_PLAYER_CLIP_EXPORTER_H
+#define VIDEO_PLAYER_CLIP_EXPORTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ffmpeg_headers.h"
+
+// 片段导出的参数
+struct ClipExportOptions {
+    std::string inputPath;
+    std::string outputPath;       // 容器由扩展名决定（.mp4 / .mkv 等）
+    int64_t startUs = 0;          // 片段起止时间，相对于文件开头（AV_TIME_BASE）
+    int64_t endUs = -1;           // 小于 0 表示到文件结尾
+    bool accurateStart = false;   // 只重新编码开头的一个 GOP，让片段从 startUs 那一帧开始
+};
+
+// 片段导出：把输入的一段时间按包原样复制（stream copy）重新封装成新文件，不解码也不编码，
+// 速度只受读写速度限制。默认在 startUs 之前最近的关键帧处切入，片段可能比要求的早开始一些；
+// accurateStart 时从该关键帧解码到下一个关键帧，把 startUs 之后的这几帧用同样的编码重新编码，
+// 之后的包仍然原样复制。只支持 H.264 / HEVC / VP8 / VP9（编码参数集可以随关键帧带入，
+// 其余编码或没有对应编码器时退回关键帧切入）。
+// 与播放器各自打开输入，不影响正在进行的播放；开启磁盘缓存时网络输入同样走缓存。
+// 同一时间只能有一个导出，回调在导出线程上执行，回调里不能调用 start / wait
+class ClipExporter {
+public:
+    enum class State {
+        Idle,
+        Running,
+        Finished,
+        Failed,
+        Cancelled,
+    };
+
+    // fraction 为 [0, 1] 的完成比例，每前进 1% 回调一次
+    using ProgressCallback = std::function<void(double fraction)>;
+    // 导出结束（完成、失败或取消）时回调一次，失败时 error 为原因
+    using FinishCallback = std::function<void(State state, const std::string &error)>;
+
+    ClipExporter() = default;
+
+    ~ClipExporter();
+
+    ClipExporter(const ClipExporter &) = delete;
+
+    ClipExporter &operator=(const ClipExporter &) = delete;
+
+    // 在后台线程开始导出，已有导出在进行时返回 false
+    bool start(const ClipExportOptions &options, ProgressCallback onProgress = nullptr,
+               FinishCallback onFinish = nullptr);
+
+    // 请求取消，阻塞的读写会通过中断回调立即返回，未写完的输出文件被删除
+    void cancel();
+
+    // 等待导出线程结束，返回最终状态
+    State wait();
+
+    State state() const { return state_; }
+
+    double progress() const { return progress_; }
+
+    std::string error();
+
+private:
+    void run(ClipExportOptions options, ProgressCallback onProgress, FinishCallback onFinish);
+
+    // 导出的主体，失败时返回 FFmpeg 错误码并写入 error_
+    int exportClip(const ClipExportOptions &options, const ProgressCallback &onProgress);
+
+    void setError(const std::string &message);
+
+    std::mutex mutex_;  // 保护 thread_ 和 error_
+    std::thread thread_;
+    std::string error_;
+    std::atomic<State> state_{State::Idle};
+    std::atomic<double> progress_{0};
+    std::atomic<bool> cancelled_{false};
+};
+
+#endif // VIDEO_PLAYER_CLIP_EXPORTER_H
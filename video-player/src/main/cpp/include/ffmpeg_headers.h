@@ -0,0 +1,49 @@
+#ifndef VIDEO_PLAYER_FFMPEG_HEADERS_H
+#define VIDEO_PLAYER_FFMPEG_HEADERS_H
+
+extern "C" {
+#if !defined(__ANDROID__)  // 主机构建：使用系统安装的 FFmpeg
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/display.h>
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/md5.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/time.h>
+#include <libswscale/swscale.h>
+#elif defined(__arm64__) || defined(__aarch64__)  // 针对 arm64-v8a 架构
+#include "ffmpeg/arm64-v8a/include/libavformat/avformat.h"
+#include "ffmpeg/arm64-v8a/include/libavcodec/avcodec.h"
+#include "ffmpeg/arm64-v8a/include/libavutil/display.h"
+#include "ffmpeg/arm64-v8a/include/libavutil/frame.h"
+#include "ffmpeg/arm64-v8a/include/libavutil/imgutils.h"
+#include "ffmpeg/arm64-v8a/include/libavutil/md5.h"
+#include "ffmpeg/arm64-v8a/include/libavutil/pixdesc.h"
+#include "ffmpeg/arm64-v8a/include/libavutil/time.h"
+#include "ffmpeg/arm64-v8a/include/libswscale/swscale.h"
+#elif defined(__x86_64__)  // 针对 x86_64 架构
+#include "ffmpeg/x86_64/include/libavformat/avformat.h"
+#include "ffmpeg/x86_64/include/libavcodec/avcodec.h"
+#include "ffmpeg/x86_64/include/libavutil/display.h"
+#include "ffmpeg/x86_64/include/libavutil/frame.h"
+#include "ffmpeg/x86_64/include/libavutil/imgutils.h"
+#include "ffmpeg/x86_64/include/libavutil/md5.h"
+#include "ffmpeg/x86_64/include/libavutil/pixdesc.h"
+#include "ffmpeg/x86_64/include/libavutil/time.h"
+#include "ffmpeg/x86_64/include/libswscale/swscale.h"
+#else
+// 默认使用通用的头文件
+#include "ffmpeg/include/libavformat/avformat.h"
+#include "ffmpeg/include/libavcodec/avcodec.h"
+#include "ffmpeg/include/libavutil/display.h"
+#include "ffmpeg/include/libavutil/frame.h"
+#include "ffmpeg/include/libavutil/imgutils.h"
+#include "ffmpeg/include/libavutil/md5.h"
+#include "ffmpeg/include/libavutil/pixdesc.h"
+#include "ffmpeg/include/libavutil/time.h"
+#include "ffmpeg/include/libswscale/swscale.h"
+#endif
+}
+
+#endif // VIDEO_PLAYER_FFMPEG_HEADERS_H
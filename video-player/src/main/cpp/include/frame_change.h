@@ -0,0 +1,79 @@
+#ifndef VIDEO_PLAYER_FRAME_CHANGE_H
+#define VIDEO_PLAYER_FRAME_CHANGE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ffmpeg_headers.h"
+#include "frame_pool.h"
+
+// 一帧相对于上一次输出内容的变化
+struct FrameChange {
+    enum class Kind {
+        Full,       // 第一帧、尺寸或格式变化、检测关闭或格式不支持：整帧输出
+        Unchanged,  // 所有块都与上一次输出相同（或差异在阈值内）：保持当前画面
+        Partial,    // 只有 rects 中的区域变化
+    };
+
+    // 变化区域，亮度平面的像素坐标，色度平面按抽样比例换算
+    struct Rect {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    Kind kind = Kind::Full;
+    std::vector<Rect> rects;  // Partial 时有效：同一块行里相邻的变化块合并成一个矩形
+};
+
+// 静态帧检测：屏幕录制、幻灯片讲座里有大段完全相同的帧，逐块（默认 64x64）用 SIMD 计算与
+// 上一次输出内容的绝对差之和，全部块都没变时输出端不必再复制、上传，只变了一部分时只上传变化的块。
+// 参考内容是检测器自己保存的一份“当前显示的画面”：只有判定为变化的块才更新，所以阈值大于 0 时
+// 近似相同的块不会一帧帧累积偏差。threshold 为每像素平均绝对差的上限，0 表示逐字节相同。
+// 只处理 8 位平面格式（YUV420P 等），其余格式总是返回 Full。
+// configure 可以在任意线程调用，在下一帧生效；compare 只在一个输出线程上调用。
+// 结果写入 change.* 指标：frames / unchangedFrames / partialFrames，skippedBytes / totalBytes
+// 为输出端省掉的和原本需要复制、上传的字节数，skippedPercent 为两者之比
+class FrameChangeDetector {
+public:
+    FrameChangeDetector() = default;
+
+    ~FrameChangeDetector();
+
+    FrameChangeDetector(const FrameChangeDetector &) = delete;
+
+    FrameChangeDetector &operator=(const FrameChangeDetector &) = delete;
+
+    // tileSize 为 0 时整帧作为一块（只区分相同和不同），否则向上取整到 16 的倍数
+    void configure(bool enabled, int tileSize = 64, int threshold = 0);
+
+    bool enabled();
+
+    // 与上一次输出的内容比较并更新参考，返回的引用在下一次 compare 之前有效。
+    // partialUpdates 为 false 表示输出端只能整帧更新，部分变化的帧按 Full 返回
+    const FrameChange &compare(const AVFrame *frame, bool partialUpdates);
+
+    // 输出端换了画面（seek、重新播放、重建表面）时调用，下一帧整帧输出
+    void reset();
+
+private:
+    bool ensureReference(const AVFrame *frame);
+
+    // 把 [x0, x1) x [y0, y1)（亮度坐标）在各平面上对应的区域复制到参考
+    void copyTile(const AVFrame *frame, int x0, int y0, int x1, int y1);
+
+    std::mutex mutex_;
+    bool enabled_ = false;
+    int tileSize_ = 64;
+    int threshold_ = 0;
+    bool resetRequested_ = false;
+
+    FramePool pool_;
+    AVFrame *reference_ = nullptr;
+    std::vector<uint8_t> dirty_;  // 每块是否变化，按块行排列
+    FrameChange change_;
+};
+
+#endif // VIDEO_PLAYER_FRAME_CHANGE_H
@@ -0,0 +1,53 @@
+#ifndef VIDEO_PLAYER_FRAME_DOWNSCALER_H
+#define VIDEO_PLAYER_FRAME_DOWNSCALER_H
+
+#include <cstdint>
+
+#include "ffmpeg_headers.h"
+#include "frame_pool.h"
+
+// 按显示表面大小在解码端降分辨率：源分辨率是表面的 threshold 倍以上时，先用解码器的 lowres
+// （MPEG-4/MJPEG 等支持的编码器）在解码时直接输出缩小的帧，剩下的 2 的幂次在入队前用 SIMD
+// 2:1 盒式滤波缩小，其余格式或非 2 的幂次时用 swscale。缩放发生在帧进入队列之前，
+// 之后的复制、上传都按缩小后的大小进行。输出不小于表面大小，剩余的缩放交给 GPU。
+struct DownscalePlan {
+    int lowres = 0;        // 解码器 lowres 级数，每级宽高减半
+    int boxSteps = 0;      // 解码后再做的 2:1 缩小次数
+    bool swsOnly = false;  // 倍数不到 2（threshold < 2）时直接用 swscale 缩放到表面大小
+    int outputWidth = 0;   // 预计的输出尺寸，不缩放时为源尺寸
+    int outputHeight = 0;
+
+    bool active() const { return lowres > 0 || boxSteps > 0 || swsOnly; }
+};
+
+class FrameDownscaler {
+public:
+    // 计算缩放方案：targetWidth/targetHeight 为 0 或倍数小于 threshold 时不缩放
+    static DownscalePlan plan(const AVCodec *codec, int sourceWidth, int sourceHeight,
+                              int targetWidth, int targetHeight, double threshold);
+
+    explicit FrameDownscaler(const DownscalePlan &plan) : plan_(plan) {}
+
+    ~FrameDownscaler();
+
+    FrameDownscaler(const FrameDownscaler &) = delete;
+
+    FrameDownscaler &operator=(const FrameDownscaler &) = delete;
+
+    // 返回要入队的新帧（调用者释放）：需要缩小时是缩放后的帧，否则是 av_frame_clone。
+    // fullSizeBytes 是不降分辨率时一帧的紧密排列大小，用于统计节省的带宽
+    AVFrame *process(const AVFrame *frame, int64_t fullSizeBytes);
+
+    const DownscalePlan &plan() const { return plan_; }
+
+private:
+    AVFrame *halve(const AVFrame *source);
+
+    AVFrame *scaleWithSws(const AVFrame *source, int width, int height);
+
+    DownscalePlan plan_;
+    FramePool pool_;
+    SwsContext *swsContext_ = nullptr;
+};
+
+#endif // VIDEO_PLAYER_FRAME_DOWNSCALER_H
@@ -0,0 +1,114 @@
+#ifndef VIDEO_PLAYER_FRAME_FANOUT_H
+#define VIDEO_PLAYER_FRAME_FANOUT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ffmpeg_headers.h"
+#include "metrics.h"
+
+// 一个旁路消费者（分析模型、录制器等）的帧队列。每帧是解码帧的 av_frame_ref 视图，不复制像素；
+// 队列有界，满了按 DropPolicy 丢帧，发布端从不等待消费者
+class FrameSubscriber {
+public:
+    enum class DropPolicy {
+        DropOldest,  // 丢掉队列里最旧的帧，消费者总是拿到最新的画面（分析、预览）
+        DropNewest,  // 丢掉新来的帧，队列里已有的连续帧保持不变（按段录制）
+    };
+
+    // 本实例的统计，重新订阅同一个名字时从 0 开始
+    struct Stats {
+        int64_t delivered = 0;  // 已被取走的帧数
+        int64_t dropped = 0;    // 因队列满丢弃的帧数
+        int64_t queued = 0;     // 当前排队的帧数
+        int64_t lagUs = 0;      // 最新发布的帧与消费者最近取走的帧之间的媒体时间差
+    };
+
+    FrameSubscriber(std::string name, size_t capacity, DropPolicy policy);
+
+    ~FrameSubscriber();
+
+    FrameSubscriber(const FrameSubscriber &) = delete;
+
+    FrameSubscriber &operator=(const FrameSubscriber &) = delete;
+
+    const std::string &name() const { return name_; }
+
+    // 取下一帧，调用者通过 av_frame_free 释放。timeoutUs 为 0 时不等待，小于 0 时一直等到有帧或 close；
+    // 超时或已关闭时返回 nullptr。ptsUs 不为空时填入帧的媒体时间
+    AVFrame *pop(int64_t timeoutUs, int64_t *ptsUs = nullptr);
+
+    Stats stats();
+
+    // 停止接收新帧并唤醒等待中的 pop，已排队的帧仍然可以取走
+    void close();
+
+private:
+    friend class FrameFanout;
+
+    struct Pending {
+        AVFrame *frame;
+        int64_t ptsUs;
+    };
+
+    // 发布端调用：只加引用计数，从不等待
+    void push(const AVFrame *frame, int64_t ptsUs);
+
+    void flush();
+
+    // 调用时持有 mutex_
+    void setLag(int64_t lagUs);
+
+    const std::string name_;
+    const size_t capacity_;
+    const DropPolicy policy_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> queue_;
+    bool closed_ = false;
+    int64_t latestPtsUs_ = AV_NOPTS_VALUE;   // 最新发布的帧
+    int64_t takenPtsUs_ = AV_NOPTS_VALUE;    // 最近取走的帧
+    // stats() 的来源，只属于这个订阅者；同时同步到 fanout.<名字>.* 指标（同名订阅者共用指标）
+    int64_t delivered_ = 0;
+    int64_t dropped_ = 0;
+    int64_t lagUs_ = 0;
+    metrics::Counter &deliveredMetric_;
+    metrics::Counter &droppedMetric_;
+    metrics::Counter &lagMetric_;
+};
+
+// 解码帧的多消费者分发：显示路径仍然是原来的帧队列（它的背压控制解码节奏），其余消费者各自订阅，
+// 每个订阅者有自己的有界队列和丢帧策略，慢的订阅者只会让自己丢帧，不会拖住解码和显示。
+// 每个订阅者的指标为 fanout.<名字>.delivered / dropped / lagUs，只用于观察；
+// FrameSubscriber::stats 按实例统计，不受同名订阅者和 metrics::resetAll 影响
+class FrameFanout {
+public:
+    std::shared_ptr<FrameSubscriber> subscribe(const std::string &name, size_t capacity = 4,
+                                               FrameSubscriber::DropPolicy policy =
+                                               FrameSubscriber::DropPolicy::DropOldest);
+
+    // 取消订阅并关闭它的队列
+    void unsubscribe(const std::shared_ptr<FrameSubscriber> &subscriber);
+
+    // 没有订阅者时发布端可以跳过
+    bool active() const { return count_ > 0; }
+
+    // 解码线程调用：给每个订阅者一个引用
+    void publish(const AVFrame *frame, int64_t ptsUs);
+
+    // seek / 重新播放时丢弃所有排队的帧
+    void flush();
+
+private:
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<FrameSubscriber>> subscribers_;
+    std::atomic<int> count_{0};
+};
+
+#endif // VIDEO_PLAYER_FRAME_FANOUT_H
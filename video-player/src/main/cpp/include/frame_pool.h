@@ -0,0 +1,36 @@
+#ifndef VIDEO_PLAYER_FRAME_POOL_H
+#define VIDEO_PLAYER_FRAME_POOL_H
+
+#include <cstddef>
+#include <map>
+
+#include "ffmpeg_headers.h"
+
+// 我们自己生成的帧（缩放、裁剪输出）的分配器：按平面大小分成 AVBufferPool，尺寸稳定时
+// 不再分配内存；帧缓冲和解码器分配的帧一样计入 DecodedFrames 记账。
+// 只保留当前尺寸和格式的池，尺寸或格式变化（如 ROI 裁剪区域、ABR 切换分辨率）时释放旧的池，
+// 避免每种出现过的平面大小都留下一个池。
+// 只在一个线程上分配，帧可以在任意线程释放；池销毁时仍被引用的缓冲在最后一个引用释放时才释放
+class FramePool {
+public:
+    FramePool() = default;
+
+    ~FramePool();
+
+    FramePool(const FramePool &) = delete;
+
+    FramePool &operator=(const FramePool &) = delete;
+
+    // 分配一帧，行宽按 32 字节对齐，内容未初始化；失败返回 nullptr
+    AVFrame *alloc(int width, int height, AVPixelFormat format);
+
+private:
+    void releasePools();
+
+    std::map<size_t, AVBufferPool *> pools_;
+    int width_ = 0;
+    int height_ = 0;
+    AVPixelFormat format_ = AV_PIX_FMT_NONE;
+};
+
+#endif // VIDEO_PLAYER_FRAME_POOL_H
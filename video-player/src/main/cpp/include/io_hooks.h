@@ -0,0 +1,76 @@
+#ifndef VIDEO_PLAYER_IO_HOOKS_H
+#define VIDEO_PLAYER_IO_HOOKS_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "ffmpeg_headers.h"
+
+// 拦截解复用器内部打开的子资源（HLS/DASH 的分片和播放列表）：在真实的 AVIOContext 外再包一层，
+// 统计每个资源的字节数和花在读取调用里的时间。解码端背压造成的停顿不在读取调用里，不会拉低吞吐。
+// MediaCache 开启时同一层还负责磁盘缓存：命中的块直接从磁盘读，未命中的边读边写入，
+// 资源完全命中时不连网。
+// 主输入由 avformat_close_input 直接 avio_close，不能在 io_open 里包装，需要缓存时通过
+// openInput 以自定义 I/O 打开，关闭输入后再调用 closeInput。
+class IoHooks {
+public:
+    // 一个子资源从打开到关闭的网络传输统计（不含缓存命中的部分）
+    struct Transfer {
+        std::string url;
+        int64_t bytes = 0;
+        int64_t readMicros = 0;  // 累计在读取调用里的时间
+    };
+
+    using OpenCallback = std::function<void(const char *url)>;
+    using CloseCallback = std::function<void(const Transfer &transfer)>;
+
+    ~IoHooks();
+
+    // 必须在 avformat_open_input 之前调用，IoHooks 的生命周期要长于 context
+    void install(AVFormatContext *context);
+
+    // 以带缓存的自定义 I/O 打开主输入，成功后 context->pb 被设置并带上 AVFMT_FLAG_CUSTOM_IO
+    int openInput(AVFormatContext *context, const char *url);
+
+    // avformat_close_input 之后释放 openInput 打开的主输入
+    void closeInput();
+
+    // 回调在解复用线程（av_read_frame 内部）执行，应尽快返回
+    void setOpenCallback(OpenCallback callback) { onOpen_ = std::move(callback); }
+
+    void setCloseCallback(CloseCallback callback) { onClose_ = std::move(callback); }
+
+private:
+    struct WrappedIo;
+
+    // 连网（资源完全命中缓存时跳过）并包装成新的 AVIOContext，失败时 io 的资源已释放
+    int wrap(WrappedIo *io, AVIOContext **wrapper);
+
+    void release(AVIOContext *wrapper, WrappedIo *io);
+
+    // 关闭网络连接；主输入的 owner 此时可能已经释放，直接 avio_closep
+    void closeInner(WrappedIo *io);
+
+    static int ioOpen(AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
+                      AVDictionary **options);
+
+    static int ioClose(AVFormatContext *s, AVIOContext *pb);
+
+    static int readPacket(void *opaque, uint8_t *buf, int size);
+
+    static int64_t seek(void *opaque, int64_t offset, int whence);
+
+    int (*defaultOpen_)(AVFormatContext *, AVIOContext **, const char *, int,
+                        AVDictionary **) = nullptr;
+    int (*defaultClose_)(AVFormatContext *, AVIOContext *) = nullptr;
+    OpenCallback onOpen_;
+    CloseCallback onClose_;
+    std::mutex mutex_;
+    std::unordered_map<AVIOContext *, WrappedIo *> wrapped_;
+    AVIOContext *inputIo_ = nullptr;
+};
+
+#endif // VIDEO_PLAYER_IO_HOOKS_H
@@ -0,0 +1,23 @@
+#ifndef VIDEO_PLAYER_LOG_H
+#define VIDEO_PLAYER_LOG_H
+
+// 日志宏：包含前定义 LOG_TAG。Android 上输出到 logcat，主机构建输出到 stderr
+#ifndef LOG_TAG
+#define LOG_TAG "Native-FFmpegDecoder"
+#endif
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#else
+#include <cstdio>
+#define VP_HOST_LOG(level, ...) \
+    (fprintf(stderr, level "/" LOG_TAG ": " __VA_ARGS__), fputc('\n', stderr))
+#define LOGI(...) VP_HOST_LOG("I", __VA_ARGS__)
+#define LOGW(...) VP_HOST_LOG("W", __VA_ARGS__)
+#define LOGE(...) VP_HOST_LOG("E", __VA_ARGS__)
+#endif
+
+#endif // VIDEO_PLAYER_LOG_H
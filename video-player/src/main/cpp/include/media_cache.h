@@ -0,0 +1,111 @@
+#ifndef VIDEO_PLAYER_MEDIA_CACHE_H
+#define VIDEO_PLAYER_MEDIA_CACHE_H
+
+#include <cstdint>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 网络媒体的磁盘缓存：每个资源（URL，HLS 字节范围分片再加上范围）按固定大小切块，
+// 每块一个文件。播放时边读边写入，之后的读取（重播、往回 seek）直接从磁盘返回。
+// 总大小受 LRU 字节预算限制，LRU 顺序在内存里维护，每块每次运行最多更新一次文件修改时间来持久化，
+// 重启后扫描目录恢复。文件读写不持有缓存的锁，锁只保护内存里的索引，多个播放器、导出、探测之间不互相等待磁盘。
+// 资源长度作为校验值：重新连网时长度变了就丢弃该资源的全部缓存块。
+// 命中率和节省的字节数写入 cache.* 指标。
+class MediaCache {
+public:
+    static const int64_t BLOCK_SIZE = 256 * 1024;
+
+    static MediaCache &instance();
+
+    // 一个读取者（每个包装的 IO 一个）当前所在的块：块文件保持打开，同一块内的后续读取直接 pread，
+    // 不再打开文件；块被淘汰或重新写入后下一次读取重新打开。只在一个线程上使用
+    class BlockReader {
+    public:
+        BlockReader() = default;
+
+        ~BlockReader() { close(); }
+
+        BlockReader(const BlockReader &) = delete;
+
+        BlockReader &operator=(const BlockReader &) = delete;
+
+        void close();
+
+    private:
+        friend class MediaCache;
+
+        int fd_ = -1;
+        uint64_t id_ = 0;  // 打开的是哪个块（BlockEntry::id）
+    };
+
+    // 设置缓存目录和字节预算；目录为空或预算为 0 时关闭缓存
+    bool configure(const std::string &directory, int64_t capacityBytes);
+
+    bool enabled();
+
+    // 只缓存网络上的媒体数据，播放列表 / MPD 会变化，不缓存
+    static bool isCacheable(const char *url);
+
+    // 已知的资源长度，没有记录时返回 -1
+    int64_t resourceSize(const std::string &key);
+
+    // 记录连网得到的资源长度；与已记录的不同时丢弃旧的缓存块
+    void setResourceSize(const std::string &key, int64_t size);
+
+    // 资源的所有块都在磁盘上，可以完全不连网
+    bool isComplete(const std::string &key);
+
+    bool hasBlock(const std::string &key, int64_t block);
+
+    // 从缓存块的 offset 处读取，未命中返回 -1；块文件留在 reader 里供同一块的后续读取使用
+    int readBlock(const std::string &key, int64_t block, int64_t offset, uint8_t *buf, int size,
+                  BlockReader &reader);
+
+    // 写入一个完整的块（最后一块可能不满 BLOCK_SIZE）
+    void writeBlock(const std::string &key, int64_t block, const uint8_t *data, int64_t size);
+
+    // 统计从缓存 / 网络读取的可缓存字节，用于计算命中率
+    void recordRead(int64_t hitBytes, int64_t missBytes);
+
+private:
+    struct BlockEntry {
+        int64_t size;
+        std::list<std::string>::iterator lruPosition;
+        uint64_t id;      // 每次加入索引时分配，区分同名文件被删掉后重新写入的块
+        bool persisted;   // 本次运行已经更新过文件修改时间（或刚写入）
+    };
+
+    static std::string hashKey(const std::string &key);
+
+    std::string blockFile(const std::string &hash, int64_t block) const;
+
+    std::string metaFile(const std::string &hash) const;
+
+    void loadLocked();
+
+    void addLocked(const std::string &file, int64_t size, bool persisted);
+
+    // 从索引中删除，要删除的文件追加到 doomed，由调用者释放锁之后 unlinkAll
+    void removeLocked(const std::string &file, std::vector<std::string> &doomed);
+
+    void evictLocked(std::vector<std::string> &doomed);
+
+    static void unlinkAll(const std::vector<std::string> &paths);
+
+    std::mutex mutex_;
+    std::string directory_;
+    int64_t capacity_ = 0;
+    int64_t totalBytes_ = 0;
+    std::list<std::string> lru_;  // 块文件名，队首最近使用
+    std::unordered_map<std::string, BlockEntry> blocks_;
+    std::unordered_map<std::string, int64_t> sizes_;  // 资源哈希 -> 长度
+    std::unordered_map<std::string, int> blockCounts_;  // 资源哈希 -> 磁盘上的块数
+    uint64_t nextId_ = 1;
+    std::atomic<uint64_t> tempSequence_{0};  // 同一块被同时写入时临时文件不冲突
+};
+
+#endif // VIDEO_PLAYER_MEDIA_CACHE_H
@@ -0,0 +1,69 @@
+#ifndef VIDEO_PLAYER_MEDIA_PROBER_H
+#define VIDEO_PLAYER_MEDIA_PROBER_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 一个媒体文件的元数据，时长为 AV_TIME_BASE 单位，编码名为 FFmpeg 的编码名（如 "hevc"、"aac"）
+struct MediaInfo {
+    bool valid = false;       // 打开失败或没有音视频流时为 false，同样缓存，文件不变就不再重试
+    int64_t durationUs = -1;
+    int width = 0;
+    int height = 0;
+    int rotation = 0;         // 显示时顺时针旋转的角度（0/90/180/270）
+    double frameRate = 0;
+    int64_t bitRate = 0;
+    std::string videoCodec;
+    std::string audioCodec;
+};
+
+// 要探测的文件。size / mtime 是缓存的校验值，调用者已经知道（如 MediaStore 的 SIZE、DATE_MODIFIED）
+// 时直接传入，省掉每个文件一次 stat；小于 0 时用 stat 取得（mtime 为纳秒）
+struct ProbeRequest {
+    std::string path;
+    int64_t size = -1;
+    int64_t mtime = -1;
+};
+
+// 媒体库元数据批量探测：在有界的线程池上并行打开文件，只读容器头里的流参数（头里缺少尺寸或编码时
+// 才用很小的 probesize 读几个包），不解码。结果按 (路径, 大小, 修改时间) 缓存在内存里，并持久化到
+// 一个紧凑的二进制文件，缓存已热时整个媒体库的扫描只是几千次哈希查找。
+// 命中、未命中和探测耗时写入 probe.* 指标
+class MediaProber {
+public:
+    static MediaProber &instance();
+
+    // 设置持久化文件并载入已有内容，为空时只在内存中缓存
+    bool setCacheFile(const std::string &file);
+
+    // 按 requests 的顺序返回结果：命中缓存的直接返回，其余最多用 threads 个线程并行探测
+    // （0 表示按 CPU 核数，最多 8 个），探测到新内容时写回持久化文件
+    std::vector<MediaInfo> probe(const std::vector<ProbeRequest> &requests, int threads = 0);
+
+    // 把内存中的缓存写入持久化文件（先写临时文件再 rename），没有变化时不写
+    bool flush();
+
+    // 不经过缓存直接探测一个文件
+    static MediaInfo probeFile(const char *path);
+
+private:
+    struct Entry {
+        int64_t size;
+        int64_t mtime;
+        MediaInfo info;
+    };
+
+    bool loadLocked();
+
+    bool saveLocked();
+
+    std::mutex mutex_;
+    std::string file_;
+    std::unordered_map<std::string, Entry> entries_;  // 路径 -> 校验值和结果
+    bool dirty_ = false;
+};
+
+#endif // VIDEO_PLAYER_MEDIA_PROBER_H
@@ -0,0 +1,76 @@
+#ifndef VIDEO_PLAYER_MEMORY_BUDGET_H
+#define VIDEO_PLAYER_MEMORY_BUDGET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ffmpeg_headers.h"
+
+// 播放管线的内存记账：按子系统统计当前和峰值字节数（memory.<分类>.currentBytes / peakBytes 指标）。
+// 解码帧通过 get_buffer2 包装在 av_buffer 释放回调里记账，包括队列里的帧、拉模式下 Java 持有的帧
+// 和解码器内部的参考帧；我们自己的缓冲区用 TrackedBuffer 分配。
+// 设置硬预算后，解码线程在下一帧可能超出预算时停止提前解码，等输出端释放帧。
+namespace memory {
+
+    enum class Category {
+        DecodedFrames,  // 解码器分配的帧缓冲
+        Packets,        // 解码线程持有的压缩包
+        RenderBuffers,  // 输出端的复制缓冲（JNI 回调等）
+        IoBuffers,      // I/O 包装层和磁盘缓存的缓冲
+        Count
+    };
+
+    void allocated(Category category, int64_t bytes);
+
+    void freed(Category category, int64_t bytes);
+
+    int64_t current(Category category);
+
+    // 所有分类的当前字节数之和
+    int64_t total();
+
+    // 设置硬预算（字节），0 表示不限制
+    void setBudget(int64_t bytes);
+
+    int64_t budget();
+
+    // 再分配 bytes 字节后是否仍在预算内
+    bool fits(int64_t bytes);
+
+    // 作为 AVCodecContext::get_buffer2：用默认分配器分配，再把每个平面的 AVBufferRef
+    // 包一层带释放回调的引用，帧缓冲真正释放（或回到 FFmpeg 的缓冲池）时减账
+    int trackedGetBuffer2(AVCodecContext *context, AVFrame *frame, int flags);
+
+    // 给我们自己分配的帧（如缩放输出）的缓冲加上同样的记账
+    void trackFrameBuffers(AVFrame *frame);
+
+    // 记账的字节缓冲区，容量只增不减，析构时释放
+    class TrackedBuffer {
+    public:
+        explicit TrackedBuffer(Category category) : category_(category) {}
+
+        ~TrackedBuffer() { reset(); }
+
+        TrackedBuffer(const TrackedBuffer &) = delete;
+
+        TrackedBuffer &operator=(const TrackedBuffer &) = delete;
+
+        // 保证容量至少为 size 字节，扩容时不保留原有内容
+        uint8_t *reserve(size_t size);
+
+        uint8_t *data() const { return data_.get(); }
+
+        size_t capacity() const { return capacity_; }
+
+        void reset();
+
+    private:
+        Category category_;
+        std::unique_ptr<uint8_t[]> data_;
+        size_t capacity_ = 0;
+    };
+
+}  // namespace memory
+
+#endif // VIDEO_PLAYER_MEMORY_BUDGET_H
@@ -0,0 +1,34 @@
+#ifndef VIDEO_PLAYER_METRICS_H
+#define VIDEO_PLAYER_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// 运行时指标：按名字注册的原子计数器，各子系统直接累加，统一导出为 JSON 供 Java 层和工具读取。
+// 返回的引用在进程生命周期内有效，热路径上应缓存引用而不是每次按名字查找。
+namespace metrics {
+
+    class Counter {
+    public:
+        void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+
+        void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+
+        int64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> value_{0};
+    };
+
+    Counter &counter(const char *name);
+
+    // 所有指标的 JSON 对象，键按名字排序
+    std::string snapshotJson();
+
+    // 把所有指标清零（名字保留）
+    void resetAll();
+
+}  // namespace metrics
+
+#endif // VIDEO_PLAYER_METRICS_H
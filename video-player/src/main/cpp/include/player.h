@@ -0,0 +1,172 @@
+#ifndef VIDEO_PLAYER_PLAYER_H
+#define VIDEO_PLAYER_PLAYER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "abr_controller.h"
+#include "decoder_pool.h"
+#include "ffmpeg_headers.h"
+#include "frame_change.h"
+#include "frame_downscaler.h"
+#include "frame_fanout.h"
+#include "io_hooks.h"
+#include "region_of_interest.h"
+#include "scene_detector.h"
+#include "video_sink.h"
+#include "vsync_scheduler.h"
+
+// 播放核心：解复用、解码、帧队列和按时间输出，不依赖 JNI，Android 和主机构建共用
+
+const int BUFFER_SECS = 2;  // 缓冲秒数
+const int MIN_QUEUE_SIZE = 5;  // 最小队列大小
+const int MAX_QUEUE_SIZE = 60;  // 最大队列大小
+
+// FFmpeg 相关资源封装
+struct FFmpegContext {
+    AVFormatContext *formatContext = nullptr;  // 存储音视频封装格式中包含的所有信息
+    AVCodecContext *codecContext = nullptr;    // 编解码器上下文，存储编解码器的相关参数
+    const AVCodec *codec = nullptr;           // 编解码器，包含实际的编解码功能实现
+    DecoderOptions decoderOptions;            // 打开解码器时的选项，切换变体重开解码器时沿用
+    int videoStreamIndex = -1;                // 正在解码的视频流
+    double frameRate = 0.0;  // 添加帧率字段
+    int64_t frameInterval = 0;  // 帧间隔（微秒）
+    int64_t nextFrameTime = 0;  // 下一帧的目标时间
+    int targetQueueSize;  // 目标队列大小
+    int64_t startTime = 0;        // 开始播放时间
+    int64_t totalDuration = 0;    // 视频总时长（微秒）
+    int64_t currentTime = 0;      // 当前播放时间（微秒）
+    double timeBase = 0.0;        // 时间基准
+    int64_t clockAnchorTime = -1; // 播放时钟锚点：首帧显示时的单调时钟时间（微秒）
+    int64_t clockAnchorPts = 0;   // 播放时钟锚点对应的媒体时间（微秒）
+    int64_t pauseTime = 0;        // 进入暂停时的单调时钟时间（微秒）
+    std::unique_ptr<IoHooks> ioHooks;     // 子资源 I/O 统计，需比 formatContext 活得久
+    std::unique_ptr<AbrController> abr;   // 多变体输入的码率选择，非自适应输入时为空
+    std::unique_ptr<FrameDownscaler> downscaler;  // 按显示表面大小缩小入队的帧
+    int outputWidth = 0;          // 入队帧的尺寸（降分辨率后）
+    int outputHeight = 0;
+    int64_t fullFrameBytes = 0;   // 不降分辨率时一帧的紧密排列大小
+
+    // 获取格式化的间字符串
+    static std::string getFormattedTime(int64_t timeInMicros);
+
+    ~FFmpegContext();
+
+    void calculateTargetQueueSize();
+};
+
+extern std::unique_ptr<FFmpegContext> ffmpegContext;
+
+// 打开文件并初始化解码器，失败返回 false
+bool initDecoder(const char *path);
+
+// 启动解码线程；推送模式下同时启动渲染线程，把帧按时间交给 sink。
+// 拉模式下 sink 可以为空，帧由 acquireLatestFrame 获取。
+bool startDecoding(std::shared_ptr<VideoSink> sink);
+
+// 停止并 join 所有管线线程
+void stopDecoding();
+
+// 暂停/恢复：线程停在播放时钟上，解码器和已解码的帧保持不变
+void pauseDecoding();
+
+void resumeDecoding();
+
+// 从头重新播放，不重建线程和解码器
+void restartDecoding();
+
+void releaseDecoder();
+
+bool isDecoding();
+
+bool isPaused();
+
+// 低延迟直播模式（RTSP/RTMP/HTTP-FLV）：fflags nobuffer、最小探测、low_delay + slice 线程，
+// 队列只保留 mailboxSize（1~2）帧，到达即显示，队列满时丢弃旧帧追赶。需在 initDecoder 之前设置
+bool setLiveMode(bool enabled, int mailboxSize = 2);
+
+bool isLiveMode();
+
+// 自适应码率（HLS master / DASH）：按分片下载吞吐和已解码缓冲选择变体，在分片边界切换，
+// 编码参数允许时不重开解码器。需在 initDecoder 之前设置，非多变体输入时不起作用
+void setAbrEnabled(bool enabled);
+
+bool isAbrEnabled();
+
+// 显示表面大小：源分辨率达到表面的 threshold 倍（默认 2）以上时在解码端降分辨率，
+// 优先用解码器的 lowres，否则入队前用 SIMD 盒式滤波缩小。需在 initDecoder 之前设置，0 表示不缩放
+void setTargetSurfaceSize(int width, int height);
+
+void setDownscaleThreshold(double factor);
+
+// 解复用时把视频以外的流（音频、字幕、数据、封面图）设为 AVDISCARD_ALL，默认开启；需在 initDecoder 之前设置
+void setDiscardUnusedStreams(bool enabled);
+
+// 有多个视频流时的编码偏好，逗号分隔的 FFmpeg 编码名（如 "hevc,h264"），按顺序优先；
+// 为空时使用 av_find_best_stream 的选择。需在 initDecoder 之前设置
+void setPreferredVideoCodecs(const std::string &codecNames);
+
+// 10/12 位输入（HEVC Main10 的 yuv420p10le、P010）入队前转换成的 8 位格式：AV_PIX_FMT_YUV420P（默认，
+// GL 渲染器和 JNI 回调使用）或 AV_PIX_FMT_NV12；dither 为 true 时用有序抖动减少色带。需在 initDecoder 之前设置
+void setHighBitDepthOutput(AVPixelFormat output, bool dither);
+
+// 输出区域：只复制、上传（可选缩放）帧的一个子矩形，坐标相对于入队帧的尺寸。
+// 可以在播放中随时调用，修改在下一帧生效；width/height 为 0 恢复整帧输出
+void setRegionOfInterest(const RegionOfInterest &region);
+
+RegionOfInterest regionOfInterest();
+
+// 拉模式：不启动渲染线程，由显示端调用 acquireLatestFrame；需在开始解码前设置
+bool setPullMode(bool enabled);
+
+bool isPullMode();
+
+// vsync 驱动的推送模式：渲染线程不按帧时间睡眠，而是在 vsyncScheduler() 收到的每个外部 vsync 上醒来，
+// 为预测的下一次 vsync 选出理想时间最接近的帧，同一 vsync 里到期的旧帧丢弃。需在开始解码前设置，
+// 时钟源（Choreographer、SimulatedVsyncTicker）需持续调用 vsyncScheduler().onVsync。
+// 收到外部 vsync 时，拉模式和按时钟输出的播放时钟锚点也会对齐到 vsync 网格
+bool setVsyncDriven(bool enabled);
+
+bool isVsyncDriven();
+
+VsyncScheduler &vsyncScheduler();
+
+// 显示以外的帧消费者（分析模型、录制器等）在这里订阅入队的帧。订阅者拿到的是引用，队列满时按各自的
+// 策略丢帧，从不阻塞解码和显示；seek 和重新播放时清空所有订阅者的队列。可以在播放中随时订阅、取消
+FrameFanout &frameFanout();
+
+// 关闭后解码和输出不再按 PTS 等待，以最快速度运行，用于测量管线吞吐
+void setPacingEnabled(bool enabled);
+
+// 解码到文件末尾且所有帧都已输出（线程仍在运行，可以 restartDecoding）
+bool isPlaybackFinished();
+
+// 拉模式取帧：返回最适合 presentationTimeNs 这次显示的帧，没有新帧时返回 nullptr。
+// 已经被取代的帧直接丢弃，返回的帧由调用者通过 av_frame_free 释放。
+// 开启静态帧检测时，与上一次取走的内容相同的帧也返回 nullptr；change 不为空时填入相对上一帧的
+// 变化区域，显示端可以只上传这些区域（为空时部分变化的帧按整帧处理）
+AVFrame *acquireLatestFrame(int64_t presentationTimeNs, FrameChange *change = nullptr);
+
+// 静态帧检测：按 tileSize 的块与上一次输出的内容比较，没变的帧推送模式下调用 onFrameUnchanged、
+// 拉模式下不返回，每像素平均绝对差不超过 threshold 的块视为没变。可以在播放中随时调用，默认关闭
+void setFrameChangeDetection(bool enabled, int tileSize = 64, int threshold = 0);
+
+// 显示端丢失了当前画面（如 GL 上下文重建）时调用，下一帧整帧输出
+void resetFrameChanges();
+
+// 场景切换检测：入队的帧以引用交给独立的分析线程，得分（0 ~ 100）达到 threshold 且距上一个切换点
+// 不短于 minSceneUs 时记为切换点。可以在播放中随时调用，默认关闭；seek 和重新播放后重新开始比较
+void setSceneDetection(bool enabled, double threshold = 10.0, int64_t minSceneUs = 500000);
+
+// 取出上次调用以来检测到的场景切换点，按媒体时间顺序
+std::vector<SceneCut> takeSceneCuts();
+
+#endif // VIDEO_PLAYER_PLAYER_H
@@ -0,0 +1,58 @@
+#ifndef VIDEO_PLAYER_PRESENTATION_STATS_H
+#define VIDEO_PLAYER_PRESENTATION_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+// 呈现时间统计：每帧实际交给输出端（推送模式）或被显示端在 vsync 上取走（拉模式）的时间，
+// 减去按播放时钟由 PTS 得出的理想时间，得到呈现误差。结果写入 present.* 指标：
+//   present.error.*      误差直方图（early8ms 表示提前 8ms 以上，late2ms 表示晚 2~8ms，依此类推）
+//   present.lateFrames   晚于理想时间半个帧间隔以上的帧
+//   present.errorMeanUs / errorMaxUs / jitterUs（相邻两帧误差之差的平均值）
+//   present.repeatedFrames / skippedFrames / cadenceBreaks
+// 节奏检测按帧间隔累计偏差：推送模式比较相邻两帧的实际间隔和 PTS 间隔，拉模式比较每帧停留的
+// vsync 数和 帧间隔 / vsync 间隔 的期望值（如 24fps 在 60Hz 上的 3:2 交替）；累计多出一个 vsync
+// 或一帧记为重复，少了记为节奏中断，被后续帧取代而没显示的帧记为跳过。
+// on* 只在一个输出线程上调用；markDiscontinuity 和 reset 可以在任意线程调用
+class PresentationStats {
+public:
+    // 一帧交给输出端，时间都是 av_gettime_relative 的微秒
+    void onFramePresented(int64_t idealUs, int64_t actualUs, int64_t frameIntervalUs);
+
+    // 拉模式每次显示端取帧、vsync 驱动的推送模式每个 vsync 调用一次，newFrame 为是否换了新帧，
+    // skipped 为这次被取代、没有显示就丢弃的帧数
+    void onVsync(int64_t vsyncUs, bool newFrame, int skipped);
+
+    // 暂停、恢复、重新播放等时间线不连续时调用，下一帧不参与间隔和节奏判断
+    void markDiscontinuity() { discontinuity_ = true; }
+
+    // 新的播放（initDecoder、重新播放）开始时调用，误差均值、最大值和抖动从头统计：
+    // 对应的 present.* 指标立即清零，累计值由输出线程在下一次 on* 时清空
+    void reset();
+
+private:
+    // 输出线程上清空累计值
+    void applyReset();
+
+    void updateCadence(double driftDelta);
+
+    std::atomic<bool> discontinuity_{true};
+    std::atomic<bool> resetRequested_{false};
+    int64_t lastIdealUs_ = 0;
+    int64_t lastActualUs_ = 0;
+    int64_t lastErrorUs_ = 0;
+    int64_t errorSumUs_ = 0;
+    int64_t jitterSumUs_ = 0;
+    int64_t frames_ = 0;
+    int64_t jitterSamples_ = 0;
+    int64_t frameIntervalUs_ = 0;
+    double driftFrames_ = 0;      // 推送模式：累计的实际间隔与 PTS 间隔之差，以帧为单位
+    bool pullMode_ = false;       // 收到过 onVsync，节奏按 vsync 计
+    int64_t lastVsyncUs_ = -1;
+    double vsyncIntervalUs_ = 0;  // vsync 间隔的滑动平均
+    int holdVsyncs_ = 0;          // 当前帧已经停留的 vsync 数
+    bool holding_ = false;        // 已经有帧在显示
+    double driftVsyncs_ = 0;      // 拉模式：累计的停留 vsync 数与期望值之差
+};
+
+#endif // VIDEO_PLAYER_PRESENTATION_STATS_H
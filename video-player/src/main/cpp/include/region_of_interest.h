@@ -0,0 +1,53 @@
+#ifndef VIDEO_PLAYER_REGION_OF_INTEREST_H
+#define VIDEO_PLAYER_REGION_OF_INTEREST_H
+
+#include <mutex>
+
+#include "ffmpeg_headers.h"
+#include "frame_pool.h"
+
+// 输出区域（放大、监控画面只显示帧的一部分）：坐标相对于入队帧，即降分辨率之后的尺寸。
+// width/height 为 0 表示输出整帧；outputWidth/outputHeight 非 0 时把区域缩放到这个尺寸
+struct RegionOfInterest {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    int outputWidth = 0;
+    int outputHeight = 0;
+
+    bool active() const { return width > 0 && height > 0; }
+};
+
+// 在输出端按区域裁剪：只复制（或缩放）可见区域的像素，之后的复制和上传都和可见面积成正比。
+// 区域的起点和尺寸按色度抽样单位对齐，4:2:0 时向外扩到偶数。set 可以在任意线程调用，
+// 每帧在 apply 开始时读取一次区域，所以修改总是在两帧之间生效，不会出现半帧新区域的情况。
+// apply 只在一个输出线程（渲染线程或 GL 线程）上调用
+class RegionCropper {
+public:
+    RegionCropper() = default;
+
+    ~RegionCropper();
+
+    RegionCropper(const RegionCropper &) = delete;
+
+    RegionCropper &operator=(const RegionCropper &) = delete;
+
+    void set(const RegionOfInterest &region);
+
+    RegionOfInterest get();
+
+    // 返回裁剪后的新帧（调用者释放），不需要裁剪或失败时返回 nullptr，调用者继续使用原帧。
+    // compact 为 false 时返回引用原帧缓冲的零复制视图（平面指针指向区域起点、行宽不变），
+    // 适合 av_image_copy_to_buffer 这类按行读取的输出端；为 true 时复制成紧密的新帧，
+    // 供按行宽上传整个平面的 GL 纹理使用
+    AVFrame *apply(const AVFrame *frame, bool compact);
+
+private:
+    std::mutex mutex_;
+    RegionOfInterest region_;
+    FramePool pool_;
+    SwsContext *swsContext_ = nullptr;
+};
+
+#endif // VIDEO_PLAYER_REGION_OF_INTEREST_H
@@ -0,0 +1,42 @@
+#ifndef VIDEO_PLAYER_ROW_KERNELS_H
+#define VIDEO_PLAYER_ROW_KERNELS_H
+
+#include <cstdint>
+
+// 热循环里逐行处理像素的内核：NEON / AVX2 / SSE2 按编译目标选一种，余下的样本由标量循环处理。
+// 放在一个不依赖 FFmpeg 的文件里，simd_check 可以单独编译它们，与独立的标量实现逐字节对比
+namespace rows {
+
+    // 每行加到样本上的偏移，16 个通道（覆盖 AVX2 一次处理的样本数），之后整体右移 shift 位。
+    // 不抖动时是四舍五入的 1 << (shift - 1)；抖动时按 2x2 Bayer 矩阵 {0, 2; 3, 1} 在被丢弃的
+    // 两位里取阈值，paired 为交错的 UV 平面，相邻的 U、V 用同一个阈值
+    struct DitherRow {
+        alignas(32) uint16_t lanes[16];
+    };
+
+    // 一行样本转 8 位：饱和加偏移、右移、饱和收窄
+    void convertRow(const uint16_t *src, uint8_t *dst, int count, int shift, const DitherRow &dither);
+
+    // 两个平面的色度转 8 位并交错成 NV12 的 UV 平面
+    void interleaveRow(const uint16_t *u, const uint16_t *v, uint8_t *dst, int count, int shift,
+                       const DitherRow &dither);
+
+    // 交错的 UV 平面（P010）转 8 位并拆成 U、V 两个平面
+    void deinterleaveRow(const uint16_t *uv, uint8_t *u, uint8_t *v, int count, int shift,
+                         const DitherRow &dither);
+
+    // 一行的绝对差之和，16 字节一组，适合块内的短行
+    uint32_t blockSad(const uint8_t *a, const uint8_t *b, int bytes);
+
+    // 一行的绝对差之和，整行比较时一次处理 32 字节
+    uint64_t lineSad(const uint8_t *a, const uint8_t *b, int width);
+
+    // 64 级亮度直方图，bins 为四组交替累加的计数，使用者自己合并
+    void accumulateHistogram(const uint8_t *row, int width, uint32_t (*bins)[64]);
+
+    // 2:1 缩小的一行输出：每个像素是上下两行中相邻两个像素的四舍五入平均
+    void halveRow(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int width);
+
+}  // namespace rows
+
+#endif // VIDEO_PLAYER_ROW_KERNELS_H
@@ -0,0 +1,85 @@
+#ifndef VIDEO_PLAYER_SCENE_DETECTOR_H
+#define VIDEO_PLAYER_SCENE_DETECTOR_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ffmpeg_headers.h"
+
+// 一个场景切换点：ptsUs 为新场景第一帧的媒体时间，score 为 0 ~ 100 的切换强度
+struct SceneCut {
+    int64_t ptsUs;
+    double score;
+};
+
+// 场景切换检测，用于自动章节和智能缩略图。解码线程把入队的帧以引用（av_frame_ref，不复制像素）
+// 交给独立的分析线程，不占用解码和呈现的时间；分析线程来不及时丢弃最旧的待分析帧，
+// 相当于隔帧比较，切换仍然能检测到。
+// 每帧只看亮度平面，每 4 行取 1 行：用 SIMD 计算与上一帧的绝对差（平均帧差 mafd），
+// 同时统计 64 级亮度直方图。得分为 min(mafd, |mafd - 上一帧 mafd|) 与直方图差的平均：
+// 连续运动时 mafd 一直很高但变化不大，得分低；镜头切换时两者同时跳变。
+// 得分达到阈值且距离上一个切换点不短于 minSceneUs 时记为切换点。
+// 分析的是降分辨率之后的帧；只支持 8 位的平面 / 半平面 YUV 和 GRAY8。
+// 每帧耗时写入 scene.* 指标：frames / cuts / droppedFrames，analysisMicros 为累计，microsPerFrame 为平均
+class SceneDetector {
+public:
+    SceneDetector() = default;
+
+    ~SceneDetector();
+
+    SceneDetector(const SceneDetector &) = delete;
+
+    SceneDetector &operator=(const SceneDetector &) = delete;
+
+    // 开启时启动分析线程，关闭时停止并丢弃待分析的帧；可以在任意线程调用
+    void configure(bool enabled, double threshold = 10.0, int64_t minSceneUs = 500000);
+
+    bool enabled() const { return enabled_; }
+
+    // 解码线程调用：关闭时直接返回，开启时只增加引用计数
+    void submit(const AVFrame *frame, int64_t ptsUs);
+
+    // seek / 重新播放后调用，下一帧不与之前的帧比较
+    void reset();
+
+    // 取出上次调用以来检测到的切换点，按时间顺序
+    std::vector<SceneCut> takeCuts();
+
+private:
+    struct Pending {
+        AVFrame *frame;
+        int64_t ptsUs;
+    };
+
+    void run();
+
+    void analyze(AVFrame *frame, int64_t ptsUs);
+
+    void stopWorker();
+
+    std::mutex configMutex_;  // 串行化 configure（开关和分析线程的启动、停止）
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> queue_;
+    std::vector<SceneCut> cuts_;
+    std::thread thread_;      // 只在持有 configMutex_ 时（或析构时）启动和停止
+    bool stopRequested_ = false;
+    bool resetRequested_ = false;
+    double threshold_ = 10.0;
+    int64_t minSceneUs_ = 500000;
+    std::atomic<bool> enabled_{false};
+
+    // 以下只在分析线程上访问
+    AVFrame *previous_ = nullptr;      // 上一帧的引用
+    std::array<uint32_t, 64> previousHistogram_ = {};
+    double previousMafd_ = 0;
+    int64_t lastCutUs_ = INT64_MIN;
+};
+
+#endif // VIDEO_PLAYER_SCENE_DETECTOR_H
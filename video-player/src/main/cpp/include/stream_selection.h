@@ -0,0 +1,27 @@
+#ifndef VIDEO_PLAYER_STREAM_SELECTION_H
+#define VIDEO_PLAYER_STREAM_SELECTION_H
+
+#include <string>
+#include <vector>
+
+#include "ffmpeg_headers.h"
+
+// 解复用端的流选择：选出要解码的视频流，其余流（音频、字幕、数据、封面图）设为 AVDISCARD_ALL，
+// 解复用器不再为它们分配和返回包，MP4 等容器还能直接跳过它们的负载不读。
+namespace streams {
+
+    // 选择视频流：只考虑有解码器、不是封面图（attached_pic）的视频流。preferredCodecs 为空时
+    // 直接用 av_find_best_stream 的结果；否则按列表顺序选编码，同一编码内 av_find_best_stream
+    // 选中的流优先，其次像素数大的。返回流下标并通过 decoder 返回解码器，找不到时返回负数
+    int selectVideoStream(AVFormatContext *context, const std::vector<AVCodecID> &preferredCodecs,
+                          const AVCodec **decoder);
+
+    // 除 keep 以外的流全部设为 AVDISCARD_ALL，返回被丢弃的流数
+    int discardAllExcept(AVFormatContext *context, int keep);
+
+    // 解析逗号分隔的编码名（如 "hevc,h264"），无法识别的名字忽略
+    std::vector<AVCodecID> parseCodecList(const std::string &names);
+
+}  // namespace streams
+
+#endif // VIDEO_PLAYER_STREAM_SELECTION_H
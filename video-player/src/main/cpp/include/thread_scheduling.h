@@ -0,0 +1,78 @@
+#ifndef VIDEO_PLAYER_THREAD_SCHEDULING_H
+#define VIDEO_PLAYER_THREAD_SCHEDULING_H
+
+#include <cstdint>
+#include <string>
+
+// 管线线程的调度配置：按角色设置 nice 值或实时调度策略、CPU 亲和性，并给系统线程命名
+// （top / systrace / Perfetto 里可见，与 trace 的线程名独立）。
+// 线程启动时用 ScopedThread 登记角色，修改某个角色的配置时对已经在运行的线程立即生效；
+// 从没设置过的角色不做任何修改。
+// 大小核由 /sys/devices/system/cpu 下的 cpu_capacity（没有时用 cpuinfo_max_freq）区分，
+// 各核相同（多数桌面机器）时大核和小核都是全部核心。
+// 只在 Linux / Android 上生效，其余平台只记录配置；失败（如没有权限提高优先级）时写日志并计入
+// threads.policyFailures，线程照常运行
+namespace scheduling {
+
+    enum class Role {
+        Decode,      // 解复用和解码（同一个线程）
+        Render,      // 推送模式的渲染线程
+        Analysis,    // 场景检测等旁路分析
+        Background,  // 片段导出、媒体库探测
+        Count
+    };
+
+    struct Policy {
+        int nice = 0;               // SCHED_OTHER 的 nice 值，-20 ~ 19，越小越优先
+        int realtimePriority = 0;   // 大于 0 时使用 SCHED_FIFO 的这个优先级（1 ~ 99），失败时退回 nice
+        uint64_t cpuMask = 0;       // 允许运行的核心，第 i 位对应 cpu i；0 表示不限制
+    };
+
+    enum class Preset {
+        Default,      // 恢复默认：nice 0、不限制核心，交给系统调度
+        Performance,  // 解码和渲染放在大核并提高优先级，分析不限制核心
+        Efficiency,   // 所有线程放在小核，分析和后台任务降低优先级
+        Balanced,     // 只有对延迟敏感的渲染放在大核，解码不限制，分析和后台任务放在小核
+    };
+
+    // 角色的名字，如 "decode"，也用作系统线程名的后缀
+    const char *roleName(Role role);
+
+    const char *presetName(Preset preset);
+
+    // 按名字解析预设（default / performance / efficiency / balanced），不认识时返回 false
+    bool parsePreset(const char *name, Preset *preset);
+
+    void setPolicy(Role role, const Policy &policy);
+
+    Policy policy(Role role);
+
+    // 按预设设置所有角色
+    void applyPreset(Preset preset);
+
+    uint64_t bigCoreMask();
+
+    uint64_t littleCoreMask();
+
+    // 各角色的配置和登记的线程数，如 "decode: nice -4, cpus 0xf0, 1 thread"，用于日志和工具输出
+    std::string describe();
+
+    // 在线程函数开头声明：命名当前线程、应用角色的配置，析构时取消登记
+    class ScopedThread {
+    public:
+        explicit ScopedThread(Role role);
+
+        ~ScopedThread();
+
+        ScopedThread(const ScopedThread &) = delete;
+
+        ScopedThread &operator=(const ScopedThread &) = delete;
+
+    private:
+        Role role_;
+        int tid_;
+    };
+
+}  // namespace scheduling
+
+#endif // VIDEO_PLAYER_THREAD_SCHEDULING_H
@@ -0,0 +1,68 @@
+#ifndef VIDEO_PLAYER_TRACE_H
+#define VIDEO_PLAYER_TRACE_H
+
+#include <cstdint>
+
+// 管线事件追踪：记录 begin/end 与计数器事件到每线程无锁环形缓冲区，
+// 可导出为 Chrome trace JSON（chrome://tracing 或 Perfetto UI 直接打开）。
+// 由 VP_ENABLE_TRACE 控制，关闭时所有 TRACE_* 宏展开为空，不产生任何开销。
+#ifndef VP_ENABLE_TRACE
+#define VP_ENABLE_TRACE 0
+#endif
+
+namespace trace {
+
+    enum class EventType : uint8_t {
+        Begin,
+        End,
+        Counter,
+    };
+
+    // 事件名必须是静态生命周期的字符串（字面量），缓冲区只保存指针
+    void begin(const char *name);
+    void end(const char *name);
+    void counter(const char *name, int64_t value);
+
+    // 设置当前线程在 trace 中显示的名字
+    void setThreadName(const char *name);
+
+    // 是否同时转发到 Android ATrace（systrace / Perfetto 系统追踪）
+    void setAtraceEnabled(bool enabled);
+
+    // 将所有线程缓冲区中的事件导出为 Chrome trace JSON，成功返回 true
+    bool dumpChromeJson(const char *path);
+
+    // 清空所有线程缓冲区
+    void reset();
+
+    class ScopedSection {
+    public:
+        explicit ScopedSection(const char *name) : name_(name) { begin(name_); }
+        ~ScopedSection() { end(name_); }
+        ScopedSection(const ScopedSection &) = delete;
+        ScopedSection &operator=(const ScopedSection &) = delete;
+
+    private:
+        const char *name_;
+    };
+
+}  // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if VP_ENABLE_TRACE
+#define TRACE_BEGIN(name) trace::begin(name)
+#define TRACE_END(name) trace::end(name)
+#define TRACE_COUNTER(name, value) trace::counter(name, static_cast<int64_t>(value))
+#define TRACE_SCOPE(name) trace::ScopedSection TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) trace::setThreadName(name)
+#else
+#define TRACE_BEGIN(name) ((void) 0)
+#define TRACE_END(name) ((void) 0)
+#define TRACE_COUNTER(name, value) ((void) 0)
+#define TRACE_SCOPE(name) ((void) 0)
+#define TRACE_THREAD_NAME(name) ((void) 0)
+#endif
+
+#endif // VIDEO_PLAYER_TRACE_H
@@ -0,0 +1,127 @@
+#ifndef VIDEO_PLAYER_VIDEO_SINK_H
+#define VIDEO_PLAYER_VIDEO_SINK_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ffmpeg_headers.h"
+
+// 视频输出端：渲染线程按显示时间把帧交给 sink，由 sink 决定如何呈现。
+// 所有回调都在渲染线程上调用。
+class VideoSink {
+public:
+    virtual ~VideoSink() = default;
+
+    virtual const char *name() const = 0;
+
+    // 渲染线程开始/结束时调用，用于 attach JVM 等与线程绑定的初始化
+    virtual bool onThreadStart() { return true; }
+
+    virtual void onThreadStop() {}
+
+    // 呈现一帧；frame 在返回后仍归调用者所有，sink 需要保留数据时必须自行复制
+    virtual void onFrame(const AVFrame *frame) = 0;
+
+    // 开启静态帧检测时，与上一次输出内容相同的帧改为调用这里。能保持当前画面的输出端（Surface、
+    // Java 回调）覆盖它跳过复制；默认仍按新帧输出，需要每帧数据的输出端（校验、内存）不受影响
+    virtual void onFrameUnchanged(const AVFrame *frame) { onFrame(frame); }
+
+    uint64_t framesRendered() const { return framesRendered_; }
+
+    uint64_t bytesRendered() const { return bytesRendered_; }
+
+protected:
+    uint64_t framesRendered_ = 0;
+    uint64_t bytesRendered_ = 0;
+};
+
+// 返回按 1 字节对齐紧密排列后整帧的大小，格式不支持时返回负数
+int packedFrameSize(const AVFrame *frame);
+
+// 每次把整帧像素复制或转换到新缓冲区时调用（输出端复制、缩放、裁剪复制），累计到
+// pipeline.frameCopies；除以输出帧数即每帧复制次数，回归检查用它发现多出来的复制
+void countFrameCopy();
+
+// 丢弃所有帧，只计数；用于测量不含输出开销的管线吞吐
+class NullSink : public VideoSink {
+public:
+    const char *name() const override { return "null"; }
+
+    void onFrame(const AVFrame *frame) override;
+};
+
+// 把每帧复制成紧密排列的缓冲区保存在内存中，最多保留 maxFrames 帧（超出后只计数）。
+// 用于在没有显示设备的主机上测量包含复制开销的吞吐，或检查输出内容。
+class MemorySink : public VideoSink {
+public:
+    explicit MemorySink(size_t maxFrames = 0) : maxFrames_(maxFrames) {}
+
+    const char *name() const override { return "memory"; }
+
+    void onFrame(const AVFrame *frame) override;
+
+    // 取走已经保存的帧
+    std::vector<std::vector<uint8_t>> takeFrames();
+
+private:
+    size_t maxFrames_;
+    std::vector<uint8_t> scratch_;
+    std::mutex framesMutex_;
+    std::vector<std::vector<uint8_t>> frames_;
+};
+
+// 计算交给输出端的每帧字节的 MD5：按 av_image_copy_to_buffer（1 字节对齐）紧密排列，
+// 与 JNI 回调和 MemorySink 复制出的数据完全一致，再逐平面计算。用于主机上的黄金帧回归检查
+class ChecksumSink : public VideoSink {
+public:
+    struct FrameChecksum {
+        int64_t pts = AV_NOPTS_VALUE;
+        int width = 0;
+        int height = 0;
+        int format = -1;
+        std::vector<std::string> planes;  // 每个平面的 MD5（32 位十六进制）
+    };
+
+    const char *name() const override { return "checksum"; }
+
+    void onFrame(const AVFrame *frame) override;
+
+    // 取走已经计算的校验和，按输出顺序排列
+    std::vector<FrameChecksum> takeChecksums();
+
+private:
+    std::vector<uint8_t> buffer_;
+    std::mutex checksumsMutex_;
+    std::vector<FrameChecksum> checksums_;
+};
+
+#ifdef __ANDROID__
+struct ANativeWindow;
+
+// 直接锁定 ANativeWindow 缓冲区并转换为 RGBA 写入，不经过 Java 层
+class NativeWindowSink : public VideoSink {
+public:
+    // 持有 window 的一个引用，析构时释放
+    explicit NativeWindowSink(ANativeWindow *window);
+
+    ~NativeWindowSink() override;
+
+    const char *name() const override { return "native_window"; }
+
+    void onFrame(const AVFrame *frame) override;
+
+    // 窗口在没有新缓冲时一直显示上一次提交的缓冲
+    void onFrameUnchanged(const AVFrame * /*frame*/) override { framesRendered_++; }
+
+private:
+    ANativeWindow *window_;
+    SwsContext *swsContext_ = nullptr;
+    int configuredWidth_ = 0;
+    int configuredHeight_ = 0;
+};
+#endif
+
+#endif // VIDEO_PLAYER_VIDEO_SINK_H
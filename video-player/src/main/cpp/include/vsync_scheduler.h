@@ -0,0 +1,81 @@
+#ifndef VIDEO_PLAYER_VSYNC_SCHEDULER_H
+#define VIDEO_PLAYER_VSYNC_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// vsync 驱动的呈现调度：外部时钟源（Android 上是 Choreographer 的 frameTimeNanos，主机上是
+// SimulatedVsyncTicker）每个 vsync 调用一次 onVsync，渲染线程在 waitForVsync 上醒来，
+// 为预测的下一次 vsync 选出 PTS 最接近的帧。
+// 周期由相邻 tick 的间隔平滑估计：漏掉的 tick（间隔约为整数倍周期）不影响估计，
+// 连续几次明显不同的间隔视为刷新率切换，重新估计。
+// alignAnchor 在播放时钟建立时微调锚点，让帧的理想时间尽量远离两个 vsync 的中点：
+// 24fps 在 60Hz 上帧与 vsync 的相对位置只有两种，锚点落在 1/4 周期处时两种位置离判定边界都有
+// 1/4 周期的余量，tick 抖动不会让 3:2 节奏随机变成 2:3，避免不必要的抖动。
+// 时间都是 av_gettime_relative 的微秒；所有方法可以在任意线程调用
+class VsyncScheduler {
+public:
+    void onVsync(int64_t vsyncUs);
+
+    // 等待调用之后到来的下一个 vsync，返回它的时间；超时或 interrupt 时返回 -1
+    int64_t waitForVsync(int64_t timeoutUs);
+
+    // 唤醒所有 waitForVsync，用于停止、暂停时让渲染线程重新检查状态
+    void interrupt();
+
+    // 收到过足够的 tick，周期估计可用
+    bool hasEstimate() const;
+
+    int64_t periodUs() const;
+
+    // vsyncUs 之后第 n 个 vsync 的预测时间
+    int64_t predict(int64_t vsyncUs, int n) const;
+
+    // 把播放时钟锚点在 ±半个周期内平移，让之后帧的理想时间相对 vsync 网格的位置最稳定。
+    // 没有周期估计或帧间隔未知时原样返回
+    int64_t alignAnchor(int64_t anchorUs, int64_t frameIntervalUs) const;
+
+    // 时钟源停止（如界面进入后台）时调用，之后重新估计周期
+    void reset();
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    int64_t lastVsyncUs_ = -1;
+    double periodUs_ = 0;
+    int samples_ = 0;          // 参与估计的间隔数
+    int outliers_ = 0;         // 连续的、与当前估计不符的间隔数
+    uint64_t sequence_ = 0;    // 收到的 tick 数，waitForVsync 据此判断有没有新 tick
+    uint64_t interrupts_ = 0;
+};
+
+// 主机上的模拟 vsync 时钟源：独立线程按 hz 产生 tick，时间戳叠加确定性的 ±jitterUs 抖动
+// （与 Choreographer 一样报告 vsync 的时间而不是回调被调度的时间），用于在 Linux 上测试调度
+class SimulatedVsyncTicker {
+public:
+    SimulatedVsyncTicker(VsyncScheduler &scheduler, double hz, int64_t jitterUs = 0);
+
+    ~SimulatedVsyncTicker();
+
+    SimulatedVsyncTicker(const SimulatedVsyncTicker &) = delete;
+
+    SimulatedVsyncTicker &operator=(const SimulatedVsyncTicker &) = delete;
+
+    void start();
+
+    void stop();
+
+private:
+    void run();
+
+    VsyncScheduler &scheduler_;
+    int64_t periodUs_;
+    int64_t jitterUs_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+#endif // VIDEO_PLAYER_VSYNC_SCHEDULER_H
@@ -0,0 +1,329 @@
+#define LOG_TAG "Native-IoHooks"
+
+#include "io_hooks.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "log.h"
+#include "media_cache.h"
+#include "memory_budget.h"
+
+namespace {
+
+    const int WRAPPED_BUFFER_SIZE = 32768;
+
+    // HLS 的字节范围分片共用一个 URL，缓存 key 需要带上范围
+    std::string cacheKeyFor(const char *url, AVDictionary *options) {
+        std::string key = url;
+        const AVDictionaryEntry *offset = av_dict_get(options, "offset", nullptr, 0);
+        const AVDictionaryEntry *end = av_dict_get(options, "end_offset", nullptr, 0);
+        if (offset || end) {
+            key += std::string("#") + (offset ? offset->value : "0") + "-" + (end ? end->value : "");
+        }
+        return key;
+    }
+
+}  // namespace
+
+// 包装层的 opaque。avio 的 AVClass 会把 opaque 当作子对象查找选项（如 HLS 读取 cookies），
+// 所以第一个成员必须是（空的）AVClass 指针
+struct IoHooks::WrappedIo {
+    const AVClass *avClass = nullptr;
+    IoHooks *hooks = nullptr;
+    AVFormatContext *owner = nullptr;  // 用它的 io_open 连网
+    bool isInput = false;              // 主输入，关闭时 owner 已经释放
+    int flags = AVIO_FLAG_READ;
+    AVDictionary *options = nullptr;   // 延迟连网时使用的打开选项
+    AVIOContext *inner = nullptr;      // 网络连接，完全命中缓存时为空
+    Transfer transfer;
+
+    // 磁盘缓存
+    bool cached = false;
+    std::string cacheKey;
+    int64_t size = -1;
+    int64_t position = 0;       // 包装层的读取位置
+    int64_t innerPosition = 0;  // 网络连接的读取位置
+    int64_t fillBlock = -1;     // 正在边读边填充的缓存块
+    int64_t fillSize = 0;
+    memory::TrackedBuffer fill{memory::Category::IoBuffers};
+    MediaCache::BlockReader cacheReader;  // 当前读取的缓存块，块内的 32 KiB 读取不再重新打开文件
+};
+
+namespace {
+
+    int64_t blockLength(int64_t size, int64_t block) {
+        return std::min<int64_t>(MediaCache::BLOCK_SIZE, size - block * MediaCache::BLOCK_SIZE);
+    }
+
+}  // namespace
+
+IoHooks::~IoHooks() {
+    closeInput();
+}
+
+void IoHooks::install(AVFormatContext *context) {
+    defaultOpen_ = context->io_open;
+    defaultClose_ = context->io_close2;
+    context->opaque = this;
+    context->io_open = ioOpen;
+    context->io_close2 = ioClose;
+}
+
+int IoHooks::openInput(AVFormatContext *context, const char *url) {
+    auto *io = new WrappedIo();
+    io->hooks = this;
+    io->owner = context;
+    io->isInput = true;
+    io->transfer.url = url;
+    AVIOContext *wrapper = nullptr;
+    int ret = wrap(io, &wrapper);
+    if (ret < 0) {
+        delete io;
+        return ret;
+    }
+    inputIo_ = wrapper;
+    context->pb = wrapper;
+    context->flags |= AVFMT_FLAG_CUSTOM_IO;
+    return 0;
+}
+
+void IoHooks::closeInput() {
+    if (!inputIo_) {
+        return;
+    }
+    WrappedIo *io = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = wrapped_.find(inputIo_);
+        if (it != wrapped_.end()) {
+            io = it->second;
+            wrapped_.erase(it);
+        }
+    }
+    if (io) {
+        release(inputIo_, io);
+    }
+    inputIo_ = nullptr;
+}
+
+int IoHooks::wrap(WrappedIo *io, AVIOContext **wrapper) {
+    MediaCache &cache = MediaCache::instance();
+    const char *url = io->transfer.url.c_str();
+    if (cache.enabled() && MediaCache::isCacheable(url)) {
+        io->cacheKey = cacheKeyFor(url, io->options);
+        io->cached = cache.isComplete(io->cacheKey);
+    }
+
+    // 资源的所有块都在磁盘上时不连网；否则立即连网，让 404 等错误在打开时就返回
+    if (io->cached) {
+        io->size = cache.resourceSize(io->cacheKey);
+    } else {
+        AVDictionary *options = nullptr;
+        av_dict_copy(&options, io->options, 0);
+        int ret = defaultOpen_(io->owner, &io->inner, url, io->flags, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            io->inner = nullptr;
+            return ret;
+        }
+        // 长度未知（分块传输）的资源不缓存；长度与记录不同说明资源已更新，旧块会被丢弃
+        if (!io->cacheKey.empty()) {
+            io->size = avio_size(io->inner);
+            io->cached = io->size > 0;
+            if (io->cached) {
+                cache.setResourceSize(io->cacheKey, io->size);
+            }
+        }
+    }
+
+    auto *buffer = static_cast<uint8_t *>(av_malloc(WRAPPED_BUFFER_SIZE));
+    *wrapper = buffer ? avio_alloc_context(buffer, WRAPPED_BUFFER_SIZE, 0, io,
+                                           readPacket, nullptr, seek) : nullptr;
+    if (!*wrapper) {
+        av_free(buffer);
+        closeInner(io);
+        av_dict_free(&io->options);
+        return AVERROR(ENOMEM);
+    }
+    memory::allocated(memory::Category::IoBuffers, WRAPPED_BUFFER_SIZE);
+    (*wrapper)->seekable = io->inner ? io->inner->seekable : AVIO_SEEKABLE_NORMAL;
+    std::lock_guard<std::mutex> lock(mutex_);
+    wrapped_[*wrapper] = io;
+    return 0;
+}
+
+void IoHooks::release(AVIOContext *wrapper, WrappedIo *io) {
+    if (onClose_ && !io->isInput) {
+        onClose_(io->transfer);
+    }
+    av_freep(&wrapper->buffer);
+    avio_context_free(&wrapper);
+    memory::freed(memory::Category::IoBuffers, WRAPPED_BUFFER_SIZE);
+    closeInner(io);
+    av_dict_free(&io->options);
+    delete io;
+}
+
+void IoHooks::closeInner(WrappedIo *io) {
+    if (!io->inner) {
+        return;
+    }
+    if (io->isInput) {
+        avio_closep(&io->inner);
+    } else {
+        defaultClose_(io->owner, io->inner);
+        io->inner = nullptr;
+    }
+}
+
+int IoHooks::ioOpen(AVFormatContext *s, AVIOContext **pb, const char *url, int flags,
+                    AVDictionary **options) {
+    auto *hooks = static_cast<IoHooks *>(s->opaque);
+    // s->pb 为空说明是主输入；写入的资源也不包装
+    if (!s->pb || (flags & AVIO_FLAG_WRITE)) {
+        return hooks->defaultOpen_(s, pb, url, flags, options);
+    }
+
+    auto *io = new WrappedIo();
+    io->hooks = hooks;
+    io->owner = s;
+    io->flags = flags;
+    io->transfer.url = url;
+    if (options) {
+        av_dict_copy(&io->options, *options, 0);
+    }
+    AVIOContext *wrapper = nullptr;
+    int ret = hooks->wrap(io, &wrapper);
+    if (ret < 0) {
+        av_dict_free(&io->options);
+        delete io;
+        return ret;
+    }
+    *pb = wrapper;
+
+    if (hooks->onOpen_) {
+        hooks->onOpen_(url);
+    }
+    return 0;
+}
+
+int IoHooks::ioClose(AVFormatContext *s, AVIOContext *pb) {
+    auto *hooks = static_cast<IoHooks *>(s->opaque);
+    WrappedIo *io = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(hooks->mutex_);
+        auto it = hooks->wrapped_.find(pb);
+        if (it != hooks->wrapped_.end()) {
+            io = it->second;
+            hooks->wrapped_.erase(it);
+        }
+    }
+    if (!io) {
+        return hooks->defaultClose_(s, pb);
+    }
+    hooks->release(pb, io);
+    return 0;
+}
+
+int IoHooks::readPacket(void *opaque, uint8_t *buf, int size) {
+    auto *io = static_cast<WrappedIo *>(opaque);
+    MediaCache &cache = MediaCache::instance();
+    const int64_t blockSize = MediaCache::BLOCK_SIZE;
+    if (io->size >= 0 && io->position >= io->size) {
+        return AVERROR_EOF;
+    }
+
+    int64_t block = io->position / blockSize;
+    int64_t offset = io->position % blockSize;
+    if (io->cached) {
+        int n = cache.readBlock(io->cacheKey, block, offset, buf, size, io->cacheReader);
+        if (n > 0) {
+            io->position += n;
+            cache.recordRead(n, 0);
+            return n;
+        }
+        // 只读到当前块的末尾，下一块可能又在缓存里
+        size = static_cast<int>(std::min<int64_t>(size, blockLength(io->size, block) - offset));
+    }
+
+    // 缓存未命中（或块被淘汰了）：需要时才连网，连接位置不对时 seek 过去
+    if (!io->inner) {
+        AVDictionary *options = nullptr;
+        av_dict_copy(&options, io->options, 0);
+        int ret = io->hooks->defaultOpen_(io->owner, &io->inner, io->transfer.url.c_str(),
+                                          io->flags, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            io->inner = nullptr;
+            return ret;
+        }
+        io->innerPosition = 0;
+        if (avio_size(io->inner) != io->size) {
+            // 资源在两次播放之间变了，之后只走网络
+            cache.setResourceSize(io->cacheKey, avio_size(io->inner));
+            io->cached = false;
+            io->size = avio_size(io->inner);
+        }
+    }
+    if (io->innerPosition != io->position) {
+        int64_t ret = avio_seek(io->inner, io->position, SEEK_SET);
+        if (ret < 0) {
+            return static_cast<int>(ret);
+        }
+        io->innerPosition = io->position;
+    }
+
+    int64_t begin = av_gettime_relative();
+    int n = avio_read_partial(io->inner, buf, size);
+    io->transfer.readMicros += av_gettime_relative() - begin;
+    if (n <= 0) {
+        return n == 0 ? AVERROR_EOF : n;
+    }
+    io->transfer.bytes += n;
+
+    // 写穿：从块的开头连续读到结尾才写入磁盘，中途 seek 走的块不写
+    if (io->cached) {
+        cache.recordRead(0, n);
+        if (io->fillBlock != block) {
+            io->fillSize = 0;
+            io->fillBlock = (offset == 0 && !cache.hasBlock(io->cacheKey, block)) ? block : -1;
+        }
+        if (io->fillBlock == block && io->fillSize == offset) {
+            memcpy(io->fill.reserve(MediaCache::BLOCK_SIZE) + io->fillSize, buf, n);
+            io->fillSize += n;
+            if (io->fillSize == blockLength(io->size, block)) {
+                cache.writeBlock(io->cacheKey, block, io->fill.data(), io->fillSize);
+                io->fillSize = 0;
+                io->fillBlock = -1;
+            }
+        }
+    }
+    io->position += n;
+    io->innerPosition += n;
+    return n;
+}
+
+int64_t IoHooks::seek(void *opaque, int64_t offset, int whence) {
+    auto *io = static_cast<WrappedIo *>(opaque);
+    if (whence == AVSEEK_SIZE) {
+        return io->size >= 0 ? io->size : io->inner ? avio_size(io->inner) : AVERROR(ENOSYS);
+    }
+    whence &= ~AVSEEK_FORCE;
+    if (!io->cached) {
+        int64_t ret = avio_seek(io->inner, offset, whence);
+        if (ret >= 0) {
+            io->position = io->innerPosition = ret;
+        }
+        return ret;
+    }
+    int64_t target = whence == SEEK_SET ? offset
+                     : whence == SEEK_CUR ? io->position + offset
+                     : whence == SEEK_END && io->size >= 0 ? io->size + offset : -1;
+    if (target < 0) {
+        return AVERROR(EINVAL);
+    }
+    // 只移动读取位置，真正需要网络数据时再 seek 连接
+    io->position = target;
+    return target;
+}
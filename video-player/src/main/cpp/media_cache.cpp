@@ -0,0 +1,377 @@
+#define LOG_TAG "Native-MediaCache"
+
+#include "media_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include <vector>
+
+#include "log.h"
+#include "metrics.h"
+
+namespace {
+
+    const char BLOCK_SUFFIX[] = ".blk";
+    const char META_SUFFIX[] = ".meta";
+
+    bool endsWith(const std::string &text, const char *suffix) {
+        size_t n = strlen(suffix);
+        return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+    }
+
+    // 块文件名为 <资源哈希>_<块序号>.blk
+    std::string hashOfBlockFile(const std::string &file) {
+        return file.substr(0, file.find('_'));
+    }
+
+}  // namespace
+
+MediaCache &MediaCache::instance() {
+    static MediaCache cache;
+    return cache;
+}
+
+void MediaCache::BlockReader::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    id_ = 0;
+}
+
+bool MediaCache::configure(const std::string &directory, int64_t capacityBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_.clear();
+    capacity_ = 0;
+    totalBytes_ = 0;
+    lru_.clear();
+    blocks_.clear();
+    sizes_.clear();
+    blockCounts_.clear();
+    if (directory.empty() || capacityBytes <= 0) {
+        LOGI("磁盘缓存已关闭");
+        return true;
+    }
+
+    if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        LOGE("无法创建缓存目录 %s: %s", directory.c_str(), strerror(errno));
+        return false;
+    }
+    directory_ = directory;
+    capacity_ = capacityBytes;
+    loadLocked();
+    std::vector<std::string> doomed;
+    evictLocked(doomed);
+    // 只在设置缓存时发生，直接在锁内删除
+    unlinkAll(doomed);
+    LOGI("磁盘缓存: %s, %lld / %lld 字节, %zu 块", directory_.c_str(),
+         static_cast<long long>(totalBytes_), static_cast<long long>(capacity_), blocks_.size());
+    return true;
+}
+
+bool MediaCache::enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !directory_.empty();
+}
+
+bool MediaCache::isCacheable(const char *url) {
+    bool network = strncmp(url, "http://", 7) == 0 || strncmp(url, "https://", 8) == 0;
+    if (!network) {
+        return false;
+    }
+    const char *end = strchr(url, '?');
+    std::string path(url, end ? static_cast<size_t>(end - url) : strlen(url));
+    return !endsWith(path, ".m3u8") && !endsWith(path, ".m3u") && !endsWith(path, ".mpd");
+}
+
+// FNV-1a 64 位，作为资源在磁盘上的文件名
+std::string MediaCache::hashKey(const std::string &key) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c: key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+std::string MediaCache::blockFile(const std::string &hash, int64_t block) const {
+    return hash + "_" + std::to_string(block) + BLOCK_SUFFIX;
+}
+
+std::string MediaCache::metaFile(const std::string &hash) const {
+    return directory_ + "/" + hash + META_SUFFIX;
+}
+
+// 扫描缓存目录，按文件修改时间恢复 LRU 顺序；未写完的临时文件直接删除
+void MediaCache::loadLocked() {
+    DIR *dir = opendir(directory_.c_str());
+    if (!dir) {
+        return;
+    }
+    struct Found {
+        std::string file;
+        int64_t size;
+        int64_t mtime;  // 纳秒，同一秒内写入的块也要能排序
+    };
+    std::vector<Found> found;
+    while (dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        std::string path = directory_ + "/" + name;
+        struct stat info{};
+        if (endsWith(name, ".tmp")) {
+            unlink(path.c_str());
+        } else if (endsWith(name, BLOCK_SUFFIX) && stat(path.c_str(), &info) == 0) {
+            found.push_back({name, static_cast<int64_t>(info.st_size),
+                             static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 +
+                             info.st_mtim.tv_nsec});
+        }
+    }
+    closedir(dir);
+
+    std::sort(found.begin(), found.end(), [](const Found &a, const Found &b) {
+        return a.mtime < b.mtime;
+    });
+    for (const auto &block: found) {
+        addLocked(block.file, block.size, false);
+    }
+}
+
+void MediaCache::addLocked(const std::string &file, int64_t size, bool persisted) {
+    static auto &sizeBytes = metrics::counter("cache.sizeBytes");
+    lru_.push_front(file);
+    blocks_[file] = {size, lru_.begin(), nextId_++, persisted};
+    blockCounts_[hashOfBlockFile(file)]++;
+    totalBytes_ += size;
+    sizeBytes.set(totalBytes_);
+}
+
+void MediaCache::removeLocked(const std::string &file, std::vector<std::string> &doomed) {
+    static auto &sizeBytes = metrics::counter("cache.sizeBytes");
+    auto it = blocks_.find(file);
+    if (it == blocks_.end()) {
+        return;
+    }
+    totalBytes_ -= it->second.size;
+    sizeBytes.set(totalBytes_);
+    lru_.erase(it->second.lruPosition);
+    blocks_.erase(it);
+    doomed.push_back(directory_ + "/" + file);
+
+    // 资源的最后一块被删掉时，长度记录也没有用了
+    std::string hash = hashOfBlockFile(file);
+    if (--blockCounts_[hash] <= 0) {
+        blockCounts_.erase(hash);
+        sizes_.erase(hash);
+        doomed.push_back(metaFile(hash));
+    }
+}
+
+void MediaCache::evictLocked(std::vector<std::string> &doomed) {
+    static auto &evictions = metrics::counter("cache.evictions");
+    while (totalBytes_ > capacity_ && !lru_.empty()) {
+        std::string oldest = lru_.back();  // removeLocked 会从 lru_ 中删除这个字符串
+        removeLocked(oldest, doomed);
+        evictions.add(1);
+    }
+}
+
+// 已经从索引中删除的文件；正在读它们的 BlockReader 仍然可以读完已打开的文件
+void MediaCache::unlinkAll(const std::vector<std::string> &paths) {
+    for (const auto &path: paths) {
+        unlink(path.c_str());
+    }
+}
+
+int64_t MediaCache::resourceSize(const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory_.empty()) {
+        return -1;
+    }
+    std::string hash = hashKey(key);
+    auto it = sizes_.find(hash);
+    if (it != sizes_.end()) {
+        return it->second;
+    }
+
+    // 元数据文件：第一行长度，第二行原始 key（用于排查）
+    int64_t size = -1;
+    if (FILE *file = fopen(metaFile(hash).c_str(), "r")) {
+        long long value = -1;
+        if (fscanf(file, "%lld", &value) == 1) {
+            size = value;
+        }
+        fclose(file);
+    }
+    if (size >= 0) {
+        sizes_[hash] = size;
+    }
+    return size;
+}
+
+void MediaCache::setResourceSize(const std::string &key, int64_t size) {
+    if (resourceSize(key) == size) {
+        return;
+    }
+    std::vector<std::string> doomed;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (directory_.empty()) {
+        return;
+    }
+    std::string hash = hashKey(key);
+    if (sizes_.count(hash)) {
+        // 资源已经变化（长度不同），旧块全部作废
+        LOGI("资源长度变化，丢弃缓存: %s", key.c_str());
+        std::vector<std::string> stale;
+        for (const auto &entry: blocks_) {
+            if (hashOfBlockFile(entry.first) == hash) {
+                stale.push_back(entry.first);
+            }
+        }
+        for (const auto &file: stale) {
+            removeLocked(file, doomed);
+        }
+    }
+    sizes_[hash] = size;
+    std::string meta = metaFile(hash);
+    lock.unlock();
+    unlinkAll(doomed);
+    if (FILE *file = fopen(meta.c_str(), "w")) {
+        fprintf(file, "%lld\n%s\n", static_cast<long long>(size), key.c_str());
+        fclose(file);
+    }
+}
+
+bool MediaCache::isComplete(const std::string &key) {
+    int64_t size = resourceSize(key);
+    if (size <= 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string hash = hashKey(key);
+    for (int64_t block = 0; block * BLOCK_SIZE < size; block++) {
+        if (!blocks_.count(blockFile(hash, block))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MediaCache::hasBlock(const std::string &key, int64_t block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blocks_.count(blockFile(hashKey(key), block)) > 0;
+}
+
+int MediaCache::readBlock(const std::string &key, int64_t block, int64_t offset, uint8_t *buf,
+                          int size, BlockReader &reader) {
+    std::string file = blockFile(hashKey(key), block);
+    std::string path;
+    int64_t blockSize;
+    uint64_t id;
+    bool persist;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(file);
+        if (it == blocks_.end() || offset >= it->second.size) {
+            reader.close();
+            return -1;
+        }
+        BlockEntry &entry = it->second;
+        lru_.splice(lru_.begin(), lru_, entry.lruPosition);
+        persist = !entry.persisted;
+        entry.persisted = true;
+        blockSize = entry.size;
+        id = entry.id;
+        path = directory_ + "/" + file;
+    }
+
+    if (reader.id_ != id) {
+        reader.close();
+        reader.fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (reader.fd_ < 0) {
+            // 文件被外部删掉了，当作未命中
+            std::vector<std::string> doomed;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = blocks_.find(file);
+                if (it != blocks_.end() && it->second.id == id) {
+                    removeLocked(file, doomed);
+                }
+            }
+            unlinkAll(doomed);
+            return -1;
+        }
+        reader.id_ = id;
+    }
+    // offset 是块内偏移，不超过 BLOCK_SIZE，32 位 off_t 也不会截断
+    size_t wanted = static_cast<size_t>(std::min<int64_t>(size, blockSize - offset));
+    ssize_t n = pread(reader.fd_, buf, wanted, static_cast<off_t>(offset));
+    if (n <= 0) {
+        reader.close();
+        return -1;
+    }
+    if (persist) {
+        // 修改时间即重启后的 LRU 顺序，每块每次运行只写一次
+        utime(path.c_str(), nullptr);
+    }
+    return static_cast<int>(n);
+}
+
+void MediaCache::writeBlock(const std::string &key, int64_t block, const uint8_t *data, int64_t size) {
+    std::string file = blockFile(hashKey(key), block);
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (directory_.empty() || size > capacity_ || blocks_.count(file)) {
+            return;
+        }
+        directory = directory_;
+    }
+
+    // 先写临时文件再改名，进程中途退出时不会留下不完整的块。写入时不持锁，
+    // 同一块被两个读取者同时写入时各用各的临时文件，内容相同，后改名的覆盖先改名的
+    std::string path = directory + "/" + file;
+    std::string temp = path + "." + std::to_string(tempSequence_++) + ".tmp";
+    FILE *stream = fopen(temp.c_str(), "wb");
+    if (!stream) {
+        return;
+    }
+    bool ok = fwrite(data, 1, static_cast<size_t>(size), stream) == static_cast<size_t>(size);
+    ok = fclose(stream) == 0 && ok;
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return;
+    }
+
+    std::vector<std::string> doomed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 写入期间缓存被重新设置时不登记；文件留在原目录，下次扫描那个目录时恢复
+        if (directory_ != directory || blocks_.count(file)) {
+            return;
+        }
+        addLocked(file, size, true);
+        evictLocked(doomed);
+    }
+    unlinkAll(doomed);
+}
+
+void MediaCache::recordRead(int64_t hitBytes, int64_t missBytes) {
+    static auto &bytesSaved = metrics::counter("cache.bytesSaved");
+    static auto &bytesMissed = metrics::counter("cache.bytesMissed");
+    static auto &hitRatio = metrics::counter("cache.hitRatioPercent");
+    bytesSaved.add(hitBytes);
+    bytesMissed.add(missBytes);
+    int64_t total = bytesSaved.get() + bytesMissed.get();
+    if (total > 0) {
+        hitRatio.set(bytesSaved.get() * 100 / total);
+    }
+}
@@ -0,0 +1,408 @@
+#define LOG_TAG "Native-MediaProber"
+
+#include "media_prober.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <thread>
+
+#include "ffmpeg_headers.h"
+#include "log.h"
+#include "metrics.h"
+#include "thread_scheduling.h"
+#include "trace.h"
+
+namespace {
+
+    // 持久化文件：魔数、版本、条目数，之后每个条目依次为
+    //   路径（u16 长度 + 字节）、size、mtime、durationUs、bitRate（i64）、
+    //   width、height、rotation（i32）、frameRate * 1000（i32）、valid（u8）、
+    //   视频编码名、音频编码名（u8 长度 + 字节）
+    // 整数按小端写入。版本不同或内容损坏时丢弃整个文件，重新探测
+    const uint32_t CACHE_MAGIC = 0x4350504d;  // "MPPC"
+    const uint32_t CACHE_VERSION = 1;
+
+    // 容器头里缺少流参数时 avformat_find_stream_info 最多读这么多数据，不解码就够拿到尺寸和编码
+    const char PROBE_SIZE[] = "262144";
+    const int64_t ANALYZE_DURATION_US = 500000;
+    const int MAX_THREADS = 8;
+
+    class Writer {
+    public:
+        void u8(uint8_t value) { data_.push_back(static_cast<char>(value)); }
+
+        void u16(uint16_t value) { bytes(value, 2); }
+
+        void u32(uint32_t value) { bytes(value, 4); }
+
+        void i64(int64_t value) { bytes(static_cast<uint64_t>(value), 8); }
+
+        void string16(const std::string &text) {
+            size_t size = std::min<size_t>(text.size(), UINT16_MAX);
+            u16(static_cast<uint16_t>(size));
+            data_.append(text, 0, size);
+        }
+
+        void string8(const std::string &text) {
+            size_t size = std::min<size_t>(text.size(), UINT8_MAX);
+            u8(static_cast<uint8_t>(size));
+            data_.append(text, 0, size);
+        }
+
+        const std::string &data() const { return data_; }
+
+    private:
+        void bytes(uint64_t value, int count) {
+            for (int i = 0; i < count; i++) {
+                data_.push_back(static_cast<char>(value >> (8 * i)));
+            }
+        }
+
+        std::string data_;
+    };
+
+    // 读取越界后 ok() 为 false，之后的读取都返回 0
+    class Reader {
+    public:
+        Reader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+        bool ok() const { return ok_; }
+
+        uint8_t u8() { return static_cast<uint8_t>(bytes(1)); }
+
+        uint16_t u16() { return static_cast<uint16_t>(bytes(2)); }
+
+        uint32_t u32() { return static_cast<uint32_t>(bytes(4)); }
+
+        int64_t i64() { return static_cast<int64_t>(bytes(8)); }
+
+        std::string string(size_t size) {
+            if (!require(size)) {
+                return {};
+            }
+            std::string text(reinterpret_cast<const char *>(data_ + pos_), size);
+            pos_ += size;
+            return text;
+        }
+
+    private:
+        bool require(size_t count) {
+            ok_ = ok_ && pos_ + count <= size_;
+            return ok_;
+        }
+
+        uint64_t bytes(int count) {
+            if (!require(static_cast<size_t>(count))) {
+                return 0;
+            }
+            uint64_t value = 0;
+            for (int i = 0; i < count; i++) {
+                value |= static_cast<uint64_t>(data_[pos_ + i]) << (8 * i);
+            }
+            pos_ += count;
+            return value;
+        }
+
+        const uint8_t *data_;
+        size_t size_;
+        size_t pos_ = 0;
+        bool ok_ = true;
+    };
+
+    // 没有调用者给出的校验值时用 stat 取得；不是本地文件（content://、网络地址）时返回 false，不缓存
+    bool fingerprint(ProbeRequest &request) {
+        if (request.size >= 0 && request.mtime >= 0) {
+            return true;
+        }
+        struct stat st = {};
+        if (stat(request.path.c_str(), &st) != 0) {
+            return false;
+        }
+        request.size = st.st_size;
+        request.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        return true;
+    }
+
+    // 容器头里的参数已经足够：每个音视频流都知道编码，视频流还知道尺寸
+    bool headerComplete(const AVFormatContext *context) {
+        for (unsigned i = 0; i < context->nb_streams; i++) {
+            const AVCodecParameters *par = context->streams[i]->codecpar;
+            if (par->codec_type != AVMEDIA_TYPE_VIDEO && par->codec_type != AVMEDIA_TYPE_AUDIO) {
+                continue;
+            }
+            if (par->codec_id == AV_CODEC_ID_NONE ||
+                (par->codec_type == AVMEDIA_TYPE_VIDEO && (par->width <= 0 || par->height <= 0))) {
+                return false;
+            }
+        }
+        return context->nb_streams > 0;
+    }
+
+    int rotationOf(const AVStream *stream) {
+        const AVPacketSideData *side = av_packet_side_data_get(stream->codecpar->coded_side_data,
+                                                               stream->codecpar->nb_coded_side_data,
+                                                               AV_PKT_DATA_DISPLAYMATRIX);
+        if (!side || side->size < 9 * static_cast<int>(sizeof(int32_t))) {
+            return 0;
+        }
+        // av_display_rotation_get 返回逆时针角度
+        double degrees = -av_display_rotation_get(reinterpret_cast<const int32_t *>(side->data));
+        int rotation = static_cast<int>(std::lround(degrees / 90)) * 90 % 360;
+        return rotation < 0 ? rotation + 360 : rotation;
+    }
+
+}  // namespace
+
+MediaProber &MediaProber::instance() {
+    static MediaProber prober;
+    return prober;
+}
+
+bool MediaProber::setCacheFile(const std::string &file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file == file_) {
+        return true;
+    }
+    file_ = file;
+    entries_.clear();
+    dirty_ = false;
+    if (file_.empty()) {
+        return true;
+    }
+    return loadLocked();
+}
+
+bool MediaProber::loadLocked() {
+    FILE *file = fopen(file_.c_str(), "rb");
+    if (!file) {
+        return true;  // 第一次使用
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[64 * 1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    fclose(file);
+
+    Reader reader(data.data(), data.size());
+    if (reader.u32() != CACHE_MAGIC || reader.u32() != CACHE_VERSION) {
+        LOGW("元数据缓存格式不符，重新探测: %s", file_.c_str());
+        return true;
+    }
+    uint32_t count = reader.u32();
+    std::unordered_map<std::string, Entry> entries;
+    entries.reserve(std::min<size_t>(count, data.size() / 32));  // 条目数损坏时不按它预留
+    for (uint32_t i = 0; i < count && reader.ok(); i++) {
+        std::string path = reader.string(reader.u16());
+        Entry entry = {};
+        entry.size = reader.i64();
+        entry.mtime = reader.i64();
+        entry.info.durationUs = reader.i64();
+        entry.info.bitRate = reader.i64();
+        entry.info.width = static_cast<int32_t>(reader.u32());
+        entry.info.height = static_cast<int32_t>(reader.u32());
+        entry.info.rotation = static_cast<int32_t>(reader.u32());
+        entry.info.frameRate = static_cast<int32_t>(reader.u32()) / 1000.0;
+        entry.info.valid = reader.u8() != 0;
+        entry.info.videoCodec = reader.string(reader.u8());
+        entry.info.audioCodec = reader.string(reader.u8());
+        entries.emplace(std::move(path), std::move(entry));
+    }
+    if (!reader.ok()) {
+        LOGW("元数据缓存已损坏，重新探测: %s", file_.c_str());
+        return true;
+    }
+    entries_ = std::move(entries);
+    LOGI("元数据缓存: %s, %zu 个文件", file_.c_str(), entries_.size());
+    return true;
+}
+
+bool MediaProber::saveLocked() {
+    Writer writer;
+    writer.u32(CACHE_MAGIC);
+    writer.u32(CACHE_VERSION);
+    writer.u32(static_cast<uint32_t>(entries_.size()));
+    for (const auto &item: entries_) {
+        const Entry &entry = item.second;
+        writer.string16(item.first);
+        writer.i64(entry.size);
+        writer.i64(entry.mtime);
+        writer.i64(entry.info.durationUs);
+        writer.i64(entry.info.bitRate);
+        writer.u32(static_cast<uint32_t>(entry.info.width));
+        writer.u32(static_cast<uint32_t>(entry.info.height));
+        writer.u32(static_cast<uint32_t>(entry.info.rotation));
+        writer.u32(static_cast<uint32_t>(std::lround(entry.info.frameRate * 1000)));
+        writer.u8(entry.info.valid ? 1 : 0);
+        writer.string8(entry.info.videoCodec);
+        writer.string8(entry.info.audioCodec);
+    }
+
+    std::string temp = file_ + ".tmp";
+    FILE *file = fopen(temp.c_str(), "wb");
+    if (!file) {
+        LOGE("无法写入元数据缓存 %s: %s", temp.c_str(), strerror(errno));
+        return false;
+    }
+    const std::string &data = writer.data();
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temp.c_str(), file_.c_str()) != 0) {
+        LOGE("无法写入元数据缓存 %s", file_.c_str());
+        remove(temp.c_str());
+        return false;
+    }
+    dirty_ = false;
+    return true;
+}
+
+bool MediaProber::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_ || file_.empty()) {
+        return true;
+    }
+    return saveLocked();
+}
+
+std::vector<MediaInfo> MediaProber::probe(const std::vector<ProbeRequest> &requests, int threads) {
+    static auto &hits = metrics::counter("probe.cacheHits");
+    static auto &misses = metrics::counter("probe.cacheMisses");
+    static auto &probeMicros = metrics::counter("probe.probeMicros");
+    TRACE_SCOPE("probe.batch");
+
+    std::vector<MediaInfo> results(requests.size());
+    std::vector<ProbeRequest> keys(requests);
+    std::vector<bool> cacheable(requests.size());
+    std::vector<size_t> pending;  // 需要打开文件的下标
+    for (size_t i = 0; i < keys.size(); i++) {
+        cacheable[i] = fingerprint(keys[i]);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < keys.size(); i++) {
+            auto it = cacheable[i] ? entries_.find(keys[i].path) : entries_.end();
+            if (it != entries_.end() && it->second.size == keys[i].size && it->second.mtime == keys[i].mtime) {
+                results[i] = it->second.info;
+            } else {
+                pending.push_back(i);
+            }
+        }
+    }
+    hits.add(static_cast<int64_t>(keys.size() - pending.size()));
+    misses.add(static_cast<int64_t>(pending.size()));
+    if (pending.empty()) {
+        return results;
+    }
+
+    // 每个线程从共享的下标取下一个文件，慢的文件（网络存储、损坏的文件）不会拖住其余线程
+    if (threads <= 0) {
+        threads = std::min(MAX_THREADS, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+    }
+    threads = std::min<int>(threads, static_cast<int>(pending.size()));
+    int64_t startedAt = av_gettime_relative();
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        TRACE_THREAD_NAME("probe");
+        size_t n;
+        while ((n = next.fetch_add(1)) < pending.size()) {
+            size_t index = pending[n];
+            results[index] = probeFile(requests[index].path.c_str());
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        // 调用线程自己也参与探测，只有新开的线程按后台任务调度
+        pool.emplace_back([&worker]() {
+            scheduling::ScopedThread scheduled(scheduling::Role::Background);
+            worker();
+        });
+    }
+    worker();
+    for (auto &thread: pool) {
+        thread.join();
+    }
+    int64_t elapsed = av_gettime_relative() - startedAt;
+    probeMicros.add(elapsed);
+    LOGI("探测 %zu 个文件（%zu 个命中缓存），%d 个线程，%lldms", requests.size(),
+         requests.size() - pending.size(), threads, static_cast<long long>(elapsed / 1000));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t index: pending) {
+        if (cacheable[index]) {
+            entries_[keys[index].path] = {keys[index].size, keys[index].mtime, results[index]};
+            dirty_ = true;
+        }
+    }
+    if (dirty_ && !file_.empty()) {
+        saveLocked();
+    }
+    return results;
+}
+
+MediaInfo MediaProber::probeFile(const char *path) {
+    static auto &failures = metrics::counter("probe.failures");
+    static auto &streamInfoReads = metrics::counter("probe.streamInfoReads");
+    MediaInfo info;
+    AVFormatContext *context = nullptr;
+    AVDictionary *options = nullptr;
+    av_dict_set(&options, "probesize", PROBE_SIZE, 0);
+    int ret = avformat_open_input(&context, path, nullptr, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        failures.add(1);
+        return info;
+    }
+
+    // MP4、MKV 等的参数都在容器头里，直接读取；只有 TS 这类没有头的才读几个包
+    if (!headerComplete(context)) {
+        streamInfoReads.add(1);
+        context->max_analyze_duration = ANALYZE_DURATION_US;
+        context->fps_probe_size = 0;
+        avformat_find_stream_info(context, nullptr);
+    }
+
+    int videoIndex = av_find_best_stream(context, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    int audioIndex = av_find_best_stream(context, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (videoIndex >= 0) {
+        const AVStream *stream = context->streams[videoIndex];
+        info.width = stream->codecpar->width;
+        info.height = stream->codecpar->height;
+        info.rotation = rotationOf(stream);
+        info.videoCodec = avcodec_get_name(stream->codecpar->codec_id);
+        AVRational rate = stream->avg_frame_rate.num > 0 ? stream->avg_frame_rate : stream->r_frame_rate;
+        info.frameRate = rate.num > 0 && rate.den > 0 ? av_q2d(rate) : 0;
+    }
+    if (audioIndex >= 0) {
+        info.audioCodec = avcodec_get_name(context->streams[audioIndex]->codecpar->codec_id);
+    }
+
+    // 没有调用 avformat_find_stream_info 时容器的总时长和码率还没有计算，从各个流推出
+    int64_t streamDuration = -1;
+    int64_t bitRate = 0;
+    for (unsigned i = 0; i < context->nb_streams; i++) {
+        const AVStream *stream = context->streams[i];
+        if (stream->duration != AV_NOPTS_VALUE && stream->duration > 0) {
+            streamDuration = std::max(streamDuration,
+                                      av_rescale_q(stream->duration, stream->time_base, AV_TIME_BASE_Q));
+        }
+        bitRate += stream->codecpar->bit_rate;
+    }
+    info.durationUs = context->duration != AV_NOPTS_VALUE ? context->duration : streamDuration;
+    info.bitRate = context->bit_rate > 0 ? context->bit_rate : bitRate;
+    if (info.bitRate <= 0 && info.durationUs > 0 && context->pb) {
+        int64_t size = avio_size(context->pb);
+        info.bitRate = size > 0 ? av_rescale(size * 8, AV_TIME_BASE, info.durationUs) : 0;
+    }
+    info.valid = videoIndex >= 0 || audioIndex >= 0;
+    if (!info.valid) {
+        failures.add(1);
+    }
+    avformat_close_input(&context);
+    return info;
+}
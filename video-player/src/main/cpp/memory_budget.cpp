@@ -0,0 +1,157 @@
+#define LOG_TAG "Native-Memory"
+
+#include "memory_budget.h"
+
+#include <atomic>
+
+#include "log.h"
+#include "metrics.h"
+
+namespace memory {
+    namespace {
+
+        const int CATEGORY_COUNT = static_cast<int>(Category::Count);
+
+        struct CategoryState {
+            std::atomic<int64_t> current{0};
+            std::atomic<int64_t> peak{0};
+            metrics::Counter *currentMetric = nullptr;
+            metrics::Counter *peakMetric = nullptr;
+        };
+
+        const char *const CATEGORY_NAMES[CATEGORY_COUNT] = {
+                "decodedFrames", "packets", "renderBuffers", "ioBuffers",
+        };
+
+        std::atomic<int64_t> g_total(0);
+        std::atomic<int64_t> g_totalPeak(0);
+        std::atomic<int64_t> g_budget(0);
+
+        // 指标引用在首次使用时注册，之后热路径上只做原子操作
+        CategoryState *states() {
+            static CategoryState *table = []() {
+                auto *result = new CategoryState[CATEGORY_COUNT];
+                for (int i = 0; i < CATEGORY_COUNT; i++) {
+                    std::string prefix = std::string("memory.") + CATEGORY_NAMES[i];
+                    result[i].currentMetric = &metrics::counter((prefix + ".currentBytes").c_str());
+                    result[i].peakMetric = &metrics::counter((prefix + ".peakBytes").c_str());
+                }
+                return result;
+            }();
+            return table;
+        }
+
+        void raisePeak(std::atomic<int64_t> &peak, int64_t value) {
+            int64_t previous = peak.load(std::memory_order_relaxed);
+            while (value > previous &&
+                   !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        void update(Category category, int64_t delta) {
+            static auto &totalCurrent = metrics::counter("memory.total.currentBytes");
+            static auto &totalPeak = metrics::counter("memory.total.peakBytes");
+            CategoryState &state = states()[static_cast<int>(category)];
+
+            int64_t value = state.current.fetch_add(delta, std::memory_order_relaxed) + delta;
+            raisePeak(state.peak, value);
+            state.currentMetric->set(value);
+            state.peakMetric->set(state.peak.load(std::memory_order_relaxed));
+
+            int64_t total = g_total.fetch_add(delta, std::memory_order_relaxed) + delta;
+            raisePeak(g_totalPeak, total);
+            totalCurrent.set(total);
+            totalPeak.set(g_totalPeak.load(std::memory_order_relaxed));
+        }
+
+        // 包装引用的释放回调：opaque 是默认分配器返回的原始引用
+        void releaseTracked(void *opaque, uint8_t *) {
+            auto *original = static_cast<AVBufferRef *>(opaque);
+            freed(Category::DecodedFrames, static_cast<int64_t>(original->size));
+            av_buffer_unref(&original);
+        }
+
+        AVBufferRef *track(AVBufferRef *original) {
+            AVBufferRef *tracked = av_buffer_create(original->data, original->size, releaseTracked,
+                                                    original, 0);
+            if (!tracked) {
+                // 包装失败时保留原始引用，只是这块不记账
+                return original;
+            }
+            allocated(Category::DecodedFrames, static_cast<int64_t>(original->size));
+            return tracked;
+        }
+
+    }  // namespace
+
+    void allocated(Category category, int64_t bytes) {
+        update(category, bytes);
+    }
+
+    void freed(Category category, int64_t bytes) {
+        update(category, -bytes);
+    }
+
+    int64_t current(Category category) {
+        return states()[static_cast<int>(category)].current.load(std::memory_order_relaxed);
+    }
+
+    int64_t total() {
+        return g_total.load(std::memory_order_relaxed);
+    }
+
+    void setBudget(int64_t bytes) {
+        static auto &budgetBytes = metrics::counter("memory.budgetBytes");
+        g_budget = bytes > 0 ? bytes : 0;
+        budgetBytes.set(g_budget);
+        LOGI("内存预算: %lld 字节", static_cast<long long>(g_budget.load()));
+    }
+
+    int64_t budget() {
+        return g_budget.load(std::memory_order_relaxed);
+    }
+
+    bool fits(int64_t bytes) {
+        int64_t limit = budget();
+        return limit == 0 || total() + bytes <= limit;
+    }
+
+    int trackedGetBuffer2(AVCodecContext *context, AVFrame *frame, int flags) {
+        int ret = avcodec_default_get_buffer2(context, frame, flags);
+        if (ret < 0) {
+            return ret;
+        }
+        trackFrameBuffers(frame);
+        return 0;
+    }
+
+    void trackFrameBuffers(AVFrame *frame) {
+        for (auto &buffer: frame->buf) {
+            if (buffer) {
+                buffer = track(buffer);
+            }
+        }
+        for (int i = 0; i < frame->nb_extended_buf; i++) {
+            frame->extended_buf[i] = track(frame->extended_buf[i]);
+        }
+    }
+
+    uint8_t *TrackedBuffer::reserve(size_t size) {
+        if (size > capacity_) {
+            reset();
+            data_.reset(new uint8_t[size]);
+            capacity_ = size;
+            allocated(category_, static_cast<int64_t>(size));
+        }
+        return data_.get();
+    }
+
+    void TrackedBuffer::reset() {
+        if (data_) {
+            freed(category_, static_cast<int64_t>(capacity_));
+            data_.reset();
+            capacity_ = 0;
+        }
+    }
+
+}  // namespace memory
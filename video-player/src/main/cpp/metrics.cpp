@@ -0,0 +1,50 @@
+#include "metrics.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace metrics {
+    namespace {
+
+        std::mutex g_registryMutex;
+
+        std::map<std::string, std::unique_ptr<Counter>> &registry() {
+            static std::map<std::string, std::unique_ptr<Counter>> counters;
+            return counters;
+        }
+
+    }  // namespace
+
+    Counter &counter(const char *name) {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        auto &slot = registry()[name];
+        if (!slot) {
+            slot = std::make_unique<Counter>();
+        }
+        return *slot;
+    }
+
+    std::string snapshotJson() {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        std::string json = "{";
+        bool first = true;
+        for (const auto &entry: registry()) {
+            if (!first) {
+                json += ",";
+            }
+            json += "\"" + entry.first + "\":" + std::to_string(entry.second->get());
+            first = false;
+        }
+        json += "}";
+        return json;
+    }
+
+    void resetAll() {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (auto &entry: registry()) {
+            entry.second->set(0);
+        }
+    }
+
+}  // namespace metrics
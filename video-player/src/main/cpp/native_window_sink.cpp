@@ -0,0 +1,65 @@
+#define LOG_TAG "Native-WindowSink"
+
+#include "video_sink.h"
+#include "log.h"
+#include "trace.h"
+
+#include <android/native_window.h>
+
+NativeWindowSink::NativeWindowSink(ANativeWindow *window) : window_(window) {
+    ANativeWindow_acquire(window_);
+}
+
+NativeWindowSink::~NativeWindowSink() {
+    sws_freeContext(swsContext_);
+    ANativeWindow_release(window_);
+}
+
+void NativeWindowSink::onFrame(const AVFrame *frame) {
+    if (frame->width != configuredWidth_ || frame->height != configuredHeight_) {
+        // 缓冲区尺寸跟随视频尺寸，由合成器负责缩放到 Surface 大小
+        if (ANativeWindow_setBuffersGeometry(window_, frame->width, frame->height,
+                                             WINDOW_FORMAT_RGBA_8888) != 0) {
+            LOGE("设置 ANativeWindow 缓冲区失败: %dx%d", frame->width, frame->height);
+            return;
+        }
+        configuredWidth_ = frame->width;
+        configuredHeight_ = frame->height;
+    }
+
+    swsContext_ = sws_getCachedContext(swsContext_,
+                                       frame->width, frame->height,
+                                       static_cast<AVPixelFormat>(frame->format),
+                                       frame->width, frame->height, AV_PIX_FMT_RGBA,
+                                       SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!swsContext_) {
+        LOGE("无法创建像素格式转换上下文: %d", frame->format);
+        return;
+    }
+
+    ANativeWindow_Buffer buffer;
+    TRACE_BEGIN("sink.window.lock");
+    int lockResult = ANativeWindow_lock(window_, &buffer, nullptr);
+    TRACE_END("sink.window.lock");
+    if (lockResult != 0) {
+        LOGE("ANativeWindow_lock 失败: %d", lockResult);
+        return;
+    }
+
+    if (buffer.width < frame->width || buffer.height < frame->height) {
+        // 新的尺寸还未生效，跳过这一帧避免越界写入
+        ANativeWindow_unlockAndPost(window_);
+        return;
+    }
+
+    TRACE_BEGIN("sink.window.blit");
+    uint8_t *dstData[4] = {static_cast<uint8_t *>(buffer.bits), nullptr, nullptr, nullptr};
+    int dstLinesize[4] = {buffer.stride * 4, 0, 0, 0};
+    sws_scale(swsContext_, frame->data, frame->linesize, 0, frame->height, dstData, dstLinesize);
+    countFrameCopy();
+    TRACE_END("sink.window.blit");
+
+    ANativeWindow_unlockAndPost(window_);
+    framesRendered_++;
+    bytesRendered_ += static_cast<uint64_t>(buffer.stride) * buffer.height * 4;
+}
@@ -0,0 +1,984 @@
+#define LOG_TAG "Native-FFmpegDecoder"
+
+#include "player.h"
+
+#include <cstring>
+#include <thread>
+#include <utility>
+
+#include "bit_depth.h"
+#include "decoder_pool.h"
+#include "frame_change.h"
+#include "log.h"
+#include "media_cache.h"
+#include "memory_budget.h"
+#include "metrics.h"
+#include "presentation_stats.h"
+#include "stream_selection.h"
+#include "thread_scheduling.h"
+#include "trace.h"
+#include "vsync_scheduler.h"
+
+// 获取格式化的间字符串
+std::string FFmpegContext::getFormattedTime(int64_t timeInMicros) {
+    int64_t totalSeconds = timeInMicros / AV_TIME_BASE;
+    // 确保 totalSeconds 在 int 范围内
+    if (totalSeconds > std::numeric_limits<int>::max()) {
+        totalSeconds = std::numeric_limits<int>::max();
+    } else if (totalSeconds < std::numeric_limits<int>::min()) {
+        totalSeconds = std::numeric_limits<int>::min();
+    }
+    int hours = static_cast<int>(totalSeconds / 3600);
+    int minutes = static_cast<int>((totalSeconds % 3600) / 60);
+    int seconds = static_cast<int>(totalSeconds % 60);
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", hours, minutes, seconds);
+    return {buffer};
+}
+
+FFmpegContext::~FFmpegContext() {
+    // 析构函数：确保资源被正确释放，解码器上下文归还到复用池
+    if (codecContext) {
+        DecoderPool::instance().release(codecContext);
+        codecContext = nullptr;
+    }
+    if (formatContext) {
+        avformat_close_input(&formatContext);
+    }
+}
+
+void FFmpegContext::calculateTargetQueueSize() {
+    // 根据帧率计算合适的队列大小
+    targetQueueSize = static_cast<int>(frameRate * BUFFER_SECS);
+    // 确保队列大小在合理范围内
+    targetQueueSize = std::max(MIN_QUEUE_SIZE,
+                      std::min(targetQueueSize, MAX_QUEUE_SIZE));
+    LOGI("设置目标队列大小: %d (帧率: %.2f)", targetQueueSize, frameRate);
+}
+
+// vsync 驱动时等待一个 tick 的最长时间，超时后重新检查停止、暂停等状态
+const int64_t VSYNC_TIMEOUT_US = 100000;
+
+// 全局变量
+std::unique_ptr<FFmpegContext> ffmpegContext;           // FFmpeg上下文的智能指针
+std::mutex frameQueueMutex;                            // 帧队列互斥锁，用于线程同步
+std::condition_variable frameQueueCV;                  // 条件变量，用于线程间通信
+std::queue<AVFrame *> frameQueue;                      // 存储解码后等待渲染的帧队列
+std::atomic<bool> g_isDecoding(false);                 // 原子变量，控制解码过程
+std::atomic<bool> g_pullMode(false);                   // 拉模式：由 GL 线程按 vsync 取帧，不启动渲染线程
+std::atomic<bool> g_pacingEnabled(true);               // 是否按 PTS 控制解码和输出节奏
+std::atomic<bool> g_decodeFinished(false);             // 解码线程已读到文件末尾
+std::atomic<bool> g_renderFinished(false);             // 渲染线程已输出全部帧
+std::atomic<bool> g_isPaused(false);                   // 暂停：线程停在时钟上，解码器和已解码帧保持不变
+std::atomic<bool> g_restartRequested(false);           // 请求从头重新播放，由解码线程处理
+std::atomic<bool> g_abortRequest(false);               // 中断阻塞中的 FFmpeg I/O，使停止不受网络读取影响
+std::atomic<bool> g_liveMode(false);                   // 低延迟直播模式：最小探测、邮箱队列、到达即显示
+std::atomic<int> g_liveMailboxSize(2);                 // 直播模式下的队列长度（1 或 2 帧）
+std::atomic<bool> g_abrEnabled(false);                 // 多变体输入按吞吐和缓冲自适应选择码率
+std::atomic<int> g_targetSurfaceWidth(0);              // 显示表面大小，0 表示不按表面降分辨率
+std::atomic<int> g_targetSurfaceHeight(0);
+std::atomic<double> g_downscaleThreshold(2.0);         // 源分辨率达到表面的这个倍数才降分辨率
+std::atomic<bool> g_discardUnusedStreams(true);       // 解复用时丢弃视频以外的所有流
+std::mutex g_codecPreferenceMutex;
+std::vector<AVCodecID> g_preferredCodecs;              // 多个视频流时的编码偏好，受上面的锁保护
+RegionCropper g_regionCropper;                         // 输出区域，在渲染线程或拉模式取帧时裁剪
+FrameChangeDetector g_changeDetector;                  // 静态帧检测，没变的帧不再复制、上传
+BitDepthConverter g_depthConverter;                    // 10/12 位帧入队前转 8 位
+SceneDetector g_sceneDetector;                         // 场景切换检测，在自己的线程上分析入队的帧
+FrameFanout g_frameFanout;                             // 显示以外的帧消费者，各自持有引用和有界队列
+PresentationStats g_presentationStats;                 // 每帧实际呈现时间相对理想时间的误差和节奏
+std::atomic<bool> g_vsyncDriven(false);                // 推送模式由外部 vsync 驱动，而不是按帧时间睡眠
+VsyncScheduler g_vsyncScheduler;                       // 外部 vsync 的周期估计和预测
+std::thread g_decodeThread;                            // 解码线程，停止时 join
+std::thread g_renderThread;                            // 渲染线程（仅推送模式），停止时 join
+
+
+// 工具函数：释放帧资源
+inline void freeFrame(AVFrame *frame) {
+    if (frame) {
+        av_frame_free(&frame);
+    }
+}
+
+// 初始化解码器函数
+bool initDecoder(const char *path) {
+    ffmpegContext = std::make_unique<FFmpegContext>();
+
+    avformat_network_init();
+    LOGI("Initializing decoder with video path: %s", path);
+    g_presentationStats.reset();
+
+    // 停止时通过中断回调让阻塞的 av_read_frame 立即返回，保证线程能及时 join
+    g_abortRequest = false;
+    ffmpegContext->formatContext = avformat_alloc_context();
+    if (!ffmpegContext->formatContext) {
+        LOGE("Failed to allocate format context");
+        return false;
+    }
+    ffmpegContext->formatContext->interrupt_callback.callback = [](void *) -> int {
+        return g_abortRequest ? 1 : 0;
+    };
+
+    // 直播模式：关闭解复用缓冲，只探测最少的数据就开始解码
+    AVDictionary *formatOptions = nullptr;
+    if (g_liveMode) {
+        av_dict_set(&formatOptions, "fflags", "nobuffer", 0);
+        av_dict_set(&formatOptions, "probesize", "32768", 0);
+        av_dict_set(&formatOptions, "analyzeduration", "100000", 0);
+        av_dict_set(&formatOptions, "fpsprobesize", "0", 0);
+    }
+
+    // 自适应码率：包装分片 I/O 以测量下载吞吐。HLS 的长连接复用和并行预取会绕过 io_open，
+    // 也会让多个分片的下载时间重叠，这里关掉以得到逐分片的吞吐。
+    // 磁盘缓存同样在这一层：分片和字节范围按 URL 缓存，之后重播或往回 seek 时直接从磁盘读
+    bool cacheEnabled = MediaCache::instance().enabled();
+    if (g_abrEnabled || cacheEnabled) {
+        ffmpegContext->ioHooks = std::make_unique<IoHooks>();
+        ffmpegContext->ioHooks->install(ffmpegContext->formatContext);
+        av_dict_set(&formatOptions, "http_persistent", "0", 0);
+        av_dict_set(&formatOptions, "http_multiple", "0", 0);
+    }
+    if (g_abrEnabled) {
+        ffmpegContext->abr = std::make_unique<AbrController>();
+        ffmpegContext->abr->connect(*ffmpegContext->ioHooks);
+    }
+    if (cacheEnabled && MediaCache::isCacheable(path)) {
+        // 渐进式文件（如 HTTP 上的 MP4）的主输入也走缓存，以自定义 I/O 打开
+        int ret = ffmpegContext->ioHooks->openInput(ffmpegContext->formatContext, path);
+        if (ret < 0) {
+            LOGE("Failed to open video file: %s (%d)", path, ret);
+            av_dict_free(&formatOptions);
+            return false;
+        }
+    }
+
+    TRACE_BEGIN("open");
+    int openResult = avformat_open_input(&ffmpegContext->formatContext, path, nullptr,
+                                         &formatOptions);
+    TRACE_END("open");
+    av_dict_free(&formatOptions);
+    if (openResult != 0) {
+        LOGE("Failed to open video file: %s", path);
+        return false;
+    }
+
+    TRACE_BEGIN("probe");
+    int probeResult = avformat_find_stream_info(ffmpegContext->formatContext, nullptr);
+    TRACE_END("probe");
+    if (probeResult < 0) {
+        LOGE("Failed to find stream info for: %s", path);
+        return false;
+    }
+
+    int videoStreamIndex = -1;
+    if (ffmpegContext->abr && ffmpegContext->abr->attach(ffmpegContext->formatContext)) {
+        // 从最低码率的变体起播，其余变体已被 discard
+        videoStreamIndex = ffmpegContext->abr->activeVideoStream();
+        ffmpegContext->abr->setBufferProbe([]() {
+            std::lock_guard<std::mutex> lock(frameQueueMutex);
+            return static_cast<double>(frameQueue.size()) / ffmpegContext->targetQueueSize;
+        });
+        ffmpegContext->codec = avcodec_find_decoder(
+                ffmpegContext->formatContext->streams[videoStreamIndex]->codecpar->codec_id);
+    } else {
+        ffmpegContext->abr.reset();
+        std::vector<AVCodecID> preferredCodecs;
+        {
+            std::lock_guard<std::mutex> lock(g_codecPreferenceMutex);
+            preferredCodecs = g_preferredCodecs;
+        }
+        videoStreamIndex = streams::selectVideoStream(ffmpegContext->formatContext, preferredCodecs,
+                                                      &ffmpegContext->codec);
+    }
+
+    if (videoStreamIndex < 0 && videoStreamIndex != AVERROR_DECODER_NOT_FOUND) {
+        LOGE("No video stream found");
+        return false;
+    }
+    if (videoStreamIndex < 0 || !ffmpegContext->codec) {
+        LOGE("Failed to find codec for video stream");
+        return false;
+    }
+
+    // 播放器只解码视频：其余流在解复用器里直接丢弃，不再读出和释放它们的包
+    if (g_discardUnusedStreams) {
+        static auto &discardedStreams = metrics::counter("demux.discardedStreams");
+        int discarded = streams::discardAllExcept(ffmpegContext->formatContext, videoStreamIndex);
+        discardedStreams.set(discarded);
+        LOGI("视频流 %d，丢弃其余 %d 个流", videoStreamIndex, discarded);
+    }
+
+    AVStream *videoStream = ffmpegContext->formatContext->streams[videoStreamIndex];
+
+    // 参数相同时复用之前打开过的解码器上下文
+    // 直播模式下用 low_delay 和 slice 线程，帧线程会为每个线程多引入一帧延迟
+    if (g_liveMode) {
+        ffmpegContext->decoderOptions.flags = AV_CODEC_FLAG_LOW_DELAY;
+        ffmpegContext->decoderOptions.threadType = FF_THREAD_SLICE;
+    }
+    // 源分辨率远大于显示表面时降分辨率，lowres 是解码器选项，要在打开解码器前确定
+    const AVCodecParameters *par = videoStream->codecpar;
+    DownscalePlan downscale = FrameDownscaler::plan(ffmpegContext->codec, par->width, par->height,
+                                                    g_targetSurfaceWidth, g_targetSurfaceHeight,
+                                                    g_downscaleThreshold);
+    ffmpegContext->decoderOptions.lowres = downscale.lowres;
+    ffmpegContext->outputWidth = downscale.outputWidth;
+    ffmpegContext->outputHeight = downscale.outputHeight;
+    // 高位深的帧入队前就转成 8 位，不降分辨率时的大小也按转换后的格式计
+    auto queuedFormat = static_cast<AVPixelFormat>(par->format);
+    if (BitDepthConverter::canConvert(queuedFormat)) {
+        queuedFormat = g_depthConverter.outputFormat();
+        LOGI("高位深输入 %s，入队前转换为 %s", av_get_pix_fmt_name(static_cast<AVPixelFormat>(par->format)),
+             av_get_pix_fmt_name(queuedFormat));
+    }
+    ffmpegContext->fullFrameBytes = av_image_get_buffer_size(queuedFormat, par->width, par->height, 1);
+    ffmpegContext->downscaler = std::make_unique<FrameDownscaler>(downscale);
+    if (downscale.active()) {
+        static auto &lowres = metrics::counter("downscale.lowres");
+        lowres.set(downscale.lowres);
+        LOGI("降分辨率: %dx%d -> %dx%d（lowres %d，盒式滤波 %d 次%s）", par->width, par->height,
+             downscale.outputWidth, downscale.outputHeight, downscale.lowres, downscale.boxSteps,
+             downscale.swsOnly ? "，swscale" : "");
+    }
+    ffmpegContext->codecContext = DecoderPool::instance().acquire(ffmpegContext->codec,
+                                                                  videoStream->codecpar,
+                                                                  ffmpegContext->decoderOptions);
+    if (!ffmpegContext->codecContext) {
+        return false;
+    }
+    ffmpegContext->codecContext->pkt_timebase = videoStream->time_base;
+    ffmpegContext->videoStreamIndex = videoStreamIndex;
+
+    // 获取视频流的帧率并计算队列大小
+    ffmpegContext->frameRate = av_q2d(videoStream->avg_frame_rate);
+    ffmpegContext->calculateTargetQueueSize();
+    if (g_liveMode) {
+        ffmpegContext->targetQueueSize = g_liveMailboxSize;
+        LOGI("直播模式：队列长度 %d", ffmpegContext->targetQueueSize);
+    }
+
+    ffmpegContext->timeBase = av_q2d(videoStream->time_base);
+
+    LOGI("Decoder initialized successfully");
+
+    // 获取视频总时长
+    if (ffmpegContext->formatContext->duration != AV_NOPTS_VALUE) {
+        ffmpegContext->totalDuration = ffmpegContext->formatContext->duration;
+        LOGI("视频总时长: %s",
+             ffmpegContext->getFormattedTime(ffmpegContext->totalDuration).c_str());
+    }
+    return true;
+}
+
+// 媒体时间（微秒）。切换变体后不同流的时间基可能不同，入队时记在帧的 time_base 上
+static int64_t frameTimeMicros(const AVFrame *frame) {
+    double timeBase = frame->time_base.num > 0 ? av_q2d(frame->time_base) : ffmpegContext->timeBase;
+    return frame->pts == AV_NOPTS_VALUE ? 0 : static_cast<int64_t>(
+            frame->pts * timeBase * AV_TIME_BASE);
+}
+
+// 名义帧间隔（微秒），帧率未知时为 0
+static int64_t nominalFrameInterval() {
+    return ffmpegContext->frameRate > 0 ? static_cast<int64_t>(AV_TIME_BASE / ffmpegContext->frameRate) : 0;
+}
+
+// 播放时钟：把媒体时间映射到单调时钟（av_gettime_relative，微秒），调用者需持有 frameQueueMutex。
+// 有外部 vsync 时锚点对齐到 vsync 网格上最稳定的位置
+static int64_t presentationTimeFor(const AVFrame *frame, int64_t now) {
+    if (ffmpegContext->clockAnchorTime < 0) {
+        ffmpegContext->clockAnchorTime = g_vsyncScheduler.alignAnchor(now, nominalFrameInterval());
+        ffmpegContext->clockAnchorPts = frameTimeMicros(frame);
+    }
+    return ffmpegContext->clockAnchorTime + frameTimeMicros(frame) - ffmpegContext->clockAnchorPts;
+}
+
+// 从头重新播放：清空队列和解码器内部缓冲，线程保持运行
+static void handleRestart() {
+    TRACE_SCOPE("decode.restart");
+    int ret = av_seek_frame(ffmpegContext->formatContext, -1,
+                            ffmpegContext->formatContext->start_time != AV_NOPTS_VALUE
+                            ? ffmpegContext->formatContext->start_time : 0,
+                            AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        LOGE("重新播放时 seek 失败: %d", ret);
+    }
+    avcodec_flush_buffers(ffmpegContext->codecContext);
+    g_presentationStats.reset();
+
+    std::lock_guard<std::mutex> lock(frameQueueMutex);
+    while (!frameQueue.empty()) {
+        freeFrame(frameQueue.front());
+        frameQueue.pop();
+    }
+    ffmpegContext->clockAnchorTime = -1;
+    g_changeDetector.reset();
+    g_sceneDetector.reset();
+    g_frameFanout.flush();
+    g_decodeFinished = false;
+    g_renderFinished = false;
+    g_restartRequested = false;
+    frameQueueCV.notify_all();
+}
+
+// 参数集在码流内（Annex B 或没有 extradata）时，解码器能直接处理新变体的 SPS/PPS
+static bool hasInBandParameterSets(const AVCodecParameters *par) {
+    const uint8_t *data = par->extradata;
+    int size = par->extradata_size;
+    return size == 0 || (size >= 3 && data[0] == 0 && data[1] == 0 &&
+                         (data[2] == 1 || (size >= 4 && data[2] == 0 && data[3] == 1)));
+}
+
+// ABR 切换到新变体的视频流：编码器相同且参数集可以带内更新时继续使用当前解码器，
+// 否则把当前上下文归还复用池，按新流的参数重新获取
+static bool switchVideoStream(int streamIndex) {
+    TRACE_SCOPE("decode.switchStream");
+    AVStream *stream = ffmpegContext->formatContext->streams[streamIndex];
+    const AVCodecParameters *par = stream->codecpar;
+    AVCodecContext *current = ffmpegContext->codecContext;
+    bool sameExtradata = current->extradata_size == par->extradata_size &&
+                         (par->extradata_size == 0 ||
+                          memcmp(current->extradata, par->extradata, par->extradata_size) == 0);
+    bool reuse = current->codec_id == par->codec_id &&
+                 (sameExtradata || hasInBandParameterSets(par));
+
+    if (!reuse) {
+        static auto &reopens = metrics::counter("abr.decoderReopens");
+        const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+        AVCodecContext *next = codec ? DecoderPool::instance().acquire(
+                codec, par, ffmpegContext->decoderOptions) : nullptr;
+        if (!next) {
+            LOGE("切换到视频流 %d 时无法打开解码器", streamIndex);
+            return false;
+        }
+        DecoderPool::instance().release(current);
+        ffmpegContext->codec = codec;
+        ffmpegContext->codecContext = next;
+        reopens.add(1);
+    }
+    ffmpegContext->codecContext->pkt_timebase = stream->time_base;
+    ffmpegContext->videoStreamIndex = streamIndex;
+    ffmpegContext->timeBase = av_q2d(stream->time_base);
+    LOGI("切换到视频流 %d（%dx%d），%s解码器", streamIndex, par->width, par->height,
+         reuse ? "沿用" : "重开");
+    return true;
+}
+
+// 解码线程函数：负责从视频文件中读取数据并解码，按队列容量限速
+void decodeThreadFunc() {
+    TRACE_THREAD_NAME("decode");
+    scheduling::ScopedThread scheduled(scheduling::Role::Decode);
+    static auto &demuxBytesRead = metrics::counter("demux.bytesRead");
+    static auto &unusedPackets = metrics::counter("demux.unusedPackets");
+    // Use av_packet_alloc to allocate a new AVPacket
+    AVPacket *packet = av_packet_alloc();
+    if (!packet) {
+        LOGE("无法分配 AVPacket");
+        g_decodeFinished = true;
+        return;
+    }
+    AVFrame *frame = av_frame_alloc();
+    if (!frame) {
+        LOGE("无法分配 AVFrame");
+        av_packet_free(&packet);  // Free the packet if frame allocation fails
+        g_decodeFinished = true;
+        return;
+    }
+
+    while (g_isDecoding) {
+        {
+            // 暂停或已到文件末尾时停在这里，等待恢复、重新播放或停止
+            std::unique_lock<std::mutex> lock(frameQueueMutex);
+            frameQueueCV.wait(lock, []() {
+                return !g_isDecoding || g_restartRequested || (!g_isPaused && !g_decodeFinished);
+            });
+        }
+        if (!g_isDecoding) {
+            break;
+        }
+        if (g_restartRequested) {
+            handleRestart();
+            continue;
+        }
+
+        TRACE_BEGIN("demux");
+        int readResult = av_read_frame(ffmpegContext->formatContext, packet);
+        TRACE_END("demux");
+        int64_t packetBytes = readResult >= 0 && packet->buf ? static_cast<int64_t>(packet->buf->size) : 0;
+        memory::allocated(memory::Category::Packets, packetBytes);
+        // 主输入实际读取的字节数；对比丢弃无用流前后的 demux.bytesRead 即可看出省下的读取量
+        if (ffmpegContext->formatContext->pb) {
+            demuxBytesRead.set(ffmpegContext->formatContext->pb->bytes_read);
+        }
+        if (readResult < 0) {
+            if (readResult != AVERROR_EOF && g_abortRequest) {
+                break;
+            }
+            // 文件结束后线程不退出，可以直接重新播放
+            g_decodeFinished = true;
+            frameQueueCV.notify_all();
+            LOGI("解码到达文件末尾");
+            continue;
+        }
+
+        // ABR 选中了新变体：旧变体剩余的包丢弃，新变体的第一个包到达时切换解码
+        if (ffmpegContext->abr) {
+            int activeStream = ffmpegContext->abr->activeVideoStream();
+            if (packet->stream_index == activeStream &&
+                activeStream != ffmpegContext->videoStreamIndex) {
+                switchVideoStream(activeStream);
+            }
+        }
+
+        if (packet->stream_index != ffmpegContext->videoStreamIndex) {
+            unusedPackets.add(1);
+        } else {
+            TRACE_BEGIN("decode.send");
+            int sendResult = avcodec_send_packet(ffmpegContext->codecContext, packet);
+            TRACE_END("decode.send");
+            if (sendResult == 0) {
+                while (true) {
+                    TRACE_BEGIN("decode.receive");
+                    int receiveResult = avcodec_receive_frame(ffmpegContext->codecContext, frame);
+                    TRACE_END("decode.receive");
+                    if (receiveResult != 0) {
+                        break;
+                    }
+
+                    // 10/12 位的帧先在同一次遍历里转成 8 位，之后的缩小也就走 8 位的 SIMD 路径
+                    AVFrame *converted = g_depthConverter.convert(frame);
+                    // 入队前先缩小到显示表面大小，之后的复制和上传都按缩小后的大小进行
+                    AVFrame *outputFrame = ffmpegContext->downscaler->process(
+                            converted ? converted : frame, ffmpegContext->fullFrameBytes);
+                    freeFrame(converted);
+                    av_frame_unref(frame);
+                    if (!outputFrame) {
+                        continue;
+                    }
+                    // 场景检测和其他订阅者只拿走一个引用，满了各自丢帧，不会在这里等待
+                    outputFrame->time_base = ffmpegContext->codecContext->pkt_timebase;
+                    g_sceneDetector.submit(outputFrame, frameTimeMicros(outputFrame));
+                    g_frameFanout.publish(outputFrame, frameTimeMicros(outputFrame));
+                    // 设置了内存预算时，再解码一帧可能超出预算就先等输出端释放帧；
+                    // 队列为空时总是放行，否则解码器的参考帧本身超预算时会死锁
+                    int64_t frameBytes = packedFrameSize(outputFrame);
+                    // 直播模式的队列长度（1 或 2）本来就小于 MIN_QUEUE_SIZE，这里只保证至少 1 帧
+                    auto queueLimit = static_cast<size_t>(std::max(1, ffmpegContext->targetQueueSize));
+                    auto canPush = [&]() {
+                        return g_liveMode || (frameQueue.size() < queueLimit &&
+                                              (frameQueue.empty() || memory::fits(frameBytes)));
+                    };
+                    std::unique_lock<std::mutex> lock(frameQueueMutex);
+                    if (!canPush() && frameQueue.size() < queueLimit) {
+                        static auto &budgetWaits = metrics::counter("memory.budgetWaits");
+                        budgetWaits.add(1);
+                    }
+                    // 队列满或暂停时等待；节奏由渲染端（或拉模式的显示端）按播放时钟控制
+                    TRACE_BEGIN("queue.wait");
+                    frameQueueCV.wait(lock, [&]() {
+                        return !g_isDecoding || g_restartRequested || (!g_isPaused && canPush());
+                    });
+                    TRACE_END("queue.wait");
+                    if (!g_isDecoding || g_restartRequested) {
+                        freeFrame(outputFrame);
+                        break;
+                    }
+
+                    TRACE_BEGIN("queue.push");
+                    // 直播模式从不阻塞解复用，队列满时丢弃最旧的帧追上实时进度
+                    while (g_liveMode && !frameQueue.empty() && frameQueue.size() >= queueLimit) {
+                        static auto &liveDropped = metrics::counter("live.droppedFrames");
+                        freeFrame(frameQueue.front());
+                        frameQueue.pop();
+                        liveDropped.add(1);
+                    }
+                    frameQueue.push(outputFrame);
+                    TRACE_COUNTER("frameQueue.size", frameQueue.size());
+                    frameQueueCV.notify_all();
+                    TRACE_END("queue.push");
+                }
+            }
+        }
+        av_packet_unref(packet);  // Unreference the packet after use
+        memory::freed(memory::Category::Packets, packetBytes);
+    }
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);  // Free the packet when done
+    frameQueueCV.notify_all();
+    LOGI("解码线程结束");
+}
+
+// 渲染线程函数：负责按播放时钟把解码后的帧交给输出端
+void renderThreadFunc(std::shared_ptr<VideoSink> sink) {
+    TRACE_THREAD_NAME("render");
+    scheduling::ScopedThread scheduled(scheduling::Role::Render);
+    if (!sink->onThreadStart()) {
+        LOGE("输出端 %s 初始化失败", sink->name());
+        g_renderFinished = true;
+        return;
+    }
+
+    while (g_isDecoding) {
+        AVFrame* frame = nullptr;
+        // 按时钟输出时才有理想呈现时间；直播模式到达即显示，不统计
+        bool tracked = g_pacingEnabled && !g_liveMode;
+        int64_t idealTime = 0;
+
+        // vsync 驱动：每个 vsync 醒来一次，为下一次 vsync（这次交出的帧实际上屏的时间）选帧。
+        // 周期估计出来之前不输出
+        bool vsyncDriven = tracked && g_vsyncDriven;
+        int64_t displayTime = -1;
+        if (vsyncDriven) {
+            int64_t vsync = g_vsyncScheduler.waitForVsync(VSYNC_TIMEOUT_US);
+            if (vsync < 0 || !g_vsyncScheduler.hasEstimate()) {
+                continue;
+            }
+            displayTime = g_vsyncScheduler.predict(vsync, 1);
+        }
+        int dropped = 0;
+        {
+            std::unique_lock<std::mutex> lock(frameQueueMutex);
+
+            if (vsyncDriven && frameQueue.empty() && !g_decodeFinished && !g_isPaused) {
+                // 解码没跟上，这个 vsync 继续显示上一帧，不在这里等帧错过后面的 vsync
+                g_presentationStats.onVsync(displayTime, false, 0);
+                continue;
+            }
+
+            TRACE_BEGIN("queue.pop");
+            frameQueueCV.wait(lock, []() {
+                return !g_isDecoding ||
+                       (!g_isPaused && !g_restartRequested && (!frameQueue.empty() || g_decodeFinished));
+            });
+            TRACE_END("queue.pop");
+            if (!g_isDecoding) {
+                break;
+            }
+            if (frameQueue.empty()) {
+                // 文件已解码完毕且队列为空，等待重新播放或停止
+                if (!g_renderFinished) {
+                    g_renderFinished = true;
+                    LOGI("播放结束");
+                }
+                frameQueueCV.wait(lock, []() {
+                    return !g_isDecoding || !g_decodeFinished;
+                });
+                continue;
+            }
+
+            if (vsyncDriven) {
+                // 队首帧的理想时间离下一次 vsync 还超过半个周期：它属于之后的 vsync，继续显示上一帧
+                int64_t halfPeriod = g_vsyncScheduler.periodUs() / 2;
+                if (presentationTimeFor(frameQueue.front(), displayTime) > displayTime + halfPeriod) {
+                    g_presentationStats.onVsync(displayTime, false, 0);
+                    continue;
+                }
+                // 同一个 vsync 里有多帧到期（帧率高于刷新率或解码追赶）时只显示最新的一帧
+                frame = frameQueue.front();
+                frameQueue.pop();
+                while (!frameQueue.empty() &&
+                       presentationTimeFor(frameQueue.front(), displayTime) <= displayTime + halfPeriod) {
+                    freeFrame(frame);
+                    dropped++;
+                    frame = frameQueue.front();
+                    frameQueue.pop();
+                }
+            } else if (g_pacingEnabled && !g_liveMode) {
+                // 按播放时钟等到这一帧的显示时间；期间暂停、停止或重新播放会立即唤醒。
+                // 直播模式到达即显示
+                TRACE_SCOPE("render.pace");
+                int64_t target = presentationTimeFor(frameQueue.front(), av_gettime_relative());
+                int64_t wait = target - av_gettime_relative();
+                if (wait > 0 && frameQueueCV.wait_for(lock, std::chrono::microseconds(wait), []() {
+                    return !g_isDecoding || g_isPaused || g_restartRequested;
+                })) {
+                    continue;
+                }
+            }
+            if (!frame) {
+                if (frameQueue.empty() || g_isPaused) {
+                    continue;
+                }
+                frame = frameQueue.front();
+                frameQueue.pop();
+            }
+            TRACE_COUNTER("frameQueue.size", frameQueue.size());
+            frameQueueCV.notify_all();
+            if (tracked) {
+                idealTime = presentationTimeFor(frame, vsyncDriven ? displayTime : av_gettime_relative());
+            }
+
+            // 使用 PTS 更新当前播放时间
+            if (frame->pts != AV_NOPTS_VALUE) {
+                ffmpegContext->currentTime = frameTimeMicros(frame);
+
+                // 每秒输出一次播放进度
+                static int64_t lastLogTime = 0;
+                if (ffmpegContext->currentTime - lastLogTime >= AV_TIME_BASE) {
+                    LOGI("播放进度: %s / %s",
+                         ffmpegContext->getFormattedTime(ffmpegContext->currentTime).c_str(),
+                         ffmpegContext->getFormattedTime(ffmpegContext->totalDuration).c_str());
+                    lastLogTime = ffmpegContext->currentTime;
+                }
+            }
+        }
+
+        // 只把输出区域交给输出端；输出端按行复制，用零复制视图即可
+        AVFrame *cropped = g_regionCropper.apply(frame, false);
+        if (cropped) {
+            freeFrame(frame);
+            frame = cropped;
+        }
+
+        // 渲染帧
+        if (frame->data[0]) {
+            if (vsyncDriven) {
+                // 帧在预测的下一次 vsync 上屏，节奏按 vsync 计
+                g_presentationStats.onVsync(displayTime, true, dropped);
+                g_presentationStats.onFramePresented(idealTime, displayTime, nominalFrameInterval());
+            } else if (tracked) {
+                g_presentationStats.onFramePresented(idealTime, av_gettime_relative(),
+                                                     nominalFrameInterval());
+            }
+            // 与上一次输出相同的帧只通知输出端保持画面，推送的输出端都按整帧更新
+            bool unchanged = g_changeDetector.compare(frame, false).kind == FrameChange::Kind::Unchanged;
+            TRACE_BEGIN("render.sink");
+            if (unchanged) {
+                sink->onFrameUnchanged(frame);
+            } else {
+                sink->onFrame(frame);
+            }
+            TRACE_END("render.sink");
+        }
+        freeFrame(frame);
+        if (memory::budget() > 0) {
+            // 帧缓冲此时才真正释放，唤醒可能因内存预算而等待的解码线程
+            frameQueueCV.notify_all();
+        }
+    }
+
+    LOGI("渲染线程结束，输出端 %s 共输出 %llu 帧", sink->name(),
+         static_cast<unsigned long long>(sink->framesRendered()));
+    sink->onThreadStop();
+    g_renderFinished = true;
+}
+
+// 启动解码和渲染线程
+bool startDecoding(std::shared_ptr<VideoSink> sink) {
+    LOGI("startNativeDecoding");
+    if (g_isDecoding) {
+        LOGI("Decoding already started.");
+        return false;
+    }
+    if (!ffmpegContext) {
+        LOGE("Decoder not initialized");
+        return false;
+    }
+    if (!g_pullMode && !sink) {
+        LOGE("Push mode requires a video sink");
+        return false;
+    }
+
+    g_isDecoding = true;
+    g_isPaused = false;
+    g_restartRequested = false;
+    g_abortRequest = false;
+    g_decodeFinished = false;
+    g_renderFinished = false;
+    ffmpegContext->startTime = av_gettime_relative();
+    ffmpegContext->clockAnchorTime = -1;
+    g_presentationStats.markDiscontinuity();
+    g_changeDetector.reset();
+    g_sceneDetector.reset();
+    g_frameFanout.flush();
+
+    g_decodeThread = std::thread(decodeThreadFunc);
+    if (!g_pullMode) {
+        // 拉模式下帧由显示端通过 acquireLatestFrame 获取，不需要渲染线程
+        g_renderThread = std::thread(renderThreadFunc, std::move(sink));
+    }
+    return true;
+}
+
+// 停止解码和渲染线程，等待线程退出后返回
+void stopDecoding() {
+    LOGI("stopNativeDecoding");
+
+    if (!g_isDecoding) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(frameQueueMutex);
+        g_isDecoding = false;
+        g_abortRequest = true;
+    }
+    frameQueueCV.notify_all();
+    g_vsyncScheduler.interrupt();
+
+    if (g_decodeThread.joinable()) {
+        g_decodeThread.join();
+    }
+    if (g_renderThread.joinable()) {
+        g_renderThread.join();
+    }
+
+    std::unique_lock<std::mutex> lock(frameQueueMutex);
+    while (!frameQueue.empty()) {
+        freeFrame(frameQueue.front());
+        frameQueue.pop();
+    }
+    g_isPaused = false;
+
+    LOGI("Stopped decoding and rendering.");
+}
+
+// 暂停：线程停在时钟上，解码器、解复用状态和已解码的帧都保留
+void pauseDecoding() {
+    std::lock_guard<std::mutex> lock(frameQueueMutex);
+    if (!g_isDecoding || g_isPaused) {
+        return;
+    }
+    g_isPaused = true;
+    ffmpegContext->pauseTime = av_gettime_relative();
+    g_presentationStats.markDiscontinuity();
+    frameQueueCV.notify_all();
+    LOGI("Playback paused");
+}
+
+// 恢复：时钟平移暂停时长，队首帧在不超过一个帧间隔内输出
+void resumeDecoding() {
+    std::lock_guard<std::mutex> lock(frameQueueMutex);
+    if (!g_isDecoding || !g_isPaused) {
+        return;
+    }
+    if (ffmpegContext->clockAnchorTime >= 0) {
+        // 平移后的锚点不再对齐 vsync 网格，重新对齐
+        ffmpegContext->clockAnchorTime = g_vsyncScheduler.alignAnchor(
+                ffmpegContext->clockAnchorTime + av_gettime_relative() - ffmpegContext->pauseTime,
+                nominalFrameInterval());
+    }
+    g_isPaused = false;
+    g_presentationStats.markDiscontinuity();
+    frameQueueCV.notify_all();
+    LOGI("Playback resumed");
+}
+
+// 从头重新播放，不销毁线程和解码器
+void restartDecoding() {
+    std::lock_guard<std::mutex> lock(frameQueueMutex);
+    if (!g_isDecoding) {
+        return;
+    }
+    g_restartRequested = true;
+    frameQueueCV.notify_all();
+}
+
+// 释放解码器资源
+void releaseDecoder() {
+    LOGI("releaseDecoder");
+
+    stopDecoding();
+    ffmpegContext.reset();
+
+    LOGI("Decoder released");
+}
+
+bool isDecoding() {
+    return g_isDecoding;
+}
+
+bool isPaused() {
+    return g_isPaused;
+}
+
+bool setLiveMode(bool enabled, int mailboxSize) {
+    if (g_isDecoding) {
+        LOGE("setLiveMode must be called before initDecoder");
+        return false;
+    }
+    g_liveMode = enabled;
+    g_liveMailboxSize = std::max(1, std::min(mailboxSize, 2));
+    LOGI("直播模式: %s", enabled ? "on" : "off");
+    return true;
+}
+
+bool isLiveMode() {
+    return g_liveMode;
+}
+
+void setAbrEnabled(bool enabled) {
+    g_abrEnabled = enabled;
+    LOGI("自适应码率: %s", enabled ? "on" : "off");
+}
+
+bool isAbrEnabled() {
+    return g_abrEnabled;
+}
+
+void setTargetSurfaceSize(int width, int height) {
+    g_targetSurfaceWidth = std::max(0, width);
+    g_targetSurfaceHeight = std::max(0, height);
+    LOGI("显示表面大小: %dx%d", width, height);
+}
+
+void setDownscaleThreshold(double factor) {
+    g_downscaleThreshold = std::max(1.0, factor);
+}
+
+void setDiscardUnusedStreams(bool enabled) {
+    g_discardUnusedStreams = enabled;
+}
+
+void setPreferredVideoCodecs(const std::string &codecNames) {
+    std::vector<AVCodecID> codecs = streams::parseCodecList(codecNames);
+    std::lock_guard<std::mutex> lock(g_codecPreferenceMutex);
+    g_preferredCodecs = std::move(codecs);
+}
+
+void setHighBitDepthOutput(AVPixelFormat output, bool dither) {
+    g_depthConverter.configure(output, dither);
+    LOGI("高位深输出: %s%s", av_get_pix_fmt_name(g_depthConverter.outputFormat()), dither ? "（抖动）" : "");
+}
+
+void setRegionOfInterest(const RegionOfInterest &region) {
+    g_regionCropper.set(region);
+}
+
+RegionOfInterest regionOfInterest() {
+    return g_regionCropper.get();
+}
+
+bool setPullMode(bool enabled) {
+    if (g_isDecoding) {
+        LOGE("setPullMode must be called before startNativeDecoding");
+        return false;
+    }
+    g_pullMode = enabled;
+    LOGI("帧输出模式: %s", g_pullMode ? "pull" : "push");
+    return true;
+}
+
+bool isPullMode() {
+    return g_pullMode;
+}
+
+bool setVsyncDriven(bool enabled) {
+    if (g_isDecoding) {
+        LOGE("setVsyncDriven must be called before startNativeDecoding");
+        return false;
+    }
+    g_vsyncDriven = enabled;
+    LOGI("vsync 驱动: %s", enabled ? "on" : "off");
+    return true;
+}
+
+bool isVsyncDriven() {
+    return g_vsyncDriven;
+}
+
+VsyncScheduler &vsyncScheduler() {
+    return g_vsyncScheduler;
+}
+
+FrameFanout &frameFanout() {
+    return g_frameFanout;
+}
+
+void setPacingEnabled(bool enabled) {
+    g_pacingEnabled = enabled;
+}
+
+bool isPlaybackFinished() {
+    if (g_pullMode) {
+        std::lock_guard<std::mutex> lock(frameQueueMutex);
+        return g_decodeFinished && frameQueue.empty();
+    }
+    return g_renderFinished;
+}
+
+AVFrame *acquireLatestFrame(int64_t presentationTimeNs, FrameChange *change) {
+    if (!g_isDecoding || !g_pullMode || !ffmpegContext) {
+        return nullptr;
+    }
+
+    TRACE_SCOPE("pull.acquire");
+    AVFrame *frame = nullptr;
+    int dropped = 0;
+    {
+        std::unique_lock<std::mutex> lock(frameQueueMutex);
+        if (g_isPaused) {
+            return nullptr;
+        }
+
+        // 显示端时间（System.nanoTime）与 av_gettime_relative 同为单调时钟。
+        // 每次调用对应一个 vsync，没有新帧时上一帧多停留一个 vsync
+        int64_t displayTime = presentationTimeNs / 1000;
+        if (frameQueue.empty()) {
+            g_presentationStats.onVsync(displayTime, false, 0);
+            return nullptr;
+        }
+        int64_t halfInterval = nominalFrameInterval() / 2;
+
+        // 队首帧还没到显示时间，继续显示上一帧；直播模式总是取最新的帧
+        bool live = g_liveMode;
+        if (!live && presentationTimeFor(frameQueue.front(), displayTime) > displayTime + halfInterval) {
+            g_presentationStats.onVsync(displayTime, false, 0);
+            return nullptr;
+        }
+
+        // 跳过已经被后续帧取代的帧，只取本次 vsync 应显示的最新一帧
+        frame = frameQueue.front();
+        frameQueue.pop();
+        while (!frameQueue.empty() &&
+               (live || presentationTimeFor(frameQueue.front(), displayTime) <= displayTime + halfInterval)) {
+            freeFrame(frame);
+            dropped++;
+            frame = frameQueue.front();
+            frameQueue.pop();
+        }
+        ffmpegContext->currentTime = frameTimeMicros(frame);
+        g_presentationStats.onVsync(displayTime, true, dropped);
+        if (!live) {
+            g_presentationStats.onFramePresented(presentationTimeFor(frame, displayTime), displayTime,
+                                                 nominalFrameInterval());
+        }
+        TRACE_COUNTER("frameQueue.size", frameQueue.size());
+        TRACE_COUNTER("pull.dropped", dropped);
+    }
+    frameQueueCV.notify_all();
+
+    // GL 线程按行宽上传整个平面，裁剪后的区域复制成紧密的帧，上传量和可见面积成正比
+    AVFrame *cropped = g_regionCropper.apply(frame, true);
+    if (cropped) {
+        freeFrame(frame);
+        frame = cropped;
+    }
+
+    // 和上一次取走的内容相同时不返回帧，显示端保留现有纹理；部分变化时告诉显示端只上传变化的区域
+    const FrameChange &frameChange = g_changeDetector.compare(frame, change != nullptr);
+    if (frameChange.kind == FrameChange::Kind::Unchanged) {
+        freeFrame(frame);
+        return nullptr;
+    }
+    if (change) {
+        *change = frameChange;
+    }
+    return frame;
+}
+
+void setFrameChangeDetection(bool enabled, int tileSize, int threshold) {
+    g_changeDetector.configure(enabled, tileSize, threshold);
+}
+
+void resetFrameChanges() {
+    g_changeDetector.reset();
+}
+
+void setSceneDetection(bool enabled, double threshold, int64_t minSceneUs) {
+    g_sceneDetector.configure(enabled, threshold, minSceneUs);
+}
+
+std::vector<SceneCut> takeSceneCuts() {
+    return g_sceneDetector.takeCuts();
+}
@@ -0,0 +1,176 @@
+#define LOG_TAG "Native-Presentation"
+
+#include "presentation_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "metrics.h"
+#include "trace.h"
+
+namespace {
+
+    // 误差直方图的桶：error >= lowerUs 且小于下一个桶的 lowerUs
+    struct Bucket {
+        int64_t lowerUs;
+        const char *name;
+    };
+
+    const Bucket ERROR_BUCKETS[] = {
+            {INT64_MIN, "present.error.early8ms"},
+            {-8000,     "present.error.early2ms"},
+            {-2000,     "present.error.onTime"},
+            {2000,      "present.error.late2ms"},
+            {8000,      "present.error.late8ms"},
+            {16000,     "present.error.late16ms"},
+            {33000,     "present.error.late33ms"},
+            {66000,     "present.error.late66ms"},
+    };
+
+    const int BUCKET_COUNT = sizeof(ERROR_BUCKETS) / sizeof(ERROR_BUCKETS[0]);
+
+    // 间隔超过这么多帧视为时间线不连续（如 seek、长时间卡顿后的恢复），不计入节奏
+    const int64_t MAX_GAP_FRAMES = 10;
+
+    metrics::Counter &bucketCounter(int index) {
+        static metrics::Counter *counters[BUCKET_COUNT] = {};
+        if (!counters[index]) {
+            counters[index] = &metrics::counter(ERROR_BUCKETS[index].name);
+        }
+        return *counters[index];
+    }
+
+}  // namespace
+
+void PresentationStats::reset() {
+    static auto &errorMean = metrics::counter("present.errorMeanUs");
+    static auto &errorMax = metrics::counter("present.errorMaxUs");
+    static auto &jitter = metrics::counter("present.jitterUs");
+    resetRequested_ = true;
+    discontinuity_ = true;
+    errorMean.set(0);
+    errorMax.set(0);
+    jitter.set(0);
+}
+
+void PresentationStats::applyReset() {
+    errorSumUs_ = 0;
+    jitterSumUs_ = 0;
+    frames_ = 0;
+    jitterSamples_ = 0;
+    driftFrames_ = 0;
+    driftVsyncs_ = 0;
+    holding_ = false;
+    holdVsyncs_ = 0;
+}
+
+void PresentationStats::onFramePresented(int64_t idealUs, int64_t actualUs, int64_t frameIntervalUs) {
+    static auto &frames = metrics::counter("present.frames");
+    static auto &lateFrames = metrics::counter("present.lateFrames");
+    static auto &errorMean = metrics::counter("present.errorMeanUs");
+    static auto &errorMax = metrics::counter("present.errorMaxUs");
+    static auto &jitter = metrics::counter("present.jitterUs");
+    if (resetRequested_.exchange(false)) {
+        applyReset();
+    }
+
+    int64_t error = actualUs - idealUs;
+    TRACE_COUNTER("present.errorUs", error);
+    int bucket = BUCKET_COUNT - 1;
+    while (bucket > 0 && error < ERROR_BUCKETS[bucket].lowerUs) {
+        bucket--;
+    }
+    bucketCounter(bucket).add(1);
+    frames.add(1);
+    if (frameIntervalUs > 0 && error > frameIntervalUs / 2) {
+        lateFrames.add(1);
+    }
+    frames_++;
+    errorSumUs_ += error;
+    errorMean.set(errorSumUs_ / frames_);
+    if (error > errorMax.get()) {
+        errorMax.set(error);
+    }
+    if (frameIntervalUs > 0) {
+        frameIntervalUs_ = frameIntervalUs;
+    }
+
+    bool discontinuity = discontinuity_.exchange(false);
+    int64_t idealDelta = idealUs - lastIdealUs_;
+    int64_t actualDelta = actualUs - lastActualUs_;
+    if (!discontinuity && frameIntervalUs_ > 0 && idealDelta >= 0 &&
+        idealDelta < MAX_GAP_FRAMES * frameIntervalUs_ && actualDelta < MAX_GAP_FRAMES * frameIntervalUs_) {
+        jitterSumUs_ += std::llabs(error - lastErrorUs_);
+        jitterSamples_++;
+        jitter.set(jitterSumUs_ / jitterSamples_);
+        if (!pullMode_) {
+            updateCadence(static_cast<double>(actualDelta - idealDelta) / frameIntervalUs_);
+        }
+    } else {
+        driftFrames_ = 0;
+        driftVsyncs_ = 0;
+        holding_ = false;
+    }
+    lastIdealUs_ = idealUs;
+    lastActualUs_ = actualUs;
+    lastErrorUs_ = error;
+}
+
+void PresentationStats::onVsync(int64_t vsyncUs, bool newFrame, int skipped) {
+    static auto &skippedFrames = metrics::counter("present.skippedFrames");
+    static auto &cadenceBreaks = metrics::counter("present.cadenceBreaks");
+    static auto &vsyncInterval = metrics::counter("present.vsyncIntervalUs");
+
+    if (resetRequested_.exchange(false)) {
+        applyReset();
+    }
+    pullMode_ = true;
+    if (lastVsyncUs_ >= 0) {
+        auto delta = static_cast<double>(vsyncUs - lastVsyncUs_);
+        // 超过 100ms 的间隔是显示端停顿，不计入 vsync 周期
+        if (delta > 0 && delta < 100000) {
+            vsyncIntervalUs_ = vsyncIntervalUs_ > 0 ? vsyncIntervalUs_ * 0.95 + delta * 0.05 : delta;
+            vsyncInterval.set(static_cast<int64_t>(vsyncIntervalUs_));
+        }
+    }
+    lastVsyncUs_ = vsyncUs;
+
+    if (skipped > 0) {
+        skippedFrames.add(skipped);
+        cadenceBreaks.add(1);
+    }
+    if (!newFrame) {
+        holdVsyncs_++;
+        return;
+    }
+    // 上一帧停留了 holdVsyncs_ 个 vsync，和期望的 帧间隔 / vsync 间隔 比较
+    if (holding_ && vsyncIntervalUs_ > 0 && frameIntervalUs_ > 0 && !discontinuity_) {
+        updateCadence(holdVsyncs_ - static_cast<double>(frameIntervalUs_) / vsyncIntervalUs_);
+    }
+    holding_ = true;
+    holdVsyncs_ = 1;
+}
+
+void PresentationStats::updateCadence(double driftDelta) {
+    static auto &repeatedFrames = metrics::counter("present.repeatedFrames");
+    static auto &skippedFrames = metrics::counter("present.skippedFrames");
+    static auto &cadenceBreaks = metrics::counter("present.cadenceBreaks");
+
+    // 推送模式以帧为单位，拉模式以 vsync 为单位；累计偏差超过一个单位即节奏被打破
+    double &drift = pullMode_ ? driftVsyncs_ : driftFrames_;
+    drift += driftDelta;
+    if (drift >= 1.0) {
+        repeatedFrames.add(static_cast<int64_t>(std::floor(drift)));
+        cadenceBreaks.add(1);
+        drift = 0;
+    } else if (drift <= -1.0) {
+        // 推送模式下两帧挤在一个帧间隔内，前一帧实际上没有被看到
+        if (!pullMode_) {
+            skippedFrames.add(static_cast<int64_t>(std::floor(-drift)));
+        }
+        cadenceBreaks.add(1);
+        drift = 0;
+    }
+    TRACE_COUNTER("present.cadenceBreaks", cadenceBreaks.get());
+}
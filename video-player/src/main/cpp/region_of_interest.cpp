@@ -0,0 +1,118 @@
+#define LOG_TAG "Native-ROI"
+
+#include "region_of_interest.h"
+
+#include <algorithm>
+
+#include "log.h"
+#include "metrics.h"
+#include "trace.h"
+#include "video_sink.h"
+
+namespace {
+
+    int alignDown(int value, int alignment) {
+        return value / alignment * alignment;
+    }
+
+    int alignUp(int value, int alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+}  // namespace
+
+RegionCropper::~RegionCropper() {
+    sws_freeContext(swsContext_);
+}
+
+void RegionCropper::set(const RegionOfInterest &region) {
+    static auto &updates = metrics::counter("roi.updates");
+    std::lock_guard<std::mutex> lock(mutex_);
+    region_ = region;
+    updates.add(1);
+}
+
+RegionOfInterest RegionCropper::get() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return region_;
+}
+
+AVFrame *RegionCropper::apply(const AVFrame *frame, bool compact) {
+    static auto &frames = metrics::counter("roi.frames");
+    static auto &visiblePercent = metrics::counter("roi.visiblePercent");
+
+    RegionOfInterest region = get();
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    if (!region.active() || !desc || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM))) {
+        return nullptr;
+    }
+
+    // 起点向下、终点向上对齐到色度抽样单位，再限制在帧内
+    int alignX = 1 << desc->log2_chroma_w;
+    int alignY = 1 << desc->log2_chroma_h;
+    int left = alignDown(std::max(0, std::min(region.x, frame->width - 1)), alignX);
+    int top = alignDown(std::max(0, std::min(region.y, frame->height - 1)), alignY);
+    int right = std::min(frame->width, alignUp(region.x + region.width, alignX));
+    int bottom = std::min(frame->height, alignUp(region.y + region.height, alignY));
+    if (right <= left || bottom <= top) {
+        return nullptr;
+    }
+    if (left == 0 && top == 0 && right == frame->width && bottom == frame->height &&
+        !region.outputWidth) {
+        return nullptr;
+    }
+
+    TRACE_SCOPE("roi.apply");
+    // 先得到指向区域的零复制视图：引用原帧的缓冲，只移动各平面的指针
+    AVFrame *view = av_frame_clone(frame);
+    if (!view) {
+        return nullptr;
+    }
+    view->crop_left = left;
+    view->crop_top = top;
+    view->crop_right = frame->width - right;
+    view->crop_bottom = frame->height - bottom;
+    if (av_frame_apply_cropping(view, AV_FRAME_CROP_UNALIGNED) < 0) {
+        LOGW("无法裁剪到区域 %d,%d %dx%d", left, top, right - left, bottom - top);
+        av_frame_free(&view);
+        return nullptr;
+    }
+    frames.add(1);
+    visiblePercent.set(static_cast<int64_t>(view->width) * view->height * 100 /
+                       (static_cast<int64_t>(frame->width) * frame->height));
+
+    auto format = static_cast<AVPixelFormat>(view->format);
+    if (region.outputWidth > 0 && region.outputHeight > 0) {
+        // 缩放输出：只有可见区域参与 swscale
+        int width = alignUp(region.outputWidth, alignX);
+        int height = alignUp(region.outputHeight, alignY);
+        swsContext_ = sws_getCachedContext(swsContext_, view->width, view->height, format,
+                                           width, height, format, SWS_BILINEAR,
+                                           nullptr, nullptr, nullptr);
+        AVFrame *scaled = swsContext_ ? pool_.alloc(width, height, format) : nullptr;
+        if (!scaled) {
+            av_frame_free(&view);
+            return nullptr;
+        }
+        sws_scale(swsContext_, view->data, view->linesize, 0, view->height,
+                  scaled->data, scaled->linesize);
+        countFrameCopy();
+        av_frame_copy_props(scaled, view);
+        av_frame_free(&view);
+        return scaled;
+    }
+    if (!compact) {
+        return view;
+    }
+
+    AVFrame *copy = pool_.alloc(view->width, view->height, format);
+    if (!copy || av_frame_copy(copy, view) < 0) {
+        av_frame_free(&copy);
+        av_frame_free(&view);
+        return nullptr;
+    }
+    countFrameCopy();
+    av_frame_copy_props(copy, view);
+    av_frame_free(&view);
+    return copy;
+}
@@ -0,0 +1,237 @@
+#include "row_kernels.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+    inline uint8_t convertSample(uint16_t value, uint16_t offset, int shift) {
+        uint32_t sum = std::min<uint32_t>(static_cast<uint32_t>(value) + offset, 0xffff);
+        return static_cast<uint8_t>(std::min<uint32_t>(sum >> shift, 255));
+    }
+
+}  // namespace
+
+namespace rows {
+
+    void convertRow(const uint16_t *src, uint8_t *dst, int count, int shift, const DitherRow &dither) {
+        int x = 0;
+#if defined(__ARM_NEON)
+        const uint16x8_t offset = vld1q_u16(dither.lanes);
+        const int16x8_t rightShift = vdupq_n_s16(static_cast<int16_t>(-shift));
+        for (; x + 16 <= count; x += 16) {
+            uint16x8_t low = vshlq_u16(vqaddq_u16(vld1q_u16(src + x), offset), rightShift);
+            uint16x8_t high = vshlq_u16(vqaddq_u16(vld1q_u16(src + x + 8), offset), rightShift);
+            vst1q_u8(dst + x, vcombine_u8(vqmovn_u16(low), vqmovn_u16(high)));
+        }
+#elif defined(__AVX2__)
+        const __m256i offset = _mm256_load_si256(reinterpret_cast<const __m256i *>(dither.lanes));
+        const __m128i rightShift = _mm_cvtsi32_si128(shift);
+        for (; x + 32 <= count; x += 32) {
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x + 16));
+            low = _mm256_srl_epi16(_mm256_adds_epu16(low, offset), rightShift);
+            high = _mm256_srl_epi16(_mm256_adds_epu16(high, offset), rightShift);
+            // packus 按 128 位通道交错，permute 恢复样本顺序
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xd8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), packed);
+        }
+#elif defined(__SSE2__)
+        const __m128i offset = _mm_load_si128(reinterpret_cast<const __m128i *>(dither.lanes));
+        const __m128i rightShift = _mm_cvtsi32_si128(shift);
+        for (; x + 16 <= count; x += 16) {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x + 8));
+            low = _mm_srl_epi16(_mm_adds_epu16(low, offset), rightShift);
+            high = _mm_srl_epi16(_mm_adds_epu16(high, offset), rightShift);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(low, high));
+        }
+#endif
+        for (; x < count; x++) {
+            dst[x] = convertSample(src[x], dither.lanes[x & 15], shift);
+        }
+    }
+
+    void interleaveRow(const uint16_t *u, const uint16_t *v, uint8_t *dst, int count, int shift,
+                       const DitherRow &dither) {
+        int x = 0;
+#if defined(__ARM_NEON)
+        const uint16x8_t offset = vld1q_u16(dither.lanes);
+        const int16x8_t rightShift = vdupq_n_s16(static_cast<int16_t>(-shift));
+        for (; x + 8 <= count; x += 8) {
+            uint8x8x2_t uv;
+            uv.val[0] = vqmovn_u16(vshlq_u16(vqaddq_u16(vld1q_u16(u + x), offset), rightShift));
+            uv.val[1] = vqmovn_u16(vshlq_u16(vqaddq_u16(vld1q_u16(v + x), offset), rightShift));
+            vst2_u8(dst + 2 * x, uv);
+        }
+#elif defined(__SSE2__)
+        const __m128i offset = _mm_load_si128(reinterpret_cast<const __m128i *>(dither.lanes));
+        const __m128i rightShift = _mm_cvtsi32_si128(shift);
+        for (; x + 8 <= count; x += 8) {
+            __m128i vu = _mm_loadu_si128(reinterpret_cast<const __m128i *>(u + x));
+            __m128i vv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + x));
+            vu = _mm_srl_epi16(_mm_adds_epu16(vu, offset), rightShift);
+            vv = _mm_srl_epi16(_mm_adds_epu16(vv, offset), rightShift);
+            // 收窄后的 8 个 U 与 8 个 V 按字节交错
+            __m128i packed = _mm_packus_epi16(vu, vv);
+            __m128i interleaved = _mm_unpacklo_epi8(packed, _mm_srli_si128(packed, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * x), interleaved);
+        }
+#endif
+        for (; x < count; x++) {
+            dst[2 * x] = convertSample(u[x], dither.lanes[x & 15], shift);
+            dst[2 * x + 1] = convertSample(v[x], dither.lanes[x & 15], shift);
+        }
+    }
+
+    void deinterleaveRow(const uint16_t *uv, uint8_t *u, uint8_t *v, int count, int shift,
+                         const DitherRow &dither) {
+        int x = 0;
+#if defined(__ARM_NEON)
+        // 偏移按交错排列给出，和样本一样拆开
+        const uint16x8x2_t offsets = vld2q_u16(dither.lanes);
+        const int16x8_t rightShift = vdupq_n_s16(static_cast<int16_t>(-shift));
+        for (; x + 8 <= count; x += 8) {
+            uint16x8x2_t samples = vld2q_u16(uv + 2 * x);
+            vst1_u8(u + x, vqmovn_u16(vshlq_u16(vqaddq_u16(samples.val[0], offsets.val[0]), rightShift)));
+            vst1_u8(v + x, vqmovn_u16(vshlq_u16(vqaddq_u16(samples.val[1], offsets.val[1]), rightShift)));
+        }
+#elif defined(__SSE2__)
+        const __m128i offset = _mm_load_si128(reinterpret_cast<const __m128i *>(dither.lanes));
+        const __m128i rightShift = _mm_cvtsi32_si128(shift);
+        const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+        for (; x + 8 <= count; x += 8) {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + 2 * x));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + 2 * x + 8));
+            low = _mm_srl_epi16(_mm_adds_epu16(low, offset), rightShift);
+            high = _mm_srl_epi16(_mm_adds_epu16(high, offset), rightShift);
+            // 收窄后是 u0 v0 u1 v1 ...，偶数字节是 U，奇数字节是 V
+            __m128i packed = _mm_packus_epi16(low, high);
+            __m128i us = _mm_and_si128(packed, lowBytes);
+            __m128i vs = _mm_srli_epi16(packed, 8);
+            __m128i planar = _mm_packus_epi16(us, vs);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(u + x), planar);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(v + x), _mm_srli_si128(planar, 8));
+        }
+#endif
+        for (; x < count; x++) {
+            u[x] = convertSample(uv[2 * x], dither.lanes[(2 * x) & 15], shift);
+            v[x] = convertSample(uv[2 * x + 1], dither.lanes[(2 * x + 1) & 15], shift);
+        }
+    }
+
+    uint32_t blockSad(const uint8_t *a, const uint8_t *b, int bytes) {
+        uint32_t sum = 0;
+        int x = 0;
+#if defined(__ARM_NEON)
+        uint32x4_t acc = vdupq_n_u32(0);
+        for (; x + 16 <= bytes; x += 16) {
+            uint8x16_t diff = vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x));
+            acc = vpadalq_u16(acc, vpaddlq_u8(diff));
+        }
+        uint64x2_t total = vpaddlq_u32(acc);
+        sum = static_cast<uint32_t>(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1));
+#elif defined(__SSE2__)
+        __m128i acc = _mm_setzero_si128();
+        for (; x + 16 <= bytes; x += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+            acc = _mm_add_epi32(acc, _mm_sad_epu8(va, vb));
+        }
+        sum = static_cast<uint32_t>(_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+        for (; x < bytes; x++) {
+            sum += static_cast<uint32_t>(std::abs(a[x] - b[x]));
+        }
+        return sum;
+    }
+
+    uint64_t lineSad(const uint8_t *a, const uint8_t *b, int width) {
+        uint64_t sum = 0;
+        int x = 0;
+#if defined(__ARM_NEON)
+        uint32x4_t acc = vdupq_n_u32(0);
+        for (; x + 32 <= width; x += 32) {
+            uint8x16_t d0 = vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x));
+            uint8x16_t d1 = vabdq_u8(vld1q_u8(a + x + 16), vld1q_u8(b + x + 16));
+            acc = vpadalq_u16(acc, vaddq_u16(vpaddlq_u8(d0), vpaddlq_u8(d1)));
+        }
+        uint64x2_t total = vpaddlq_u32(acc);
+        sum = vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1);
+#elif defined(__AVX2__)
+        __m256i acc = _mm256_setzero_si256();
+        for (; x + 32 <= width; x += 32) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + x));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + x));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(va, vb));
+        }
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum = static_cast<uint64_t>(_mm_cvtsi128_si64(half)) +
+              static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half)));
+#elif defined(__SSE2__)
+        __m128i acc = _mm_setzero_si128();
+        for (; x + 16 <= width; x += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+            acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+        }
+        sum = static_cast<uint64_t>(_mm_cvtsi128_si32(acc)) +
+              static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+#endif
+        for (; x < width; x++) {
+            sum += static_cast<uint64_t>(std::abs(a[x] - b[x]));
+        }
+        return sum;
+    }
+
+    // 四组计数交替累加，相邻像素落在同一级时不会连续写同一个计数器
+    void accumulateHistogram(const uint8_t *row, int width, uint32_t (*bins)[64]) {
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            bins[0][row[x] >> 2]++;
+            bins[1][row[x + 1] >> 2]++;
+            bins[2][row[x + 2] >> 2]++;
+            bins[3][row[x + 3] >> 2]++;
+        }
+        for (; x < width; x++) {
+            bins[0][row[x] >> 2]++;
+        }
+    }
+
+    void halveRow(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int width) {
+        int x = 0;
+#if defined(__ARM_NEON)
+        for (; x + 8 <= width; x += 8) {
+            uint16x8_t sum = vpaddlq_u8(vld1q_u8(row0 + 2 * x));
+            sum = vpadalq_u8(sum, vld1q_u8(row1 + 2 * x));
+            vst1_u8(dst + x, vrshrn_n_u16(sum, 2));
+        }
+#elif defined(__SSE2__)
+        const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; x + 8 <= width; x += 8) {
+            __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * x));
+            __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * x));
+            __m128i sum = _mm_add_epi16(_mm_and_si128(top, lowBytes), _mm_srli_epi16(top, 8));
+            sum = _mm_add_epi16(sum, _mm_and_si128(bottom, lowBytes));
+            sum = _mm_add_epi16(sum, _mm_srli_epi16(bottom, 8));
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + x),
+                             _mm_packus_epi16(sum, _mm_setzero_si128()));
+        }
+#endif
+        for (; x < width; x++) {
+            dst[x] = static_cast<uint8_t>(
+                    (row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1] + 2) >> 2);
+        }
+    }
+
+}  // namespace rows
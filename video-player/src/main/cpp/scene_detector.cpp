@@ -0,0 +1,218 @@
+#define LOG_TAG "Native-Scene"
+
+#include "scene_detector.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "log.h"
+#include "metrics.h"
+#include "row_kernels.h"
+#include "thread_scheduling.h"
+#include "trace.h"
+
+namespace {
+
+    // 待分析的帧最多这么多个，多出来时丢弃最旧的，分析线程不会拖住解码
+    const size_t MAX_PENDING = 3;
+    // 每隔几行取一行
+    const int ROW_STEP = 4;
+
+    // 亮度在第 0 个平面、每像素 1 字节
+    bool isSupported(const AVFrame *frame) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+        return desc && !(desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL |
+                                        AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_FLOAT)) &&
+               desc->comp[0].plane == 0 && desc->comp[0].step == 1 && desc->comp[0].depth == 8 &&
+               frame->width > 0 && frame->height > 0;
+    }
+
+}  // namespace
+
+SceneDetector::~SceneDetector() {
+    stopWorker();
+    av_frame_free(&previous_);
+}
+
+void SceneDetector::configure(bool enabled, double threshold, int64_t minSceneUs) {
+    // 开关的判断和分析线程的启动、停止整个串行化：并发的 configure 不会重复启动线程，
+    // 也不会 join 一个正在被赋值的线程。分析线程不使用 configMutex_，持有它 join 不会死锁
+    std::lock_guard<std::mutex> configLock(configMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threshold_ = threshold;
+        minSceneUs_ = std::max<int64_t>(0, minSceneUs);
+    }
+    if (enabled == enabled_) {
+        return;
+    }
+    if (enabled) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopRequested_ = false;
+            resetRequested_ = true;
+        }
+        enabled_ = true;
+        thread_ = std::thread(&SceneDetector::run, this);
+    } else {
+        enabled_ = false;
+        stopWorker();
+    }
+    LOGI("场景检测: %s, 阈值 %.1f, 最短场景 %lldms", enabled ? "on" : "off", threshold,
+         static_cast<long long>(minSceneUs / 1000));
+}
+
+void SceneDetector::stopWorker() {
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+        worker = std::move(thread_);
+    }
+    cv_.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Pending &pending: queue_) {
+        av_frame_free(&pending.frame);
+    }
+    queue_.clear();
+}
+
+void SceneDetector::submit(const AVFrame *frame, int64_t ptsUs) {
+    static auto &dropped = metrics::counter("scene.droppedFrames");
+    if (!enabled_ || !isSupported(frame)) {
+        return;
+    }
+    AVFrame *ref = av_frame_alloc();
+    if (!ref || av_frame_ref(ref, frame) < 0) {
+        av_frame_free(&ref);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopRequested_) {
+            av_frame_free(&ref);
+            return;
+        }
+        while (queue_.size() >= MAX_PENDING) {
+            av_frame_free(&queue_.front().frame);
+            queue_.pop_front();
+            dropped.add(1);
+        }
+        queue_.push_back({ref, ptsUs});
+    }
+    cv_.notify_one();
+}
+
+void SceneDetector::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Pending &pending: queue_) {
+        av_frame_free(&pending.frame);
+    }
+    queue_.clear();
+    resetRequested_ = true;
+}
+
+std::vector<SceneCut> SceneDetector::takeCuts() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<SceneCut> cuts;
+    cuts.swap(cuts_);
+    return cuts;
+}
+
+void SceneDetector::run() {
+    TRACE_THREAD_NAME("scene");
+    scheduling::ScopedThread scheduled(scheduling::Role::Analysis);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this]() { return stopRequested_ || !queue_.empty(); });
+        if (stopRequested_) {
+            break;
+        }
+        Pending pending = queue_.front();
+        queue_.pop_front();
+        if (resetRequested_) {
+            resetRequested_ = false;
+            av_frame_free(&previous_);
+        }
+        lock.unlock();
+        analyze(pending.frame, pending.ptsUs);
+        lock.lock();
+    }
+    lock.unlock();
+    av_frame_free(&previous_);
+}
+
+void SceneDetector::analyze(AVFrame *frame, int64_t ptsUs) {
+    static auto &frames = metrics::counter("scene.frames");
+    static auto &cutCount = metrics::counter("scene.cuts");
+    static auto &analysisMicros = metrics::counter("scene.analysisMicros");
+    static auto &microsPerFrame = metrics::counter("scene.microsPerFrame");
+    TRACE_SCOPE("scene.analyze");
+    int64_t startedAt = av_gettime_relative();
+
+    int width = frame->width;
+    int height = frame->height;
+    bool comparable = previous_ && previous_->width == width && previous_->height == height &&
+                      previous_->format == frame->format;
+    uint32_t bins[4][64] = {};
+    uint64_t sad = 0;
+    int64_t samples = 0;
+    for (int y = 0; y < height; y += ROW_STEP) {
+        const uint8_t *row = frame->data[0] + static_cast<ptrdiff_t>(y) * frame->linesize[0];
+        rows::accumulateHistogram(row, width, bins);
+        if (comparable) {
+            sad += rows::lineSad(row, previous_->data[0] + static_cast<ptrdiff_t>(y) * previous_->linesize[0], width);
+        }
+        samples += width;
+    }
+    std::array<uint32_t, 64> histogram = {};
+    for (int i = 0; i < 64; i++) {
+        histogram[i] = bins[0][i] + bins[1][i] + bins[2][i] + bins[3][i];
+    }
+
+    if (comparable && samples > 0) {
+        // mafd 与直方图差都换算到 0 ~ 100
+        double mafd = static_cast<double>(sad) * 100.0 / (static_cast<double>(samples) * 255.0);
+        uint64_t histogramDiff = 0;
+        for (int i = 0; i < 64; i++) {
+            histogramDiff += static_cast<uint64_t>(std::abs(static_cast<int64_t>(histogram[i]) -
+                                                            static_cast<int64_t>(previousHistogram_[i])));
+        }
+        double histogramScore = static_cast<double>(histogramDiff) * 50.0 / static_cast<double>(samples);
+        double motionScore = std::min(mafd, std::abs(mafd - previousMafd_));
+        double score = (motionScore + histogramScore) / 2;
+        previousMafd_ = mafd;
+
+        double threshold;
+        int64_t minSceneUs;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            threshold = threshold_;
+            minSceneUs = minSceneUs_;
+        }
+        if (score >= threshold && (lastCutUs_ == INT64_MIN || ptsUs - lastCutUs_ >= minSceneUs)) {
+            lastCutUs_ = ptsUs;
+            cutCount.add(1);
+            TRACE_COUNTER("scene.score", static_cast<int64_t>(score));
+            std::lock_guard<std::mutex> lock(mutex_);
+            cuts_.push_back({ptsUs, score});
+        }
+    } else {
+        // 第一帧（或 seek 之后、尺寸变化）：只作为之后比较的基准
+        previousMafd_ = 0;
+        lastCutUs_ = INT64_MIN;
+    }
+    previousHistogram_ = histogram;
+
+    // 持有的是引用，换成当前帧只是交换指针
+    av_frame_free(&previous_);
+    previous_ = frame;
+
+    int64_t elapsed = av_gettime_relative() - startedAt;
+    frames.add(1);
+    analysisMicros.add(elapsed);
+    microsPerFrame.set(analysisMicros.get() / std::max<int64_t>(1, frames.get()));
+}
@@ -0,0 +1,91 @@
+#define LOG_TAG "Native-Streams"
+
+#include "stream_selection.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+namespace streams {
+
+    int selectVideoStream(AVFormatContext *context, const std::vector<AVCodecID> &preferredCodecs,
+                          const AVCodec **decoder) {
+        const AVCodec *bestDecoder = nullptr;
+        int best = av_find_best_stream(context, AVMEDIA_TYPE_VIDEO, -1, -1, &bestDecoder, 0);
+        if (preferredCodecs.empty()) {
+            *decoder = best >= 0 ? bestDecoder : nullptr;
+            return best;
+        }
+
+        // 排名：在偏好列表中的位置（不在列表中的排最后），同名次时 av_find_best_stream 的结果优先
+        int selected = -1;
+        size_t selectedRank = 0;
+        int64_t selectedPixels = 0;
+        for (unsigned int i = 0; i < context->nb_streams; i++) {
+            const AVStream *stream = context->streams[i];
+            const AVCodecParameters *par = stream->codecpar;
+            if (par->codec_type != AVMEDIA_TYPE_VIDEO ||
+                (stream->disposition & AV_DISPOSITION_ATTACHED_PIC) ||
+                !avcodec_find_decoder(par->codec_id)) {
+                continue;
+            }
+            size_t rank = std::find(preferredCodecs.begin(), preferredCodecs.end(), par->codec_id) -
+                          preferredCodecs.begin();
+            int64_t pixels = static_cast<int64_t>(par->width) * par->height;
+            bool better = selected < 0 || rank < selectedRank ||
+                          (rank == selectedRank && selected != best &&
+                           (static_cast<int>(i) == best || pixels > selectedPixels));
+            if (better) {
+                selected = static_cast<int>(i);
+                selectedRank = rank;
+                selectedPixels = pixels;
+            }
+        }
+        if (selected < 0) {
+            *decoder = nullptr;
+            return best < 0 ? best : AVERROR_STREAM_NOT_FOUND;
+        }
+        *decoder = avcodec_find_decoder(context->streams[selected]->codecpar->codec_id);
+        if (selected != best) {
+            LOGI("按编码偏好选择视频流 %d（%s），而不是 %d", selected, (*decoder)->name, best);
+        }
+        return selected;
+    }
+
+    int discardAllExcept(AVFormatContext *context, int keep) {
+        int discarded = 0;
+        for (unsigned int i = 0; i < context->nb_streams; i++) {
+            AVStream *stream = context->streams[i];
+            if (static_cast<int>(i) == keep) {
+                stream->discard = AVDISCARD_DEFAULT;
+            } else {
+                stream->discard = AVDISCARD_ALL;
+                discarded++;
+            }
+        }
+        return discarded;
+    }
+
+    std::vector<AVCodecID> parseCodecList(const std::string &names) {
+        std::vector<AVCodecID> codecs;
+        size_t begin = 0;
+        while (begin <= names.size()) {
+            size_t end = names.find(',', begin);
+            if (end == std::string::npos) {
+                end = names.size();
+            }
+            std::string name = names.substr(begin, end - begin);
+            if (!name.empty()) {
+                const AVCodecDescriptor *descriptor = avcodec_descriptor_get_by_name(name.c_str());
+                if (descriptor) {
+                    codecs.push_back(descriptor->id);
+                } else {
+                    LOGW("未知的编码名: %s", name.c_str());
+                }
+            }
+            begin = end + 1;
+        }
+        return codecs;
+    }
+
+}  // namespace streams
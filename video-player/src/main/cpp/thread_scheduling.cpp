@@ -0,0 +1,316 @@
+#define LOG_TAG "Native-Sched"
+
+#include "thread_scheduling.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "log.h"
+#include "metrics.h"
+
+namespace scheduling {
+    namespace {
+
+        const int ROLE_COUNT = static_cast<int>(Role::Count);
+        const int MAX_CPUS = 64;
+
+        const char *const ROLE_NAMES[ROLE_COUNT] = {
+                "decode", "render", "analysis", "background",
+        };
+
+        struct Topology {
+            uint64_t all = 0;
+            uint64_t big = 0;
+            uint64_t little = 0;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::array<Policy, ROLE_COUNT> policies{};
+            std::array<bool, ROLE_COUNT> configured{};  // 没设置过的角色不去改动线程继承来的调度
+            std::vector<std::pair<Role, int>> threads;  // 登记的 (角色, 线程 id)
+        };
+
+        Registry &registry() {
+            static Registry *instance = new Registry();
+            return *instance;
+        }
+
+        // 读取 sysfs 里的一个整数，不存在时返回 -1
+        int64_t readSysfsValue(const char *path) {
+            FILE *file = fopen(path, "r");
+            if (!file) {
+                return -1;
+            }
+            long long value = -1;
+            if (fscanf(file, "%lld", &value) != 1) {
+                value = -1;
+            }
+            fclose(file);
+            return value;
+        }
+
+        // 按每个核心的相对算力分组：算力最低的是小核，其余（包括超大核）都是大核
+        Topology detectTopology() {
+            Topology topology;
+#if defined(__linux__)
+            long configured = sysconf(_SC_NPROCESSORS_CONF);
+            int count = static_cast<int>(std::min<long>(std::max<long>(configured, 1), MAX_CPUS));
+            int64_t capacities[MAX_CPUS];
+            int64_t minCapacity = INT64_MAX;
+            int64_t maxCapacity = -1;
+            for (int cpu = 0; cpu < count; cpu++) {
+                char path[128];
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", cpu);
+                int64_t capacity = readSysfsValue(path);
+                if (capacity < 0) {
+                    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+                    capacity = readSysfsValue(path);
+                }
+                capacities[cpu] = capacity;
+                topology.all |= uint64_t(1) << cpu;
+                if (capacity >= 0) {
+                    minCapacity = std::min(minCapacity, capacity);
+                    maxCapacity = std::max(maxCapacity, capacity);
+                }
+            }
+            if (maxCapacity > minCapacity) {
+                for (int cpu = 0; cpu < count; cpu++) {
+                    if (capacities[cpu] == minCapacity) {
+                        topology.little |= uint64_t(1) << cpu;
+                    } else {
+                        topology.big |= uint64_t(1) << cpu;
+                    }
+                }
+            } else {
+                topology.big = topology.all;
+                topology.little = topology.all;
+            }
+            LOGI("CPU 拓扑: %d 个核心, 大核 0x%" PRIx64 ", 小核 0x%" PRIx64, count, topology.big,
+                 topology.little);
+#endif
+            return topology;
+        }
+
+        const Topology &topology() {
+            static const Topology instance = detectTopology();
+            return instance;
+        }
+
+        int currentThreadId() {
+#if defined(__linux__)
+            return static_cast<int>(syscall(SYS_gettid));
+#else
+            return 0;
+#endif
+        }
+
+        // 把配置应用到一个线程（不必是当前线程），失败的项写日志后跳过
+        void applyToThread(int tid, Role role, const Policy &policy) {
+#if defined(__linux__)
+            static auto &failures = metrics::counter("threads.policyFailures");
+            const char *name = ROLE_NAMES[static_cast<int>(role)];
+            bool realtime = false;
+            if (policy.realtimePriority > 0) {
+                sched_param param = {};
+                param.sched_priority = policy.realtimePriority;
+                if (sched_setscheduler(tid, SCHED_FIFO, &param) == 0) {
+                    realtime = true;
+                } else {
+                    failures.add(1);
+                    LOGW("%s 线程无法使用 SCHED_FIFO %d: %s，改用 nice", name, policy.realtimePriority,
+                         strerror(errno));
+                }
+            }
+            if (!realtime) {
+                sched_param param = {};
+                if (sched_setscheduler(tid, SCHED_OTHER, &param) != 0 ||
+                    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), policy.nice) != 0) {
+                    failures.add(1);
+                    LOGW("%s 线程无法设置 nice %d: %s", name, policy.nice, strerror(errno));
+                }
+            }
+
+            uint64_t mask = policy.cpuMask & topology().all;
+            if (mask == 0) {
+                mask = topology().all;
+            }
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+                if (mask & (uint64_t(1) << cpu)) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+                failures.add(1);
+                LOGW("%s 线程无法设置 CPU 亲和性 0x%" PRIx64 ": %s", name, mask, strerror(errno));
+            }
+#else
+            (void) tid;
+            (void) role;
+            (void) policy;
+#endif
+        }
+
+    }  // namespace
+
+    const char *roleName(Role role) {
+        return ROLE_NAMES[static_cast<int>(role)];
+    }
+
+    const char *presetName(Preset preset) {
+        switch (preset) {
+            case Preset::Performance:
+                return "performance";
+            case Preset::Efficiency:
+                return "efficiency";
+            case Preset::Balanced:
+                return "balanced";
+            case Preset::Default:
+            default:
+                return "default";
+        }
+    }
+
+    bool parsePreset(const char *name, Preset *preset) {
+        for (Preset candidate: {Preset::Default, Preset::Performance, Preset::Efficiency, Preset::Balanced}) {
+            if (strcmp(name, presetName(candidate)) == 0) {
+                *preset = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void setPolicy(Role role, const Policy &policy) {
+        Registry &state = registry();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.policies[static_cast<int>(role)] = policy;
+        state.configured[static_cast<int>(role)] = true;
+        for (const auto &thread: state.threads) {
+            if (thread.first == role) {
+                applyToThread(thread.second, role, policy);
+            }
+        }
+    }
+
+    Policy policy(Role role) {
+        Registry &state = registry();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.policies[static_cast<int>(role)];
+    }
+
+    void applyPreset(Preset preset) {
+        uint64_t big = topology().big;
+        uint64_t little = topology().little;
+        // nice 值参照 Android 的线程优先级：-8 为 URGENT_DISPLAY，-4 为 DISPLAY，10 为 BACKGROUND
+        std::array<Policy, ROLE_COUNT> policies{};
+        switch (preset) {
+            case Preset::Performance:
+                policies[static_cast<int>(Role::Decode)] = {-4, 0, big};
+                policies[static_cast<int>(Role::Render)] = {-8, 0, big};
+                policies[static_cast<int>(Role::Background)] = {10, 0, 0};
+                break;
+            case Preset::Efficiency:
+                policies[static_cast<int>(Role::Decode)] = {0, 0, little};
+                policies[static_cast<int>(Role::Render)] = {-4, 0, little};
+                policies[static_cast<int>(Role::Analysis)] = {10, 0, little};
+                policies[static_cast<int>(Role::Background)] = {10, 0, little};
+                break;
+            case Preset::Balanced:
+                policies[static_cast<int>(Role::Decode)] = {-2, 0, 0};
+                policies[static_cast<int>(Role::Render)] = {-8, 0, big};
+                policies[static_cast<int>(Role::Analysis)] = {10, 0, little};
+                policies[static_cast<int>(Role::Background)] = {10, 0, little};
+                break;
+            case Preset::Default:
+            default:
+                break;
+        }
+        for (int i = 0; i < ROLE_COUNT; i++) {
+            setPolicy(static_cast<Role>(i), policies[i]);
+        }
+        LOGI("线程调度预设: %s", presetName(preset));
+    }
+
+    uint64_t bigCoreMask() {
+        return topology().big;
+    }
+
+    uint64_t littleCoreMask() {
+        return topology().little;
+    }
+
+    std::string describe() {
+        Registry &state = registry();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        std::string result;
+        for (int i = 0; i < ROLE_COUNT; i++) {
+            const Policy &policy = state.policies[i];
+            int threadCount = 0;
+            for (const auto &thread: state.threads) {
+                threadCount += static_cast<int>(thread.first) == i;
+            }
+            char line[160];
+            if (policy.realtimePriority > 0) {
+                snprintf(line, sizeof(line), "%s: fifo %d", ROLE_NAMES[i], policy.realtimePriority);
+            } else {
+                snprintf(line, sizeof(line), "%s: nice %d", ROLE_NAMES[i], policy.nice);
+            }
+            result += line;
+            if (policy.cpuMask != 0) {
+                snprintf(line, sizeof(line), ", cpus 0x%" PRIx64, policy.cpuMask);
+                result += line;
+            }
+            snprintf(line, sizeof(line), ", %d thread%s", threadCount, threadCount == 1 ? "" : "s");
+            result += line;
+            if (i + 1 < ROLE_COUNT) {
+                result += "; ";
+            }
+        }
+        return result;
+    }
+
+    ScopedThread::ScopedThread(Role role) : role_(role), tid_(currentThreadId()) {
+#if defined(__linux__)
+        // 系统线程名最长 15 个字符
+        char name[16];
+        snprintf(name, sizeof(name), "vp-%s", roleName(role));
+        pthread_setname_np(pthread_self(), name);
+#endif
+        Registry &state = registry();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.threads.emplace_back(role_, tid_);
+        if (state.configured[static_cast<int>(role_)]) {
+            applyToThread(tid_, role_, state.policies[static_cast<int>(role_)]);
+        }
+    }
+
+    ScopedThread::~ScopedThread() {
+        Registry &state = registry();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (auto it = state.threads.begin(); it != state.threads.end(); ++it) {
+            if (it->first == role_ && it->second == tid_) {
+                state.threads.erase(it);
+                break;
+            }
+        }
+    }
+
+}  // namespace scheduling
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""ABR 测试用的本地限速 HTTP 服务器。
+
+generate 用本机 ffmpeg 生成 240p/480p/720p 三个变体的 HLS（master.m3u8），
+serve 以共享带宽提供该目录，带宽按时间表变化，模拟链路拥塞和恢复：
+
+    python3 abr_test_server.py generate /tmp/abr
+    python3 abr_test_server.py serve /tmp/abr --schedule 6000:0,800:20,3000:40
+    pipeline_bench http://127.0.0.1:8000/master.m3u8 --paced --abr
+
+--schedule 为逗号分隔的 "带宽kbps:开始秒"，从服务器启动时开始计时。
+"""
+
+import argparse
+import functools
+import http.server
+import os
+import subprocess
+import sys
+import threading
+import time
+
+CHUNK_SIZE = 16 * 1024
+
+VARIANTS = [
+    # (宽, 高, 码率)
+    (426, 240, "400k"),
+    (854, 480, "1200k"),
+    (1280, 720, "3000k"),
+]
+
+
+def generate(output_dir, duration):
+    os.makedirs(output_dir, exist_ok=True)
+    split = "".join(f"[v{i}]" for i in range(len(VARIANTS)))
+    filters = [f"[0:v]split={len(VARIANTS)}{split}"]
+    for i, (width, height, _) in enumerate(VARIANTS):
+        filters.append(f"[v{i}]scale={width}:{height}[out{i}]")
+    command = ["ffmpeg", "-y", "-f", "lavfi", "-i",
+               f"testsrc2=size=1280x720:rate=30:duration={duration}",
+               "-filter_complex", ";".join(filters)]
+    for i, (_, _, bitrate) in enumerate(VARIANTS):
+        command += ["-map", f"[out{i}]", f"-c:v:{i}", "libx264", f"-b:v:{i}", bitrate,
+                    f"-maxrate:v:{i}", bitrate, f"-bufsize:v:{i}", bitrate]
+    # 固定 GOP，保证每个分片都从关键帧开始，变体之间分片边界对齐
+    command += ["-g", "60", "-keyint_min", "60", "-sc_threshold", "0",
+                "-f", "hls", "-hls_time", "2", "-hls_playlist_type", "vod",
+                "-hls_segment_filename", os.path.join(output_dir, "v%v_%03d.ts"),
+                "-master_pl_name", "master.m3u8",
+                "-var_stream_map", " ".join(f"v:{i}" for i in range(len(VARIANTS))),
+                os.path.join(output_dir, "v%v.m3u8")]
+    subprocess.run(command, check=True)
+
+
+class Link:
+    """所有连接共享的带宽，模拟一条瓶颈链路"""
+
+    def __init__(self, schedule):
+        self.schedule = sorted(schedule, key=lambda entry: entry[1])
+        self.start = time.monotonic()
+        self.lock = threading.Lock()
+        self.next_free = self.start
+
+    def rate_bytes_per_sec(self):
+        elapsed = time.monotonic() - self.start
+        rate = self.schedule[0][0]
+        for kbps, begin in self.schedule:
+            if elapsed >= begin:
+                rate = kbps
+        return rate * 1000 / 8
+
+    def reserve(self, size):
+        """返回这块数据可以发出前需要等待的秒数"""
+        with self.lock:
+            now = time.monotonic()
+            begin = max(now, self.next_free)
+            self.next_free = begin + size / self.rate_bytes_per_sec()
+            return self.next_free - now
+
+
+class ThrottledHandler(http.server.SimpleHTTPRequestHandler):
+    link = None
+
+    def copyfile(self, source, outputfile):
+        while True:
+            chunk = source.read(CHUNK_SIZE)
+            if not chunk:
+                break
+            delay = self.link.reserve(len(chunk))
+            if delay > 0:
+                time.sleep(delay)
+            outputfile.write(chunk)
+
+    def log_message(self, format, *args):
+        rate = self.link.rate_bytes_per_sec() * 8 / 1000
+        sys.stderr.write(f"[{rate:.0f} kbps] {format % args}\n")
+
+
+def parse_schedule(text):
+    schedule = []
+    for entry in text.split(","):
+        kbps, begin = entry.split(":")
+        schedule.append((float(kbps), float(begin)))
+    return schedule
+
+
+def serve(directory, port, schedule):
+    ThrottledHandler.link = Link(schedule)
+    handler = functools.partial(ThrottledHandler, directory=directory)
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", port), handler)
+    print(f"serving {directory} on http://127.0.0.1:{port}/ schedule={schedule}")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    generate_parser = commands.add_parser("generate")
+    generate_parser.add_argument("directory")
+    generate_parser.add_argument("--duration", type=int, default=60)
+
+    serve_parser = commands.add_parser("serve")
+    serve_parser.add_argument("directory")
+    serve_parser.add_argument("--port", type=int, default=8000)
+    serve_parser.add_argument("--schedule", default="6000:0,800:20,3000:40")
+
+    args = parser.parse_args()
+    if args.command == "generate":
+        generate(args.directory, args.duration)
+    else:
+        serve(args.directory, args.port, parse_schedule(args.schedule))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,268 @@
+// 线程版管线与协程版管线的资源对比：同时播放 N 路，比较线程数和上下文切换次数。
+// 用法: async_bench <input> [--players N] [--workers W] [--mode threads|coroutines|both]
+//                   [--paced] [--seconds S] [--decoder-threads T]
+//
+// threads 模式用现有的 player.cpp（全局单实例）：fork N 个子进程各播放一路，线程数为各子进程
+// /proc/<pid>/status 中 Threads 之和的峰值，上下文切换取自 getrusage(RUSAGE_CHILDREN)。
+// coroutines 模式在本进程里创建 N 个 AsyncPipeline，共享 W 个工作线程（默认 2），线程数为
+// /proc/self/status 的峰值（含主线程），上下文切换取自 getrusage(RUSAGE_SELF)。
+// 两边的线程数都包括解码器内部的线程：线程版使用 FFmpeg 的默认设置，协程版由
+// --decoder-threads 决定（默认 1，解码直接在工作线程上进行）。
+// --paced 按播放时钟输出 S 秒（默认 10），late 为晚于理想时间半帧以上的帧数；
+// 不加时以最快速度跑完整个文件，fps 为所有路合计的吞吐
+
+#define LOG_TAG "AsyncBench"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "async_executor.h"
+#include "async_pipeline.h"
+#include "metrics.h"
+#include "player.h"
+#include "video_sink.h"
+
+namespace {
+
+    struct BenchResult {
+        int peakThreads = 0;
+        long voluntarySwitches = 0;
+        long involuntarySwitches = 0;
+        uint64_t frames = 0;
+        uint64_t lateFrames = 0;
+        double seconds = 0;
+    };
+
+    // 子进程通过管道报告的结果
+    struct ChildReport {
+        uint64_t frames;
+        uint64_t lateFrames;
+    };
+
+    int readThreadCount(const char *statusPath) {
+        FILE *file = fopen(statusPath, "r");
+        if (!file) {
+            return 0;
+        }
+        char line[256];
+        int threads = 0;
+        while (fgets(line, sizeof(line), file)) {
+            if (sscanf(line, "Threads: %d", &threads) == 1) {
+                break;
+            }
+        }
+        fclose(file);
+        return threads;
+    }
+
+    double elapsedSince(std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    // 子进程：用现有的线程版管线播放一路
+    [[noreturn]] void runThreadedChild(const char *input, bool paced, double seconds, int reportFd) {
+        ChildReport report = {0, 0};
+        auto sink = std::make_shared<NullSink>();
+        if (initDecoder(input)) {
+            setPullMode(false);
+            setPacingEnabled(paced);
+            auto begin = std::chrono::steady_clock::now();
+            if (startDecoding(sink)) {
+                while (!isPlaybackFinished() && (!paced || elapsedSince(begin) < seconds)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+                stopDecoding();
+            }
+            releaseDecoder();
+            report.frames = sink->framesRendered();
+            report.lateFrames = static_cast<uint64_t>(metrics::counter("present.lateFrames").get());
+        }
+        ssize_t written = write(reportFd, &report, sizeof(report));
+        _exit(written == sizeof(report) ? 0 : 1);
+    }
+
+    bool runThreaded(const char *input, int players, bool paced, double seconds, BenchResult *result) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return false;
+        }
+        fflush(stdout);
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<pid_t> children;
+        for (int i = 0; i < players; i++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(fds[0]);
+                runThreadedChild(input, paced, seconds, fds[1]);
+            }
+            if (pid > 0) {
+                children.push_back(pid);
+            }
+        }
+        close(fds[1]);
+
+        std::vector<bool> exited(children.size(), false);
+        size_t remaining = children.size();
+        while (remaining > 0) {
+            int threads = 0;
+            for (size_t i = 0; i < children.size(); i++) {
+                if (exited[i]) {
+                    continue;
+                }
+                char path[64];
+                snprintf(path, sizeof(path), "/proc/%d/status", children[i]);
+                threads += readThreadCount(path);
+                if (waitpid(children[i], nullptr, WNOHANG) == children[i]) {
+                    exited[i] = true;
+                    remaining--;
+                }
+            }
+            result->peakThreads = std::max(result->peakThreads, threads);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        result->seconds = elapsedSince(begin);
+
+        ChildReport report;
+        while (read(fds[0], &report, sizeof(report)) == sizeof(report)) {
+            result->frames += report.frames;
+            result->lateFrames += report.lateFrames;
+        }
+        close(fds[0]);
+        rusage usage = {};
+        getrusage(RUSAGE_CHILDREN, &usage);
+        result->voluntarySwitches = usage.ru_nvcsw;
+        result->involuntarySwitches = usage.ru_nivcsw;
+        return true;
+    }
+
+    bool runCoroutines(const char *input, int players, int workers, int decoderThreads, bool paced,
+                       double seconds, BenchResult *result) {
+        rusage before = {};
+        getrusage(RUSAGE_SELF, &before);
+        auto begin = std::chrono::steady_clock::now();
+        {
+            async::Executor executor(workers);
+            AsyncPipelineOptions options;
+            options.paced = paced;
+            options.decoderThreads = decoderThreads;
+            std::vector<std::unique_ptr<AsyncPipeline>> pipelines;
+            for (int i = 0; i < players; i++) {
+                auto pipeline = std::make_unique<AsyncPipeline>(executor, std::make_shared<NullSink>());
+                if (!pipeline->open(input, options)) {
+                    return false;
+                }
+                pipelines.push_back(std::move(pipeline));
+            }
+            for (auto &pipeline: pipelines) {
+                pipeline->start();
+            }
+            while (!paced || elapsedSince(begin) < seconds) {
+                result->peakThreads = std::max(result->peakThreads, readThreadCount("/proc/self/status"));
+                bool allFinished = true;
+                for (auto &pipeline: pipelines) {
+                    allFinished = allFinished && pipeline->finished();
+                }
+                if (allFinished) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            for (auto &pipeline: pipelines) {
+                pipeline->stop();
+                result->frames += pipeline->framesPresented();
+                result->lateFrames += pipeline->lateFrames();
+            }
+            result->seconds = elapsedSince(begin);
+        }
+        rusage after = {};
+        getrusage(RUSAGE_SELF, &after);
+        result->voluntarySwitches = after.ru_nvcsw - before.ru_nvcsw;
+        result->involuntarySwitches = after.ru_nivcsw - before.ru_nivcsw;
+        return true;
+    }
+
+    void printResult(const char *mode, int players, const BenchResult &result) {
+        printf("%-11s %7d %8d %12ld %12ld %9llu %10.1f %8llu\n", mode, players, result.peakThreads,
+               result.voluntarySwitches, result.involuntarySwitches,
+               static_cast<unsigned long long>(result.frames),
+               result.seconds > 0 ? static_cast<double>(result.frames) / result.seconds : 0,
+               static_cast<unsigned long long>(result.lateFrames));
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr,
+                "usage: %s <input> [--players N] [--workers W] [--mode threads|coroutines|both]"
+                " [--paced] [--seconds S] [--decoder-threads T]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *input = argv[1];
+    int players = 4;
+    int workers = 2;
+    const char *mode = "both";
+    bool paced = false;
+    double seconds = 10;
+    int decoderThreads = 1;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            players = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            mode = argv[++i];
+        } else if (strcmp(argv[i], "--paced") == 0) {
+            paced = true;
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--decoder-threads") == 0 && i + 1 < argc) {
+            decoderThreads = std::max(0, atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    bool runThreads = strcmp(mode, "threads") == 0 || strcmp(mode, "both") == 0;
+    bool runCoroutine = strcmp(mode, "coroutines") == 0 || strcmp(mode, "both") == 0;
+    if (!runThreads && !runCoroutine) {
+        fprintf(stderr, "unknown mode: %s\n", mode);
+        return 1;
+    }
+
+    printf("input:      %s%s\n", input, paced ? " (paced)" : "");
+    printf("%-11s %7s %8s %12s %12s %9s %10s %8s\n", "mode", "players", "threads", "voluntary cs",
+           "forced cs", "frames", "fps", "late");
+    // 先跑 fork 的一边，子进程不会继承协程版的工作线程
+    if (runThreads) {
+        BenchResult result;
+        if (!runThreaded(input, players, paced, seconds, &result)) {
+            return 1;
+        }
+        printResult("threads", players, result);
+    }
+    if (runCoroutine) {
+        BenchResult result;
+        if (!runCoroutines(input, players, workers, decoderThreads, paced, seconds, &result)) {
+            return 1;
+        }
+        printResult("coroutines", players, result);
+        printf("            %d workers, %d decoder thread%s per player, %lld resumes, %lld timer waits\n",
+               workers, decoderThreads, decoderThreads == 1 ? "" : "s",
+               static_cast<long long>(metrics::counter("async.resumes").get()),
+               static_cast<long long>(metrics::counter("async.timerWaits").get()));
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+// 片段导出工具：与 App 内相同的 ClipExporter，在主机上检查切点和导出速度。
+// 用法: clip_export <input> <output.mp4|output.mkv> [--start SECONDS] [--end SECONDS] [--accurate]
+//
+// 结束后打印用时、写入字节数和吞吐（MB/s），以及重新编码的帧数。流复制时吞吐应接近磁盘读写速度，
+// CPU 时间远小于墙钟时间；--accurate 只多出开头一个 GOP 的解码和编码。可以用 corpus_gen 生成的
+// long / bframes GOP 文件检查切点，例如：
+//   corpus_gen corpus --gops long,bframes --containers mp4,mkv --duration 20
+//   clip_export corpus/1080p_30fps_yuv420p_bframes.mp4 clip.mp4 --start 3.3 --end 8 --accurate
+//   ffprobe -show_frames clip.mp4   （第一帧应为 3.3s 处的画面）
+
+#define LOG_TAG "ClipExport"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "clip_exporter.h"
+#include "metrics.h"
+
+static ClipExporter *g_exporter = nullptr;
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <input> <output> [--start SECONDS] [--end SECONDS] [--accurate]\n", argv[0]);
+        return 1;
+    }
+
+    ClipExportOptions options;
+    options.inputPath = argv[1];
+    options.outputPath = argv[2];
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            options.startUs = static_cast<int64_t>(atof(argv[++i]) * AV_TIME_BASE);
+        } else if (strcmp(argv[i], "--end") == 0 && i + 1 < argc) {
+            options.endUs = static_cast<int64_t>(atof(argv[++i]) * AV_TIME_BASE);
+        } else if (strcmp(argv[i], "--accurate") == 0) {
+            options.accurateStart = true;
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    ClipExporter exporter;
+    g_exporter = &exporter;
+    signal(SIGINT, [](int) {
+        if (g_exporter) {
+            g_exporter->cancel();
+        }
+    });
+
+    int64_t startedAt = av_gettime_relative();
+    clock_t cpuStart = clock();
+    exporter.start(options, [](double fraction) {
+        fprintf(stderr, "\r%3d%%", static_cast<int>(fraction * 100));
+    });
+    ClipExporter::State state = exporter.wait();
+    fprintf(stderr, "\n");
+    g_exporter = nullptr;
+
+    if (state != ClipExporter::State::Finished) {
+        fprintf(stderr, "export %s: %s\n", state == ClipExporter::State::Cancelled ? "cancelled" : "failed",
+                exporter.error().c_str());
+        return 1;
+    }
+    double seconds = static_cast<double>(av_gettime_relative() - startedAt) / AV_TIME_BASE;
+    double cpuSeconds = static_cast<double>(clock() - cpuStart) / CLOCKS_PER_SEC;
+    int64_t bytes = metrics::counter("export.bytes").get();
+    printf("time:       %.3fs wall, %.3fs cpu\n", seconds, cpuSeconds);
+    printf("written:    %lld bytes in %lld packets, %.1f MB/s\n", static_cast<long long>(bytes),
+           static_cast<long long>(metrics::counter("export.packets").get()),
+           seconds > 0 ? bytes / seconds / (1024 * 1024) : 0.0);
+    printf("reencoded:  %lld frames\n", static_cast<long long>(metrics::counter("export.reencodedFrames").get()));
+    return 0;
+}
@@ -0,0 +1,433 @@
+// 合成测试媒体生成器：用我们已经依赖的 libavcodec 编码器和 libavformat 封装器生成确定性的测试流，
+// 让基准和回归检查不再依赖某台手机上的 test1.mp4。同样的参数和 FFmpeg 版本每次生成逐字节相同的文件
+// （单线程编码、BITEXACT 标志、画面只由帧序号决定）。
+// 用法: corpus_gen <output dir> [--full] [--resolutions LIST] [--fps LIST] [--formats LIST]
+//                  [--gops LIST] [--containers LIST] [--duration SECONDS] [--encoder NAME]
+//
+// 矩阵的每个维度都可以用逗号分隔的列表指定：
+//   --resolutions  240p,360p,480p,720p,1080p,1440p,2160p,4320p
+//   --fps          24,25,30,50,60,120
+//   --formats      yuv420p,nv12,yuv420p10le
+//   --gops         intra（全 I 帧）,long（长 GOP，无 B 帧）,bframes（长 GOP + 2 个 B 帧）
+//   --containers   mp4,mkv,ts
+// 默认只生成一个小矩阵（360p/720p/1080p × 30fps × 各像素格式 × 各 GOP × mp4），--full 生成全部组合。
+// 编码器按 libx264、libx265、mpeg4、mpeg2video 的顺序选第一个支持该像素格式的，--encoder 可指定；
+// 没有编码器支持的组合跳过并在最后列出。
+//
+// 输出目录下每个文件名为 <分辨率>_<帧率>fps_<像素格式>_<GOP>.<扩展名>，另有 manifest.json 列出
+// 每个文件的参数，golden_check 和 pipeline_bench 直接使用这个目录：
+//   corpus_gen corpus && golden_check corpus --golden golden --update
+
+#define LOG_TAG "CorpusGen"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "ffmpeg_headers.h"
+
+namespace {
+
+    struct Resolution {
+        const char *name;
+        int width;
+        int height;
+    };
+
+    const Resolution RESOLUTIONS[] = {
+            {"240p",  426,  240},
+            {"360p",  640,  360},
+            {"480p",  854,  480},
+            {"720p",  1280, 720},
+            {"1080p", 1920, 1080},
+            {"1440p", 2560, 1440},
+            {"2160p", 3840, 2160},
+            {"4320p", 7680, 4320},
+    };
+
+    const int FRAME_RATES[] = {24, 25, 30, 50, 60, 120};
+
+    const AVPixelFormat PIXEL_FORMATS[] = {AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P10LE};
+
+    struct Gop {
+        const char *name;
+        int gopSize;      // 以帧为单位，0 表示长 GOP（10 秒一个关键帧）
+        int maxBFrames;
+    };
+
+    const Gop GOPS[] = {
+            {"intra",   1, 0},
+            {"long",    0, 0},
+            {"bframes", 0, 2},
+    };
+
+    struct Container {
+        const char *name;       // 命令行和扩展名
+        const char *muxer;
+    };
+
+    const Container CONTAINERS[] = {
+            {"mp4", "mp4"},
+            {"mkv", "matroska"},
+            {"ts",  "mpegts"},
+    };
+
+    const char *const ENCODER_PREFERENCE[] = {"libx264", "libx265", "mpeg4", "mpeg2video"};
+
+    struct Spec {
+        Resolution resolution;
+        int fps;
+        AVPixelFormat format;
+        Gop gop;
+        Container container;
+    };
+
+    struct Options {
+        std::string outputDir;
+        std::vector<Resolution> resolutions;
+        std::vector<int> frameRates;
+        std::vector<AVPixelFormat> formats;
+        std::vector<Gop> gops;
+        std::vector<Container> containers;
+        double duration = 2.0;
+        const char *encoder = nullptr;
+    };
+
+    std::vector<std::string> splitList(const char *text) {
+        std::vector<std::string> items;
+        std::string current;
+        for (const char *p = text;; p++) {
+            if (*p == ',' || *p == '\0') {
+                if (!current.empty()) {
+                    items.push_back(current);
+                }
+                current.clear();
+                if (*p == '\0') {
+                    break;
+                }
+            } else {
+                current += *p;
+            }
+        }
+        return items;
+    }
+
+    // 按名字从候选表中选出列表里的项，名字无法识别时返回 false
+    template<typename T, size_t N, typename NameOf>
+    bool selectByName(const char *list, const T (&table)[N], NameOf nameOf, std::vector<T> *out) {
+        out->clear();
+        for (const auto &name: splitList(list)) {
+            bool found = false;
+            for (const auto &item: table) {
+                if (name == nameOf(item)) {
+                    out->push_back(item);
+                    found = true;
+                }
+            }
+            if (!found) {
+                fprintf(stderr, "unknown value: %s\n", name.c_str());
+                return false;
+            }
+        }
+        return !out->empty();
+    }
+
+    bool supportsFormat(const AVCodec *codec, AVPixelFormat format) {
+        const AVPixelFormat *formats = nullptr;
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+        const void *configs = nullptr;
+        if (avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_PIX_FORMAT, 0,
+                                         &configs, nullptr) < 0) {
+            return false;
+        }
+        formats = static_cast<const AVPixelFormat *>(configs);
+#else
+        formats = codec->pix_fmts;
+#endif
+        if (!formats) {
+            return false;
+        }
+        for (; *formats != AV_PIX_FMT_NONE; formats++) {
+            if (*formats == format) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const AVCodec *findEncoder(const Options &options, AVPixelFormat format) {
+        if (options.encoder) {
+            const AVCodec *codec = avcodec_find_encoder_by_name(options.encoder);
+            return codec && supportsFormat(codec, format) ? codec : nullptr;
+        }
+        for (const char *name: ENCODER_PREFERENCE) {
+            const AVCodec *codec = avcodec_find_encoder_by_name(name);
+            if (codec && supportsFormat(codec, format)) {
+                return codec;
+            }
+        }
+        return nullptr;
+    }
+
+    // 确定性的测试画面：随帧移动的对角渐变加一个匀速移动的方块，给编码器同时提供平滑区域、
+    // 边缘和运动。样点值按格式的位深缩放，任意平面布局都通过 av_write_image_line2 写入
+    void fillFrame(AVFrame *frame, int64_t index, std::vector<uint16_t> &line) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+        int boxSize = std::max(8, frame->height / 6);
+        int boxX = static_cast<int>((index * 7) % std::max(1, frame->width - boxSize));
+        int boxY = static_cast<int>((index * 3) % std::max(1, frame->height - boxSize));
+        for (int c = 0; c < desc->nb_components; c++) {
+            bool chroma = c == 1 || c == 2;
+            int shiftX = chroma ? desc->log2_chroma_w : 0;
+            int shiftY = chroma ? desc->log2_chroma_h : 0;
+            int width = AV_CEIL_RSHIFT(frame->width, shiftX);
+            int height = AV_CEIL_RSHIFT(frame->height, shiftY);
+            int depth = desc->comp[c].depth;
+            int maxValue = (1 << depth) - 1;
+            line.resize(static_cast<size_t>(width));
+            for (int y = 0; y < height; y++) {
+                int fullY = y << shiftY;
+                for (int x = 0; x < width; x++) {
+                    int fullX = x << shiftX;
+                    bool inBox = fullX >= boxX && fullX < boxX + boxSize &&
+                                 fullY >= boxY && fullY < boxY + boxSize;
+                    int value;
+                    if (!chroma) {
+                        value = inBox ? 235 : 16 + (fullX + fullY + static_cast<int>(index * 2)) % 220;
+                    } else {
+                        value = inBox ? (c == 1 ? 90 : 240) : 128 + ((c == 1 ? fullX : fullY) * 64 /
+                                                                    std::max(1, frame->width)) - 32;
+                    }
+                    line[x] = static_cast<uint16_t>((value << (depth - 8)) & maxValue);
+                }
+                av_write_image_line2(line.data(), frame->data, frame->linesize, desc, 0, y, c, width, 2);
+            }
+        }
+    }
+
+    bool encodeAndWrite(AVCodecContext *codecContext, AVFrame *frame, AVPacket *packet,
+                        AVFormatContext *formatContext, AVStream *stream) {
+        if (avcodec_send_frame(codecContext, frame) < 0) {
+            return false;
+        }
+        while (true) {
+            int ret = avcodec_receive_packet(codecContext, packet);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return true;
+            }
+            if (ret < 0) {
+                return false;
+            }
+            av_packet_rescale_ts(packet, codecContext->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+            if (av_interleaved_write_frame(formatContext, packet) < 0) {
+                return false;
+            }
+        }
+    }
+
+    bool generate(const Spec &spec, const AVCodec *encoder, const Options &options,
+                  const std::string &path) {
+        AVFormatContext *formatContext = nullptr;
+        if (avformat_alloc_output_context2(&formatContext, nullptr, spec.container.muxer,
+                                           path.c_str()) < 0) {
+            return false;
+        }
+        formatContext->flags |= AVFMT_FLAG_BITEXACT;
+        AVStream *stream = avformat_new_stream(formatContext, nullptr);
+        AVCodecContext *codecContext = avcodec_alloc_context3(encoder);
+        AVFrame *frame = av_frame_alloc();
+        AVPacket *packet = av_packet_alloc();
+        bool ok = stream && codecContext && frame && packet;
+
+        if (ok) {
+            codecContext->width = spec.resolution.width;
+            codecContext->height = spec.resolution.height;
+            codecContext->pix_fmt = spec.format;
+            codecContext->time_base = {1, spec.fps};
+            codecContext->framerate = {spec.fps, 1};
+            codecContext->gop_size = spec.gop.gopSize > 0 ? spec.gop.gopSize : spec.fps * 10;
+            codecContext->max_b_frames = spec.gop.maxBFrames;
+            // 约 0.1 bit/像素，足够看清画面又不会让 8K 文件过大
+            codecContext->bit_rate = static_cast<int64_t>(spec.resolution.width) *
+                                     spec.resolution.height * spec.fps / 10;
+            codecContext->thread_count = 1;
+            codecContext->flags |= AV_CODEC_FLAG_BITEXACT;
+            if (formatContext->oformat->flags & AVFMT_GLOBALHEADER) {
+                codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+            AVDictionary *encoderOptions = nullptr;
+            if (strcmp(encoder->name, "libx264") == 0 || strcmp(encoder->name, "libx265") == 0) {
+                av_dict_set(&encoderOptions, "preset", "veryfast", 0);
+            }
+            ok = avcodec_open2(codecContext, encoder, &encoderOptions) >= 0;
+            av_dict_free(&encoderOptions);
+        }
+        if (ok) {
+            ok = avcodec_parameters_from_context(stream->codecpar, codecContext) >= 0;
+            stream->time_base = codecContext->time_base;
+            stream->avg_frame_rate = codecContext->framerate;
+        }
+        if (ok && !(formatContext->oformat->flags & AVFMT_NOFILE)) {
+            ok = avio_open(&formatContext->pb, path.c_str(), AVIO_FLAG_WRITE) >= 0;
+        }
+        bool headerWritten = ok && avformat_write_header(formatContext, nullptr) >= 0;
+        ok = headerWritten;
+
+        if (ok) {
+            frame->width = codecContext->width;
+            frame->height = codecContext->height;
+            frame->format = codecContext->pix_fmt;
+            ok = av_frame_get_buffer(frame, 0) >= 0;
+        }
+        std::vector<uint16_t> line;
+        auto frameCount = static_cast<int64_t>(options.duration * spec.fps);
+        for (int64_t i = 0; ok && i < frameCount; i++) {
+            ok = av_frame_make_writable(frame) >= 0;
+            if (ok) {
+                fillFrame(frame, i, line);
+                frame->pts = i;
+                ok = encodeAndWrite(codecContext, frame, packet, formatContext, stream);
+            }
+        }
+        if (ok) {
+            ok = encodeAndWrite(codecContext, nullptr, packet, formatContext, stream);
+        }
+        if (headerWritten) {
+            ok = av_write_trailer(formatContext) >= 0 && ok;
+        }
+
+        if (formatContext->pb && !(formatContext->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&formatContext->pb);
+        }
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&codecContext);
+        avformat_free_context(formatContext);
+        if (!ok) {
+            remove(path.c_str());
+        }
+        return ok;
+    }
+
+    void appendManifestEntry(std::string &manifest, const std::string &file, const Spec &spec,
+                             const AVCodec *encoder) {
+        char entry[512];
+        snprintf(entry, sizeof(entry),
+                 "%s\n    {\"file\": \"%s\", \"width\": %d, \"height\": %d, \"fps\": %d,"
+                 " \"pixelFormat\": \"%s\", \"gop\": \"%s\", \"container\": \"%s\", \"encoder\": \"%s\"}",
+                 manifest.empty() ? "" : ",", file.c_str(), spec.resolution.width, spec.resolution.height,
+                 spec.fps, av_get_pix_fmt_name(spec.format), spec.gop.name, spec.container.name,
+                 encoder->name);
+        manifest += entry;
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        fprintf(stderr,
+                "usage: %s <output dir> [--full] [--resolutions LIST] [--fps LIST] [--formats LIST]"
+                " [--gops LIST] [--containers LIST] [--duration SECONDS] [--encoder NAME]\n",
+                argv[0]);
+        return 1;
+    }
+
+    Options options;
+    options.outputDir = argv[1];
+    options.resolutions = {RESOLUTIONS[1], RESOLUTIONS[3], RESOLUTIONS[4]};
+    options.frameRates = {30};
+    options.formats.assign(std::begin(PIXEL_FORMATS), std::end(PIXEL_FORMATS));
+    options.gops.assign(std::begin(GOPS), std::end(GOPS));
+    options.containers = {CONTAINERS[0]};
+    for (int i = 2; i < argc; i++) {
+        bool ok = true;
+        if (strcmp(argv[i], "--full") == 0) {
+            options.resolutions.assign(std::begin(RESOLUTIONS), std::end(RESOLUTIONS));
+            options.frameRates.assign(std::begin(FRAME_RATES), std::end(FRAME_RATES));
+            options.containers.assign(std::begin(CONTAINERS), std::end(CONTAINERS));
+        } else if (strcmp(argv[i], "--resolutions") == 0 && i + 1 < argc) {
+            ok = selectByName(argv[++i], RESOLUTIONS, [](const Resolution &r) { return std::string(r.name); },
+                              &options.resolutions);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            options.frameRates.clear();
+            for (const auto &value: splitList(argv[++i])) {
+                options.frameRates.push_back(atoi(value.c_str()));
+                ok = ok && options.frameRates.back() > 0;
+            }
+        } else if (strcmp(argv[i], "--formats") == 0 && i + 1 < argc) {
+            ok = selectByName(argv[++i], PIXEL_FORMATS,
+                              [](AVPixelFormat f) { return std::string(av_get_pix_fmt_name(f)); },
+                              &options.formats);
+        } else if (strcmp(argv[i], "--gops") == 0 && i + 1 < argc) {
+            ok = selectByName(argv[++i], GOPS, [](const Gop &g) { return std::string(g.name); },
+                              &options.gops);
+        } else if (strcmp(argv[i], "--containers") == 0 && i + 1 < argc) {
+            ok = selectByName(argv[++i], CONTAINERS, [](const Container &c) { return std::string(c.name); },
+                              &options.containers);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            options.duration = atof(argv[++i]);
+            ok = options.duration > 0;
+        } else if (strcmp(argv[i], "--encoder") == 0 && i + 1 < argc) {
+            options.encoder = argv[++i];
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+        if (!ok) {
+            fprintf(stderr, "invalid value for %s\n", argv[i - 1]);
+            return 1;
+        }
+    }
+
+    mkdir(options.outputDir.c_str(), 0755);
+    std::string manifest;
+    std::vector<std::string> skipped;
+    int failed = 0;
+    for (const auto &resolution: options.resolutions) {
+        for (int fps: options.frameRates) {
+            for (AVPixelFormat format: options.formats) {
+                const AVCodec *encoder = findEncoder(options, format);
+                for (const auto &gop: options.gops) {
+                    for (const auto &container: options.containers) {
+                        Spec spec{resolution, fps, format, gop, container};
+                        char file[128];
+                        snprintf(file, sizeof(file), "%s_%dfps_%s_%s.%s", resolution.name, fps,
+                                 av_get_pix_fmt_name(format), gop.name, container.name);
+                        if (!encoder) {
+                            skipped.emplace_back(file);
+                            continue;
+                        }
+                        std::string path = options.outputDir + "/" + file;
+                        if (generate(spec, encoder, options, path)) {
+                            printf("wrote  %s (%s)\n", file, encoder->name);
+                            appendManifestEntry(manifest, file, spec, encoder);
+                        } else {
+                            printf("FAILED %s (%s)\n", file, encoder->name);
+                            failed++;
+                        }
+                        fflush(stdout);
+                    }
+                }
+            }
+        }
+    }
+
+    std::string manifestPath = options.outputDir + "/manifest.json";
+    FILE *manifestFile = fopen(manifestPath.c_str(), "w");
+    if (manifestFile) {
+        fprintf(manifestFile, "{\n  \"duration\": %.3f,\n  \"files\": [%s\n  ]\n}\n", options.duration,
+                manifest.c_str());
+        fclose(manifestFile);
+    }
+    for (const auto &file: skipped) {
+        printf("skipped %s (no encoder for this pixel format)\n", file.c_str());
+    }
+    printf("%d failed, %zu skipped\n", failed, skipped.size());
+    return failed == 0 ? 0 : 1;
+}
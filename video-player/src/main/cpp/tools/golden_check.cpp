@@ -0,0 +1,278 @@
+// 黄金帧回归检查：在主机上解码一组媒体文件，对交给输出端的每帧字节（与 JNI 回调复制出的数据相同）
+// 逐平面计算 MD5，和保存的黄金文件逐帧比较；同一次运行里检查解码速度和每帧复制次数是否退化。
+// 用法: golden_check <input|dir>... --golden DIR [--update] [--fps-margin F]
+//                    [--target WxH [--downscale-threshold F]] [--tag NAME]
+//
+// 输入可以是文件或目录（目录下的普通文件按名字排序逐个检查）。每个输入在 DIR 下有两个文件：
+//   <name>[.<tag>].md5   每行一帧: <序号> <pts> <宽>x<高> <像素格式> <平面0 MD5>[,<平面1 MD5>...]
+//   <name>[.<tag>].perf  min_fps <最低帧率>
+//                        max_copies_per_frame <每帧最多复制次数>
+// --update 用本次结果重写黄金文件：min_fps 取本次帧率乘以 (1 - F)（默认 F = 0.25，留出机器波动），
+// max_copies_per_frame 取本次的值。修改复制、转换路径后不加 --update 运行，输出逐帧相同
+// 且性能不低于阈值时退出码为 0；任何不一致都会列出并返回 1。
+// --target 在降分辨率路径下检查，黄金文件按 --tag 区分，例如：
+//   golden_check corpus --golden golden --target 640x360 --tag 360p
+
+#define LOG_TAG "GoldenCheck"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+#include "player.h"
+#include "video_sink.h"
+
+namespace {
+
+    const int MAX_REPORTED_MISMATCHES = 10;
+
+    struct Options {
+        std::string goldenDir;
+        std::string tag;
+        bool update = false;
+        double fpsMargin = 0.25;
+        int targetWidth = 0;
+        int targetHeight = 0;
+        double downscaleThreshold = 2.0;
+    };
+
+    struct Thresholds {
+        double minFps = 0;
+        double maxCopiesPerFrame = 0;
+    };
+
+    struct RunResult {
+        std::vector<ChecksumSink::FrameChecksum> frames;
+        double fps = 0;
+        double copiesPerFrame = 0;
+    };
+
+    bool isDirectory(const std::string &path) {
+        struct stat info{};
+        return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
+    // 目录展开为其中的普通文件（按名字排序），文件原样保留
+    std::vector<std::string> expandInputs(const std::vector<std::string> &paths) {
+        std::vector<std::string> inputs;
+        for (const auto &path: paths) {
+            if (!isDirectory(path)) {
+                inputs.push_back(path);
+                continue;
+            }
+            DIR *dir = opendir(path.c_str());
+            if (!dir) {
+                continue;
+            }
+            std::vector<std::string> files;
+            while (dirent *entry = readdir(dir)) {
+                std::string file = path + "/" + entry->d_name;
+                struct stat info{};
+                // corpus_gen 的 manifest.json 等描述文件不是媒体
+                std::string name = entry->d_name;
+                bool manifest = name.size() > 5 && name.compare(name.size() - 5, 5, ".json") == 0;
+                if (name[0] != '.' && !manifest && stat(file.c_str(), &info) == 0 &&
+                    S_ISREG(info.st_mode)) {
+                    files.push_back(file);
+                }
+            }
+            closedir(dir);
+            std::sort(files.begin(), files.end());
+            inputs.insert(inputs.end(), files.begin(), files.end());
+        }
+        return inputs;
+    }
+
+    std::string goldenPath(const Options &options, const std::string &input, const char *suffix) {
+        std::string name = input.substr(input.find_last_of('/') + 1);
+        if (!options.tag.empty()) {
+            name += "." + options.tag;
+        }
+        return options.goldenDir + "/" + name + suffix;
+    }
+
+    std::string formatFrame(size_t index, const ChecksumSink::FrameChecksum &frame) {
+        const char *format = av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame.format));
+        std::ostringstream line;
+        line << index << ' ' << (frame.pts == AV_NOPTS_VALUE ? -1 : frame.pts) << ' '
+             << frame.width << 'x' << frame.height << ' ' << (format ? format : "unknown") << ' ';
+        for (size_t i = 0; i < frame.planes.size(); i++) {
+            line << (i > 0 ? "," : "") << frame.planes[i];
+        }
+        return line.str();
+    }
+
+    // 以最快速度解码整个文件，返回交给输出端的每帧校验和及性能数据
+    bool decodeOnce(const Options &options, const std::string &input, RunResult *result) {
+        auto sink = std::make_shared<ChecksumSink>();
+        metrics::resetAll();
+        setDownscaleThreshold(options.downscaleThreshold);
+        setTargetSurfaceSize(options.targetWidth, options.targetHeight);
+        setPullMode(false);
+        setPacingEnabled(false);
+        if (!initDecoder(input.c_str())) {
+            return false;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        if (!startDecoding(sink)) {
+            releaseDecoder();
+            return false;
+        }
+        while (!isPlaybackFinished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        releaseDecoder();
+
+        result->frames = sink->takeChecksums();
+        auto frames = static_cast<double>(result->frames.size());
+        result->fps = seconds > 0 ? frames / seconds : 0;
+        result->copiesPerFrame = frames > 0
+                                 ? static_cast<double>(metrics::counter("pipeline.frameCopies").get()) / frames
+                                 : 0;
+        return true;
+    }
+
+    bool writeGolden(const Options &options, const std::string &input, const RunResult &run) {
+        std::ofstream md5(goldenPath(options, input, ".md5"));
+        for (size_t i = 0; i < run.frames.size(); i++) {
+            md5 << formatFrame(i, run.frames[i]) << '\n';
+        }
+        std::ofstream perf(goldenPath(options, input, ".perf"));
+        perf << "min_fps " << run.fps * (1.0 - options.fpsMargin) << '\n'
+             << "max_copies_per_frame " << run.copiesPerFrame << '\n';
+        return md5.good() && perf.good();
+    }
+
+    bool readThresholds(const std::string &path, Thresholds *thresholds) {
+        std::ifstream perf(path);
+        if (!perf) {
+            return false;
+        }
+        std::string key;
+        double value = 0;
+        while (perf >> key >> value) {
+            if (key == "min_fps") {
+                thresholds->minFps = value;
+            } else if (key == "max_copies_per_frame") {
+                thresholds->maxCopiesPerFrame = value;
+            }
+        }
+        return true;
+    }
+
+    // 逐帧比较校验和并检查性能阈值，返回发现的问题数
+    int compareGolden(const Options &options, const std::string &input, const RunResult &run) {
+        std::ifstream md5(goldenPath(options, input, ".md5"));
+        Thresholds thresholds;
+        if (!md5 || !readThresholds(goldenPath(options, input, ".perf"), &thresholds)) {
+            fprintf(stderr, "  missing golden files for %s (run with --update)\n", input.c_str());
+            return 1;
+        }
+
+        std::vector<std::string> expected;
+        for (std::string line; std::getline(md5, line);) {
+            expected.push_back(line);
+        }
+
+        int failures = 0;
+        for (size_t i = 0; i < std::min(expected.size(), run.frames.size()); i++) {
+            std::string actual = formatFrame(i, run.frames[i]);
+            if (actual != expected[i]) {
+                if (failures < MAX_REPORTED_MISMATCHES) {
+                    fprintf(stderr, "  frame mismatch\n    expected: %s\n    actual:   %s\n",
+                            expected[i].c_str(), actual.c_str());
+                }
+                failures++;
+            }
+        }
+        if (expected.size() != run.frames.size()) {
+            fprintf(stderr, "  frame count: expected %zu, got %zu\n", expected.size(), run.frames.size());
+            failures++;
+        }
+
+        if (run.fps < thresholds.minFps) {
+            fprintf(stderr, "  decode speed regressed: %.1f fps < %.1f fps\n", run.fps, thresholds.minFps);
+            failures++;
+        }
+        // 复制次数是整数比值，留一点浮点误差
+        if (run.copiesPerFrame > thresholds.maxCopiesPerFrame + 1e-6) {
+            fprintf(stderr, "  copies per frame regressed: %.3f > %.3f\n", run.copiesPerFrame,
+                    thresholds.maxCopiesPerFrame);
+            failures++;
+        }
+        return failures;
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            options.goldenDir = argv[++i];
+        } else if (strcmp(argv[i], "--update") == 0) {
+            options.update = true;
+        } else if (strcmp(argv[i], "--fps-margin") == 0 && i + 1 < argc) {
+            options.fpsMargin = std::max(0.0, std::min(atof(argv[++i]), 1.0));
+        } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.targetWidth, &options.targetHeight) != 2) {
+                fprintf(stderr, "invalid target size: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--downscale-threshold") == 0 && i + 1 < argc) {
+            options.downscaleThreshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--tag") == 0 && i + 1 < argc) {
+            options.tag = argv[++i];
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+    std::vector<std::string> inputs = expandInputs(paths);
+    if (inputs.empty() || options.goldenDir.empty()) {
+        fprintf(stderr,
+                "usage: %s <input|dir>... --golden DIR [--update] [--fps-margin F]"
+                " [--target WxH [--downscale-threshold F]] [--tag NAME]\n",
+                argv[0]);
+        return 1;
+    }
+    if (options.update) {
+        mkdir(options.goldenDir.c_str(), 0755);
+    }
+
+    int failedInputs = 0;
+    for (const auto &input: inputs) {
+        RunResult run;
+        if (!decodeOnce(options, input, &run)) {
+            printf("FAIL   %s (cannot decode)\n", input.c_str());
+            failedInputs++;
+            continue;
+        }
+        if (options.update) {
+            bool written = writeGolden(options, input, run);
+            printf("%s %s: %zu frames, %.1f fps, %.2f copies/frame\n", written ? "UPDATE" : "FAIL  ",
+                   input.c_str(), run.frames.size(), run.fps, run.copiesPerFrame);
+            failedInputs += written ? 0 : 1;
+            continue;
+        }
+        int failures = compareGolden(options, input, run);
+        printf("%s %s: %zu frames, %.1f fps, %.2f copies/frame\n", failures == 0 ? "PASS  " : "FAIL  ",
+               input.c_str(), run.frames.size(), run.fps, run.copiesPerFrame);
+        failedInputs += failures == 0 ? 0 : 1;
+    }
+    printf("%zu inputs, %d failed\n", inputs.size(), failedInputs);
+    return failedInputs == 0 ? 0 : 1;
+}
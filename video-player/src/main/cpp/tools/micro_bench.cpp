@@ -0,0 +1,653 @@
+// 原生热路径微基准：每次改动热循环前后各跑一次，用 JSON 结果对比。
+// 用法: micro_bench [--filter SUBSTR] [--min-time SECONDS] [--json FILE]
+//
+// 覆盖的场景：
+//   frame/*       av_frame_clone、av_frame_ref 与 FramePool 池化分配的开销
+//   copy/*        av_image_copy_to_buffer、逐行 memcpy 与 NEON/SSE2 复制，360p ~ 4K 的 YUV420P
+//   depth/*       10 位转 8 位：BitDepthConverter（yuv420p10le / p010le 到 YUV420P / NV12，有无抖动）
+//                 与同样转换走 sws_scale（SWS_POINT，不做缩放）的对比，1080p 与 4K
+//   queue/*       帧队列（mutex + condition_variable，容量 8）在 1/2/4 个生产者下的推入/取出
+//   jni/*         NewDirectByteBuffer + CallVoidMethod 经过桩 JVM 的调用开销（需要 jni.h，
+//                 主机上找到 JNI 头文件时编译进来），只包含函数表间接调用和参数传递
+//   time/*        FFmpegContext::getFormattedTime
+//   sleep/*       av_usleep、wait_for（相对时长）与 wait_until / sleep_until（绝对截止时间）
+//                 醒来的精度，计数器 overshootMeanUs / overshootP99Us / overshootMaxUs
+//
+// 输出格式与 Google Benchmark 的 --benchmark_format=json 相同（context + benchmarks，
+// 时间单位 ns，附加计数器放在每一项里），可以直接用它的 compare.py 对比两次结果：
+//   micro_bench --json before.json   （改动前）
+//   micro_bench --json after.json    （改动后）
+//   compare.py benchmarks before.json after.json
+
+#define LOG_TAG "MicroBench"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef VP_HAVE_JNI
+#include <jni.h>
+#endif
+
+#include "bit_depth.h"
+#include "frame_pool.h"
+#include "player.h"
+
+namespace {
+
+    // 一次运行的状态：基准函数循环 iterations() 次，可以附加计数器
+    class State {
+    public:
+        explicit State(int64_t iterations) : iterations_(iterations) {}
+
+        int64_t iterations() const { return iterations_; }
+
+        void setBytesProcessed(int64_t bytes) { bytesProcessed_ = bytes; }
+
+        int64_t bytesProcessed() const { return bytesProcessed_; }
+
+        std::map<std::string, double> counters;
+
+    private:
+        int64_t iterations_;
+        int64_t bytesProcessed_ = 0;
+    };
+
+    struct Benchmark {
+        std::string name;
+        std::function<void(State &)> run;
+        int64_t fixedIterations = 0;  // 非 0 时不自动增加迭代次数（如睡眠精度）
+    };
+
+    struct Result {
+        std::string name;
+        int64_t iterations = 0;
+        double realNs = 0;
+        double cpuNs = 0;
+        int64_t bytesProcessed = 0;
+        std::map<std::string, double> counters;
+    };
+
+    std::vector<Benchmark> &registry() {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    void registerBenchmark(const std::string &name, std::function<void(State &)> run,
+                           int64_t fixedIterations = 0) {
+        registry().push_back({name, std::move(run), fixedIterations});
+    }
+
+    double processCpuSeconds() {
+        timespec ts{};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+
+    // 迭代次数从 1 开始按 10 倍增加，直到一次运行超过 minTime，与 Google Benchmark 的策略相同
+    Result runBenchmark(const Benchmark &benchmark, double minTime) {
+        int64_t iterations = benchmark.fixedIterations > 0 ? benchmark.fixedIterations : 1;
+        while (true) {
+            State state(iterations);
+            double cpuBegin = processCpuSeconds();
+            auto begin = std::chrono::steady_clock::now();
+            benchmark.run(state);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            double cpuSeconds = processCpuSeconds() - cpuBegin;
+            if (benchmark.fixedIterations > 0 || seconds >= minTime || iterations >= 1000000000) {
+                Result result;
+                result.name = benchmark.name;
+                result.iterations = iterations;
+                result.realNs = seconds * 1e9 / static_cast<double>(iterations);
+                result.cpuNs = cpuSeconds * 1e9 / static_cast<double>(iterations);
+                result.bytesProcessed = state.bytesProcessed();
+                result.counters = state.counters;
+                if (result.bytesProcessed > 0 && seconds > 0) {
+                    result.counters["bytes_per_second"] = static_cast<double>(result.bytesProcessed) / seconds;
+                }
+                return result;
+            }
+            double scale = seconds > 0 ? std::min(10.0, std::max(1.5, minTime * 1.4 / seconds)) : 10.0;
+            iterations = static_cast<int64_t>(static_cast<double>(iterations) * scale) + 1;
+        }
+    }
+
+    // 防止编译器把结果优化掉
+    template<typename T>
+    void doNotOptimize(T const &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    struct Resolution {
+        const char *name;
+        int width;
+        int height;
+    };
+
+    const Resolution RESOLUTIONS[] = {
+            {"360p",  640,  360},
+            {"720p",  1280, 720},
+            {"1080p", 1920, 1080},
+            {"2160p", 3840, 2160},
+    };
+
+    AVFrame *makeFrame(int width, int height) {
+        AVFrame *frame = av_frame_alloc();
+        frame->width = width;
+        frame->height = height;
+        frame->format = AV_PIX_FMT_YUV420P;
+        if (av_frame_get_buffer(frame, 32) < 0) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+        for (int i = 0; i < 3; i++) {
+            int planeHeight = i == 0 ? height : (height + 1) / 2;
+            memset(frame->data[i], 0x40 + i, static_cast<size_t>(frame->linesize[i]) * planeHeight);
+        }
+        return frame;
+    }
+
+    // ---- frame/*：帧引用与分配 ----
+
+    void registerFrameBenchmarks() {
+        registerBenchmark("frame/av_frame_clone/1080p", [](State &state) {
+            AVFrame *source = makeFrame(1920, 1080);
+            for (int64_t i = 0; i < state.iterations(); i++) {
+                AVFrame *clone = av_frame_clone(source);
+                doNotOptimize(clone);
+                av_frame_free(&clone);
+            }
+            av_frame_free(&source);
+        });
+        registerBenchmark("frame/av_frame_ref/1080p", [](State &state) {
+            AVFrame *source = makeFrame(1920, 1080);
+            AVFrame *target = av_frame_alloc();
+            for (int64_t i = 0; i < state.iterations(); i++) {
+                av_frame_ref(target, source);
+                doNotOptimize(target->data[0]);
+                av_frame_unref(target);
+            }
+            av_frame_free(&target);
+            av_frame_free(&source);
+        });
+        registerBenchmark("frame/av_frame_get_buffer/1080p", [](State &state) {
+            for (int64_t i = 0; i < state.iterations(); i++) {
+                AVFrame *frame = av_frame_alloc();
+                frame->width = 1920;
+                frame->height = 1080;
+                frame->format = AV_PIX_FMT_YUV420P;
+                av_frame_get_buffer(frame, 32);
+                doNotOptimize(frame->data[0]);
+                av_frame_free(&frame);
+            }
+        });
+        registerBenchmark("frame/FramePool/1080p", [](State &state) {
+            FramePool pool;
+            for (int64_t i = 0; i < state.iterations(); i++) {
+                AVFrame *frame = pool.alloc(1920, 1080, AV_PIX_FMT_YUV420P);
+                doNotOptimize(frame->data[0]);
+                av_frame_free(&frame);
+            }
+        });
+    }
+
+    // ---- copy/*：整帧复制成紧密排列 ----
+
+    void copyRow(uint8_t *dst, const uint8_t *src, int width) {
+        int x = 0;
+#if defined(__ARM_NEON)
+        for (; x + 64 <= width; x += 64) {
+            uint8x16x4_t block = vld1q_u8_x4(src + x);
+            vst1q_u8_x4(dst + x, block);
+        }
+#elif defined(__SSE2__)
+        for (; x + 64 <= width; x += 64) {
+            auto in = reinterpret_cast<const __m128i *>(src + x);
+            auto out = reinterpret_cast<__m128i *>(dst + x);
+            __m128i a = _mm_loadu_si128(in);
+            __m128i b = _mm_loadu_si128(in + 1);
+            __m128i c = _mm_loadu_si128(in + 2);
+            __m128i d = _mm_loadu_si128(in + 3);
+            _mm_storeu_si128(out, a);
+            _mm_storeu_si128(out + 1, b);
+            _mm_storeu_si128(out + 2, c);
+            _mm_storeu_si128(out + 3, d);
+        }
+#endif
+        if (x < width) {
+            memcpy(dst + x, src + x, static_cast<size_t>(width - x));
+        }
+    }
+
+    // 与 av_image_copy_to_buffer(align = 1) 输出相同的布局，rowCopy 决定逐行复制的方式
+    template<typename RowCopy>
+    void packYuv420(const AVFrame *frame, uint8_t *dst, RowCopy rowCopy) {
+        for (int plane = 0; plane < 3; plane++) {
+            int width = plane == 0 ? frame->width : (frame->width + 1) / 2;
+            int height = plane == 0 ? frame->height : (frame->height + 1) / 2;
+            const uint8_t *src = frame->data[plane];
+            for (int y = 0; y < height; y++) {
+                rowCopy(dst, src, width);
+                dst += width;
+                src += frame->linesize[plane];
+            }
+        }
+    }
+
+    void registerCopyBenchmarks() {
+        for (const auto &resolution: RESOLUTIONS) {
+            int width = resolution.width;
+            int height = resolution.height;
+            auto run = [width, height](int method) {
+                return [width, height, method](State &state) {
+                    AVFrame *frame = makeFrame(width, height);
+                    int size = av_image_get_buffer_size(AV_PIX_FMT_YUV420P, width, height, 1);
+                    std::vector<uint8_t> buffer(static_cast<size_t>(size));
+                    for (int64_t i = 0; i < state.iterations(); i++) {
+                        if (method == 0) {
+                            av_image_copy_to_buffer(buffer.data(), size, frame->data, frame->linesize,
+                                                    AV_PIX_FMT_YUV420P, width, height, 1);
+                        } else if (method == 1) {
+                            packYuv420(frame, buffer.data(), [](uint8_t *dst, const uint8_t *src, int n) {
+                                memcpy(dst, src, static_cast<size_t>(n));
+                            });
+                        } else {
+                            packYuv420(frame, buffer.data(), copyRow);
+                        }
+                        doNotOptimize(buffer.data());
+                    }
+                    state.setBytesProcessed(state.iterations() * size);
+                    av_frame_free(&frame);
+                };
+            };
+            std::string suffix = std::string("/") + resolution.name;
+            registerBenchmark("copy/av_image_copy_to_buffer" + suffix, run(0));
+            registerBenchmark("copy/memcpy_rows" + suffix, run(1));
+            registerBenchmark("copy/simd_rows" + suffix, run(2));
+        }
+    }
+
+    // ---- depth/*：高位深转 8 位 ----
+
+    // 10 位测试帧：亮度是水平渐变，色度是常量，数值落在格式的有效位上
+    AVFrame *makeHighDepthFrame(int width, int height, AVPixelFormat format) {
+        AVFrame *frame = av_frame_alloc();
+        frame->width = width;
+        frame->height = height;
+        frame->format = format;
+        if (av_frame_get_buffer(frame, 32) < 0) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+        int shift = format == AV_PIX_FMT_P010LE ? 6 : 0;
+        for (int y = 0; y < height; y++) {
+            auto row = reinterpret_cast<uint16_t *>(frame->data[0] + y * frame->linesize[0]);
+            for (int x = 0; x < width; x++) {
+                row[x] = static_cast<uint16_t>((x * 1023 / width) << shift);
+            }
+        }
+        for (int plane = 1; plane < av_pix_fmt_count_planes(format); plane++) {
+            for (int y = 0; y < (height + 1) / 2; y++) {
+                auto row = reinterpret_cast<uint16_t *>(frame->data[plane] + y * frame->linesize[plane]);
+                for (int x = 0; x < frame->linesize[plane] / 2; x++) {
+                    row[x] = static_cast<uint16_t>((512 + plane) << shift);
+                }
+            }
+        }
+        return frame;
+    }
+
+    void registerDepthBenchmarks() {
+        struct Conversion {
+            const char *name;
+            AVPixelFormat source;
+            AVPixelFormat output;
+        };
+        const Conversion conversions[] = {
+                {"yuv420p10le_to_yuv420p", AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P},
+                {"yuv420p10le_to_nv12",    AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_NV12},
+                {"p010le_to_nv12",         AV_PIX_FMT_P010LE,      AV_PIX_FMT_NV12},
+                {"p010le_to_yuv420p",      AV_PIX_FMT_P010LE,      AV_PIX_FMT_YUV420P},
+        };
+        for (const auto &resolution: RESOLUTIONS) {
+            if (resolution.height < 1080) {
+                continue;
+            }
+            int width = resolution.width;
+            int height = resolution.height;
+            for (const auto &conversion: conversions) {
+                // method 0：BitDepthConverter，1：带抖动，2：sws_scale
+                auto run = [width, height, conversion](int method) {
+                    return [width, height, conversion, method](State &state) {
+                        AVFrame *source = makeHighDepthFrame(width, height, conversion.source);
+                        FramePool pool;
+                        AVFrame *dest = pool.alloc(width, height, conversion.output);
+                        SwsContext *sws = nullptr;
+                        if (method == 2) {
+                            sws = sws_getContext(width, height, conversion.source, width, height,
+                                                 conversion.output, SWS_POINT, nullptr, nullptr, nullptr);
+                        }
+                        for (int64_t i = 0; i < state.iterations(); i++) {
+                            if (sws) {
+                                sws_scale(sws, source->data, source->linesize, 0, height,
+                                          dest->data, dest->linesize);
+                            } else {
+                                BitDepthConverter::convertInto(source, dest, method == 1);
+                            }
+                            doNotOptimize(dest->data[0]);
+                        }
+                        // 按读入的字节数计吞吐：源帧每像素 2 字节
+                        state.setBytesProcessed(state.iterations() *
+                                                av_image_get_buffer_size(conversion.source, width, height, 1));
+                        sws_freeContext(sws);
+                        av_frame_free(&dest);
+                        av_frame_free(&source);
+                    };
+                };
+                std::string suffix = std::string("/") + conversion.name + "/" + resolution.name;
+                registerBenchmark("depth/simd" + suffix, run(0));
+                registerBenchmark("depth/simd_dither" + suffix, run(1));
+                registerBenchmark("depth/swscale" + suffix, run(2));
+            }
+        }
+    }
+
+    // ---- queue/*：与解码线程和渲染线程之间相同的有界队列 ----
+
+    void registerQueueBenchmarks() {
+        for (int producers: {1, 2, 4}) {
+            registerBenchmark("queue/push_pop/producers:" + std::to_string(producers), [producers](State &state) {
+                const size_t capacity = 8;
+                std::mutex mutex;
+                std::condition_variable cv;
+                std::queue<AVFrame *> queue;
+                int64_t perProducer = std::max<int64_t>(1, state.iterations() / producers);
+                int64_t total = perProducer * producers;
+
+                std::vector<std::thread> threads;
+                for (int p = 0; p < producers; p++) {
+                    threads.emplace_back([&, p]() {
+                        for (int64_t i = 0; i < perProducer; i++) {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            cv.wait(lock, [&]() { return queue.size() < capacity; });
+                            queue.push(reinterpret_cast<AVFrame *>(static_cast<intptr_t>(p + 1)));
+                            cv.notify_all();
+                        }
+                    });
+                }
+                for (int64_t i = 0; i < total; i++) {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]() { return !queue.empty(); });
+                    doNotOptimize(queue.front());
+                    queue.pop();
+                    cv.notify_all();
+                }
+                for (auto &thread: threads) {
+                    thread.join();
+                }
+            });
+        }
+    }
+
+    // ---- jni/*：桩 JVM 上的回调开销 ----
+
+#ifdef VP_HAVE_JNI
+    uint8_t g_directBufferObject;
+
+    jobject JNICALL stubNewDirectByteBuffer(JNIEnv *, void *address, jlong capacity) {
+        doNotOptimize(address);
+        doNotOptimize(capacity);
+        return reinterpret_cast<jobject>(&g_directBufferObject);
+    }
+
+    void JNICALL stubCallVoidMethod(JNIEnv *, jobject obj, jmethodID method, ...) {
+        doNotOptimize(obj);
+        doNotOptimize(method);
+    }
+
+    void JNICALL stubDeleteLocalRef(JNIEnv *, jobject obj) {
+        doNotOptimize(obj);
+    }
+
+    void registerJniBenchmarks() {
+        registerBenchmark("jni/NewDirectByteBuffer+CallVoidMethod", [](State &state) {
+            JNINativeInterface_ functions{};
+            functions.NewDirectByteBuffer = stubNewDirectByteBuffer;
+            functions.CallVoidMethod = stubCallVoidMethod;
+            functions.DeleteLocalRef = stubDeleteLocalRef;
+            JNIEnv env{};
+            env.functions = &functions;
+            JNIEnv *envPointer = &env;
+            doNotOptimize(envPointer);
+
+            std::vector<uint8_t> buffer(1920 * 1080 * 3 / 2);
+            auto listener = reinterpret_cast<jobject>(buffer.data());
+            auto method = reinterpret_cast<jmethodID>(buffer.data() + 1);
+            // 与 JniCallbackSink::onFrame 的调用顺序相同
+            for (int64_t i = 0; i < state.iterations(); i++) {
+                jobject byteBuffer = envPointer->NewDirectByteBuffer(buffer.data(),
+                                                                     static_cast<jlong>(buffer.size()));
+                if (byteBuffer) {
+                    envPointer->CallVoidMethod(listener, method, byteBuffer);
+                    envPointer->DeleteLocalRef(byteBuffer);
+                }
+            }
+        });
+    }
+#else
+    void registerJniBenchmarks() {}
+#endif
+
+    // ---- time/* ----
+
+    void registerTimeBenchmarks() {
+        registerBenchmark("time/getFormattedTime", [](State &state) {
+            int64_t time = 0;
+            for (int64_t i = 0; i < state.iterations(); i++) {
+                std::string text = FFmpegContext::getFormattedTime(time);
+                doNotOptimize(text.data());
+                time += 33367;
+            }
+        });
+    }
+
+    // ---- sleep/*：醒来时间相对目标时间的偏差 ----
+
+    const int64_t SLEEP_INTERVAL_US = 2000;
+    const int64_t SLEEP_SAMPLES = 200;
+
+    // sleepUntil 睡到绝对时间 deadline（av_gettime_relative 微秒），返回醒来后的偏差统计
+    void measureSleep(State &state, const std::function<void(int64_t deadline)> &sleepUntil) {
+        std::vector<int64_t> overshoot;
+        overshoot.reserve(static_cast<size_t>(state.iterations()));
+        for (int64_t i = 0; i < state.iterations(); i++) {
+            int64_t deadline = av_gettime_relative() + SLEEP_INTERVAL_US;
+            sleepUntil(deadline);
+            overshoot.push_back(av_gettime_relative() - deadline);
+        }
+        std::sort(overshoot.begin(), overshoot.end());
+        double sum = 0;
+        for (int64_t value: overshoot) {
+            sum += static_cast<double>(value);
+        }
+        state.counters["overshootMeanUs"] = sum / static_cast<double>(overshoot.size());
+        state.counters["overshootP99Us"] = static_cast<double>(overshoot[overshoot.size() * 99 / 100]);
+        state.counters["overshootMaxUs"] = static_cast<double>(overshoot.back());
+    }
+
+    void registerSleepBenchmarks() {
+        // 相对时长：和旧的渲染线程一样按剩余时间睡眠
+        registerBenchmark("sleep/av_usleep", [](State &state) {
+            measureSleep(state, [](int64_t deadline) {
+                int64_t wait = deadline - av_gettime_relative();
+                if (wait > 0) {
+                    av_usleep(static_cast<unsigned>(wait));
+                }
+            });
+        }, SLEEP_SAMPLES);
+        registerBenchmark("sleep/cv_wait_for", [](State &state) {
+            std::mutex mutex;
+            std::condition_variable cv;
+            measureSleep(state, [&](int64_t deadline) {
+                std::unique_lock<std::mutex> lock(mutex);
+                int64_t wait = deadline - av_gettime_relative();
+                cv.wait_for(lock, std::chrono::microseconds(wait), []() { return false; });
+            });
+        }, SLEEP_SAMPLES);
+        // 绝对截止时间：被提前唤醒或调度延迟后不会累积误差
+        registerBenchmark("sleep/cv_wait_until", [](State &state) {
+            std::mutex mutex;
+            std::condition_variable cv;
+            measureSleep(state, [&](int64_t deadline) {
+                auto target = std::chrono::steady_clock::now() +
+                              std::chrono::microseconds(deadline - av_gettime_relative());
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait_until(lock, target, []() { return false; });
+            });
+        }, SLEEP_SAMPLES);
+        registerBenchmark("sleep/sleep_until", [](State &state) {
+            measureSleep(state, [](int64_t deadline) {
+                auto target = std::chrono::steady_clock::now() +
+                              std::chrono::microseconds(deadline - av_gettime_relative());
+                std::this_thread::sleep_until(target);
+            });
+        }, SLEEP_SAMPLES);
+    }
+
+    void appendJsonString(std::string &out, const std::string &text) {
+        out += '"';
+        for (char c: text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+
+    std::string toJson(const std::vector<Result> &results) {
+        char date[64];
+        time_t now = time(nullptr);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+        std::string out = "{\n  \"context\": {\n    \"date\": ";
+        appendJsonString(out, date);
+        out += ",\n    \"num_cpus\": " + std::to_string(std::thread::hardware_concurrency());
+#if defined(__ARM_NEON)
+        out += ",\n    \"simd\": \"neon\"";
+#elif defined(__SSE2__)
+        out += ",\n    \"simd\": \"sse2\"";
+#else
+        out += ",\n    \"simd\": \"none\"";
+#endif
+        out += ",\n    \"library_build_type\": ";
+#ifdef NDEBUG
+        out += "\"release\"";
+#else
+        out += "\"debug\"";
+#endif
+        out += "\n  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result &result = results[i];
+            char number[64];
+            out += i > 0 ? ",\n    {" : "\n    {";
+            out += "\n      \"name\": ";
+            appendJsonString(out, result.name);
+            out += ",\n      \"run_name\": ";
+            appendJsonString(out, result.name);
+            out += ",\n      \"run_type\": \"iteration\"";
+            out += ",\n      \"iterations\": " + std::to_string(result.iterations);
+            snprintf(number, sizeof(number), "%.3f", result.realNs);
+            out += ",\n      \"real_time\": " + std::string(number);
+            snprintf(number, sizeof(number), "%.3f", result.cpuNs);
+            out += ",\n      \"cpu_time\": " + std::string(number);
+            out += ",\n      \"time_unit\": \"ns\"";
+            for (const auto &counter: result.counters) {
+                snprintf(number, sizeof(number), "%.3f", counter.second);
+                out += ",\n      ";
+                appendJsonString(out, counter.first);
+                out += ": " + std::string(number);
+            }
+            out += "\n    }";
+        }
+        out += "\n  ]\n}\n";
+        return out;
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const char *filter = "";
+    const char *jsonPath = nullptr;
+    double minTime = 0.5;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTime = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--filter SUBSTR] [--min-time SECONDS] [--json FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    registerFrameBenchmarks();
+    registerCopyBenchmarks();
+    registerDepthBenchmarks();
+    registerQueueBenchmarks();
+    registerJniBenchmarks();
+    registerTimeBenchmarks();
+    registerSleepBenchmarks();
+
+    std::vector<Result> results;
+    printf("%-48s %14s %14s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+    for (const auto &benchmark: registry()) {
+        if (!strstr(benchmark.name.c_str(), filter)) {
+            continue;
+        }
+        Result result = runBenchmark(benchmark, minTime);
+        printf("%-48s %14.1f %14.1f %12lld", result.name.c_str(), result.realNs, result.cpuNs,
+               static_cast<long long>(result.iterations));
+        for (const auto &counter: result.counters) {
+            if (counter.first == "bytes_per_second") {
+                printf(" %.2fGiB/s", counter.second / (1024.0 * 1024 * 1024));
+            } else {
+                printf(" %s=%.1f", counter.first.c_str(), counter.second);
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+        results.push_back(std::move(result));
+    }
+
+    if (jsonPath) {
+        FILE *file = fopen(jsonPath, "w");
+        if (!file) {
+            fprintf(stderr, "cannot write %s\n", jsonPath);
+            return 1;
+        }
+        std::string json = toJson(results);
+        fwrite(json.data(), 1, json.size(), file);
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,315 @@
+// 主机管线吞吐测试：用 null / memory 输出端不经过显示，以最快速度跑完整个解码和输出流程。
+// 用法: pipeline_bench <input> [--sink null|memory] [--paced] [--live [--mailbox N]] [--abr]
+//                      [--cache DIR [--cache-mb N]] [--memory-budget-mb N]
+//                      [--target WxH [--downscale-threshold F]] [--roi X,Y,WxH[:WxH]]
+//                      [--prefer-codec LIST] [--keep-streams] [--vsync HZ[:JITTER_US]]
+//                      [--detect-changes TILE[:THRESHOLD]] [--bitdepth yuv420p|nv12[:dither]]
+//                      [--scenes THRESHOLD] [--subscribers N[:DELAY_US]]
+//
+// --live 以低延迟直播模式打开输入，可用本机 ffmpeg 作为替身服务器测试，例如：
+//   HTTP-FLV: ffmpeg -re -f lavfi -i testsrc2=size=1280x720:rate=30 -c:v libx264 -tune zerolatency
+//                    -f flv -listen 1 http://127.0.0.1:8080/live.flv
+//             pipeline_bench http://127.0.0.1:8080/live.flv --live
+//   RTSP:     用 mediamtx 等本地 RTSP 服务器，ffmpeg -re ... -f rtsp rtsp://127.0.0.1:8554/live 推流后
+//             pipeline_bench rtsp://127.0.0.1:8554/live --live --mailbox 1
+// 直播输入没有结尾，按 Ctrl+C 结束；丢帧数见输出中的 live.droppedFrames
+//
+// --abr 对 HLS master / DASH 输入启用自适应码率，配合 tools/abr_test_server.py 的限速服务器：
+//   python3 abr_test_server.py generate /tmp/abr
+//   python3 abr_test_server.py serve /tmp/abr --schedule 6000:0,800:20,3000:40
+//   pipeline_bench http://127.0.0.1:8000/master.m3u8 --paced --abr
+// 切换次数和吞吐估计见输出中的 abr.*
+//
+// --cache 为网络输入启用磁盘缓存，同一命令运行两次，第二次的 cache.hitRatioPercent /
+// cache.bytesSaved 即缓存效果
+//
+// --memory-budget-mb 设置管线内存硬预算，各分类的当前/峰值见 memory.*，
+// memory.budgetWaits 为解码线程因预算而等待的次数
+//
+// --target 模拟显示表面大小，源分辨率达到它的 F 倍（默认 2）以上时在解码端降分辨率。
+// 与 --sink memory 一起运行并和不加 --target 的结果对比，downscale.savedBytesPerFrame
+// 为每帧少复制的字节数，lowres 级数见 downscale.lowres
+//
+// --roi 只输出帧中的一个区域（坐标相对于降分辨率后的帧），冒号后可指定缩放到的尺寸，
+// 例如 --roi 640,360,640x360 或 --roi 0,0,960x540:480x270。与 --sink memory 一起运行，
+// 输出中的 MB/s 与可见面积成正比，roi.visiblePercent 为最近一帧的可见比例
+//
+// 默认只读视频流，其余流在解复用器中丢弃；--keep-streams 恢复读取所有流，在多音轨/字幕文件上
+// 对比两次的 demux 一行（主输入读取的字节数和速率）和 demux.unusedPackets。
+// --prefer-codec 在有多个视频流时按编码名顺序选择，如 --prefer-codec hevc,h264
+//
+// --paced 按播放时钟输出时额外打印 present 一行：呈现误差（实际交付时间 - PTS 得出的理想时间）的
+// 平均值、最大值和抖动，晚半帧以上的帧数，以及重复/跳过的帧和节奏中断次数；误差直方图见 present.error.*
+//
+// --vsync 用模拟的 vsync 时钟源驱动渲染线程（隐含 --paced），可选给 tick 时间戳加 ±JITTER_US 的抖动，
+// 例如 24fps 文件 --vsync 60 应得到稳定的 3:2 节奏（cadence breaks 为 0），--vsync 60:2000 检查
+// 抖动下节奏是否仍然稳定；vsync.periodUs 为估计出的周期，vsync.missedTicks 为漏掉的 tick
+//
+// --detect-changes 开启静态帧检测（TILE 为块大小，0 表示整帧比较；THRESHOLD 为每像素平均差上限），
+// 在屏幕录制、幻灯片类输入上运行，changes 一行为没变的帧数和省掉的输出字节比例。
+// 推送的输出端按整帧更新，部分变化的帧只在拉模式的 GL 上传中节省
+//
+// --bitdepth 选择 10/12 位输入（HEVC Main10）转成的 8 位格式，加 :dither 开启有序抖动；
+// 与不加时对比 fps 和 bitdepth.frames，单独的转换吞吐见 micro_bench --filter depth/
+//
+// --scenes 开启场景切换检测（THRESHOLD 为 0 ~ 100 的得分阈值，常用 10），scenes 一行为切换点数、
+// 每帧分析耗时和分析线程来不及而跳过的帧数，之后列出每个切换点的时间和得分。
+// 与不加时对比 fps，分析在自己的线程上，不应拖慢解码
+//
+// --subscribers 在显示之外再订阅 N 个帧消费者，每个消费者处理一帧用 DELAY_US 微秒（模拟分析模型、录制器），
+// fanout 一行为各订阅者取走、丢弃的帧数和最后的落后时间。与不加时对比 fps：再慢的订阅者也只会自己丢帧
+
+#define LOG_TAG "PipelineBench"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "media_cache.h"
+#include "memory_budget.h"
+#include "metrics.h"
+#include "player.h"
+#include "video_sink.h"
+
+static std::atomic<bool> g_interrupted(false);
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr,
+                "usage: %s <input> [--sink null|memory] [--paced] [--live [--mailbox N]] [--abr]"
+                " [--cache DIR [--cache-mb N]] [--memory-budget-mb N]"
+                " [--target WxH [--downscale-threshold F]] [--roi X,Y,WxH[:WxH]]"
+                " [--prefer-codec LIST] [--keep-streams] [--vsync HZ[:JITTER_US]]"
+                " [--detect-changes TILE[:THRESHOLD]] [--bitdepth yuv420p|nv12[:dither]]"
+                " [--scenes THRESHOLD] [--subscribers N[:DELAY_US]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *input = argv[1];
+    const char *sinkName = "null";
+    bool paced = false;
+    bool live = false;
+    bool abr = false;
+    const char *cacheDir = nullptr;
+    int64_t cacheMegabytes = 256;
+    int64_t memoryBudgetMegabytes = 0;
+    int mailboxSize = 2;
+    int targetWidth = 0;
+    int targetHeight = 0;
+    double downscaleThreshold = 2.0;
+    RegionOfInterest region;
+    const char *preferredCodecs = "";
+    bool keepStreams = false;
+    double vsyncHz = 0;
+    long long vsyncJitterUs = 0;
+    int changeTileSize = -1;
+    int changeThreshold = 0;
+    AVPixelFormat depthOutput = AV_PIX_FMT_YUV420P;
+    bool depthDither = false;
+    double sceneThreshold = -1;
+    int subscriberCount = 0;
+    long long subscriberDelayUs = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--sink") == 0 && i + 1 < argc) {
+            sinkName = argv[++i];
+        } else if (strcmp(argv[i], "--paced") == 0) {
+            paced = true;
+        } else if (strcmp(argv[i], "--live") == 0) {
+            live = true;
+        } else if (strcmp(argv[i], "--mailbox") == 0 && i + 1 < argc) {
+            mailboxSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--abr") == 0) {
+            abr = true;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (strcmp(argv[i], "--cache-mb") == 0 && i + 1 < argc) {
+            cacheMegabytes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--memory-budget-mb") == 0 && i + 1 < argc) {
+            memoryBudgetMegabytes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &targetWidth, &targetHeight) != 2) {
+                fprintf(stderr, "invalid target size: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--downscale-threshold") == 0 && i + 1 < argc) {
+            downscaleThreshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--prefer-codec") == 0 && i + 1 < argc) {
+            preferredCodecs = argv[++i];
+        } else if (strcmp(argv[i], "--keep-streams") == 0) {
+            keepStreams = true;
+        } else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%lf:%lld", &vsyncHz, &vsyncJitterUs) < 1 || vsyncHz <= 0) {
+                fprintf(stderr, "invalid vsync rate: %s\n", argv[i]);
+                return 1;
+            }
+            paced = true;
+        } else if (strcmp(argv[i], "--detect-changes") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d:%d", &changeTileSize, &changeThreshold) < 1 || changeTileSize < 0) {
+                fprintf(stderr, "invalid tile size: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scenes") == 0 && i + 1 < argc) {
+            sceneThreshold = atof(argv[++i]);
+            if (sceneThreshold < 0) {
+                fprintf(stderr, "invalid scene threshold: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--subscribers") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d:%lld", &subscriberCount, &subscriberDelayUs) < 1 || subscriberCount < 0) {
+                fprintf(stderr, "invalid subscribers: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--bitdepth") == 0 && i + 1 < argc) {
+            const char *value = argv[++i];
+            const char *colon = strchr(value, ':');
+            std::string name = colon ? std::string(value, colon - value) : std::string(value);
+            depthOutput = av_get_pix_fmt(name.c_str());
+            depthDither = colon && strcmp(colon + 1, "dither") == 0;
+            if (depthOutput != AV_PIX_FMT_YUV420P && depthOutput != AV_PIX_FMT_NV12) {
+                fprintf(stderr, "invalid bit depth output: %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--roi") == 0 && i + 1 < argc) {
+            int fields = sscanf(argv[++i], "%d,%d,%dx%d:%dx%d", &region.x, &region.y,
+                                &region.width, &region.height,
+                                &region.outputWidth, &region.outputHeight);
+            if (fields != 4 && fields != 6) {
+                fprintf(stderr, "invalid region: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::shared_ptr<VideoSink> sink;
+    if (strcmp(sinkName, "null") == 0) {
+        sink = std::make_shared<NullSink>();
+    } else if (strcmp(sinkName, "memory") == 0) {
+        sink = std::make_shared<MemorySink>();
+    } else {
+        fprintf(stderr, "unknown sink: %s\n", sinkName);
+        return 1;
+    }
+
+    setLiveMode(live, mailboxSize);
+    setAbrEnabled(abr);
+    setDownscaleThreshold(downscaleThreshold);
+    setTargetSurfaceSize(targetWidth, targetHeight);
+    setRegionOfInterest(region);
+    setFrameChangeDetection(changeTileSize >= 0, changeTileSize, changeThreshold);
+    setHighBitDepthOutput(depthOutput, depthDither);
+    setSceneDetection(sceneThreshold >= 0, sceneThreshold);
+    setPreferredVideoCodecs(preferredCodecs);
+    setDiscardUnusedStreams(!keepStreams);
+    memory::setBudget(memoryBudgetMegabytes * 1024 * 1024);
+    if (cacheDir && !MediaCache::instance().configure(cacheDir, cacheMegabytes * 1024 * 1024)) {
+        return 1;
+    }
+    if (!initDecoder(input)) {
+        return 1;
+    }
+    int width = ffmpegContext->outputWidth;
+    int height = ffmpegContext->outputHeight;
+
+    setPullMode(false);
+    setPacingEnabled(paced);
+    setVsyncDriven(vsyncHz > 0);
+    SimulatedVsyncTicker ticker(vsyncScheduler(), vsyncHz, vsyncJitterUs);
+    if (vsyncHz > 0) {
+        ticker.start();
+    }
+    std::vector<std::shared_ptr<FrameSubscriber>> subscribers;
+    std::vector<std::thread> consumers;
+    std::atomic<bool> consuming(true);
+    for (int i = 0; i < subscriberCount; i++) {
+        subscribers.push_back(frameFanout().subscribe("bench" + std::to_string(i)));
+    }
+    for (const auto &subscriber: subscribers) {
+        consumers.emplace_back([&consuming, subscriber, subscriberDelayUs]() {
+            while (consuming) {
+                AVFrame *frame = subscriber->pop(10000);
+                if (frame && subscriberDelayUs > 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(subscriberDelayUs));
+                }
+                av_frame_free(&frame);
+            }
+        });
+    }
+    auto begin = std::chrono::steady_clock::now();
+    if (!startDecoding(sink)) {
+        releaseDecoder();
+        return 1;
+    }
+    signal(SIGINT, [](int) { g_interrupted = true; });
+    while (!isPlaybackFinished() && !g_interrupted) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    stopDecoding();
+    ticker.stop();
+    consuming = false;
+    for (std::thread &consumer: consumers) {
+        consumer.join();
+    }
+    releaseDecoder();
+
+    double fps = seconds > 0 ? static_cast<double>(sink->framesRendered()) / seconds : 0;
+    double megabytesPerSecond = seconds > 0
+                                ? static_cast<double>(sink->bytesRendered()) / seconds / (1024 * 1024)
+                                : 0;
+    printf("input:      %s (%dx%d)\n", input, width, height);
+    printf("sink:       %s%s%s%s%s\n", sink->name(), paced ? " (paced)" : "", live ? " (live)" : "",
+           abr ? " (abr)" : "", vsyncHz > 0 ? " (vsync)" : "");
+    printf("frames:     %llu\n", static_cast<unsigned long long>(sink->framesRendered()));
+    printf("elapsed:    %.3f s\n", seconds);
+    printf("throughput: %.1f fps, %.1f MiB/s\n", fps, megabytesPerSecond);
+    if (paced && !live) {
+        auto value = [](const char *name) {
+            return static_cast<long long>(metrics::counter(name).get());
+        };
+        printf("present:    error mean %lld us, max %lld us, jitter %lld us; late %lld/%lld,"
+               " repeated %lld, skipped %lld, cadence breaks %lld\n",
+               value("present.errorMeanUs"), value("present.errorMaxUs"), value("present.jitterUs"),
+               value("present.lateFrames"), value("present.frames"), value("present.repeatedFrames"),
+               value("present.skippedFrames"), value("present.cadenceBreaks"));
+    }
+    if (changeTileSize >= 0) {
+        auto value = [](const char *name) {
+            return static_cast<long long>(metrics::counter(name).get());
+        };
+        printf("changes:    unchanged %lld/%lld, partial %lld, skipped %lld%% of output bytes\n",
+               value("change.unchangedFrames"), value("change.frames"), value("change.partialFrames"),
+               value("change.skippedPercent"));
+    }
+    if (sceneThreshold >= 0) {
+        std::vector<SceneCut> cuts = takeSceneCuts();
+        printf("scenes:     %zu cuts, %lldus/frame over %lld frames, %lld skipped\n", cuts.size(),
+               static_cast<long long>(metrics::counter("scene.microsPerFrame").get()),
+               static_cast<long long>(metrics::counter("scene.frames").get()),
+               static_cast<long long>(metrics::counter("scene.droppedFrames").get()));
+        for (const SceneCut &cut: cuts) {
+            printf("            %10.3fs  score %.1f\n", cut.ptsUs / 1e6, cut.score);
+        }
+    }
+    for (const auto &subscriber: subscribers) {
+        FrameSubscriber::Stats stats = subscriber->stats();
+        printf("fanout:     %s delivered %lld, dropped %lld, lag %lld us\n", subscriber->name().c_str(),
+               static_cast<long long>(stats.delivered), static_cast<long long>(stats.dropped),
+               static_cast<long long>(stats.lagUs));
+        frameFanout().unsubscribe(subscriber);
+    }
+    double demuxMegabytes = static_cast<double>(metrics::counter("demux.bytesRead").get()) / (1024 * 1024);
+    printf("demux:      %.1f MiB read, %.1f MiB/s%s\n", demuxMegabytes,
+           seconds > 0 ? demuxMegabytes / seconds : 0, keepStreams ? " (all streams)" : "");
+    printf("metrics:    %s\n", metrics::snapshotJson().c_str());
+    return 0;
+}
@@ -0,0 +1,248 @@
+// SIMD 行内核检查：把 row_kernels 里的每个内核与这里独立写的标量实现逐字节对比，
+// 覆盖 0 ~ 130 的各个宽度（SIMD 主循环加各种长度的标量尾部）、几个整行宽度，以及 0 ~ 3 个样本的
+// 非对齐起点。编译目标决定走哪条 SIMD 路径（NEON / AVX2 / SSE2），CMake 另外用 -mavx2
+// 编译一份 simd_check_avx2，默认的 x86_64 目标只有 SSE2，不这样 AVX2 分支没有任何构建会用到。
+// 用法: simd_check [--seed N]
+// 所有内核一致时退出码为 0；不一致时列出内核、宽度、起点和第一个不同的位置，返回 1
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "row_kernels.h"
+
+namespace {
+
+    const int MAX_REPORTED_MISMATCHES = 10;
+    const int MAX_OFFSET = 3;
+
+    std::vector<int> testWidths() {
+        std::vector<int> widths;
+        for (int width = 0; width <= 130; width++) {
+            widths.push_back(width);
+        }
+        for (int width: {255, 256, 257, 640, 959, 1920, 1921, 3840}) {
+            widths.push_back(width);
+        }
+        return widths;
+    }
+
+    const char *simdPath() {
+#if defined(__ARM_NEON)
+        return "neon";
+#elif defined(__AVX2__)
+        return "avx2";
+#elif defined(__SSE2__)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    class Checker {
+    public:
+        explicit Checker(uint32_t seed) : random_(seed) {}
+
+        int failures() const { return failures_; }
+
+        void fill(std::vector<uint8_t> &data) {
+            for (uint8_t &value: data) {
+                value = static_cast<uint8_t>(random_());
+            }
+        }
+
+        // 一半的样本取满 16 位（测饱和），一半取 10 位范围
+        void fill(std::vector<uint16_t> &data) {
+            for (uint16_t &value: data) {
+                uint32_t bits = random_();
+                value = static_cast<uint16_t>((bits & 1) ? bits >> 16 : (bits >> 16) & 0x3ff);
+            }
+        }
+
+        // 与 bit_depth.cpp 的 makeDitherRow 一样以 4 为周期（SIMD 路径按 8 个样本一组复用偏移），
+        // 取值不限于 Bayer 阈值，连同饱和一起检查
+        rows::DitherRow ditherRow() {
+            rows::DitherRow dither{};
+            uint16_t pattern[4];
+            for (uint16_t &value: pattern) {
+                value = static_cast<uint16_t>(random_() % 2 ? random_() >> 16 : random_() % 256);
+            }
+            for (int i = 0; i < 16; i++) {
+                dither.lanes[i] = pattern[i & 3];
+            }
+            return dither;
+        }
+
+        template<typename T>
+        void compare(const char *kernel, int width, int offset, const T *expected, const T *actual, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                if (expected[i] != actual[i]) {
+                    report(kernel, width, offset, i, static_cast<long long>(expected[i]),
+                           static_cast<long long>(actual[i]));
+                    return;
+                }
+            }
+        }
+
+        void report(const char *kernel, int width, int offset, size_t index, long long expected, long long actual) {
+            if (failures_++ < MAX_REPORTED_MISMATCHES) {
+                fprintf(stderr, "  %s: width %d, offset %d, index %zu: expected %lld, got %lld\n",
+                        kernel, width, offset, index, expected, actual);
+            }
+        }
+
+    private:
+        std::mt19937 random_;
+        int failures_ = 0;
+    };
+
+    uint8_t referenceSample(uint16_t value, uint16_t offset, int shift) {
+        uint32_t sum = static_cast<uint32_t>(value) + offset;
+        if (sum > 0xffff) {
+            sum = 0xffff;
+        }
+        sum >>= shift;
+        return static_cast<uint8_t>(sum > 255 ? 255 : sum);
+    }
+
+    void checkBitDepth(Checker &checker, int width, int offset) {
+        for (int shift: {2, 4, 8}) {
+            rows::DitherRow dither = checker.ditherRow();
+            std::vector<uint16_t> u(width + MAX_OFFSET), v(width + MAX_OFFSET), uv(2 * width + MAX_OFFSET);
+            checker.fill(u);
+            checker.fill(v);
+            checker.fill(uv);
+            const uint16_t *su = u.data() + offset;
+            const uint16_t *sv = v.data() + offset;
+            const uint16_t *suv = uv.data() + offset;
+
+            // 输出多留一个哨兵字节，检查内核没有写过界
+            std::vector<uint8_t> expected(2 * width + 1, 0xa5), actual(2 * width + 1 + MAX_OFFSET, 0xa5);
+            for (int x = 0; x < width; x++) {
+                expected[x] = referenceSample(su[x], dither.lanes[x & 15], shift);
+            }
+            expected.resize(width + 1);
+            rows::convertRow(su, actual.data() + offset, width, shift, dither);
+            checker.compare("convertRow", width, offset, expected.data(), actual.data() + offset, width + 1);
+
+            expected.assign(2 * width + 1, 0xa5);
+            actual.assign(2 * width + 1 + MAX_OFFSET, 0xa5);
+            for (int x = 0; x < width; x++) {
+                expected[2 * x] = referenceSample(su[x], dither.lanes[x & 15], shift);
+                expected[2 * x + 1] = referenceSample(sv[x], dither.lanes[x & 15], shift);
+            }
+            rows::interleaveRow(su, sv, actual.data() + offset, width, shift, dither);
+            checker.compare("interleaveRow", width, offset, expected.data(), actual.data() + offset,
+                            2 * width + 1);
+
+            std::vector<uint8_t> expectedU(width + 1, 0xa5), expectedV(width + 1, 0xa5);
+            std::vector<uint8_t> actualU(width + 1 + MAX_OFFSET, 0xa5), actualV(width + 1 + MAX_OFFSET, 0xa5);
+            for (int x = 0; x < width; x++) {
+                expectedU[x] = referenceSample(suv[2 * x], dither.lanes[(2 * x) & 15], shift);
+                expectedV[x] = referenceSample(suv[2 * x + 1], dither.lanes[(2 * x + 1) & 15], shift);
+            }
+            rows::deinterleaveRow(suv, actualU.data() + offset, actualV.data() + offset, width, shift, dither);
+            checker.compare("deinterleaveRow.u", width, offset, expectedU.data(), actualU.data() + offset,
+                            width + 1);
+            checker.compare("deinterleaveRow.v", width, offset, expectedV.data(), actualV.data() + offset,
+                            width + 1);
+        }
+    }
+
+    void checkSad(Checker &checker, int width, int offset) {
+        std::vector<uint8_t> a(width + MAX_OFFSET), b(width + MAX_OFFSET);
+        checker.fill(a);
+        checker.fill(b);
+        // 一半的情况让两行只有少数字节不同，接近静态画面的实际分布
+        if (width % 2 == 0) {
+            for (int x = 0; x < width; x += 7) {
+                b[x + offset] = a[x + offset];
+            }
+        }
+        uint64_t expected = 0;
+        for (int x = 0; x < width; x++) {
+            int diff = a[x + offset] - b[x + offset];
+            expected += static_cast<uint64_t>(diff < 0 ? -diff : diff);
+        }
+        uint32_t block = rows::blockSad(a.data() + offset, b.data() + offset, width);
+        if (block != expected) {
+            checker.report("blockSad", width, offset, 0, static_cast<long long>(expected), block);
+        }
+        uint64_t line = rows::lineSad(a.data() + offset, b.data() + offset, width);
+        if (line != expected) {
+            checker.report("lineSad", width, offset, 0, static_cast<long long>(expected),
+                           static_cast<long long>(line));
+        }
+    }
+
+    void checkHistogram(Checker &checker, int width, int offset) {
+        std::vector<uint8_t> row(width + MAX_OFFSET);
+        checker.fill(row);
+        uint32_t expected[64] = {};
+        for (int x = 0; x < width; x++) {
+            expected[row[x + offset] >> 2]++;
+        }
+        uint32_t bins[4][64] = {};
+        rows::accumulateHistogram(row.data() + offset, width, bins);
+        uint32_t merged[64] = {};
+        for (auto &group: bins) {
+            for (int i = 0; i < 64; i++) {
+                merged[i] += group[i];
+            }
+        }
+        checker.compare("accumulateHistogram", width, offset, expected, merged, 64);
+    }
+
+    void checkHalve(Checker &checker, int width, int offset) {
+        std::vector<uint8_t> row0(2 * width + MAX_OFFSET), row1(2 * width + MAX_OFFSET);
+        checker.fill(row0);
+        checker.fill(row1);
+        const uint8_t *top = row0.data() + offset;
+        const uint8_t *bottom = row1.data() + offset;
+        std::vector<uint8_t> expected(width + 1, 0xa5), actual(width + 1 + MAX_OFFSET, 0xa5);
+        for (int x = 0; x < width; x++) {
+            int sum = top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1];
+            expected[x] = static_cast<uint8_t>((sum + 2) / 4);
+        }
+        rows::halveRow(top, bottom, actual.data() + offset, width);
+        checker.compare("halveRow", width, offset, expected.data(), actual.data() + offset, width + 1);
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            fprintf(stderr, "usage: %s [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    if (!__builtin_cpu_supports("avx2")) {
+        printf("SKIP   avx2 build on a CPU without AVX2\n");
+        return 0;
+    }
+#endif
+
+    Checker checker(seed);
+    int cases = 0;
+    for (int width: testWidths()) {
+        for (int offset = 0; offset <= MAX_OFFSET; offset++) {
+            checkBitDepth(checker, width, offset);
+            checkSad(checker, width, offset);
+            checkHistogram(checker, width, offset);
+            checkHalve(checker, width, offset);
+            cases++;
+        }
+    }
+    printf("%s %s: %d width/offset cases, %d mismatches (seed %u)\n",
+           checker.failures() == 0 ? "PASS  " : "FAIL  ", simdPath(), cases, checker.failures(), seed);
+    return checker.failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+// 线程调度预设对比：在合成的 CPU 负载下依次用每个预设跑一遍管线，比较吞吐和呈现抖动。
+// 用法: thread_bench <input> [--presets LIST] [--hog N] [--seconds S] [--sink null|memory]
+//
+// 每个预设跑两次：不按时钟输出测吞吐（fps），按播放时钟输出 S 秒（默认 10）测呈现误差和抖动
+// （与 pipeline_bench --paced 的 present 一行相同）。--hog 启动 N 个忙循环线程（默认为核心数，
+// 0 关闭），模拟与播放争抢 CPU 的后台任务；它们按默认调度运行，不受预设影响。
+// --presets 为逗号分隔的预设名，默认 default,performance,efficiency,balanced。
+// 提高优先级（负的 nice）在桌面 Linux 上需要 CAP_SYS_NICE，没有权限时 failures 一列不为 0，
+// 该预设只有 CPU 亲和性生效；各核相同的机器上大核、小核都是全部核心，差别只来自优先级
+
+#define LOG_TAG "ThreadBench"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+#include "player.h"
+#include "thread_scheduling.h"
+#include "video_sink.h"
+
+namespace {
+
+    struct RunResult {
+        bool ok = false;
+        double fps = 0;
+        int64_t errorMeanUs = 0;
+        int64_t jitterUs = 0;
+        int64_t lateFrames = 0;
+        int64_t frames = 0;
+    };
+
+    // 合成负载：每个线程不停地做整数运算，直到 stop
+    class CpuHog {
+    public:
+        void start(int threads) {
+            stop_ = false;
+            for (int i = 0; i < threads; i++) {
+                threads_.emplace_back([this, i]() {
+                    uint64_t value = i + 1;
+                    while (!stop_.load(std::memory_order_relaxed)) {
+                        for (int n = 0; n < 4096; n++) {
+                            value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+                        }
+                        sink_.fetch_add(value & 1, std::memory_order_relaxed);
+                    }
+                });
+            }
+        }
+
+        void stop() {
+            stop_ = true;
+            for (std::thread &thread: threads_) {
+                thread.join();
+            }
+            threads_.clear();
+        }
+
+    private:
+        std::vector<std::thread> threads_;
+        std::atomic<bool> stop_{false};
+        std::atomic<uint64_t> sink_{0};  // 防止循环被优化掉
+    };
+
+    std::shared_ptr<VideoSink> makeSink(const char *name) {
+        if (strcmp(name, "memory") == 0) {
+            return std::make_shared<MemorySink>();
+        }
+        return std::make_shared<NullSink>();
+    }
+
+    // 跑一遍管线：paced 时最多 seconds 秒，否则跑完整个文件
+    RunResult runOnce(const char *input, const char *sinkName, bool paced, double seconds) {
+        RunResult result;
+        metrics::resetAll();
+        if (!initDecoder(input)) {
+            return result;
+        }
+        std::shared_ptr<VideoSink> sink = makeSink(sinkName);
+        setPullMode(false);
+        setPacingEnabled(paced);
+        auto begin = std::chrono::steady_clock::now();
+        if (!startDecoding(sink)) {
+            releaseDecoder();
+            return result;
+        }
+        double elapsed = 0;
+        while (!isPlaybackFinished() && (!paced || elapsed < seconds)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        }
+        stopDecoding();
+        releaseDecoder();
+
+        result.ok = true;
+        result.fps = elapsed > 0 ? static_cast<double>(sink->framesRendered()) / elapsed : 0;
+        result.errorMeanUs = metrics::counter("present.errorMeanUs").get();
+        result.jitterUs = metrics::counter("present.jitterUs").get();
+        result.lateFrames = metrics::counter("present.lateFrames").get();
+        result.frames = metrics::counter("present.frames").get();
+        return result;
+    }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <input> [--presets LIST] [--hog N] [--seconds S] [--sink null|memory]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const char *input = argv[1];
+    std::string presetList = "default,performance,efficiency,balanced";
+    int hogThreads = static_cast<int>(std::thread::hardware_concurrency());
+    double seconds = 10;
+    const char *sinkName = "null";
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--presets") == 0 && i + 1 < argc) {
+            presetList = argv[++i];
+        } else if (strcmp(argv[i], "--hog") == 0 && i + 1 < argc) {
+            hogThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--sink") == 0 && i + 1 < argc) {
+            sinkName = argv[++i];
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<scheduling::Preset> presets;
+    size_t start = 0;
+    while (start <= presetList.size()) {
+        size_t comma = presetList.find(',', start);
+        std::string name = presetList.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        scheduling::Preset preset;
+        if (!scheduling::parsePreset(name.c_str(), &preset)) {
+            fprintf(stderr, "unknown preset: %s\n", name.c_str());
+            return 1;
+        }
+        presets.push_back(preset);
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+
+    printf("input:      %s\n", input);
+    printf("cores:      big 0x%llx, little 0x%llx\n",
+           static_cast<unsigned long long>(scheduling::bigCoreMask()),
+           static_cast<unsigned long long>(scheduling::littleCoreMask()));
+    printf("hog:        %d threads\n", hogThreads);
+    printf("%-12s %10s %14s %12s %12s %9s\n", "preset", "fps", "error mean us", "jitter us", "late", "failures");
+
+    CpuHog hog;
+    for (scheduling::Preset preset: presets) {
+        scheduling::applyPreset(preset);
+        hog.start(hogThreads);
+        RunResult throughput = runOnce(input, sinkName, false, seconds);
+        RunResult paced = runOnce(input, sinkName, true, seconds);
+        hog.stop();
+        if (!throughput.ok || !paced.ok) {
+            return 1;
+        }
+        // resetAll 之后只剩 paced 这一遍的失败次数，两遍用同样的配置，足以说明预设是否完全生效
+        long long failures = static_cast<long long>(metrics::counter("threads.policyFailures").get());
+        char late[32];
+        snprintf(late, sizeof(late), "%lld/%lld", static_cast<long long>(paced.lateFrames),
+                 static_cast<long long>(paced.frames));
+        printf("%-12s %10.1f %14lld %12lld %12s %9lld\n", scheduling::presetName(preset), throughput.fps,
+               static_cast<long long>(paced.errorMeanUs), static_cast<long long>(paced.jitterUs), late,
+               failures);
+        printf("            %s\n", scheduling::describe().c_str());
+    }
+    scheduling::applyPreset(scheduling::Preset::Default);
+    return 0;
+}
@@ -0,0 +1,276 @@
+// vsync 调度检查：用合成的 vsync 时间戳驱动 VsyncScheduler，不依赖真实时钟和线程，结果是确定的。
+// 覆盖周期估计的预热、漏掉 tick 时周期不变、60Hz -> 90Hz 刷新率切换后重新估计、
+// 倒退或重复的时间戳被忽略，以及 alignAnchor 在 24/25/30fps 于 60Hz 上的余量和逐 vsync 的选帧
+// （与 player.cpp 的 vsync 驱动路径同样的规则：显示理想时间不晚于 vsync + 半个周期的最新一帧）。
+// 用法: vsync_check
+// 所有检查通过时退出码为 0；失败的检查逐条列出并返回 1
+
+#define LOG_TAG "VsyncCheck"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "metrics.h"
+#include "vsync_scheduler.h"
+
+// 条件不成立时记一次失败并打印原因，继续执行后面的检查
+#define CHECK(condition, ...)                                                  \
+    do {                                                                       \
+        if (!(condition)) {                                                    \
+            g_failures++;                                                      \
+            fprintf(stderr, "  %s:%d: %s: ", __func__, __LINE__, #condition);  \
+            fprintf(stderr, __VA_ARGS__);                                      \
+            fputc('\n', stderr);                                               \
+        }                                                                      \
+    } while (0)
+
+namespace {
+
+    int g_failures = 0;
+
+    const int64_t START_US = 1000000;
+
+    // 第 n 个 tick 的理想时间，按 hz 取整到微秒（和 Choreographer 报告的时间一样不是周期的整数倍）
+    int64_t tickTime(int64_t startUs, double hz, int n) {
+        return startUs + std::llround(n * 1000000.0 / hz);
+    }
+
+    // 从 startUs 开始送 count 个 tick，返回最后一个 tick 的时间
+    int64_t feed(VsyncScheduler &scheduler, int64_t startUs, double hz, int count) {
+        for (int n = 0; n < count; n++) {
+            scheduler.onVsync(tickTime(startUs, hz, n));
+        }
+        return tickTime(startUs, hz, count - 1);
+    }
+
+    bool near(int64_t value, double expected, double tolerance) {
+        return std::abs(static_cast<double>(value) - expected) <= tolerance;
+    }
+
+    void checkWarmup() {
+        VsyncScheduler scheduler;
+        CHECK(!scheduler.hasEstimate(), "no ticks yet");
+        // 4 个间隔之前没有估计
+        feed(scheduler, START_US, 60, 4);
+        CHECK(!scheduler.hasEstimate(), "3 intervals should not be enough");
+        scheduler.onVsync(tickTime(START_US, 60, 4));
+        CHECK(scheduler.hasEstimate(), "4 intervals should give an estimate");
+        CHECK(near(scheduler.periodUs(), 1000000.0 / 60, 1), "period %lld", (long long) scheduler.periodUs());
+        CHECK(near(scheduler.predict(START_US, 60), START_US + 1000000, 60), "predict 60 ticks ahead: %lld",
+              (long long) scheduler.predict(START_US, 60));
+    }
+
+    void checkMissedTicks() {
+        static auto &missedTicks = metrics::counter("vsync.missedTicks");
+        VsyncScheduler scheduler;
+        feed(scheduler, START_US, 60, 20);
+        int64_t period = scheduler.periodUs();
+        int64_t missedBefore = missedTicks.get();
+
+        // 漏掉 2 个和 4 个 tick：间隔为 3 倍、5 倍周期
+        scheduler.onVsync(tickTime(START_US, 60, 22));
+        scheduler.onVsync(tickTime(START_US, 60, 27));
+        CHECK(missedTicks.get() - missedBefore == 6, "missed %lld ticks, expected 6",
+              (long long) (missedTicks.get() - missedBefore));
+        CHECK(scheduler.hasEstimate(), "missed ticks must not drop the estimate");
+        CHECK(near(scheduler.periodUs(), static_cast<double>(period), 1), "period %lld -> %lld",
+              (long long) period, (long long) scheduler.periodUs());
+
+        // 带 ±1ms 抖动的 tick 里夹着漏掉的 tick，平滑后的周期仍在 20us 以内
+        int n = 28;
+        for (int i = 0; i < 200; i++, n++) {
+            if (i % 17 == 0) {
+                n++;
+            }
+            int64_t jitter = (i * 7919 % 2001) - 1000;
+            scheduler.onVsync(tickTime(START_US, 60, n) + jitter);
+        }
+        CHECK(near(scheduler.periodUs(), 1000000.0 / 60, 20), "period with jitter %lld",
+              (long long) scheduler.periodUs());
+    }
+
+    void checkRefreshRateChange() {
+        VsyncScheduler scheduler;
+        int64_t last = feed(scheduler, START_US, 60, 30);
+
+        // 一个迟到的 tick 只产生两个异常间隔（迟到的一个和之后提前的一个），不触发重新估计
+        scheduler.onVsync(tickTime(START_US, 60, 30) + 6000);
+        scheduler.onVsync(tickTime(START_US, 60, 31));
+        scheduler.onVsync(tickTime(START_US, 60, 32));
+        CHECK(scheduler.hasEstimate(), "one late tick must not reset the estimate");
+        CHECK(near(scheduler.periodUs(), 1000000.0 / 60, 1), "period after a late tick %lld",
+              (long long) scheduler.periodUs());
+        last = tickTime(START_US, 60, 32);
+
+        // 切换到 90Hz：前两个间隔仍按 60Hz 估计，第三个触发重新估计
+        int64_t start90 = last + std::llround(1000000.0 / 90);
+        scheduler.onVsync(tickTime(start90, 90, 0));
+        scheduler.onVsync(tickTime(start90, 90, 1));
+        CHECK(scheduler.hasEstimate() && near(scheduler.periodUs(), 1000000.0 / 60, 1),
+              "two 90Hz intervals should keep the 60Hz estimate, period %lld", (long long) scheduler.periodUs());
+        scheduler.onVsync(tickTime(start90, 90, 2));
+        CHECK(!scheduler.hasEstimate(), "third 90Hz interval should drop the 60Hz estimate");
+
+        // 重新预热：再过 4 个间隔得到 90Hz 的估计
+        for (int n = 3; n < 7; n++) {
+            CHECK(!scheduler.hasEstimate(), "estimate too early after %d ticks", n);
+            scheduler.onVsync(tickTime(start90, 90, n));
+        }
+        CHECK(scheduler.hasEstimate(), "no estimate after re-warmup");
+        CHECK(near(scheduler.periodUs(), 1000000.0 / 90, 1), "90Hz period %lld", (long long) scheduler.periodUs());
+    }
+
+    void checkNonMonotonic() {
+        static auto &ticks = metrics::counter("vsync.ticks");
+        VsyncScheduler scheduler;
+        int64_t last = feed(scheduler, START_US, 60, 20);
+        int64_t period = scheduler.periodUs();
+        int64_t ticksBefore = ticks.get();
+
+        // 重复的时间戳不算 tick，也不影响估计
+        scheduler.onVsync(last);
+        scheduler.onVsync(last);
+        CHECK(ticks.get() == ticksBefore, "duplicate timestamps counted as %lld ticks",
+              (long long) (ticks.get() - ticksBefore));
+        CHECK(scheduler.hasEstimate() && scheduler.periodUs() == period, "duplicate changed the period to %lld",
+              (long long) scheduler.periodUs());
+
+        // 倒退（时钟源重启）只重设基准：之后的正常间隔不被当作异常，连续三次倒退也不会触发重新估计
+        int64_t restart = last - 500000;
+        for (int i = 0; i < 3; i++) {
+            scheduler.onVsync(restart - i * 1000);
+        }
+        CHECK(ticks.get() == ticksBefore, "backwards timestamps counted as %lld ticks",
+              (long long) (ticks.get() - ticksBefore));
+        restart -= 2000;
+        feed(scheduler, restart + std::llround(1000000.0 / 60), 60, 5);
+        CHECK(scheduler.hasEstimate(), "backwards timestamps dropped the estimate");
+        CHECK(near(scheduler.periodUs(), static_cast<double>(period), 1), "period %lld -> %lld",
+              (long long) period, (long long) scheduler.periodUs());
+        CHECK(ticks.get() - ticksBefore == 5, "%lld ticks after restart, expected 5",
+              (long long) (ticks.get() - ticksBefore));
+    }
+
+    // 之后 frames 帧的理想时间相对 vsync 网格离判定边界（两个 vsync 的中点）最近的距离，以周期为单位
+    double alignMargin(int64_t anchorUs, int64_t referenceUs, double periodUs, int64_t intervalUs, int frames) {
+        double margin = 0.5;
+        for (int k = 0; k < frames; k++) {
+            double x = static_cast<double>(anchorUs + k * intervalUs - referenceUs) / periodUs;
+            margin = std::min(margin, std::abs(x - std::floor(x) - 0.5));
+        }
+        return margin;
+    }
+
+    // 按 player.cpp 的规则逐个 vsync 选帧：理想时间不晚于 vsync + 半个周期的最新一帧。
+    // 返回每个 vsync 显示的帧序号，vsync 时间叠加 ±jitterUs 的交替抖动
+    std::vector<int64_t> selectFrames(const VsyncScheduler &scheduler, int64_t referenceUs, int64_t anchorUs,
+                                      int64_t intervalUs, int vsyncs, int64_t jitterUs) {
+        int64_t halfPeriod = scheduler.periodUs() / 2;
+        std::vector<int64_t> shown;
+        for (int j = 1; j <= vsyncs; j++) {
+            int64_t vsync = scheduler.predict(referenceUs, j) + (j % 2 == 0 ? jitterUs : -jitterUs);
+            int64_t limit = vsync + halfPeriod - anchorUs;
+            shown.push_back(limit < 0 ? -1 : limit / intervalUs);
+        }
+        return shown;
+    }
+
+    // 每帧停留的 vsync 数，去掉第一帧和最后一帧（不完整）
+    std::vector<int> holdCounts(const std::vector<int64_t> &shown) {
+        std::vector<int> holds;
+        int count = 0;
+        for (size_t j = 1; j < shown.size(); j++) {
+            count++;
+            if (shown[j] != shown[j - 1]) {
+                if (shown[j] != shown[j - 1] + 1) {
+                    holds.push_back(0);  // 跳过了一帧
+                }
+                holds.push_back(count);
+                count = 0;
+            }
+        }
+        if (!holds.empty()) {
+            holds.erase(holds.begin());
+        }
+        return holds;
+    }
+
+    struct Cadence {
+        double fps;
+        double expectedMargin;  // 最优的余量（周期的比例）
+        int cycleFrames;        // 节奏循环的帧数
+        int cycleVsyncs;        // 一个循环内的 vsync 数
+    };
+
+    void checkCadence(const Cadence &cadence) {
+        VsyncScheduler scheduler;
+        int64_t reference = feed(scheduler, START_US, 60, 30);
+        double period = 1000000.0 / 60;
+        auto interval = static_cast<int64_t>(std::llround(1000000.0 / cadence.fps));
+
+        // 锚点故意放在第 0 帧正好落在两个 vsync 中点的位置，对齐前余量为 0
+        int64_t anchor = reference + 3 * static_cast<int64_t>(period) + static_cast<int64_t>(period / 2);
+        int64_t aligned = scheduler.alignAnchor(anchor, interval);
+        double before = alignMargin(anchor, reference, period, interval, 30);
+        double after = alignMargin(aligned, reference, period, interval, 30);
+        // 搜索步长为 1/64 周期，允许与最优余量差一步
+        CHECK(after >= cadence.expectedMargin - 1.0 / 64, "%.0ffps: margin %.3f, expected %.3f",
+              cadence.fps, after, cadence.expectedMargin);
+        CHECK(after > before, "%.0ffps: margin did not improve (%.3f -> %.3f)", cadence.fps, before, after);
+        CHECK(std::abs(aligned - anchor) <= period / 2 + 1, "%.0ffps: anchor moved %lldus", cadence.fps,
+              (long long) (aligned - anchor));
+
+        // 选帧：节奏稳定，每个循环正好 cycleVsyncs 个 vsync，每帧停留的 vsync 数只差 1
+        std::vector<int64_t> shown = selectFrames(scheduler, reference, aligned, interval, 240, 0);
+        std::vector<int> holds = holdCounts(shown);
+        int floorHold = static_cast<int>(std::floor(cadence.cycleVsyncs / static_cast<double>(cadence.cycleFrames)));
+        bool steady = holds.size() >= static_cast<size_t>(2 * cadence.cycleFrames);
+        for (size_t i = 0; steady && i < holds.size(); i++) {
+            steady = holds[i] == floorHold || holds[i] == floorHold + 1;
+        }
+        for (size_t i = 0; steady && i + cadence.cycleFrames <= holds.size(); i++) {
+            int sum = 0;
+            for (int k = 0; k < cadence.cycleFrames; k++) {
+                sum += holds[i + k];
+            }
+            steady = sum == cadence.cycleVsyncs;
+        }
+        CHECK(steady, "%.0ffps: unsteady cadence over %zu frames", cadence.fps, holds.size());
+
+        // 小于余量的 vsync 抖动不改变任何一个 vsync 选中的帧
+        auto jitter = static_cast<int64_t>((cadence.expectedMargin - 1.0 / 32) * period);
+        CHECK(selectFrames(scheduler, reference, aligned, interval, 240, jitter) == shown,
+              "%.0ffps: %lldus of vsync jitter changed the selected frames", cadence.fps, (long long) jitter);
+        CHECK(selectFrames(scheduler, reference, aligned, interval, 240, -jitter) == shown,
+              "%.0ffps: -%lldus of vsync jitter changed the selected frames", cadence.fps, (long long) jitter);
+    }
+
+    void checkAlignWithoutEstimate() {
+        VsyncScheduler scheduler;
+        feed(scheduler, START_US, 60, 3);
+        CHECK(scheduler.alignAnchor(START_US + 12345, 41667) == START_US + 12345, "aligned without an estimate");
+        feed(scheduler, START_US + 50000, 60, 10);
+        CHECK(scheduler.alignAnchor(START_US + 12345, 0) == START_US + 12345, "aligned without a frame interval");
+    }
+
+}  // namespace
+
+int main() {
+    checkWarmup();
+    checkMissedTicks();
+    checkRefreshRateChange();
+    checkNonMonotonic();
+    checkAlignWithoutEstimate();
+    // 24fps: 3:2 节奏，帧位置两种、相隔半个周期，最优余量 1/4 周期
+    checkCadence({24, 0.25, 2, 5});
+    // 25fps: 5 帧 12 个 vsync，帧位置五种、相隔 1/5 周期，最优余量 1/10 周期
+    checkCadence({25, 0.1, 5, 12});
+    // 30fps: 每帧正好两个 vsync，帧位置可以都在 vsync 上
+    checkCadence({30, 0.5, 1, 2});
+    printf("%s vsync scheduler: %d failed checks\n", g_failures == 0 ? "PASS  " : "FAIL  ", g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
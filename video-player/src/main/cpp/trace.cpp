@@ -0,0 +1,283 @@
+#define LOG_TAG "Native-Trace"
+
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "log.h"
+
+#if VP_ENABLE_TRACE
+
+namespace trace {
+    namespace {
+
+        const size_t RING_CAPACITY = 1 << 14;  // 每线程缓冲事件数，必须为 2 的幂
+
+        struct Event {
+            int64_t timestampUs;
+            int64_t value;
+            const char *name;
+            int32_t tid;
+            EventType type;
+        };
+
+        // 单生产者（所属线程）环形缓冲区，导出时由其他线程无锁读取
+        struct ThreadBuffer {
+            Event events[RING_CAPACITY];
+            std::atomic<uint64_t> writeIndex{0};
+            std::atomic<uint64_t> readStart{0};  // reset() 之后的起始位置，生产者不受影响
+            std::atomic<bool> inUse{false};
+            int32_t tid = 0;
+        };
+
+        std::mutex g_registryMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;  // 线程退出后保留，供导出和复用
+        std::vector<std::pair<int32_t, const char *>> g_threadNames;  // tid -> 线程名
+        std::atomic<bool> g_atraceEnabled(false);
+
+        // ATrace 在 API 23 之后才有，minSdk 为 21，因此运行时查找符号
+        struct ATraceApi {
+            void (*beginSection)(const char *) = nullptr;
+            void (*endSection)() = nullptr;
+            void (*setCounter)(const char *, int64_t) = nullptr;
+            bool loaded = false;
+        };
+
+        ATraceApi &atrace() {
+            static ATraceApi api = []() {
+                ATraceApi result;
+#ifdef __ANDROID__
+                void *lib = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+                if (lib) {
+                    result.beginSection = reinterpret_cast<void (*)(const char *)>(
+                            dlsym(lib, "ATrace_beginSection"));
+                    result.endSection = reinterpret_cast<void (*)()>(
+                            dlsym(lib, "ATrace_endSection"));
+                    result.setCounter = reinterpret_cast<void (*)(const char *, int64_t)>(
+                            dlsym(lib, "ATrace_setCounter"));
+                    result.loaded = result.beginSection && result.endSection;
+                }
+#endif
+                return result;
+            }();
+            return api;
+        }
+
+        int64_t nowUs() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        ThreadBuffer *acquireBuffer() {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            for (auto &buffer: g_buffers) {
+                bool expected = false;
+                if (buffer->inUse.compare_exchange_strong(expected, true)) {
+                    return buffer.get();
+                }
+            }
+            g_buffers.push_back(std::make_unique<ThreadBuffer>());
+            g_buffers.back()->inUse = true;
+            return g_buffers.back().get();
+        }
+
+        // 线程退出时归还缓冲区，已记录的事件仍保留到被新线程覆盖
+        struct ThreadBufferHolder {
+            ThreadBuffer *buffer = nullptr;
+
+            ThreadBuffer *get() {
+                if (!buffer) {
+                    buffer = acquireBuffer();
+                    buffer->tid = static_cast<int32_t>(syscall(SYS_gettid));
+                }
+                return buffer;
+            }
+
+            ~ThreadBufferHolder() {
+                if (buffer) {
+                    buffer->inUse.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        thread_local ThreadBufferHolder t_holder;
+
+        void record(EventType type, const char *name, int64_t value) {
+            ThreadBuffer *buffer = t_holder.get();
+            uint64_t index = buffer->writeIndex.load(std::memory_order_relaxed);
+            Event &event = buffer->events[index & (RING_CAPACITY - 1)];
+            event.timestampUs = nowUs();
+            event.value = value;
+            event.name = name;
+            event.tid = buffer->tid;
+            event.type = type;
+            buffer->writeIndex.store(index + 1, std::memory_order_release);
+        }
+
+        // 复制一个线程缓冲区中仍然有效的事件，丢弃复制期间可能被覆盖的部分
+        void snapshot(ThreadBuffer &buffer, std::vector<Event> &out) {
+            uint64_t end = buffer.writeIndex.load(std::memory_order_acquire);
+            uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+            begin = std::max(begin, std::min(end, buffer.readStart.load(std::memory_order_acquire)));
+            size_t firstOut = out.size();
+            for (uint64_t i = begin; i < end; i++) {
+                out.push_back(buffer.events[i & (RING_CAPACITY - 1)]);
+            }
+            uint64_t after = buffer.writeIndex.load(std::memory_order_acquire);
+            uint64_t overwritten = after > RING_CAPACITY ? after - RING_CAPACITY : 0;
+            if (overwritten > begin) {
+                size_t drop = static_cast<size_t>(std::min<uint64_t>(overwritten - begin, end - begin));
+                out.erase(out.begin() + static_cast<std::ptrdiff_t>(firstOut),
+                          out.begin() + static_cast<std::ptrdiff_t>(firstOut + drop));
+            }
+        }
+
+        void writeJsonString(FILE *file, const char *text) {
+            fputc('"', file);
+            for (const char *p = text ? text : ""; *p; p++) {
+                if (*p == '"' || *p == '\\') {
+                    fputc('\\', file);
+                }
+                fputc(*p, file);
+            }
+            fputc('"', file);
+        }
+
+    }  // namespace
+
+    void begin(const char *name) {
+        record(EventType::Begin, name, 0);
+        if (g_atraceEnabled.load(std::memory_order_relaxed) && atrace().loaded) {
+            atrace().beginSection(name);
+        }
+    }
+
+    void end(const char *name) {
+        record(EventType::End, name, 0);
+        if (g_atraceEnabled.load(std::memory_order_relaxed) && atrace().loaded) {
+            atrace().endSection();
+        }
+    }
+
+    void counter(const char *name, int64_t value) {
+        record(EventType::Counter, name, value);
+        if (g_atraceEnabled.load(std::memory_order_relaxed) && atrace().setCounter) {
+            atrace().setCounter(name, value);
+        }
+    }
+
+    void setThreadName(const char *name) {
+        int32_t tid = t_holder.get()->tid;
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (auto &entry: g_threadNames) {
+            if (entry.first == tid) {
+                entry.second = name;
+                return;
+            }
+        }
+        g_threadNames.emplace_back(tid, name);
+    }
+
+    void setAtraceEnabled(bool enabled) {
+        if (enabled && !atrace().loaded) {
+            LOGE("ATrace 不可用（需要 API 23+），仅记录到内部缓冲区");
+        }
+        g_atraceEnabled = enabled;
+    }
+
+    bool dumpChromeJson(const char *path) {
+        std::vector<Event> events;
+        std::vector<std::pair<int32_t, const char *>> threadNames;
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            for (auto &buffer: g_buffers) {
+                snapshot(*buffer, events);
+            }
+            threadNames = g_threadNames;
+        }
+
+        FILE *file = fopen(path, "w");
+        if (!file) {
+            LOGE("无法写入 trace 文件: %s", path);
+            return false;
+        }
+
+        int pid = static_cast<int>(getpid());
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        bool first = true;
+        for (const auto &thread: threadNames) {
+            fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,"
+                          "\"args\":{\"name\":", first ? "" : ",", pid, thread.first);
+            writeJsonString(file, thread.second);
+            fprintf(file, "}}");
+            first = false;
+        }
+        for (const auto &event: events) {
+            fprintf(file, "%s{\"name\":", first ? "" : ",");
+            writeJsonString(file, event.name);
+            switch (event.type) {
+                case EventType::Begin:
+                    fprintf(file, ",\"ph\":\"B\"");
+                    break;
+                case EventType::End:
+                    fprintf(file, ",\"ph\":\"E\"");
+                    break;
+                case EventType::Counter:
+                    fprintf(file, ",\"ph\":\"C\",\"args\":{\"value\":%lld}",
+                            static_cast<long long>(event.value));
+                    break;
+            }
+            fprintf(file, ",\"ts\":%lld,\"pid\":%d,\"tid\":%d}",
+                    static_cast<long long>(event.timestampUs), pid, event.tid);
+            first = false;
+        }
+        fprintf(file, "]}\n");
+        fclose(file);
+
+        LOGI("导出 %zu 个 trace 事件到 %s", events.size(), path);
+        return true;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (auto &buffer: g_buffers) {
+            buffer->readStart.store(buffer->writeIndex.load(std::memory_order_acquire),
+                                    std::memory_order_release);
+        }
+    }
+
+}  // namespace trace
+
+#else
+
+namespace trace {
+
+    void begin(const char *) {}
+
+    void end(const char *) {}
+
+    void counter(const char *, int64_t) {}
+
+    void setThreadName(const char *) {}
+
+    void setAtraceEnabled(bool) {}
+
+    bool dumpChromeJson(const char *path) {
+        LOGE("trace 未编译进当前构建（VP_ENABLE_TRACE=OFF），无法导出: %s", path);
+        return false;
+    }
+
+    void reset() {}
+
+}  // namespace trace
+
+#endif
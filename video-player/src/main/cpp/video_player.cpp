@@ -1,413 +1,765 @@
 #include <jni.h>
-#include <android/log.h>
-#include <queue>
-#include <thread>
-#include <condition_variable>
-#include <mutex>
+#include <android/native_window_jni.h>
 #include <memory>
-#include <atomic>
-#include <algorithm>
-#include <limits>
-
-extern "C" {
-#if defined(__arm64__) || defined(__aarch64__)  // 针对 arm64-v8a 架构
-#include "ffmpeg/arm64-v8a/include/libavformat/avformat.h"
-#include "ffmpeg/arm64-v8a/include/libavcodec/avcodec.h"
-#include "ffmpeg/arm64-v8a/include/libavutil/frame.h"
-#include "ffmpeg/arm64-v8a/include/libavutil/imgutils.h"
-#include "ffmpeg/arm64-v8a/include/libavutil/time.h"
-#elif defined(__x86_64__)  // 针对 x86_64 架构
-#include "ffmpeg/x86_64/include/libavformat/avformat.h"
-#include "ffmpeg/x86_64/include/libavcodec/avcodec.h"
-#include "ffmpeg/x86_64/include/libavutil/frame.h"
-#include "ffmpeg/x86_64/include/libavutil/imgutils.h"
-#include "ffmpeg/x86_64/include/libavutil/time.h"
-#else
-// 默认使用通用的头文件
-#include "ffmpeg/include/libavformat/avformat.h"
-#include "ffmpeg/include/libavcodec/avcodec.h"
-#include "ffmpeg/include/libavutil/frame.h"
-#include "ffmpeg/include/libavutil/imgutils.h"
-#include "ffmpeg/include/libavutil/time.h"
-#endif
-}
-
-#define LOG_TAG "Native-FFmpegDecoder"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "clip_exporter.h"
+#include "decoder_pool.h"
+#include "log.h"
+#include "media_cache.h"
+#include "media_prober.h"
+#include "memory_budget.h"
+#include "metrics.h"
+#include "player.h"
+#include "thread_scheduling.h"
+#include "trace.h"
+#include "video_sink.h"
 
 // 回调相关变量
-static jobject g_decoderListener = nullptr;
 static jmethodID g_onFrameDecodedMethod = nullptr;
-const int BUFFER_SECS = 2;  // 缓冲秒数
-const int MIN_QUEUE_SIZE = 5;  // 最小队列大小
-const int MAX_QUEUE_SIZE = 60;  // 最大队列大小
-
-// FFmpeg 相关资源封装
-struct FFmpegContext {
-    AVFormatContext *formatContext = nullptr;  // 存储音视频封装格式中包含的所有信息
-    AVCodecContext *codecContext = nullptr;    // 编解码器上下文，存储编解码器的相关参数
-    const AVCodec *codec = nullptr;           // 编解码器，包含实际的编解码功能实现
-    double frameRate = 0.0;  // 添加帧率字段
-    int64_t frameInterval = 0;  // 帧间隔（微秒）
-    int64_t nextFrameTime = 0;  // 下一帧的目标时间
-    int targetQueueSize;  // 目标队列大小
-    int64_t startTime = 0;        // 开始播放时间
-    int64_t totalDuration = 0;    // 视频总时长（微秒）
-    int64_t currentTime = 0;      // 当前播放时间（微秒）
-    double timeBase = 0.0;        // 时间基准
-    
-    // 获取格式化的间字符串
-    static std::string getFormattedTime(int64_t timeInMicros) {
-        int64_t totalSeconds = timeInMicros / AV_TIME_BASE;
-        // 确保 totalSeconds 在 int 范围内
-        if (totalSeconds > std::numeric_limits<int>::max()) {
-            totalSeconds = std::numeric_limits<int>::max();
-        } else if (totalSeconds < std::numeric_limits<int>::min()) {
-            totalSeconds = std::numeric_limits<int>::min();
+static std::mutex g_surfaceMutex;
+static ANativeWindow *g_nativeWindow = nullptr;  // 设置后推送模式直接输出到 Surface
+static ClipExporter g_clipExporter;              // 片段导出，同一时间只有一个
+
+// 在任意线程上释放全局引用，当前线程没有附加到 JVM 时临时附加
+static void deleteGlobalRef(JavaVM *jvm, jobject ref) {
+    JNIEnv *env = nullptr;
+    bool attached = false;
+    if (jvm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        if (jvm->AttachCurrentThread(&env, nullptr) != 0) {
+            LOGE("无法将线程附加到 JVM，全局引用未释放");
+            return;
         }
-        int hours = static_cast<int>(totalSeconds / 3600);
-        int minutes = static_cast<int>((totalSeconds % 3600) / 60);
-        int seconds = static_cast<int>(totalSeconds % 60);
-        char buffer[32];
-        snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", hours, minutes, seconds);
-        return {buffer};
-    }
-
-    ~FFmpegContext() {
-        // 析构函数：确保资源被正确释放
-        if (codecContext) {
-            avcodec_free_context(&codecContext);
+        attached = true;
+    }
+    env->DeleteGlobalRef(ref);
+    if (attached) {
+        jvm->DetachCurrentThread();
+    }
+}
+
+// 把帧复制为紧密排列的 YUV 数据，通过 onFrameDecoded 回调给 Java 层
+class JniCallbackSink : public VideoSink {
+public:
+    // listener 为全局引用，由 sink 负责释放
+    JniCallbackSink(JavaVM *jvm, jobject listener, jmethodID method)
+            : jvm_(jvm), listener_(listener), method_(method) {}
+
+    // 不依赖渲染线程是否启动成功：startDecoding 失败或 onThreadStart 失败时也释放 listener。
+    // 最后一个引用可能在任意线程上释放
+    ~JniCallbackSink() override {
+        if (listener_) {
+            deleteGlobalRef(jvm_, listener_);
         }
-        if (formatContext) {
-            avformat_close_input(&formatContext);
+    }
+
+    const char *name() const override { return "jni_callback"; }
+
+    bool onThreadStart() override {
+        if (jvm_->AttachCurrentThread(&env_, nullptr) != 0) {
+            LOGE("无法将线程附加到 JVM");
+            return false;
         }
+        return true;
     }
 
-    void calculateTargetQueueSize() {
-        // 根据帧率计算合适的队列大小
-        targetQueueSize = static_cast<int>(frameRate * BUFFER_SECS);
-        // 确保队列大小在合理范围内
-        targetQueueSize = std::max(MIN_QUEUE_SIZE, 
-                          std::min(targetQueueSize, MAX_QUEUE_SIZE));
-        LOGI("设置目标队列大小: %d (帧率: %.2f)", targetQueueSize, frameRate);
+    void onThreadStop() override {
+        // listener 在这里释放，析构时就不需要再附加线程
+        env_->DeleteGlobalRef(listener_);
+        listener_ = nullptr;
+        jvm_->DetachCurrentThread();
     }
-};
 
-// 全局变量
-std::unique_ptr<FFmpegContext> ffmpegContext;           // FFmpeg上下文的智能指针
-std::mutex frameQueueMutex;                            // 帧队列互斥锁，用于线程同步
-std::condition_variable frameQueueCV;                  // 条件变量，用于线程间通信
-std::queue<AVFrame *> frameQueue;                      // 存储解码后等待渲染的帧队列
-std::atomic<bool> g_isDecoding(false);                 // 原子变量，控制解码过程
+    void onFrame(const AVFrame *frame) override {
+        int bufferSize = packedFrameSize(frame);
+        if (bufferSize <= 0 || !method_) {
+            return;
+        }
+
+        // 复制到复用的缓冲区（按 renderBuffers 记账），Java 侧在回调返回前完成复制
+        TRACE_BEGIN("render.copy");
+        uint8_t *buffer = buffer_.reserve(static_cast<size_t>(bufferSize));
+        av_image_copy_to_buffer(
+                buffer, bufferSize,
+                frame->data, frame->linesize,
+                static_cast<AVPixelFormat>(frame->format),
+                frame->width, frame->height, 1
+        );
+        countFrameCopy();
+        TRACE_END("render.copy");
+
+        TRACE_BEGIN("jni.onFrameDecoded");
+        jobject byteBuffer = env_->NewDirectByteBuffer(buffer, bufferSize);
+        if (byteBuffer) {
+            // 带上这一帧的实际尺寸：ROI 裁剪和 ABR 切换后与初始化时报告的尺寸不同
+            env_->CallVoidMethod(listener_, method_, byteBuffer, frame->width, frame->height);
+            env_->DeleteLocalRef(byteBuffer);
+        }
+        TRACE_END("jni.onFrameDecoded");
 
+        framesRendered_++;
+        bytesRendered_ += static_cast<uint64_t>(bufferSize);
+    }
 
-// 工具函数：释放帧资源
-inline void freeFrame(AVFrame *frame) {
-    if (frame) {
-        av_frame_free(&frame);
+    // Java 侧保留着上一帧的数据，画面没变时不复制也不回调
+    void onFrameUnchanged(const AVFrame * /*frame*/) override {
+        framesRendered_++;
     }
-}
+
+private:
+    JavaVM *jvm_;
+    JNIEnv *env_ = nullptr;
+    jobject listener_;
+    jmethodID method_;
+    memory::TrackedBuffer buffer_{memory::Category::RenderBuffers};
+};
 
 // 初始化解码器函数
 extern "C" JNIEXPORT jintArray JNICALL
 Java_com_giffard_video_1player_decoder_FFmpegDecoder_initDecoder(JNIEnv *env, jobject thiz,
                                                                  jstring videoPath) {
     const char *path = env->GetStringUTFChars(videoPath, nullptr);
-    ffmpegContext = std::make_unique<FFmpegContext>();
+    bool initialized = initDecoder(path);
+    env->ReleaseStringUTFChars(videoPath, path);
+    if (!initialized) {
+        return nullptr;
+    }
 
-    avformat_network_init();
-    LOGI("Initializing decoder with video path: %s", path);
+    jclass decoderClass = env->GetObjectClass(thiz);
+    g_onFrameDecodedMethod = env->GetMethodID(decoderClass, "onFrameDecoded",
+                                              "(Ljava/nio/ByteBuffer;II)V");
 
-    if (avformat_open_input(&ffmpegContext->formatContext, path, nullptr, nullptr) != 0) {
-        LOGE("Failed to open video file: %s", path);
-        env->ReleaseStringUTFChars(videoPath, path);
-        return nullptr;
+    // 返回视频信息数组 [width, height, frameRate]，尺寸为降分辨率后入队帧的尺寸
+    jintArray info = env->NewIntArray(3);
+    jint fill[3] = {
+        ffmpegContext->outputWidth,
+        ffmpegContext->outputHeight,
+        static_cast<jint>(ffmpegContext->frameRate)
+    };
+    env->SetIntArrayRegion(info, 0, 3, fill);
+    return info;
+}
+
+// 启动解码和渲染线程
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_startNativeDecoding(JNIEnv *env,
+                                                                         jobject thiz) {
+    JavaVM *jvm = nullptr;
+    if (env->GetJavaVM(&jvm) != 0) {
+        LOGE("Failed to get JavaVM");
+        return;
     }
 
-    if (avformat_find_stream_info(ffmpegContext->formatContext, nullptr) < 0) {
-        LOGE("Failed to find stream info for: %s", path);
-        env->ReleaseStringUTFChars(videoPath, path);
-        return nullptr;
+    std::shared_ptr<VideoSink> sink;
+    if (!isPullMode()) {
+        std::lock_guard<std::mutex> lock(g_surfaceMutex);
+        if (g_nativeWindow) {
+            sink = std::make_shared<NativeWindowSink>(g_nativeWindow);
+        } else {
+            sink = std::make_shared<JniCallbackSink>(jvm, env->NewGlobalRef(thiz),
+                                                     g_onFrameDecodedMethod);
+        }
+    }
+    startDecoding(std::move(sink));
+}
+
+// 停止解码和渲染线程
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_stopNativeDecoding(JNIEnv *env,
+                                                                        jobject thiz) {
+    stopDecoding();
+}
+
+// 暂停：解码和渲染线程停在播放时钟上，解码器和已解码的帧保留
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_pauseNativeDecoding(JNIEnv *env,
+                                                                         jobject thiz) {
+    pauseDecoding();
+}
+
+// 恢复：从暂停位置继续，不重建线程
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_resumeNativeDecoding(JNIEnv *env,
+                                                                          jobject thiz) {
+    resumeDecoding();
+}
+
+// 从头重新播放，不重建线程和解码器
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_restartNativeDecoding(JNIEnv *env,
+                                                                           jobject thiz) {
+    restartDecoding();
+}
+
+// 释放解码器资源
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_releaseDecoder(JNIEnv *env, jobject thiz) {
+    releaseDecoder();
+
+    std::lock_guard<std::mutex> lock(g_surfaceMutex);
+    if (g_nativeWindow) {
+        ANativeWindow_release(g_nativeWindow);
+        g_nativeWindow = nullptr;
     }
+}
 
-    int videoStreamIndex = -1;
-    for (unsigned int i = 0; i < ffmpegContext->formatContext->nb_streams; i++) {
-        if (ffmpegContext->formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-            videoStreamIndex = static_cast<int>(i); // Explicitly cast to int
-            break;
+// 设置输出 Surface：推送模式下帧直接写入 ANativeWindow，不再回调 Java；传 null 恢复回调输出
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeSurface(JNIEnv *env, jobject thiz,
+                                                                     jobject surface) {
+    std::lock_guard<std::mutex> lock(g_surfaceMutex);
+    if (g_nativeWindow) {
+        ANativeWindow_release(g_nativeWindow);
+        g_nativeWindow = nullptr;
+    }
+    if (surface) {
+        g_nativeWindow = ANativeWindow_fromSurface(env, surface);
+        if (!g_nativeWindow) {
+            LOGE("无法从 Surface 获取 ANativeWindow");
         }
     }
+}
 
-    if (videoStreamIndex == -1) {
-        LOGE("No video stream found");
-        env->ReleaseStringUTFChars(videoPath, path);
-        return nullptr;
+// 导出 Chrome trace JSON，可在 chrome://tracing 或 ui.perfetto.dev 中打开
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_dumpTrace(JNIEnv *env, jobject thiz,
+                                                              jstring outputPath) {
+    const char *path = env->GetStringUTFChars(outputPath, nullptr);
+    bool result = trace::dumpChromeJson(path);
+    env->ReleaseStringUTFChars(outputPath, path);
+    return result ? JNI_TRUE : JNI_FALSE;
+}
+
+// 开启/关闭 ATrace 转发（systrace / Perfetto 系统追踪中可见）
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setAtraceEnabled(JNIEnv *env, jobject thiz,
+                                                                     jboolean enabled) {
+    trace::setAtraceEnabled(enabled == JNI_TRUE);
+}
+
+// 低延迟直播模式，需在 initDecoder 之前设置
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeLiveMode(JNIEnv *env, jobject thiz,
+                                                                      jboolean enabled,
+                                                                      jint mailboxSize) {
+    setLiveMode(enabled == JNI_TRUE, mailboxSize);
+}
+
+// 对 HLS master / DASH 输入启用自适应码率，需在 initDecoder 之前设置
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeAbrEnabled(JNIEnv *env, jobject thiz,
+                                                                        jboolean enabled) {
+    setAbrEnabled(enabled == JNI_TRUE);
+}
+
+// 显示表面尺寸和降分辨率阈值，需在 initDecoder 之前设置
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeTargetSurfaceSize(JNIEnv *env,
+                                                                               jobject thiz,
+                                                                               jint width,
+                                                                               jint height,
+                                                                               jfloat threshold) {
+    setDownscaleThreshold(threshold);
+    setTargetSurfaceSize(width, height);
+}
+
+// 10/12 位输入转 8 位 YUV420P（GL 渲染器和回调都按平面处理），dither 时用有序抖动。需在 initDecoder 之前设置
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeHighBitDepthOutput(JNIEnv *env,
+                                                                                jobject thiz,
+                                                                                jboolean dither) {
+    setHighBitDepthOutput(AV_PIX_FMT_YUV420P, dither == JNI_TRUE);
+}
+
+// 场景切换检测，可以在播放中随时开关
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeSceneDetection(JNIEnv *env,
+                                                                            jobject thiz,
+                                                                            jboolean enabled,
+                                                                            jfloat threshold,
+                                                                            jlong minSceneUs) {
+    setSceneDetection(enabled == JNI_TRUE, threshold, minSceneUs);
+}
+
+// 检测到的切换点，依次为 [ptsUs, score, ptsUs, score, ...]
+extern "C" JNIEXPORT jdoubleArray JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_takeNativeSceneCuts(JNIEnv *env, jobject thiz) {
+    std::vector<SceneCut> cuts = takeSceneCuts();
+    std::vector<jdouble> values;
+    values.reserve(cuts.size() * 2);
+    for (const SceneCut &cut: cuts) {
+        values.push_back(static_cast<jdouble>(cut.ptsUs));
+        values.push_back(cut.score);
+    }
+    jdoubleArray result = env->NewDoubleArray(static_cast<jsize>(values.size()));
+    if (result && !values.empty()) {
+        env->SetDoubleArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
     }
+    return result;
+}
 
-    AVStream *videoStream = ffmpegContext->formatContext->streams[videoStreamIndex];
-    ffmpegContext->codec = avcodec_find_decoder(videoStream->codecpar->codec_id);
-    if (!ffmpegContext->codec) {
-        LOGE("Failed to find codec for video stream");
-        env->ReleaseStringUTFChars(videoPath, path);
-        return nullptr;
+// 管线线程的调度预设：0 default、1 performance、2 efficiency、3 balanced，对运行中的线程立即生效
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeThreadPreset(JNIEnv *env, jobject thiz,
+                                                                          jint preset) {
+    if (preset < 0 || preset > static_cast<int>(scheduling::Preset::Balanced)) {
+        LOGW("未知的线程调度预设: %d", preset);
+        return;
     }
+    scheduling::applyPreset(static_cast<scheduling::Preset>(preset));
+}
 
-    ffmpegContext->codecContext = avcodec_alloc_context3(ffmpegContext->codec);
-    if (!ffmpegContext->codecContext) {
-        LOGE("Failed to allocate codec context");
-        env->ReleaseStringUTFChars(videoPath, path);
-        return nullptr;
+// 单个角色的调度：role 为 0 decode、1 render、2 analysis、3 background，cpuMask 为 0 时不限制核心
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeThreadPolicy(JNIEnv *env, jobject thiz,
+                                                                          jint role, jint nice,
+                                                                          jint realtimePriority,
+                                                                          jlong cpuMask) {
+    if (role < 0 || role >= static_cast<int>(scheduling::Role::Count)) {
+        LOGW("未知的线程角色: %d", role);
+        return;
     }
+    scheduling::Policy policy;
+    policy.nice = nice;
+    policy.realtimePriority = realtimePriority;
+    policy.cpuMask = static_cast<uint64_t>(cpuMask);
+    scheduling::setPolicy(static_cast<scheduling::Role>(role), policy);
+}
 
-    if (avcodec_parameters_to_context(ffmpegContext->codecContext, videoStream->codecpar) < 0) {
-        LOGE("Failed to copy codec parameters");
-        env->ReleaseStringUTFChars(videoPath, path);
-        return nullptr;
+// [大核掩码, 小核掩码]，各核相同时都是全部核心
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_getNativeCoreMasks(JNIEnv *env, jobject thiz) {
+    jlong masks[2] = {static_cast<jlong>(scheduling::bigCoreMask()),
+                      static_cast<jlong>(scheduling::littleCoreMask())};
+    jlongArray result = env->NewLongArray(2);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 2, masks);
     }
+    return result;
+}
 
-    if (avcodec_open2(ffmpegContext->codecContext, ffmpegContext->codec, nullptr) < 0) {
-        LOGE("Failed to open codec");
-        env->ReleaseStringUTFChars(videoPath, path);
-        return nullptr;
+// 各角色当前的调度配置和线程数
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_describeNativeThreads(JNIEnv *env, jobject thiz) {
+    return env->NewStringUTF(scheduling::describe().c_str());
+}
+
+// 视频流选择：preferredCodecs 为逗号分隔的编码名（可为空），discardUnused 时解复用丢弃其余流。
+// 需在 initDecoder 之前设置
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeStreamSelection(JNIEnv *env,
+                                                                             jobject thiz,
+                                                                             jstring preferredCodecs,
+                                                                             jboolean discardUnused) {
+    std::string codecs;
+    if (preferredCodecs) {
+        const char *chars = env->GetStringUTFChars(preferredCodecs, nullptr);
+        codecs = chars;
+        env->ReleaseStringUTFChars(preferredCodecs, chars);
     }
+    setPreferredVideoCodecs(codecs);
+    setDiscardUnusedStreams(discardUnused == JNI_TRUE);
+}
 
-    // 获取视频流的帧率并计算队列大小
-    ffmpegContext->frameRate = av_q2d(videoStream->avg_frame_rate);
-    ffmpegContext->calculateTargetQueueSize();
+// 输出区域：只复制、上传帧的子矩形，outputWidth/outputHeight 非 0 时再缩放到该尺寸。
+// 播放中可以随时修改，下一帧生效；width/height 为 0 恢复整帧
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeRegionOfInterest(JNIEnv *env,
+                                                                              jobject thiz,
+                                                                              jint x, jint y,
+                                                                              jint width,
+                                                                              jint height,
+                                                                              jint outputWidth,
+                                                                              jint outputHeight) {
+    RegionOfInterest region;
+    region.x = x;
+    region.y = y;
+    region.width = width;
+    region.height = height;
+    region.outputWidth = outputWidth;
+    region.outputHeight = outputHeight;
+    setRegionOfInterest(region);
+}
 
-    ffmpegContext->timeBase = av_q2d(videoStream->time_base);
+// 切换帧输出模式：true 为拉模式（GL 线程取帧），false 为原来的渲染线程推送；需在开始解码前设置
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativePullMode(JNIEnv *env, jobject thiz,
+                                                                      jboolean enabled) {
+    setPullMode(enabled == JNI_TRUE);
+}
 
-    jclass decoderClass = env->GetObjectClass(thiz);
-    g_onFrameDecodedMethod = env->GetMethodID(decoderClass, "onFrameDecoded",
-                                              "(Ljava/nio/ByteBuffer;)V");
-    g_decoderListener = env->NewGlobalRef(thiz);
+// vsync 驱动的推送模式：渲染线程在 Choreographer 的每个 vsync 上选帧；需在开始解码前设置
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeVsyncDriven(JNIEnv *env, jobject thiz,
+                                                                         jboolean enabled) {
+    setVsyncDriven(enabled == JNI_TRUE);
+}
 
-    env->ReleaseStringUTFChars(videoPath, path);
-    LOGI("Decoder initialized successfully");
+// Choreographer.FrameCallback 的 frameTimeNanos，与 av_gettime_relative 同为 CLOCK_MONOTONIC
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_onNativeVsync(JNIEnv *env, jobject thiz,
+                                                                  jlong frameTimeNanos) {
+    vsyncScheduler().onVsync(frameTimeNanos / 1000);
+}
 
-    // 获取视频总时长
-    if (ffmpegContext->formatContext->duration != AV_NOPTS_VALUE) {
-        ffmpegContext->totalDuration = ffmpegContext->formatContext->duration;
-        LOGI("视频总时长: %s", 
-             ffmpegContext->getFormattedTime(ffmpegContext->totalDuration).c_str());
-    }
+// 静态帧检测：没变的帧不再复制、上传，部分变化时只上传变化的块
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setNativeFrameChangeDetection(JNIEnv *env,
+                                                                                  jobject thiz,
+                                                                                  jboolean enabled,
+                                                                                  jint tileSize,
+                                                                                  jint threshold) {
+    setFrameChangeDetection(enabled == JNI_TRUE, tileSize, threshold);
+}
 
-    // 返回视频信息数组 [width, height, frameRate]
-    jintArray info = env->NewIntArray(3);
-    jint fill[3] = {
-        ffmpegContext->codecContext->width,
-        ffmpegContext->codecContext->height,
-        static_cast<jint>(ffmpegContext->frameRate)
-    };
-    env->SetIntArrayRegion(info, 0, 3, fill);
-    return info;
+// GL 上下文重建后纹理内容丢失，下一帧整帧上传
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_resetNativeFrameChanges(JNIEnv *env,
+                                                                            jobject thiz) {
+    resetFrameChanges();
 }
 
-// 解码线程函数：负责从视频文件中读取数据并解码
-void decodeThreadFunc() {
-    // Use av_packet_alloc to allocate a new AVPacket
-    AVPacket *packet = av_packet_alloc();
-    if (!packet) {
-        LOGE("无法分配 AVPacket");
-        return;
+// 时钟源停止（界面不可见）时重置周期估计，恢复后重新估计
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_resetNativeVsync(JNIEnv *env, jobject thiz) {
+    vsyncScheduler().reset();
+}
+
+// 把帧的尺寸、格式、行距填入 info 的前 6 项，各平面包装为直接缓冲区（不复制）填入 planes
+static bool exportFramePlanes(JNIEnv *env, const AVFrame *frame, jint *info, jobjectArray planes) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    if (!desc || !frame->data[0]) {
+        return false;
     }
-    AVFrame *frame = av_frame_alloc();
-    if (!frame) {
-        LOGE("无法分配 AVFrame");
-        av_packet_free(&packet);  // Free the packet if frame allocation fails
-        return;
+    info[0] = frame->width;
+    info[1] = frame->height;
+    info[2] = frame->format;
+    jsize planeCount = std::min<jsize>(env->GetArrayLength(planes), 3);
+    for (int i = 0; i < planeCount; i++) {
+        if (!frame->data[i]) {
+            env->SetObjectArrayElement(planes, i, nullptr);
+            continue;
+        }
+        int planeHeight = (i == 0 || (desc->flags & AV_PIX_FMT_FLAG_RGB))
+                          ? frame->height
+                          : AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h);
+        info[3 + i] = frame->linesize[i];
+        jobject plane = env->NewDirectByteBuffer(frame->data[i],
+                                                 static_cast<jlong>(frame->linesize[i]) * planeHeight);
+        env->SetObjectArrayElement(planes, i, plane);
+        env->DeleteLocalRef(plane);
     }
+    return true;
+}
 
-    int64_t lastPts = 0;
-    while (g_isDecoding) {
-        if (av_read_frame(ffmpegContext->formatContext, packet) < 0) {
-            break;
-        }
+// 拉模式取帧：返回最适合 presentationTimeNs 这次显示的帧句柄，没有新帧（或画面没变）时返回 0。
+// 已经过期的帧直接丢弃，不再复制到 Java 层。frameInfo 依次填入
+// [width, height, format, linesize0, linesize1, linesize2, dirtyRectCount]，planes 填入各平面的直接缓冲区。
+// 只有部分区域变化时 dirtyRects 依次填入 dirtyRectCount 个 [x, y, width, height]，放不下时按整帧（0）处理。
+// 返回的句柄必须通过 releaseFrame 归还。
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_acquireLatestFrame(JNIEnv *env, jobject thiz,
+                                                                       jlong presentationTimeNs,
+                                                                       jintArray frameInfo,
+                                                                       jobjectArray planes,
+                                                                       jintArray dirtyRects) {
+    FrameChange change;
+    AVFrame *frame = acquireLatestFrame(presentationTimeNs, &change);
+    if (!frame) {
+        return 0;
+    }
 
-        if (packet->stream_index == 0) {
-            if (avcodec_send_packet(ffmpegContext->codecContext, packet) == 0) {
-                while (avcodec_receive_frame(ffmpegContext->codecContext, frame) == 0) {
-                    // 使用 PTS 计算实际播放时间
-                    int64_t pts = frame->pts;
-                    if (pts != AV_NOPTS_VALUE) {
-                        auto timeInMicros = static_cast<int64_t>(pts *
-                            ffmpegContext->timeBase * AV_TIME_BASE);
-                        
-                        // 计算需要等待的时间
-                        if (lastPts != 0) {
-                            int64_t waitTime = timeInMicros - lastPts;
-                            if (waitTime > 0) {
-                                av_usleep(static_cast<unsigned int>(waitTime));
-                            }
-                        }
-                        lastPts = timeInMicros;
-                    }
-
-                    std::unique_lock<std::mutex> lock(frameQueueMutex);
-                    frameQueueCV.wait(lock, [&]() { 
-                        return frameQueue.size() < ffmpegContext->targetQueueSize; 
-                    });
-
-                    AVFrame *clonedFrame = av_frame_clone(frame);
-                    if (clonedFrame) {
-                        clonedFrame->pts = pts;  // 保存 PTS
-                        frameQueue.push(clonedFrame);
-                        frameQueueCV.notify_one();
-                    }
-                }
-            }
+    jint info[7] = {};
+    if (!exportFramePlanes(env, frame, info, planes)) {
+        av_frame_free(&frame);
+        return 0;
+    }
+    auto rectCount = static_cast<jsize>(change.rects.size());
+    if (change.kind == FrameChange::Kind::Partial && rectCount * 4 <= env->GetArrayLength(dirtyRects)) {
+        std::vector<jint> rects;
+        rects.reserve(rectCount * 4);
+        for (const auto &rect: change.rects) {
+            rects.insert(rects.end(), {rect.x, rect.y, rect.width, rect.height});
         }
-        av_packet_unref(packet);  // Unreference the packet after use
+        env->SetIntArrayRegion(dirtyRects, 0, rectCount * 4, rects.data());
+        info[6] = rectCount;
     }
+    env->SetIntArrayRegion(frameInfo, 0, 7, info);
+    return reinterpret_cast<jlong>(frame);
+}
 
+// 归还 acquireLatestFrame / acquireSubscribedFrame 返回的帧
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_releaseFrame(JNIEnv *env, jobject thiz,
+                                                                 jlong handle) {
+    auto *frame = reinterpret_cast<AVFrame *>(handle);
     av_frame_free(&frame);
-    av_packet_free(&packet);  // Free the packet when done
-    LOGI("解码线程结束");
 }
 
-// 渲染线程函数：负责将解码后的帧传递给Java层
-void renderThreadFunc(JavaVM *jvm) {
-    JNIEnv *env = nullptr;
-    if (jvm->AttachCurrentThread(&env, nullptr) != 0) {
-        LOGE("无法将线程附加到 JVM");
-        return;
+// 订阅解码帧：返回订阅句柄，必须先 unsubscribeNativeFrames 再 releaseNativeSubscription 归还。dropOldest 为 false 时队列满丢弃新帧
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_subscribeNativeFrames(JNIEnv *env, jobject thiz,
+                                                                          jstring name,
+                                                                          jint capacity,
+                                                                          jboolean dropOldest) {
+    const char *chars = env->GetStringUTFChars(name, nullptr);
+    std::string subscriberName = chars;
+    env->ReleaseStringUTFChars(name, chars);
+    auto policy = dropOldest == JNI_TRUE ? FrameSubscriber::DropPolicy::DropOldest
+                                         : FrameSubscriber::DropPolicy::DropNewest;
+    auto *subscriber = new std::shared_ptr<FrameSubscriber>(
+            frameFanout().subscribe(subscriberName, static_cast<size_t>(std::max(1, capacity)), policy));
+    return reinterpret_cast<jlong>(subscriber);
+}
+
+// 取消订阅并唤醒正在等待的 acquireSubscribedFrame，句柄仍然有效；已经取走的帧仍需各自 releaseFrame
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_unsubscribeNativeFrames(JNIEnv *env, jobject thiz,
+                                                                            jlong subscription) {
+    auto *subscriber = reinterpret_cast<std::shared_ptr<FrameSubscriber> *>(subscription);
+    frameFanout().unsubscribe(*subscriber);
+}
+
+// 释放订阅句柄。调用者保证此后不再有使用这个句柄的调用（FrameSubscription.close 等待进行中的调用结束）
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_releaseNativeSubscription(JNIEnv *env, jobject thiz,
+                                                                              jlong subscription) {
+    delete reinterpret_cast<std::shared_ptr<FrameSubscriber> *>(subscription);
+}
+
+// 从订阅队列取下一帧，最多等待 timeoutUs（0 不等待），没有帧时返回 0。frameInfo 依次填入
+// [width, height, format, linesize0, linesize1, linesize2]，ptsUs 的第 0 项填入帧的媒体时间。
+// 返回的句柄必须通过 releaseFrame 归还，持有期间解码端不会复用这块内存
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_acquireSubscribedFrame(JNIEnv *env, jobject thiz,
+                                                                           jlong subscription,
+                                                                           jlong timeoutUs,
+                                                                           jintArray frameInfo,
+                                                                           jobjectArray planes,
+                                                                           jlongArray ptsUs) {
+    // 复制一份引用，等待期间订阅者不会被释放
+    std::shared_ptr<FrameSubscriber> subscriber = *reinterpret_cast<std::shared_ptr<FrameSubscriber> *>(subscription);
+    int64_t framePtsUs = 0;
+    AVFrame *frame = subscriber->pop(timeoutUs, &framePtsUs);
+    if (!frame) {
+        return 0;
+    }
+    jint info[6] = {};
+    if (!exportFramePlanes(env, frame, info, planes)) {
+        av_frame_free(&frame);
+        return 0;
     }
+    env->SetIntArrayRegion(frameInfo, 0, 6, info);
+    jlong pts = framePtsUs;
+    env->SetLongArrayRegion(ptsUs, 0, 1, &pts);
+    return reinterpret_cast<jlong>(frame);
+}
 
-    int64_t lastRenderTime = av_gettime_relative();
-    int64_t renderInterval = ffmpegContext->frameInterval;
-
-    while (g_isDecoding) {
-        AVFrame* frame = nullptr;
-        {
-            std::unique_lock<std::mutex> lock(frameQueueMutex);
-            
-            if (frameQueueCV.wait_for(lock, std::chrono::microseconds(renderInterval),
-                                    []() { return !frameQueue.empty(); })) {
-                
-                frame = frameQueue.front();
-                frameQueue.pop();
-                
-                // 使用 PTS 更新当前播放时间
-                if (frame->pts != AV_NOPTS_VALUE) {
-                    ffmpegContext->currentTime = static_cast<int64_t>(frame->pts * 
-                        ffmpegContext->timeBase * AV_TIME_BASE);
-                    
-                    // 每秒输出一次播放进度
-                    static int64_t lastLogTime = 0;
-                    if (ffmpegContext->currentTime - lastLogTime >= AV_TIME_BASE) {
-                        LOGI("播放进度: %s / %s", 
-                             ffmpegContext->getFormattedTime(ffmpegContext->currentTime).c_str(),
-                             ffmpegContext->getFormattedTime(ffmpegContext->totalDuration).c_str());
-                        lastLogTime = ffmpegContext->currentTime;
-                    }
-                }
-            }
-        }
-        
-        if (frame) {
-            // 计算渲染时间
-            int64_t currentTime = av_gettime_relative();
-            int64_t elapsedTime = currentTime - lastRenderTime;
-            
-            if (elapsedTime < renderInterval) {
-                av_usleep(static_cast<unsigned int>(renderInterval - elapsedTime));
-            }
-            
-            // 渲染帧
-            if (frame->data[0] && g_decoderListener && g_onFrameDecodedMethod) {
-                int bufferSize = av_image_get_buffer_size(
-                    static_cast<AVPixelFormat>(frame->format),
-                    frame->width, frame->height, 1
-                );
-                
-                if (bufferSize > 0) {
-                    // 创建临时缓冲区并复制数据
-                    auto* buffer = new uint8_t[bufferSize];
-                    av_image_copy_to_buffer(
-                        buffer, bufferSize,
-                        frame->data, frame->linesize,
-                        static_cast<AVPixelFormat>(frame->format),
-                        frame->width, frame->height, 1
-                    );
-
-                    jobject byteBuffer = env->NewDirectByteBuffer(buffer, bufferSize);
-                    if (byteBuffer) {
-                        env->CallVoidMethod(g_decoderListener, g_onFrameDecodedMethod, byteBuffer);
-                        env->DeleteLocalRef(byteBuffer);
-                    }
-                    delete[] buffer;
-                }
-            }
-            
-            freeFrame(frame);
-            lastRenderTime = av_gettime_relative();
-        }
+// 订阅者的统计，依次为 [delivered, dropped, queued, lagUs]
+extern "C" JNIEXPORT jlongArray JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_getNativeSubscriberStats(JNIEnv *env, jobject thiz,
+                                                                             jlong subscription) {
+    std::shared_ptr<FrameSubscriber> subscriber = *reinterpret_cast<std::shared_ptr<FrameSubscriber> *>(subscription);
+    FrameSubscriber::Stats stats = subscriber->stats();
+    jlong values[4] = {stats.delivered, stats.dropped, stats.queued, stats.lagUs};
+    jlongArray result = env->NewLongArray(4);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 4, values);
     }
+    return result;
+}
 
-    jvm->DetachCurrentThread();
-    LOGI("渲染线程结束");
+// 导出运行时指标（JSON 对象）
+extern "C" JNIEXPORT jstring JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_getNativeMetrics(JNIEnv *env, jobject thiz) {
+    return env->NewStringUTF(metrics::snapshotJson().c_str());
 }
 
-// 启动解码和渲染线程
+// 设置解码器复用池最多保留的空闲上下文数量，0 表示关闭复用
 extern "C" JNIEXPORT void JNICALL
-Java_com_giffard_video_1player_decoder_FFmpegDecoder_startNativeDecoding(JNIEnv *env,
-                                                                         jobject thiz) {
-    LOGI("startNativeDecoding");
-    if (g_isDecoding) {
-        LOGI("Decoding already started.");
-        return;
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setDecoderPoolCapacity(JNIEnv *env,
+                                                                           jobject thiz,
+                                                                           jint capacity) {
+    DecoderPool::instance().setCapacity(static_cast<size_t>(std::max(0, capacity)));
+}
+
+// 设置网络媒体的磁盘缓存目录和字节预算，目录为空或预算为 0 时关闭；对之后打开的输入生效
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setMediaCache(JNIEnv *env, jobject thiz,
+                                                                   jstring directory,
+                                                                   jlong capacityBytes) {
+    std::string path;
+    if (directory) {
+        const char *chars = env->GetStringUTFChars(directory, nullptr);
+        path = chars;
+        env->ReleaseStringUTFChars(directory, chars);
     }
+    return MediaCache::instance().configure(path, capacityBytes) ? JNI_TRUE : JNI_FALSE;
+}
 
-    g_isDecoding = true;
-    ffmpegContext->startTime = av_gettime_relative();
+// 设置播放管线的内存硬预算（字节），0 表示不限制；接近预算时解码线程停止提前解码
+extern "C" JNIEXPORT void JNICALL
+Java_com_giffard_video_1player_decoder_FFmpegDecoder_setMemoryBudget(JNIEnv *env, jobject thiz,
+                                                                     jlong budgetBytes) {
+    memory::setBudget(budgetBytes);
+}
 
+// ---- 片段导出（com.giffard.video_player.export.ClipExporter） ----
+
+// 在后台线程开始导出，已有导出在进行时返回 false。进度和结束回调在导出线程上执行：
+// 第一次回调时附加到 JVM，结束回调后分离。callback 是这次导出自己的 Kotlin 回调对象，
+// 它的全局引用随回调一起释放，导出进行中再次调用 start 不会改变这次导出回调给谁
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_giffard_video_1player_export_ClipExporter_startNativeExport(JNIEnv *env, jobject thiz,
+                                                                    jstring inputPath,
+                                                                    jstring outputPath,
+                                                                    jlong startUs, jlong endUs,
+                                                                    jboolean accurateStart,
+                                                                    jobject callback) {
     JavaVM *jvm = nullptr;
     if (env->GetJavaVM(&jvm) != 0) {
         LOGE("Failed to get JavaVM");
-        return;
+        return JNI_FALSE;
+    }
+    jclass clazz = env->GetObjectClass(callback);
+    jmethodID onProgress = env->GetMethodID(clazz, "onNativeProgress", "(F)V");
+    jmethodID onFinished = env->GetMethodID(clazz, "onNativeFinished", "(ILjava/lang/String;)V");
+    env->DeleteLocalRef(clazz);
+    if (!onProgress || !onFinished) {
+        LOGE("ClipExporter 回调方法不存在");
+        return JNI_FALSE;
     }
 
-    std::thread(decodeThreadFunc).detach();
-    std::thread(renderThreadFunc, jvm).detach();
+    ClipExportOptions options;
+    const char *input = env->GetStringUTFChars(inputPath, nullptr);
+    options.inputPath = input;
+    env->ReleaseStringUTFChars(inputPath, input);
+    const char *output = env->GetStringUTFChars(outputPath, nullptr);
+    options.outputPath = output;
+    env->ReleaseStringUTFChars(outputPath, output);
+    options.startUs = startUs;
+    options.endUs = endUs;
+    options.accurateStart = accurateStart == JNI_TRUE;
+
+    // 两个回调共享的全局引用，回调销毁时释放（导出线程结束时或启动失败时），不依赖回调里能否附加线程
+    std::shared_ptr<_jobject> listener(env->NewGlobalRef(callback), [jvm](jobject ref) {
+        deleteGlobalRef(jvm, ref);
+    });
+    auto threadEnv = std::make_shared<JNIEnv *>(nullptr);
+    auto attach = [jvm, threadEnv]() {
+        if (!*threadEnv && jvm->AttachCurrentThread(threadEnv.get(), nullptr) != 0) {
+            LOGE("无法将导出线程附加到 JVM");
+            *threadEnv = nullptr;
+        }
+        return *threadEnv;
+    };
+    bool started = g_clipExporter.start(
+            options,
+            [attach, listener, onProgress](double fraction) {
+                if (JNIEnv *callbackEnv = attach()) {
+                    callbackEnv->CallVoidMethod(listener.get(), onProgress, static_cast<jfloat>(fraction));
+                }
+            },
+            [jvm, attach, listener, onFinished](ClipExporter::State state, const std::string &error) {
+                if (JNIEnv *callbackEnv = attach()) {
+                    jstring message = callbackEnv->NewStringUTF(error.c_str());
+                    callbackEnv->CallVoidMethod(listener.get(), onFinished, static_cast<jint>(state), message);
+                    callbackEnv->DeleteLocalRef(message);
+                    jvm->DetachCurrentThread();
+                }
+            });
+    return started ? JNI_TRUE : JNI_FALSE;
 }
 
-// 停止解码和渲染线程
 extern "C" JNIEXPORT void JNICALL
-Java_com_giffard_video_1player_decoder_FFmpegDecoder_stopNativeDecoding(JNIEnv *env,
-                                                                        jobject thiz) {
-    LOGI("stopNativeDecoding");
+Java_com_giffard_video_1player_export_ClipExporter_cancelNativeExport(JNIEnv *env, jobject thiz) {
+    g_clipExporter.cancel();
+}
 
-    if (!g_isDecoding) {
-        return;
-    }
+extern "C" JNIEXPORT jfloat JNICALL
+Java_com_giffard_video_1player_export_ClipExporter_getNativeExportProgress(JNIEnv *env, jobject thiz) {
+    return static_cast<jfloat>(g_clipExporter.progress());
+}
 
-    g_isDecoding = false;
-    frameQueueCV.notify_all();
+// ---- 媒体库元数据探测（com.giffard.video_player.library.MediaProber） ----
 
-    std::unique_lock<std::mutex> lock(frameQueueMutex);
-    while (!frameQueue.empty()) {
-        freeFrame(frameQueue.front());
-        frameQueue.pop();
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_giffard_video_1player_library_MediaProber_setNativeCacheFile(JNIEnv *env, jobject thiz,
+                                                                     jstring path) {
+    std::string file;
+    if (path) {
+        const char *chars = env->GetStringUTFChars(path, nullptr);
+        file = chars;
+        env->ReleaseStringUTFChars(path, chars);
     }
-
-    LOGI("Stopped decoding and rendering.");
+    return MediaProber::instance().setCacheFile(file) ? JNI_TRUE : JNI_FALSE;
 }
 
-// 释放解码器资源
-extern "C" JNIEXPORT void JNICALL
-Java_com_giffard_video_1player_decoder_FFmpegDecoder_releaseDecoder(JNIEnv *env, jobject thiz) {
-    LOGI("releaseDecoder");
-
-    g_isDecoding = false;
-    frameQueueCV.notify_all();
-    ffmpegContext.reset();
+// 结果按文件顺序写入调用者分配的数组：numbers 每个文件 6 项（valid、durationUs、width、height、
+// rotation、bitRate），frameRates 每个文件 1 项，codecs 每个文件 2 项（视频、音频编码名，没有时为 null）
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_giffard_video_1player_library_MediaProber_probeNative(JNIEnv *env, jobject thiz,
+                                                              jobjectArray paths, jlongArray sizes,
+                                                              jlongArray modifiedTimes, jint threads,
+                                                              jlongArray numbers, jfloatArray frameRates,
+                                                              jobjectArray codecs) {
+    jsize count = env->GetArrayLength(paths);
+    if (env->GetArrayLength(sizes) != count || env->GetArrayLength(modifiedTimes) != count ||
+        env->GetArrayLength(numbers) != count * 6 || env->GetArrayLength(frameRates) != count ||
+        env->GetArrayLength(codecs) != count * 2) {
+        LOGE("probeNative: 数组长度不一致");
+        return JNI_FALSE;
+    }
 
-    if (g_decoderListener) {
-        env->DeleteGlobalRef(g_decoderListener);
-        g_decoderListener = nullptr;
+    std::vector<ProbeRequest> requests(static_cast<size_t>(count));
+    std::vector<jlong> sizeValues(static_cast<size_t>(count));
+    std::vector<jlong> timeValues(static_cast<size_t>(count));
+    env->GetLongArrayRegion(sizes, 0, count, sizeValues.data());
+    env->GetLongArrayRegion(modifiedTimes, 0, count, timeValues.data());
+    for (jsize i = 0; i < count; i++) {
+        auto path = static_cast<jstring>(env->GetObjectArrayElement(paths, i));
+        const char *chars = env->GetStringUTFChars(path, nullptr);
+        requests[i].path = chars;
+        env->ReleaseStringUTFChars(path, chars);
+        env->DeleteLocalRef(path);
+        requests[i].size = sizeValues[i];
+        requests[i].mtime = timeValues[i];
     }
 
-    LOGI("Decoder released");
+    std::vector<MediaInfo> results = MediaProber::instance().probe(requests, threads);
+
+    std::vector<jlong> numberValues(static_cast<size_t>(count) * 6);
+    std::vector<jfloat> rateValues(static_cast<size_t>(count));
+    std::unordered_map<std::string, jstring> codecStrings;
+    for (jsize i = 0; i < count; i++) {
+        const MediaInfo &info = results[i];
+        jlong *fields = &numberValues[static_cast<size_t>(i) * 6];
+        fields[0] = info.valid ? 1 : 0;
+        fields[1] = info.durationUs;
+        fields[2] = info.width;
+        fields[3] = info.height;
+        fields[4] = info.rotation;
+        fields[5] = info.bitRate;
+        rateValues[i] = static_cast<jfloat>(info.frameRate);
+        // 编码名只有少数几种，每种只创建一个 Java 字符串
+        const std::string *names[2] = {&info.videoCodec, &info.audioCodec};
+        for (int k = 0; k < 2; k++) {
+            if (names[k]->empty()) {
+                continue;
+            }
+            jstring &name = codecStrings[*names[k]];
+            if (!name) {
+                name = env->NewStringUTF(names[k]->c_str());
+            }
+            env->SetObjectArrayElement(codecs, i * 2 + k, name);
+        }
+    }
+    for (auto &entry: codecStrings) {
+        env->DeleteLocalRef(entry.second);
+    }
+    env->SetLongArrayRegion(numbers, 0, count * 6, numberValues.data());
+    env->SetFloatArrayRegion(frameRates, 0, count, rateValues.data());
+    return JNI_TRUE;
 }
-
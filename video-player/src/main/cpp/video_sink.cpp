@@ -0,0 +1,103 @@
+#define LOG_TAG "Native-VideoSink"
+
+#include "video_sink.h"
+#include "log.h"
+#include "metrics.h"
+#include "trace.h"
+
+int packedFrameSize(const AVFrame *frame) {
+    return av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format),
+                                    frame->width, frame->height, 1);
+}
+
+void countFrameCopy() {
+    static auto &copies = metrics::counter("pipeline.frameCopies");
+    copies.add(1);
+}
+
+void NullSink::onFrame(const AVFrame * /*frame*/) {
+    framesRendered_++;
+}
+
+void MemorySink::onFrame(const AVFrame *frame) {
+    int bufferSize = packedFrameSize(frame);
+    if (bufferSize <= 0) {
+        return;
+    }
+
+    TRACE_SCOPE("sink.memory.copy");
+    std::lock_guard<std::mutex> lock(framesMutex_);
+    std::vector<uint8_t> *target = &scratch_;
+    if (frames_.size() < maxFrames_) {
+        frames_.emplace_back();
+        target = &frames_.back();
+    }
+    target->resize(static_cast<size_t>(bufferSize));
+    av_image_copy_to_buffer(target->data(), bufferSize,
+                            frame->data, frame->linesize,
+                            static_cast<AVPixelFormat>(frame->format),
+                            frame->width, frame->height, 1);
+    countFrameCopy();
+    framesRendered_++;
+    bytesRendered_ += static_cast<uint64_t>(bufferSize);
+}
+
+std::vector<std::vector<uint8_t>> MemorySink::takeFrames() {
+    std::lock_guard<std::mutex> lock(framesMutex_);
+    return std::move(frames_);
+}
+
+void ChecksumSink::onFrame(const AVFrame *frame) {
+    auto format = static_cast<AVPixelFormat>(frame->format);
+    int bufferSize = packedFrameSize(frame);
+    if (bufferSize <= 0) {
+        return;
+    }
+
+    // 紧密排列时各平面的大小，和 av_image_copy_to_buffer 写出的布局一致
+    int linesize[4] = {0};
+    ptrdiff_t strides[4] = {0};
+    size_t sizes[4] = {0};
+    if (av_image_fill_linesizes(linesize, format, frame->width) < 0) {
+        return;
+    }
+    for (int i = 0; i < 4; i++) {
+        strides[i] = linesize[i];
+    }
+    if (av_image_fill_plane_sizes(sizes, format, frame->height, strides) < 0) {
+        return;
+    }
+
+    TRACE_SCOPE("sink.checksum");
+    buffer_.resize(static_cast<size_t>(bufferSize));
+    av_image_copy_to_buffer(buffer_.data(), bufferSize, frame->data, frame->linesize, format,
+                            frame->width, frame->height, 1);
+    countFrameCopy();
+
+    FrameChecksum checksum;
+    checksum.pts = frame->pts;
+    checksum.width = frame->width;
+    checksum.height = frame->height;
+    checksum.format = frame->format;
+    size_t offset = 0;
+    for (int i = 0; i < 4 && sizes[i] > 0 && offset + sizes[i] <= buffer_.size(); i++) {
+        uint8_t digest[16];
+        av_md5_sum(digest, buffer_.data() + offset, sizes[i]);
+        char hex[33];
+        for (int j = 0; j < 16; j++) {
+            snprintf(hex + j * 2, 3, "%02x", digest[j]);
+        }
+        checksum.planes.emplace_back(hex, 32);
+        offset += sizes[i];
+    }
+
+    std::lock_guard<std::mutex> lock(checksumsMutex_);
+    checksums_.push_back(std::move(checksum));
+    framesRendered_++;
+    bytesRendered_ += static_cast<uint64_t>(bufferSize);
+}
+
+std::vector<ChecksumSink::FrameChecksum> ChecksumSink::takeChecksums() {
+    std::lock_guard<std::mutex> lock(checksumsMutex_);
+    return std::move(checksums_);
+}
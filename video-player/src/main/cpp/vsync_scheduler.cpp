@@ -0,0 +1,198 @@
+#define LOG_TAG "Native-Vsync"
+
+#include "vsync_scheduler.h"
+
+#include <chrono>
+#include <cmath>
+
+#include "ffmpeg_headers.h"
+#include "log.h"
+#include "metrics.h"
+#include "trace.h"
+
+namespace {
+
+    // 可接受的刷新率范围（10Hz ~ 500Hz），之外的间隔不参与估计
+    const int64_t MIN_PERIOD_US = 2000;
+    const int64_t MAX_PERIOD_US = 100000;
+    // 前几个间隔直接平均，之后按 1/16 的权重平滑
+    const int WARMUP_SAMPLES = 4;
+    const double SMOOTHING = 1.0 / 16;
+    // 连续这么多个间隔都与估计不符，视为刷新率切换
+    const int MAX_OUTLIERS = 3;
+    // alignAnchor 的搜索：把一个周期分成这么多份，检查之后这么多帧。帧数足够覆盖常见的节奏循环
+    // （24/60 为 2 帧、25/60 为 5 帧），再多周期估计的误差会累积得比要找的余量还大
+    const int ALIGN_STEPS = 64;
+    const int ALIGN_FRAMES = 30;
+
+}  // namespace
+
+void VsyncScheduler::onVsync(int64_t vsyncUs) {
+    static auto &ticks = metrics::counter("vsync.ticks");
+    static auto &missedTicks = metrics::counter("vsync.missedTicks");
+    static auto &period = metrics::counter("vsync.periodUs");
+    [[maybe_unused]] uint64_t sequence;  // 只用于 trace，关闭 trace 时没有读取
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (lastVsyncUs_ >= 0 && vsyncUs <= lastVsyncUs_) {
+            // 时间戳倒退或重复（时钟源重启），只更新基准
+            lastVsyncUs_ = vsyncUs;
+            return;
+        }
+        if (lastVsyncUs_ >= 0) {
+            auto interval = static_cast<double>(vsyncUs - lastVsyncUs_);
+            double missed = periodUs_ > 0 ? std::round(interval / periodUs_) : 1;
+            if (periodUs_ > 0 && missed >= 2 && std::abs(interval - missed * periodUs_) < periodUs_ / 4) {
+                // 时钟源漏掉了 tick（主线程繁忙时 Choreographer 会跳过回调），周期不变
+                missedTicks.add(static_cast<int64_t>(missed) - 1);
+                outliers_ = 0;
+            } else if (periodUs_ > 0 && std::abs(interval - periodUs_) > periodUs_ / 4) {
+                if (++outliers_ >= MAX_OUTLIERS) {
+                    LOGI("vsync 周期变化: %.0fus -> %.0fus", periodUs_, interval);
+                    periodUs_ = 0;
+                    samples_ = 0;
+                    outliers_ = 0;
+                }
+            } else if (interval >= MIN_PERIOD_US && interval <= MAX_PERIOD_US) {
+                samples_++;
+                double weight = samples_ <= WARMUP_SAMPLES ? 1.0 / samples_ : SMOOTHING;
+                periodUs_ += (interval - periodUs_) * weight;
+                outliers_ = 0;
+            }
+        }
+        lastVsyncUs_ = vsyncUs;
+        sequence = ++sequence_;
+        period.set(static_cast<int64_t>(periodUs_));
+    }
+    ticks.add(1);
+    TRACE_COUNTER("vsync.tick", static_cast<int64_t>(sequence & 1));
+    cv_.notify_all();
+}
+
+int64_t VsyncScheduler::waitForVsync(int64_t timeoutUs) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t sequence = sequence_;
+    uint64_t interrupts = interrupts_;
+    bool ticked = cv_.wait_for(lock, std::chrono::microseconds(timeoutUs), [&]() {
+        return sequence_ != sequence || interrupts_ != interrupts;
+    });
+    if (!ticked || interrupts_ != interrupts) {
+        return -1;
+    }
+    return lastVsyncUs_;
+}
+
+void VsyncScheduler::interrupt() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interrupts_++;
+    }
+    cv_.notify_all();
+}
+
+bool VsyncScheduler::hasEstimate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return samples_ >= WARMUP_SAMPLES;
+}
+
+int64_t VsyncScheduler::periodUs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int64_t>(periodUs_);
+}
+
+int64_t VsyncScheduler::predict(int64_t vsyncUs, int n) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return vsyncUs + static_cast<int64_t>(std::llround(periodUs_ * n));
+}
+
+int64_t VsyncScheduler::alignAnchor(int64_t anchorUs, int64_t frameIntervalUs) const {
+    double period;
+    int64_t reference;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (samples_ < WARMUP_SAMPLES || frameIntervalUs <= 0) {
+            return anchorUs;
+        }
+        period = periodUs_;
+        reference = lastVsyncUs_;
+    }
+
+    // 帧 k 的理想时间在 vsync 网格上的位置 x = (anchor + shift + k * interval - reference) / period，
+    // 显示在最近的 vsync 上，小数部分接近 0.5 时抖动就会改变归属。选让所有帧离 0.5 最远的平移，
+    // 同样好时取平移最小的
+    double base = static_cast<double>(anchorUs - reference) / period;
+    double step = static_cast<double>(frameIntervalUs) / period;
+    double bestMargin = -1;
+    double bestShift = 0;
+    for (int i = 0; i < ALIGN_STEPS; i++) {
+        // 0, +1, -1, +2, -2 ... 的顺序，平移从小到大
+        int offset = (i + 1) / 2 * (i % 2 == 1 ? 1 : -1);
+        double shift = static_cast<double>(offset) / ALIGN_STEPS;
+        double margin = 0.5;
+        for (int k = 0; k < ALIGN_FRAMES && margin > bestMargin; k++) {
+            double x = base + shift + k * step;
+            double fraction = x - std::floor(x);
+            margin = std::min(margin, std::abs(fraction - 0.5));
+        }
+        if (margin > bestMargin + 1e-9) {
+            bestMargin = margin;
+            bestShift = shift;
+        }
+    }
+    return anchorUs + static_cast<int64_t>(std::llround(bestShift * period));
+}
+
+void VsyncScheduler::reset() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastVsyncUs_ = -1;
+        periodUs_ = 0;
+        samples_ = 0;
+        outliers_ = 0;
+        interrupts_++;
+    }
+    cv_.notify_all();
+}
+
+SimulatedVsyncTicker::SimulatedVsyncTicker(VsyncScheduler &scheduler, double hz, int64_t jitterUs)
+        : scheduler_(scheduler),
+          periodUs_(static_cast<int64_t>(AV_TIME_BASE / (hz > 0 ? hz : 60.0))),
+          jitterUs_(jitterUs) {}
+
+SimulatedVsyncTicker::~SimulatedVsyncTicker() {
+    stop();
+}
+
+void SimulatedVsyncTicker::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&SimulatedVsyncTicker::run, this);
+}
+
+void SimulatedVsyncTicker::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SimulatedVsyncTicker::run() {
+    TRACE_THREAD_NAME("vsync");
+    // 线性同余序列产生抖动，同样的参数每次运行得到同样的时间戳序列
+    uint32_t seed = 12345;
+    int64_t next = av_gettime_relative() + periodUs_;
+    while (running_) {
+        int64_t wait = next - av_gettime_relative();
+        if (wait > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(wait));
+        }
+        int64_t jitter = 0;
+        if (jitterUs_ > 0) {
+            seed = seed * 1664525u + 1013904223u;
+            jitter = static_cast<int64_t>(seed >> 8) % (2 * jitterUs_ + 1) - jitterUs_;
+        }
+        scheduler_.onVsync(next + jitter);
+        next += periodUs_;
+    }
+}
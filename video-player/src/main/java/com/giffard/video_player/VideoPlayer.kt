@@ -2,18 +2,33 @@ package com.giffard.video_player
 
 
 import android.util.Log
+import android.view.Surface
 import com.giffard.video_player.decoder.VideoDecoder
 import com.giffard.video_player.decoder.VideoDecoderFactory
+import com.giffard.video_player.export.ClipExporter
 import com.giffard.video_player.renderer.VideoRenderer
+import com.giffard.video_player.renderer.VsyncTicker
 import java.nio.ByteBuffer
 
 
+/**
+ * @param pullMode 为 true 时由 GL 线程在 onDrawFrame 中按显示时间取帧，
+ * 不再启动 native 渲染线程逐帧回调 Java；为 false 时使用原来的推送模式
+ */
 class VideoPlayer(
     private val videoRenderer: VideoRenderer,
-    videoDecoderFactory: VideoDecoderFactory
+    videoDecoderFactory: VideoDecoderFactory,
+    private var pullMode: Boolean = true
 ) : VideoDecoder.DecoderListener {
 
     private var decoder: VideoDecoder? = null
+    private var downscaleThreshold = 2f
+
+    // 输出到 Surface 时由 Choreographer 的 vsync 驱动 native 渲染线程选帧
+    private var vsyncTicker: VsyncTicker? = null
+
+    // 当前播放的输入，导出片段时作为源
+    private var videoPath: String? = null
 
     companion object {
         const val TAG = "VideoPlayer"
@@ -27,23 +42,148 @@ class VideoPlayer(
     init {
         decoder = videoDecoderFactory.createDecoder()
         decoder?.setDecoderListener(this)
+        decoder?.setPullMode(pullMode)
+    }
+
+    /**
+     * 以低延迟直播模式播放，延迟优先于流畅度，需在 [start] 之前调用
+     */
+    fun setLiveMode(enabled: Boolean, mailboxSize: Int = 2) {
+        decoder?.setLiveMode(enabled, mailboxSize)
+    }
+
+    /**
+     * HLS master / DASH 输入自适应码率，需在 [start] 之前调用。
+     * 变体分辨率不同，拉模式（默认）按每帧的实际尺寸渲染
+     */
+    fun setAdaptiveBitrate(enabled: Boolean) {
+        decoder?.setAdaptiveBitrate(enabled)
+    }
+
+    /**
+     * 视频分辨率达到显示表面的 [threshold] 倍以上时在解码端降分辨率，需在 [start] 之前调用。
+     * 表面尺寸取自 GL 渲染器，渲染器的表面还没创建时不缩放
+     */
+    fun setDownscaleToSurface(enabled: Boolean, threshold: Float = 2f) {
+        downscaleThreshold = if (enabled) threshold else 0f
     }
 
     fun start(videoPath: String) {
+        this.videoPath = videoPath
+        if (downscaleThreshold > 0f && pullMode) {
+            decoder?.setTargetSurfaceSize(
+                videoRenderer.surfaceWidth,
+                videoRenderer.surfaceHeight,
+                downscaleThreshold
+            )
+        }
         decoder?.init(videoPath)
+        if (pullMode) {
+            videoRenderer.setFrameSource(decoder)
+        }
+        vsyncTicker?.start()
         decoder?.startDecoding()
     }
 
+    /**
+     * 绕过 Java 层和 GL 渲染，由 native 直接输出到 [surface]（如 SurfaceView 的 Surface），
+     * 按 Choreographer 的 vsync 选帧。需在 [start] 之前调用
+     */
+    fun setOutputSurface(surface: Surface?) {
+        if (surface != null) {
+            pullMode = false
+            decoder?.setPullMode(false)
+        }
+        decoder?.setOutputSurface(surface)
+        decoder?.setVsyncDriven(surface != null)
+        stopVsyncTicker()
+        vsyncTicker = surface?.let {
+            VsyncTicker { frameTimeNanos -> decoder?.onVsync(frameTimeNanos) }
+        }
+    }
+
+    private fun stopVsyncTicker() {
+        vsyncTicker?.let {
+            it.stop()
+            decoder?.resetVsync()
+        }
+    }
+
+    /**
+     * 只显示视频的一个子矩形（放大、监控画面），复制和纹理上传量与可见面积成正比。
+     * 播放中随时可以调用，下一帧生效；[outputWidth]/[outputHeight] 非 0 时在 native 端缩放
+     */
+    fun setRegionOfInterest(
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        outputWidth: Int = 0,
+        outputHeight: Int = 0
+    ) {
+        decoder?.setRegionOfInterest(x, y, width, height, outputWidth, outputHeight)
+    }
+
+    fun clearRegionOfInterest() {
+        decoder?.setRegionOfInterest(0, 0, 0, 0)
+    }
+
+    /**
+     * 屏幕录制、幻灯片等大段静止的内容：没变的帧不再复制和上传纹理，只变了一部分时只上传变化的块
+     */
+    fun setStaticFrameDetection(enabled: Boolean, tileSize: Int = 64, threshold: Int = 0) {
+        decoder?.setFrameChangeDetection(enabled, tileSize, threshold)
+    }
+
+    /**
+     * 把当前播放内容中 [startMs] 到 [endMs] 的部分按流复制导出到 [outputPath]（.mp4 / .mkv），不影响播放。
+     * [accurateStart] 见 [ClipExporter.start]。还没有 [start] 过或已有导出（包括其他播放器的）在进行时返回 false
+     */
+    fun exportClip(
+        outputPath: String,
+        startMs: Long,
+        endMs: Long,
+        accurateStart: Boolean = false,
+        listener: ClipExporter.Listener? = null
+    ): Boolean {
+        val source = videoPath ?: return false
+        return ClipExporter.start(source, outputPath, startMs, endMs, accurateStart, listener)
+    }
+
+    /**
+     * 取消进行中的导出。导出器是进程内共用的（见 [ClipExporter]），也会取消其他播放器启动的导出
+     */
+    fun cancelClipExport() {
+        ClipExporter.cancel()
+    }
+
+    fun pause() {
+        decoder?.pauseDecoding()
+    }
+
+    fun resume() {
+        decoder?.resumeDecoding()
+    }
+
+    fun restart() {
+        decoder?.restartDecoding()
+    }
+
     fun stop() {
+        videoRenderer.setFrameSource(null)
         decoder?.stopDecoding()
+        stopVsyncTicker()
     }
 
     fun release() {
+        videoRenderer.setFrameSource(null)
         decoder?.release()
+        stopVsyncTicker()
+        vsyncTicker = null
     }
 
     override fun onFrameDecoded(frame: ByteBuffer, width: Int, height: Int) {
-        videoRenderer.setYUVData(frame)
+        videoRenderer.setYUVData(frame, width, height)
     }
 
     override fun onVideoMetadataReady(width: Int, height: Int, frameRate: Float) {
@@ -1,6 +1,7 @@
 package com.giffard.video_player.decoder
 
 import android.util.Log
+import android.view.Surface
 import com.giffard.video_player.decoder.VideoDecoder.DecoderListener
 import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicBoolean
@@ -12,12 +13,67 @@ class FFmpegDecoder : VideoDecoder {
     private val isDecoding = AtomicBoolean(false)    // Tracks if decoding is in progress
     private var frameWidth: Int = 0
     private var frameHeight: Int = 0
+    private val frameInfo = IntArray(7)
+    private val dirtyRects = IntArray(4 * MAX_DIRTY_RECTS)
 
     // JNI Method Declarations
     private external fun initDecoder(videoPath: String): IntArray
     private external fun startNativeDecoding()
     private external fun stopNativeDecoding()
+    private external fun pauseNativeDecoding()
+    private external fun resumeNativeDecoding()
+    private external fun restartNativeDecoding()
     private external fun releaseDecoder()
+    private external fun dumpTrace(outputPath: String): Boolean
+    private external fun setAtraceEnabled(enabled: Boolean)
+    private external fun setNativePullMode(enabled: Boolean)
+    private external fun setNativeVsyncDriven(enabled: Boolean)
+    private external fun onNativeVsync(frameTimeNanos: Long)
+    private external fun resetNativeVsync()
+    private external fun setNativeFrameChangeDetection(enabled: Boolean, tileSize: Int, threshold: Int)
+    private external fun resetNativeFrameChanges()
+    private external fun setNativeLiveMode(enabled: Boolean, mailboxSize: Int)
+    private external fun setNativeAbrEnabled(enabled: Boolean)
+    private external fun setNativeTargetSurfaceSize(width: Int, height: Int, threshold: Float)
+    private external fun setNativeStreamSelection(preferredCodecs: String?, discardUnused: Boolean)
+    private external fun setNativeHighBitDepthOutput(dither: Boolean)
+    private external fun setNativeSceneDetection(enabled: Boolean, threshold: Float, minSceneUs: Long)
+    private external fun takeNativeSceneCuts(): DoubleArray
+    private external fun setNativeThreadPreset(preset: Int)
+    private external fun setNativeThreadPolicy(role: Int, nice: Int, realtimePriority: Int, cpuMask: Long)
+    private external fun getNativeCoreMasks(): LongArray
+    private external fun describeNativeThreads(): String
+    private external fun setNativeRegionOfInterest(
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        outputWidth: Int,
+        outputHeight: Int
+    )
+    private external fun acquireLatestFrame(
+        presentationTimeNs: Long,
+        frameInfo: IntArray,
+        planes: Array<ByteBuffer?>,
+        dirtyRects: IntArray
+    ): Long
+    private external fun releaseFrame(handle: Long)
+    private external fun subscribeNativeFrames(name: String, capacity: Int, dropOldest: Boolean): Long
+    private external fun unsubscribeNativeFrames(subscription: Long)
+    private external fun releaseNativeSubscription(subscription: Long)
+    private external fun acquireSubscribedFrame(
+        subscription: Long,
+        timeoutUs: Long,
+        frameInfo: IntArray,
+        planes: Array<ByteBuffer?>,
+        ptsUs: LongArray
+    ): Long
+    private external fun getNativeSubscriberStats(subscription: Long): LongArray
+    private external fun setNativeSurface(surface: Surface?)
+    private external fun getNativeMetrics(): String
+    private external fun setDecoderPoolCapacity(capacity: Int)
+    private external fun setMediaCache(directory: String?, capacityBytes: Long): Boolean
+    private external fun setMemoryBudget(budgetBytes: Long)
 
     override fun init(videoPath: String) {
         if (isInitialized.get()) {
@@ -81,6 +137,33 @@ class FFmpegDecoder : VideoDecoder {
         }
     }
 
+    override fun pauseDecoding() {
+        if (!isDecoding.get()) {
+            Log.w(TAG, "Decoding is not in progress.")
+            return
+        }
+        pauseNativeDecoding()
+        Log.i(TAG, "Paused decoding")
+    }
+
+    override fun resumeDecoding() {
+        if (!isDecoding.get()) {
+            Log.w(TAG, "Decoding is not in progress.")
+            return
+        }
+        resumeNativeDecoding()
+        Log.i(TAG, "Resumed decoding")
+    }
+
+    override fun restartDecoding() {
+        if (!isDecoding.get()) {
+            Log.w(TAG, "Decoding is not in progress.")
+            return
+        }
+        restartNativeDecoding()
+        Log.i(TAG, "Restarted decoding")
+    }
+
     override fun release() {
         if (!isInitialized.get()) {
             Log.w(TAG, "Decoder not initialized. Nothing to release.")
@@ -98,11 +181,274 @@ class FFmpegDecoder : VideoDecoder {
         }
     }
 
+    /**
+     * 导出管线 trace（Chrome trace JSON），仅在 VP_ENABLE_TRACE 构建中有效
+     */
+    fun exportTrace(outputPath: String): Boolean {
+        return try {
+            dumpTrace(outputPath)
+        } catch (e: Exception) {
+            Log.e(TAG, "Error exporting trace: ${e.message}")
+            false
+        }
+    }
+
+    /**
+     * native 运行时指标（JSON 对象），如 decoderPool.hits / decoderPool.savedOpenUs
+     */
+    fun getMetrics(): String = getNativeMetrics()
+
+    /**
+     * 场景切换检测：解码出的帧以引用交给 native 的分析线程，不影响解码和显示。得分（0 ~ 100）达到
+     * [threshold] 且距上一个切换点不短于 [minSceneMs] 时记为切换点，用 [takeSceneCuts] 取出。
+     * 每帧分析耗时见 [getMetrics] 中的 scene.microsPerFrame，播放中随时可以修改
+     */
+    fun setSceneDetection(enabled: Boolean, threshold: Float = 10f, minSceneMs: Long = 500) {
+        setNativeSceneDetection(enabled, threshold, minSceneMs * 1000)
+    }
+
+    /**
+     * 取出上次调用以来检测到的场景切换点，按时间顺序
+     */
+    fun takeSceneCuts(): List<SceneCut> {
+        val values = takeNativeSceneCuts()
+        return List(values.size / 2) { i ->
+            SceneCut((values[i * 2] / 1000).toLong(), values[i * 2 + 1].toFloat())
+        }
+    }
+
+    /**
+     * 订阅解码帧，供显示以外的消费者（分析模型、录制器等）使用。订阅者拿到的是 native 帧的引用，不复制像素；
+     * 每个订阅者有自己的长度为 [capacity] 的队列，满了丢弃最旧（[dropOldest]）或最新的帧，
+     * 慢的订阅者只会让自己丢帧，不影响解码和显示。各订阅者的指标见 [getMetrics] 中的 fanout.<name>.*，
+     * [name] 应当唯一。不再使用时必须调用 [FrameSubscription.close]
+     */
+    fun subscribeFrames(name: String, capacity: Int = 4, dropOldest: Boolean = true): FrameSubscription =
+        FrameSubscription(this, subscribeNativeFrames(name, capacity, dropOldest))
+
+    internal fun unsubscribeFrames(subscription: Long) {
+        unsubscribeNativeFrames(subscription)
+    }
+
+    internal fun releaseSubscription(subscription: Long) {
+        releaseNativeSubscription(subscription)
+    }
+
+    internal fun acquireSubscribedFrame(
+        subscription: Long,
+        timeoutUs: Long,
+        frameInfo: IntArray,
+        ptsUs: LongArray
+    ): VideoFrame? {
+        val planes = arrayOfNulls<ByteBuffer>(3)
+        val handle = acquireSubscribedFrame(subscription, timeoutUs, frameInfo, planes, ptsUs)
+        if (handle == 0L) {
+            return null
+        }
+        return VideoFrame(
+            handle,
+            frameInfo[0],
+            frameInfo[1],
+            frameInfo[2],
+            planes,
+            intArrayOf(frameInfo[3], frameInfo[4], frameInfo[5]),
+            timeUs = ptsUs[0]
+        )
+    }
+
+    internal fun getSubscriberStats(subscription: Long): LongArray = getNativeSubscriberStats(subscription)
+
+    /**
+     * 设置解码器上下文复用池的容量，0 表示每次都重新打开解码器
+     */
+    fun setDecoderReuseCapacity(capacity: Int) {
+        setDecoderPoolCapacity(capacity)
+    }
+
+    /**
+     * native 播放管线的内存硬预算（字节），0 表示不限制。接近预算时解码线程停止提前解码，
+     * 各分类的当前/峰值占用见 [getMetrics] 中的 memory.*
+     */
+    fun setMemoryLimit(budgetBytes: Long) {
+        setMemoryBudget(budgetBytes)
+    }
+
+    /**
+     * 网络媒体（HLS/DASH 分片、HTTP 文件的字节范围）的磁盘缓存，重播和往回 seek 时从磁盘读取。
+     * 按 [capacityBytes] 做 LRU 淘汰，[directory] 为 null 或容量为 0 时关闭。对之后 [init] 的输入生效
+     */
+    fun setDiskCache(directory: String?, capacityBytes: Long): Boolean {
+        return setMediaCache(directory, capacityBytes)
+    }
+
+    /**
+     * 视频流选择：文件有多个视频流时按 [preferredCodecs]（逗号分隔的 FFmpeg 编码名，如 "hevc,h264"）
+     * 的顺序优先，null 时由 FFmpeg 选择最佳流。[discardUnusedStreams] 为 true（默认）时音频、字幕
+     * 等其余流在解复用时直接丢弃，读取量见 [getMetrics] 中的 demux.*。需在 [init] 之前设置
+     */
+    fun setStreamSelection(preferredCodecs: String?, discardUnusedStreams: Boolean = true) {
+        if (isInitialized.get()) {
+            Log.w(TAG, "Stream selection must be set before init().")
+            return
+        }
+        setNativeStreamSelection(preferredCodecs, discardUnusedStreams)
+    }
+
+    /**
+     * 按预设设置 native 管线线程（解码、渲染、分析、后台任务）的优先级和 CPU 亲和性，
+     * 对正在运行的线程立即生效。没有权限提高优先级时该项不生效，次数见 [getMetrics] 中的 threads.policyFailures
+     */
+    fun setThreadPreset(preset: ThreadPreset) {
+        setNativeThreadPreset(preset.ordinal)
+    }
+
+    /**
+     * 单独设置一类线程：[nice] 为 -20 ~ 19（越小越优先），[realtimePriority] 大于 0 时改用 SCHED_FIFO，
+     * [cpuMask] 的第 i 位对应 cpu i，0 表示不限制，可以由 [bigCoreMask] / [littleCoreMask] 组合
+     */
+    fun setThreadPolicy(thread: PipelineThread, nice: Int, cpuMask: Long = 0, realtimePriority: Int = 0) {
+        setNativeThreadPolicy(thread.ordinal, nice, realtimePriority, cpuMask)
+    }
+
+    /**
+     * 大核的 CPU 掩码；各核相同的设备上是全部核心
+     */
+    fun bigCoreMask(): Long = getNativeCoreMasks()[0]
+
+    /**
+     * 小核的 CPU 掩码；各核相同的设备上是全部核心
+     */
+    fun littleCoreMask(): Long = getNativeCoreMasks()[1]
+
+    /**
+     * 各类线程当前的调度配置和线程数，用于日志
+     */
+    fun describeThreads(): String = describeNativeThreads()
+
+    /**
+     * HEVC Main10 等 10/12 位输入在入队前转换成 8 位 YUV420P，[dither] 为 true 时用有序抖动减少
+     * 平滑渐变里的色带。只转换位深，不做 HDR 色调映射，转换帧数见 [getMetrics] 中的 bitdepth.frames。
+     * 需在 [init] 之前设置
+     */
+    fun setHighBitDepthDither(dither: Boolean) {
+        if (isInitialized.get()) {
+            Log.w(TAG, "High bit depth output must be set before init().")
+            return
+        }
+        setNativeHighBitDepthOutput(dither)
+    }
+
+    /**
+     * 将管线 trace 事件同时转发到系统 ATrace
+     */
+    fun enableSystemTrace(enabled: Boolean) {
+        setAtraceEnabled(enabled)
+    }
+
+    override fun setOutputSurface(surface: Surface?) {
+        if (isDecoding.get()) {
+            Log.w(TAG, "Output surface must be set before decoding starts.")
+            return
+        }
+        setNativeSurface(surface)
+    }
+
+    override fun setLiveMode(enabled: Boolean, mailboxSize: Int) {
+        if (isInitialized.get()) {
+            Log.w(TAG, "Live mode must be set before init().")
+            return
+        }
+        setNativeLiveMode(enabled, mailboxSize)
+    }
+
+    override fun setAdaptiveBitrate(enabled: Boolean) {
+        if (isInitialized.get()) {
+            Log.w(TAG, "Adaptive bitrate must be set before init().")
+            return
+        }
+        setNativeAbrEnabled(enabled)
+    }
+
+    override fun setTargetSurfaceSize(width: Int, height: Int, threshold: Float) {
+        if (isInitialized.get()) {
+            Log.w(TAG, "Target surface size must be set before init().")
+            return
+        }
+        setNativeTargetSurfaceSize(width, height, threshold)
+    }
+
+    override fun setRegionOfInterest(
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        outputWidth: Int,
+        outputHeight: Int
+    ) {
+        setNativeRegionOfInterest(x, y, width, height, outputWidth, outputHeight)
+    }
+
+    override fun setPullMode(enabled: Boolean) {
+        if (isDecoding.get()) {
+            Log.w(TAG, "Pull mode must be set before decoding starts.")
+            return
+        }
+        setNativePullMode(enabled)
+    }
+
+    override fun setFrameChangeDetection(enabled: Boolean, tileSize: Int, threshold: Int) {
+        setNativeFrameChangeDetection(enabled, tileSize, threshold)
+    }
+
+    override fun setVsyncDriven(enabled: Boolean) {
+        if (isDecoding.get()) {
+            Log.w(TAG, "Vsync driven output must be set before decoding starts.")
+            return
+        }
+        setNativeVsyncDriven(enabled)
+    }
+
+    override fun onVsync(frameTimeNanos: Long) {
+        onNativeVsync(frameTimeNanos)
+    }
+
+    override fun resetVsync() {
+        resetNativeVsync()
+    }
+
+    override fun acquireLatestFrame(presentationTimeNs: Long): VideoFrame? {
+        if (!isDecoding.get()) {
+            return null
+        }
+        val planes = arrayOfNulls<ByteBuffer>(3)
+        val handle = acquireLatestFrame(presentationTimeNs, frameInfo, planes, dirtyRects)
+        if (handle == 0L) {
+            return null
+        }
+        return VideoFrame(
+            handle,
+            frameInfo[0],
+            frameInfo[1],
+            frameInfo[2],
+            planes,
+            intArrayOf(frameInfo[3], frameInfo[4], frameInfo[5]),
+            if (frameInfo[6] > 0) dirtyRects.copyOf(4 * frameInfo[6]) else null
+        )
+    }
+
+    override fun onContentLost() {
+        resetNativeFrameChanges()
+    }
+
+    override fun releaseFrame(frame: VideoFrame) {
+        releaseFrame(frame.handle)
+    }
+
     override fun setDecoderListener(listener: DecoderListener) {
         decoderListener = listener
     }
 
-    override fun onFrameDecoded(frame: ByteBuffer?) {
+    override fun onFrameDecoded(frame: ByteBuffer?, width: Int, height: Int) {
         if (decoderListener == null) {
             Log.w(TAG, "No listener set. Decoded frame will not be processed.")
             return
@@ -119,7 +465,7 @@ class FFmpegDecoder : VideoDecoder {
                         clear()
                         put(it)
                         flip()
-                        decoderListener?.onFrameDecoded(this, frameWidth, frameHeight)
+                        decoderListener?.onFrameDecoded(this, width, height)
                     }
                 } catch (e: Exception) {
                     Log.e(TAG, "Error processing decoded frame: ${e.message}")
@@ -130,5 +476,8 @@ class FFmpegDecoder : VideoDecoder {
 
     companion object {
         private const val TAG = "FFmpegDecoder"
+
+        // 一帧最多报告的变化矩形数，超过时按整帧上传
+        private const val MAX_DIRTY_RECTS = 256
     }
 }
@@ -0,0 +1,18 @@
+package com.giffard.video_player.decoder
+
+/**
+ * 拉模式帧来源：GL 线程在 onDrawFrame 中按显示时间取帧，而不是由 native 渲染线程推送
+ */
+interface FrameSource {
+    /**
+     * 获取最适合 [presentationTimeNs]（System.nanoTime 时基）显示的帧，没有新帧时返回 null
+     */
+    fun acquireLatestFrame(presentationTimeNs: Long): VideoFrame?
+
+    fun releaseFrame(frame: VideoFrame)
+
+    /**
+     * 显示端丢失了已上传的画面（如 GL 上下文重建），下一帧必须整帧返回
+     */
+    fun onContentLost() {}
+}
@@ -0,0 +1,77 @@
+package com.giffard.video_player.decoder
+
+/**
+ * [FFmpegDecoder.subscribeFrames] 返回的解码帧订阅。同一个订阅应当只在一个线程上取帧；
+ * 取到的帧用 [release] 归还，持有期间 native 不会复用这块内存，但持有太久会让自己的队列丢帧
+ */
+class FrameSubscription internal constructor(
+    private val decoder: FFmpegDecoder,
+    private val handle: Long
+) {
+    // 保护 closed 和 inFlight：close 在释放 native 句柄前等待进行中的 acquire / stats 结束
+    private val lock = Object()
+    private var closed = false
+    private var inFlight = 0
+    private val frameInfo = IntArray(6)
+    private val ptsUs = LongArray(1)
+
+    /**
+     * 订阅者的统计：[delivered] 已取走的帧数，[dropped] 因队列满丢弃的帧数，[queued] 当前排队的帧数，
+     * [lagMs] 最新解码的帧与最近取走的帧之间的媒体时间差
+     */
+    data class Stats(
+        val delivered: Long,
+        val dropped: Long,
+        val queued: Int,
+        val lagMs: Long
+    )
+
+    /**
+     * 取下一帧，最多等待 [timeoutMs]（0 不等待），没有帧或已关闭时返回 null
+     */
+    fun acquire(timeoutMs: Long = 0): VideoFrame? =
+        withHandle(null) { decoder.acquireSubscribedFrame(handle, timeoutMs * 1000, frameInfo, ptsUs) }
+
+    fun release(frame: VideoFrame) {
+        decoder.releaseFrame(frame)
+    }
+
+    fun stats(): Stats = withHandle(Stats(0, 0, 0, 0)) {
+        val values = decoder.getSubscriberStats(handle)
+        Stats(values[0], values[1], values[2].toInt(), values[3] / 1000)
+    }
+
+    /**
+     * 取消订阅，队列里剩下的帧随之释放，正在等待的 [acquire] 立即返回 null；已经取走的帧仍需 [release]
+     */
+    fun close() {
+        synchronized(lock) {
+            if (closed) return
+            closed = true
+        }
+        // 先关闭 native 队列唤醒等待中的 acquire，等它们返回后再释放句柄
+        decoder.unsubscribeFrames(handle)
+        synchronized(lock) {
+            while (inFlight > 0) {
+                lock.wait()
+            }
+        }
+        decoder.releaseSubscription(handle)
+    }
+
+    private inline fun <T> withHandle(closedValue: T, block: () -> T): T {
+        synchronized(lock) {
+            if (closed) return closedValue
+            inFlight++
+        }
+        try {
+            return block()
+        } finally {
+            synchronized(lock) {
+                if (--inFlight == 0) {
+                    lock.notifyAll()
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,18 @@
+package com.giffard.video_player.decoder
+
+/**
+ * native 管线线程的角色，顺序与 native 的 scheduling::Role 一致
+ */
+enum class PipelineThread {
+    /** 解复用和解码 */
+    DECODE,
+
+    /** 推送模式的渲染线程 */
+    RENDER,
+
+    /** 场景检测等旁路分析 */
+    ANALYSIS,
+
+    /** 片段导出、媒体库探测 */
+    BACKGROUND
+}
@@ -0,0 +1,10 @@
+package com.giffard.video_player.decoder
+
+/**
+ * 场景切换点：[timeMs] 为新场景第一帧的媒体时间，[score] 为 0 ~ 100 的切换强度，
+ * 可用于自动章节和挑选缩略图（切换点之后的帧）
+ */
+data class SceneCut(
+    val timeMs: Long,
+    val score: Float
+)
@@ -0,0 +1,18 @@
+package com.giffard.video_player.decoder
+
+/**
+ * native 管线线程的调度预设，顺序与 native 的 scheduling::Preset 一致
+ */
+enum class ThreadPreset {
+    /** 恢复默认：nice 0、不限制核心，交给系统调度 */
+    DEFAULT,
+
+    /** 解码和渲染放在大核并提高优先级 */
+    PERFORMANCE,
+
+    /** 所有线程放在小核，分析和后台任务降低优先级 */
+    EFFICIENCY,
+
+    /** 只有渲染放在大核，解码不限制，分析和后台任务放在小核 */
+    BALANCED
+}
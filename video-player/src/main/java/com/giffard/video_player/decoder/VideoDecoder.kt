@@ -1,12 +1,90 @@
 package com.giffard.video_player.decoder
 
+import android.view.Surface
 import java.nio.ByteBuffer
 
-interface VideoDecoder {
+interface VideoDecoder : FrameSource {
     fun init(videoPath: String)
+    fun setPullMode(enabled: Boolean)
+
+    /**
+     * 低延迟直播模式（RTSP/RTMP/HTTP-FLV）：最小探测、只保留 [mailboxSize]（1~2）帧、
+     * 到达即显示，积压时丢帧追赶。需在 [init] 之前设置
+     */
+    fun setLiveMode(enabled: Boolean, mailboxSize: Int = 2)
+
+    /**
+     * HLS master / DASH 输入按下载吞吐和缓冲自适应选择码率，在分片边界切换变体。需在 [init] 之前设置
+     */
+    fun setAdaptiveBitrate(enabled: Boolean)
+
+    /**
+     * 显示表面尺寸：视频分辨率达到表面的 [threshold] 倍以上时在解码端降分辨率，
+     * 之后的复制和纹理上传都按缩小后的尺寸进行。传 0 表示不缩放，需在 [init] 之前设置
+     */
+    fun setTargetSurfaceSize(width: Int, height: Int, threshold: Float = 2f)
+
+    /**
+     * 输出区域：只复制、上传帧中 ([x], [y], [width], [height]) 的部分，坐标相对于 init 返回的尺寸；
+     * [outputWidth]/[outputHeight] 非 0 时再缩放到该尺寸。播放中随时可以修改，下一帧生效，
+     * [width]/[height] 为 0 恢复整帧。区域按色度抽样对齐，实际帧尺寸以拉模式取到的帧为准
+     */
+    fun setRegionOfInterest(
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        outputWidth: Int = 0,
+        outputHeight: Int = 0
+    )
+
+    /**
+     * 推送模式下直接把帧写入 [surface]（native ANativeWindow 输出），不经过 Java 回调；
+     * 传 null 恢复为 onFrameDecoded 回调输出。需在开始解码前设置
+     */
+    fun setOutputSurface(surface: Surface?)
+
+    /**
+     * 静态帧检测（屏幕录制、幻灯片）：按 [tileSize] 的块与上一次输出的画面比较，没变的帧不再复制、
+     * 上传，拉模式下只变了一部分时只上传变化的块。每像素平均差不超过 [threshold] 的块视为没变，
+     * 0 表示逐字节相同。省掉的字节比例见 FFmpegDecoder.getMetrics 中的 change.skippedPercent，播放中随时可以修改
+     */
+    fun setFrameChangeDetection(enabled: Boolean, tileSize: Int = 64, threshold: Int = 0)
+
+    /**
+     * vsync 驱动的推送输出：native 渲染线程不按帧时间睡眠，而是在 [onVsync] 送来的每个 vsync 上
+     * 为下一次 vsync 选出 PTS 最合适的帧（如 24fps 在 60Hz 上得到稳定的 3:2 节奏）。需在开始解码前设置
+     */
+    fun setVsyncDriven(enabled: Boolean)
+
+    /**
+     * 外部 vsync 时钟源（Choreographer.FrameCallback）每帧调用一次，[frameTimeNanos] 为 vsync 时间
+     */
+    fun onVsync(frameTimeNanos: Long)
+
+    /**
+     * 时钟源停止后调用，重新开始时重新估计 vsync 周期
+     */
+    fun resetVsync()
     fun startDecoding()
-    fun onFrameDecoded(frame: ByteBuffer?)
+
+    /**
+     * 推送模式下 native 渲染线程回调，[width]、[height] 为这一帧的实际尺寸，
+     * 设置 ROI 或 ABR 切换分辨率后与 onVideoMetadataReady 报告的尺寸不同
+     */
+    fun onFrameDecoded(frame: ByteBuffer?, width: Int, height: Int)
     fun stopDecoding()
+
+    /**
+     * 暂停/恢复：native 线程停在播放时钟上，解码器和已解码的帧保持不变
+     */
+    fun pauseDecoding()
+    fun resumeDecoding()
+
+    /**
+     * 从头重新播放，不重建 native 线程和解码器
+     */
+    fun restartDecoding()
     fun release()
 
     interface DecoderListener {
@@ -0,0 +1,22 @@
+package com.giffard.video_player.decoder
+
+import java.nio.ByteBuffer
+
+/**
+ * 拉模式下由 [FrameSource.acquireLatestFrame] 返回的解码帧。
+ * planes 直接指向 native 解码帧的各平面内存，strides 为对应的行字节数，
+ * 使用完毕后必须调用 [FrameSource.releaseFrame] 归还，之后不能再访问 planes。
+ * dirtyRects 不为 null 时只有这些区域相对上一帧变化，依次为 [x, y, width, height]（亮度坐标），
+ * 显示端可以只上传这些区域；为 null 时整帧更新。
+ * timeUs 为帧的媒体时间（微秒），只有 [FrameSubscription.acquire] 返回的帧填入，其余为 -1。
+ */
+class VideoFrame(
+    val handle: Long,
+    val width: Int,
+    val height: Int,
+    val format: Int,
+    val planes: Array<ByteBuffer?>,
+    val strides: IntArray,
+    val dirtyRects: IntArray? = null,
+    val timeUs: Long = -1
+)
@@ -0,0 +1,105 @@
+package com.giffard.video_player.export
+
+import android.util.Log
+
+/**
+ * 片段导出：把输入的一段时间按包原样复制重新封装成 MP4 / MKV（由输出文件扩展名决定），
+ * 不解码也不编码，速度只受读写速度限制。默认从起点之前最近的关键帧切入；[start] 的
+ * accurateStart 为 true 时只重新编码开头一个 GOP，片段从起点那一帧开始（H.264 / HEVC / VP8 / VP9，
+ * 其余编码退回关键帧切入）。导出在 native 后台线程进行。native 层只有一个导出器，所以这里是进程内的单例：
+ * 同一时间只能有一个导出，[cancel] 和 [progress] 作用于当前进行中的导出，不论是谁启动的
+ */
+object ClipExporter {
+
+    private const val TAG = "ClipExporter"
+    private const val STATE_FINISHED = 2
+    private const val STATE_CANCELLED = 4
+
+    init {
+        System.loadLibrary("video_player")
+    }
+
+    enum class Result {
+        FINISHED,
+        FAILED,
+        CANCELLED,
+    }
+
+    /**
+     * 回调都在 native 导出线程上执行，更新界面需要自己切到主线程
+     */
+    interface Listener {
+        /** [fraction] 为 0 ~ 1 的完成比例，每前进 1% 回调一次 */
+        fun onProgress(fraction: Float)
+
+        /** 失败时 [error] 为原因，未完成的输出文件已被删除 */
+        fun onFinished(result: Result, error: String?)
+    }
+
+    private external fun startNativeExport(
+        inputPath: String,
+        outputPath: String,
+        startUs: Long,
+        endUs: Long,
+        accurateStart: Boolean,
+        callback: ExportCallback
+    ): Boolean
+    private external fun cancelNativeExport()
+    private external fun getNativeExportProgress(): Float
+
+    /**
+     * 导出 [inputPath] 中 [startMs] 到 [endMs]（小于 0 表示到结尾）的部分到 [outputPath]。
+     * 已有导出在进行时返回 false，进行中的导出仍然回调它自己的 listener
+     */
+    fun start(
+        inputPath: String,
+        outputPath: String,
+        startMs: Long,
+        endMs: Long = -1,
+        accurateStart: Boolean = false,
+        listener: Listener? = null
+    ): Boolean {
+        val endUs = if (endMs >= 0) endMs * 1000 else -1
+        val started = startNativeExport(
+            inputPath, outputPath, startMs * 1000, endUs, accurateStart, ExportCallback(listener)
+        )
+        if (!started) {
+            Log.w(TAG, "Another export is in progress.")
+        }
+        return started
+    }
+
+    /**
+     * 取消进行中的导出，结束后以 [Result.CANCELLED] 回调 [Listener.onFinished]
+     */
+    fun cancel() {
+        cancelNativeExport()
+    }
+
+    val progress: Float
+        get() = getNativeExportProgress()
+
+    // 一次导出的回调目标：native 持有它的全局引用直到这次导出结束，之后的 start 不会改变它的 listener
+    private class ExportCallback(private val listener: Listener?) {
+
+        // 由 native 导出线程调用
+        @Suppress("unused")
+        fun onNativeProgress(fraction: Float) {
+            listener?.onProgress(fraction)
+        }
+
+        // state 与 native ClipExporter::State 的顺序一致：2 完成，3 失败，4 取消
+        @Suppress("unused")
+        fun onNativeFinished(state: Int, error: String) {
+            val result = when (state) {
+                STATE_FINISHED -> Result.FINISHED
+                STATE_CANCELLED -> Result.CANCELLED
+                else -> Result.FAILED
+            }
+            if (result == Result.FAILED) {
+                Log.e(TAG, "Export failed: $error")
+            }
+            listener?.onFinished(result, error.ifEmpty { null })
+        }
+    }
+}
@@ -0,0 +1,102 @@
+package com.giffard.video_player.library
+
+import java.io.File
+
+/**
+ * 媒体库里一个文件的元数据，[videoCodec] / [audioCodec] 为 FFmpeg 的编码名（如 "hevc"、"aac"）
+ */
+data class MediaInfo(
+    val durationMs: Long,
+    val width: Int,
+    val height: Int,
+    val rotation: Int,
+    val frameRate: Float,
+    val bitRate: Long,
+    val videoCodec: String?,
+    val audioCodec: String?
+)
+
+/**
+ * [size] 和 [modifiedTime] 是缓存的校验值，从 MediaStore 查询时直接传 SIZE 和 DATE_MODIFIED，
+ * 小于 0 时由 native 对 [path] 做 stat
+ */
+data class ProbeRequest(
+    val path: String,
+    val size: Long = -1,
+    val modifiedTime: Long = -1
+)
+
+/**
+ * 媒体库元数据批量探测：native 在有界的线程池上并行打开文件，只读容器头，不解码。结果按
+ * (路径, 大小, 修改时间) 缓存并持久化到 [setCacheFile] 指定的文件，缓存已热时整个库的扫描只需几毫秒
+ */
+object MediaProber {
+
+    init {
+        System.loadLibrary("video_player")
+    }
+
+    // 每个文件在 numbers 中占的位置：valid、durationUs、width、height、rotation、bitRate
+    private const val NUMBER_FIELDS = 6
+
+    private external fun setNativeCacheFile(path: String?): Boolean
+    private external fun probeNative(
+        paths: Array<String>,
+        sizes: LongArray,
+        modifiedTimes: LongArray,
+        threads: Int,
+        numbers: LongArray,
+        frameRates: FloatArray,
+        codecs: Array<String?>
+    ): Boolean
+
+    /**
+     * 持久化文件，一般放在 cacheDir 下；null 时只在进程内缓存
+     */
+    fun setCacheFile(file: File?): Boolean {
+        return setNativeCacheFile(file?.absolutePath)
+    }
+
+    /**
+     * 按 [requests] 的顺序返回元数据，无法读取的文件为 null。未命中缓存的文件最多用 [threads]
+     * 个线程并行探测（0 表示按 CPU 核数），会阻塞调用线程，不要在主线程调用
+     */
+    fun probe(requests: List<ProbeRequest>, threads: Int = 0): List<MediaInfo?> {
+        val count = requests.size
+        if (count == 0) {
+            return emptyList()
+        }
+        val numbers = LongArray(count * NUMBER_FIELDS)
+        val frameRates = FloatArray(count)
+        val codecs = arrayOfNulls<String>(count * 2)
+        val ok = probeNative(
+            Array(count) { requests[it].path },
+            LongArray(count) { requests[it].size },
+            LongArray(count) { requests[it].modifiedTime },
+            threads,
+            numbers,
+            frameRates,
+            codecs
+        )
+        if (!ok) {
+            return List(count) { null }
+        }
+        return List(count) { i ->
+            val base = i * NUMBER_FIELDS
+            if (numbers[base] == 0L) {
+                null
+            } else {
+                MediaInfo(
+                    durationMs = if (numbers[base + 1] >= 0) numbers[base + 1] / 1000 else -1,
+                    width = numbers[base + 2].toInt(),
+                    height = numbers[base + 3].toInt(),
+                    rotation = numbers[base + 4].toInt(),
+                    frameRate = frameRates[i],
+                    bitRate = numbers[base + 5],
+                    videoCodec = codecs[i * 2],
+                    audioCodec = codecs[i * 2 + 1]
+                )
+            }
+        }
+    }
+}
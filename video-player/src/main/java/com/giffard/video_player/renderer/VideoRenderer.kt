@@ -3,6 +3,8 @@ package com.giffard.video_player.renderer
 import android.opengl.GLES20
 import android.opengl.GLSurfaceView
 import android.util.Log
+import com.giffard.video_player.decoder.FrameSource
+import com.giffard.video_player.decoder.VideoFrame
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
 import java.nio.FloatBuffer
@@ -32,13 +34,18 @@ class VideoRenderer :
             uniform sampler2D uTextureY;
             uniform sampler2D uTextureU;
             uniform sampler2D uTextureV;
+            // 纹理按 stride 上传时，有效宽度占纹理宽度的比例
+            uniform float uScaleY;
+            uniform float uScaleUV;
             varying vec2 vTexCoord;
             
             void main() {
                 // 取 YUV 值
-                float y = texture2D(uTextureY, vTexCoord).r;
-                float u = texture2D(uTextureU, vTexCoord).r - 0.5;
-                float v = texture2D(uTextureV, vTexCoord).r - 0.5;
+                vec2 yCoord = vec2(vTexCoord.x * uScaleY, vTexCoord.y);
+                vec2 uvCoord = vec2(vTexCoord.x * uScaleUV, vTexCoord.y);
+                float y = texture2D(uTextureY, yCoord).r;
+                float u = texture2D(uTextureU, uvCoord).r - 0.5;
+                float v = texture2D(uTextureV, uvCoord).r - 0.5;
                 
                 // BT.601 标准的 YUV 到 RGB 转换
                 vec3 rgb;
@@ -58,6 +65,10 @@ class VideoRenderer :
     private var yTextureHandle = 0
     private var uTextureHandle = 0
     private var vTextureHandle = 0
+    private var scaleYHandle = 0
+    private var scaleUVHandle = 0
+    private var scaleY = 1f
+    private var scaleUV = 1f
 
     // YUV 纹理 ID
     private val textureIds = IntArray(3)
@@ -76,8 +87,28 @@ class VideoRenderer :
     private var frameAvailable = false
 
     private var currentBuffer: ByteBuffer? = null
+    // currentBuffer 里那一帧的尺寸
+    private var currentWidth = 0
+    private var currentHeight = 0
     private val bufferLock = Object()
 
+    // 显示表面尺寸，解码端据此降分辨率；表面还没创建时为 0
+    @Volatile
+    var surfaceWidth = 0
+        private set
+
+    @Volatile
+    var surfaceHeight = 0
+        private set
+
+    // 拉模式帧来源，设置后在 onDrawFrame 中按显示时间取帧
+    @Volatile
+    private var frameSource: FrameSource? = null
+
+    // 纹理里现有内容的行宽和高度，帧的布局相同时才能只上传变化的区域
+    private val uploadedStrides = IntArray(3)
+    private var uploadedHeight = 0
+
     init {
         // 修改顶点坐标和纹理坐标
         val vertexData = floatArrayOf(
@@ -118,6 +149,13 @@ class VideoRenderer :
         yTextureHandle = GLES20.glGetUniformLocation(programId, "uTextureY")
         uTextureHandle = GLES20.glGetUniformLocation(programId, "uTextureU")
         vTextureHandle = GLES20.glGetUniformLocation(programId, "uTextureV")
+        scaleYHandle = GLES20.glGetUniformLocation(programId, "uScaleY")
+        scaleUVHandle = GLES20.glGetUniformLocation(programId, "uScaleUV")
+
+        // 新上下文里的纹理是空的，下一帧整帧上传
+        uploadedStrides.fill(0)
+        uploadedHeight = 0
+        frameSource?.onContentLost()
 
         // 创建纹理
         GLES20.glGenTextures(3, textureIds, 0)
@@ -132,12 +170,26 @@ class VideoRenderer :
 
     override fun onSurfaceChanged(gl: GL10?, width: Int, height: Int) {
         GLES20.glViewport(0, 0, width, height)
+        surfaceWidth = width
+        surfaceHeight = height
     }
 
     override fun onDrawFrame(gl: GL10?) {
-        synchronized(bufferLock) {
-            if (currentBuffer != null) {
-                updateYUVTextures(currentBuffer!!)
+        val source = frameSource
+        if (source != null) {
+            // 拉模式：只上传本次显示需要的帧，没有新帧时保留上一帧纹理
+            source.acquireLatestFrame(System.nanoTime())?.let { frame ->
+                try {
+                    updateYUVTextures(frame)
+                } finally {
+                    source.releaseFrame(frame)
+                }
+            }
+        } else {
+            synchronized(bufferLock) {
+                if (currentBuffer != null) {
+                    updateYUVTextures(currentBuffer!!, currentWidth, currentHeight)
+                }
             }
         }
 
@@ -146,6 +198,8 @@ class VideoRenderer :
         
         // 使用着色器程序
         GLES20.glUseProgram(programId)
+        GLES20.glUniform1f(scaleYHandle, scaleY)
+        GLES20.glUniform1f(scaleUVHandle, scaleUV)
 
         // 禁用深度测试
         GLES20.glDisable(GLES20.GL_DEPTH_TEST)
@@ -181,11 +235,20 @@ class VideoRenderer :
         GLES20.glDisableVertexAttribArray(texCoordHandle)
     }
 
-    private fun updateYUVTextures(data: ByteBuffer) {
-        if (videoWidth == 0 || videoHeight == 0) return
-
-        val ySize = videoWidth * videoHeight
-        val uvSize = ySize / 4
+    // 紧密排列的 YUV420P，按帧自己的尺寸上传；奇数尺寸的色度平面向上取整，与 native 侧的打包一致
+    private fun updateYUVTextures(data: ByteBuffer, width: Int, height: Int) {
+        if (width <= 0 || height <= 0) return
+
+        val chromaWidth = (width + 1) / 2
+        val chromaHeight = (height + 1) / 2
+        val ySize = width * height
+        val uvSize = chromaWidth * chromaHeight
+        if (data.capacity() < ySize + 2 * uvSize) {
+            Log.w(TAG, "Frame buffer too small for ${width}x$height: ${data.capacity()}")
+            return
+        }
+        // 行宽不一定是 4 的倍数
+        GLES20.glPixelStorei(GLES20.GL_UNPACK_ALIGNMENT, 1)
 
         // 更新 Y 分量纹理
         GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, textureIds[0])
@@ -193,7 +256,7 @@ class VideoRenderer :
         data.limit(ySize)
         GLES20.glTexImage2D(
             GLES20.GL_TEXTURE_2D, 0, GLES20.GL_LUMINANCE,
-            videoWidth, videoHeight, 0,
+            width, height, 0,
             GLES20.GL_LUMINANCE, GLES20.GL_UNSIGNED_BYTE,
             data
         )
@@ -204,7 +267,7 @@ class VideoRenderer :
         data.limit(ySize + uvSize)
         GLES20.glTexImage2D(
             GLES20.GL_TEXTURE_2D, 0, GLES20.GL_LUMINANCE,
-            videoWidth / 2, videoHeight / 2, 0,
+            chromaWidth, chromaHeight, 0,
             GLES20.GL_LUMINANCE, GLES20.GL_UNSIGNED_BYTE,
             data
         )
@@ -215,7 +278,7 @@ class VideoRenderer :
         data.limit(ySize + 2 * uvSize)
         GLES20.glTexImage2D(
             GLES20.GL_TEXTURE_2D, 0, GLES20.GL_LUMINANCE,
-            videoWidth / 2, videoHeight / 2, 0,
+            chromaWidth, chromaHeight, 0,
             GLES20.GL_LUMINANCE, GLES20.GL_UNSIGNED_BYTE,
             data
         )
@@ -223,6 +286,65 @@ class VideoRenderer :
         // 重置 buffer 位置
         data.position(0)
         data.limit(data.capacity())
+        scaleY = 1f
+        scaleUV = 1f
+    }
+
+    // 直接从解码帧的平面上传，按 stride 作为纹理宽度，避免逐行整理数据
+    private fun updateYUVTextures(frame: VideoFrame) {
+        val strides = frame.strides
+        if (strides[0] <= 0 || strides[1] <= 0 || strides[2] <= 0) return
+
+        val chromaWidth = (frame.width + 1) / 2
+        val chromaHeight = (frame.height + 1) / 2
+        val rects = frame.dirtyRects
+        if (rects != null && frame.height == uploadedHeight && strides.contentEquals(uploadedStrides)) {
+            // 只有部分块变化：GLES2 没有 UNPACK_ROW_LENGTH，按整行上传变化块所在的行带，
+            // 同一块行的矩形 y 范围相同，只上传一次
+            var lastTop = -1
+            for (i in rects.indices step 4) {
+                val top = rects[i + 1]
+                if (top == lastTop) continue
+                lastTop = top
+                val bottom = top + rects[i + 3]
+                updatePlaneRows(textureIds[0], frame.planes[0] ?: return, strides[0], top, bottom)
+                updatePlaneRows(textureIds[1], frame.planes[1] ?: return, strides[1], top / 2, (bottom + 1) / 2)
+                updatePlaneRows(textureIds[2], frame.planes[2] ?: return, strides[2], top / 2, (bottom + 1) / 2)
+            }
+            return
+        }
+
+        uploadPlane(textureIds[0], frame.planes[0] ?: return, strides[0], frame.height)
+        uploadPlane(textureIds[1], frame.planes[1] ?: return, strides[1], chromaHeight)
+        uploadPlane(textureIds[2], frame.planes[2] ?: return, strides[2], chromaHeight)
+        strides.copyInto(uploadedStrides)
+        uploadedHeight = frame.height
+
+        scaleY = frame.width.toFloat() / strides[0]
+        scaleUV = chromaWidth.toFloat() / strides[1]
+    }
+
+    private fun updatePlaneRows(textureId: Int, plane: ByteBuffer, stride: Int, top: Int, bottom: Int) {
+        GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, textureId)
+        plane.position(top * stride)
+        GLES20.glTexSubImage2D(
+            GLES20.GL_TEXTURE_2D, 0, 0, top,
+            stride, bottom - top,
+            GLES20.GL_LUMINANCE, GLES20.GL_UNSIGNED_BYTE,
+            plane
+        )
+        plane.position(0)
+    }
+
+    private fun uploadPlane(textureId: Int, plane: ByteBuffer, stride: Int, height: Int) {
+        GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, textureId)
+        plane.position(0)
+        GLES20.glTexImage2D(
+            GLES20.GL_TEXTURE_2D, 0, GLES20.GL_LUMINANCE,
+            stride, height, 0,
+            GLES20.GL_LUMINANCE, GLES20.GL_UNSIGNED_BYTE,
+            plane
+        )
     }
 
     private fun createProgram(): Int {
@@ -264,19 +386,24 @@ class VideoRenderer :
         return shader
     }
 
+    fun setFrameSource(source: FrameSource?) {
+        frameSource = source
+    }
+
     fun setVideoDimensions(width: Int, height: Int) {
         videoWidth = width
         videoHeight = height
     }
 
-    fun setYUVData(data: ByteBuffer) {
+    fun setYUVData(data: ByteBuffer, width: Int, height: Int) {
         synchronized(bufferLock) {
             // 复制数据到新的 ByteBuffer
-            val newBuffer = ByteBuffer.allocateDirect(data.capacity())
-            data.rewind()
+            val newBuffer = ByteBuffer.allocateDirect(data.remaining())
             newBuffer.put(data)
             newBuffer.rewind()
             currentBuffer = newBuffer
+            currentWidth = width
+            currentHeight = height
         }
     }
 }
@@ -0,0 +1,45 @@
+package com.giffard.video_player.renderer
+
+import android.os.Handler
+import android.os.Looper
+import android.view.Choreographer
+
+/**
+ * 把 Choreographer 的 vsync 转发给 native 调度器：每个 vsync 回调一次 [onVsync]，参数为
+ * frameTimeNanos（vsync 的时间，不是回调被执行的时间）。Choreographer 只能在有 Looper 的线程上使用，
+ * 这里固定在主线程注册；[start]/[stop] 可以在任意线程调用
+ */
+class VsyncTicker(private val onVsync: (Long) -> Unit) : Choreographer.FrameCallback {
+
+    private val mainHandler = Handler(Looper.getMainLooper())
+
+    @Volatile
+    private var running = false
+
+    fun start() {
+        if (running) {
+            return
+        }
+        running = true
+        mainHandler.post {
+            if (running) {
+                Choreographer.getInstance().postFrameCallback(this)
+            }
+        }
+    }
+
+    fun stop() {
+        running = false
+        mainHandler.post {
+            Choreographer.getInstance().removeFrameCallback(this)
+        }
+    }
+
+    override fun doFrame(frameTimeNanos: Long) {
+        if (!running) {
+            return
+        }
+        onVsync(frameTimeNanos)
+        Choreographer.getInstance().postFrameCallback(this)
+    }
+}